@@ -12,6 +12,7 @@
 #include <QStringList>
 #include <QFontDatabase>
 #include <QDebug>
+#include <utilities/memoryaccounting.h>
 #include "smuflloader.h"
 
 uint qHash(const FontColor& fontColor)
@@ -21,10 +22,18 @@ uint qHash(const FontColor& fontColor)
 
 SMuFLLoader::SMuFLLoader(QObject *parent)
     : MusicFont(parent),
-      m_engravings({0})
+      m_engravings({0}),
+      m_glyphNamesBytes(0),
+      m_fontGlyphsBytes(0)
 {
 }
 
+SMuFLLoader::~SMuFLLoader()
+{
+    setAccountedBytes(m_glyphNamesBytes, 0);
+    setAccountedBytes(m_fontGlyphsBytes, 0);
+}
+
 void SMuFLLoader::setFont(const QFont &font)
 {
     m_font = font;
@@ -69,7 +78,8 @@ void SMuFLLoader::loadGlyphnamesFromFile(const QString &glyphNamesFilePath)
 {
     QFile glyphNamesFile(glyphNamesFilePath);
     glyphNamesFile.open(QIODevice::ReadOnly);
-    QJsonDocument smuflGlyphMeta(QJsonDocument::fromJson(glyphNamesFile.readAll()));
+    QByteArray glyphNamesJson(glyphNamesFile.readAll());
+    QJsonDocument smuflGlyphMeta(QJsonDocument::fromJson(glyphNamesJson));
     glyphNamesFile.close();
 
     QJsonObject smuflGlyphs(smuflGlyphMeta.object());
@@ -79,13 +89,15 @@ void SMuFLLoader::loadGlyphnamesFromFile(const QString &glyphNamesFilePath)
     }
 
     m_glyphNames = smuflGlyphs;
+    setAccountedBytes(m_glyphNamesBytes, glyphNamesJson.size());
 }
 
 void SMuFLLoader::loadFontMetadataFromFile(const QString &fontMetadataFilePath)
 {
     QFile fontMetadataFile(fontMetadataFilePath);
     fontMetadataFile.open(QIODevice::ReadOnly);
-    QJsonDocument smuflGlyphMeta(QJsonDocument::fromJson(fontMetadataFile.readAll()));
+    QByteArray fontMetadataJson(fontMetadataFile.readAll());
+    QJsonDocument smuflGlyphMeta(QJsonDocument::fromJson(fontMetadataJson));
     fontMetadataFile.close();
 
     QJsonObject fontMetaData(smuflGlyphMeta.object());
@@ -101,6 +113,7 @@ void SMuFLLoader::loadFontMetadataFromFile(const QString &fontMetadataFilePath)
     setEngravingsFromJson(engravingsJson);
 
     m_fontGlyphs = fontMetaData.value(QStringLiteral("glyphs")).toObject();
+    setAccountedBytes(m_fontGlyphsBytes, fontMetadataJson.size());
 }
 
 void SMuFLLoader::setEngravingsFromJson(const QJsonObject &json)
@@ -225,3 +238,9 @@ quint32 SMuFLLoader::codepointFromString(const QString &codepoint) const
 
     return code;
 }
+
+void SMuFLLoader::setAccountedBytes(qint64 &accountedBytes, qint64 bytes)
+{
+    MemoryAccounting::addBytes(MemoryAccounting::FontMetadata, bytes - accountedBytes);
+    accountedBytes = bytes;
+}
@@ -20,6 +20,7 @@ class SMuFLLoader : public MusicFont
     Q_OBJECT
 public:
     explicit SMuFLLoader(QObject *parent = 0);
+    ~SMuFLLoader();
 
     void setFont(const QFont &font);
     void setFontFromPath(const QString &path);
@@ -43,11 +44,14 @@ private:
     QPointF pointFromJsonValue(const QJsonObject& json, const QString& dataName);
     quint32 codepointFromString(const QString& codepoint) const;
     quint32 codepointFromGlyphAndCodepointType(const QString& glyphname, const QString &codepointType) const;
+    void setAccountedBytes(qint64 &accountedBytes, qint64 bytes);
     QFont m_font;
     Engravings m_engravings;
     QJsonObject m_glyphNames;
     QJsonObject m_fontGlyphs;
     QHash<FontColor, QColor> m_fontColors;
+    qint64 m_glyphNamesBytes;     // Size of the loaded json files for the memory accounting
+    qint64 m_fontGlyphsBytes;
 };
 
 #endif // SMUFLLOADER_H
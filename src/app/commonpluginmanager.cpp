@@ -6,15 +6,34 @@
  *
  */
 
+#include <QDebug>
+#include <QMutexLocker>
 #include <QPluginLoader>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QSettings>
+#include <QJsonArray>
+#include <QJsonDocument>
 #include <common/graphictypes/symbolgraphicbuilder.h>
 #include <common/interfaces/symbolinterface.h>
 #include <common/interfaces/instrumentinterface.h>
 #include <common/datatypes/instrument.h>
 #include "commonpluginmanager.h"
 
+namespace {
+const QString MetaDataCacheSettingsKey("PluginMetaDataCache");
+const QString CacheLastModifiedKey("lastModified");
+const QString CacheMetaDataKey("metaData");
+const QString PluginMetaDataKey("MetaData");
+const QString InstrumentsKey("instruments");
+const QString SymbolsKey("symbols");
+const QString TypeKey("type");
+const QString NameKey("name");
+}
+
 CommonPluginManager::CommonPluginManager(QObject *parent)
     : QObject(parent),
+      m_mutex(QMutex::Recursive),
       m_staticPlugins(0),
       m_dynamicPlugins(0)
 {
@@ -23,6 +42,7 @@ CommonPluginManager::CommonPluginManager(QObject *parent)
 
 CommonPluginManager::CommonPluginManager(const QDir &pluginsPath, QObject *parent)
     : QObject(parent),
+      m_mutex(QMutex::Recursive),
       m_staticPlugins(0),
       m_dynamicPlugins(0),
       m_pluginsPath(pluginsPath)
@@ -37,14 +57,25 @@ CommonPluginManager::~CommonPluginManager()
 
 void CommonPluginManager::setPluginsPathAndLoadDynamicPlugins(const QDir &pluginsPath)
 {
+    QMutexLocker locker(&m_mutex);
     m_pluginsPath = pluginsPath;
 
     loadDynamicPlugins();
 }
 
+/*!
+ * \brief CommonPluginManager::loadStaticPlugins Registers the static plugins like the dynamic
+ *        ones. Plugins with a catalog in their meta data are instantiated on first use.
+ */
 void CommonPluginManager::loadStaticPlugins()
 {
-    foreach (QObject *plugin, QPluginLoader::staticInstances()) {
+    foreach (const QStaticPlugin &staticPlugin, QPluginLoader::staticPlugins()) {
+        PendingPlugin pendingPlugin;
+        pendingPlugin.staticInstance = staticPlugin.instance;
+        if (addPendingPlugin(pendingPlugin, staticPlugin.metaData(), &m_staticPlugins))
+            continue;
+
+        QObject *plugin = staticPlugin.instance();
         if (addInstrumentPlugin(plugin)) {
             m_staticPlugins++;
         }
@@ -52,14 +83,37 @@ void CommonPluginManager::loadStaticPlugins()
     }
 }
 
+/*!
+ * \brief CommonPluginManager::loadDynamicPlugins Reads the meta data of all plugins in the plugins
+ *        path. Plugins which list their instruments and symbols in their meta data are loaded when
+ *        one of them is used for the first time. All other plugins are loaded immediately.
+ *        The meta data is cached in the settings by file and last modification time. Entries
+ *        of plugin files, that don't exist anymore, are removed from the cache.
+ */
 void CommonPluginManager::loadDynamicPlugins()
 {
     if (m_pluginsPath.isReadable() == false) {
         qWarning("Plugin directory is not readable");
         return;
     }
-    foreach (QString fileName, m_pluginsPath.entryList(QDir::Files)) {
-        QPluginLoader loader(m_pluginsPath.absoluteFilePath(fileName));
+
+    QSettings settings;
+    QByteArray cachedJson(settings.value(MetaDataCacheSettingsKey).toByteArray());
+    QJsonObject oldCache(QJsonDocument::fromJson(cachedJson).object());
+    QJsonObject cache(oldCache);
+
+    foreach (const QFileInfo &pluginFile, m_pluginsPath.entryInfoList(QDir::Files)) {
+        QJsonObject metaData(pluginMetaData(pluginFile, &cache));
+        if (metaData.isEmpty())
+            continue;
+
+        PendingPlugin pendingPlugin;
+        pendingPlugin.loader = new QPluginLoader(pluginFile.absoluteFilePath(), this);
+        if (addPendingPlugin(pendingPlugin, metaData, &m_dynamicPlugins))
+            continue;
+        delete pendingPlugin.loader;
+
+        QPluginLoader loader(pluginFile.absoluteFilePath());
         QObject *plugin = loader.instance();
         if (plugin) {
             if (addInstrumentPlugin(plugin)) {
@@ -68,9 +122,172 @@ void CommonPluginManager::loadDynamicPlugins()
             addSymbolPlugin(plugin);
         }
     }
+
+    foreach (const QString &filePath, cache.keys()) {
+        if (!QFileInfo::exists(filePath))
+            cache.remove(filePath);
+    }
+
+    if (cache != oldCache) {
+        settings.setValue(MetaDataCacheSettingsKey,
+                          QJsonDocument(cache).toJson(QJsonDocument::Compact));
+    }
+}
+
+/*!
+ * \brief CommonPluginManager::pluginMetaData Returns the meta data of a plugin file without
+ *        loading the plugin. The meta data is only read from the file, if it isn't in the cache
+ *        or the file has changed.
+ * \return The meta data or an empty object, if the file is no plugin.
+ */
+QJsonObject CommonPluginManager::pluginMetaData(const QFileInfo &pluginFile, QJsonObject *cache) const
+{
+    QString filePath(pluginFile.absoluteFilePath());
+    double lastModified = static_cast<double>(pluginFile.lastModified().toMSecsSinceEpoch());
+
+    QJsonObject cacheEntry(cache->value(filePath).toObject());
+    if (cacheEntry.value(CacheLastModifiedKey).toDouble() == lastModified &&
+            cacheEntry.contains(CacheMetaDataKey)) {
+        return cacheEntry.value(CacheMetaDataKey).toObject();
+    }
+
+    QPluginLoader loader(filePath);
+    QJsonObject metaData(loader.metaData());
+
+    cacheEntry.insert(CacheLastModifiedKey, lastModified);
+    cacheEntry.insert(CacheMetaDataKey, metaData);
+    cache->insert(filePath, cacheEntry);
+
+    return metaData;
+}
+
+/*!
+ * \brief CommonPluginManager::addPendingPlugin Registers the instruments and symbols listed in
+ *        the meta data of a plugin without loading it. A dynamic plugin, that provides none of
+ *        them, is deleted.
+ * \param instrumentPluginCount Is incremented, if the plugin provides an instrument.
+ * \return False, if the meta data has no list of instruments or symbols.
+ */
+bool CommonPluginManager::addPendingPlugin(const PendingPlugin &pendingPlugin, const QJsonObject &metaData,
+                                           int *instrumentPluginCount)
+{
+    QJsonObject catalog(metaData.value(PluginMetaDataKey).toObject());
+    if (!catalog.contains(InstrumentsKey) &&
+            !catalog.contains(SymbolsKey))
+        return false;
+
+    int plugin = m_pendingPlugins.count();
+    bool hasInstrument = false;
+    foreach (const QJsonValue &value, catalog.value(InstrumentsKey).toArray()) {
+        QJsonObject instrument(value.toObject());
+        int type = instrument.value(TypeKey).toInt();
+        QString name = instrument.value(NameKey).toString();
+        if (type == LP::NoInstrument ||
+                m_instrumentMetaDatas.contains(type) ||
+                m_pendingInstruments.contains(type) ||
+                m_instrumentTypes.contains(name))
+            continue;
+
+        PendingInstrument pendingInstrument;
+        pendingInstrument.name = name;
+        pendingInstrument.plugin = plugin;
+        m_pendingInstruments.insert(type, pendingInstrument);
+        m_instrumentTypes.insert(name, type);
+        hasInstrument = true;
+    }
+
+    bool hasSymbol = false;
+    foreach (const QJsonValue &value, catalog.value(SymbolsKey).toArray()) {
+        int type = value.toObject().value(TypeKey).toInt();
+        if (type == LP::NoSymbolType ||
+                m_symbolDispatch.contains(type) ||
+                m_pendingSymbolPlugins.contains(type))
+            continue;
+
+        m_pendingSymbolPlugins.insert(type, plugin);
+        hasSymbol = true;
+    }
+
+    if (hasInstrument)
+        (*instrumentPluginCount)++;
+    if (hasInstrument || hasSymbol)
+        m_pendingPlugins.append(pendingPlugin);
+    else
+        delete pendingPlugin.loader;
+
+    return true;
+}
+
+/*!
+ * \brief CommonPluginManager::loadPendingPlugin Loads a plugin registered with addPendingPlugin
+ *        and adds its instruments and symbols like the ones of all other plugins. The plugin
+ *        belongs to the thread of the manager, even if it is loaded from another thread.
+ */
+void CommonPluginManager::loadPendingPlugin(int pendingPlugin) const
+{
+    QMutableMapIterator<int, PendingInstrument> instruments(m_pendingInstruments);
+    while (instruments.hasNext()) {
+        if (instruments.next().value().plugin == pendingPlugin)
+            instruments.remove();
+    }
+
+    QMutableHashIterator<int, int> symbols(m_pendingSymbolPlugins);
+    while (symbols.hasNext()) {
+        if (symbols.next().value() == pendingPlugin)
+            symbols.remove();
+    }
+
+    const PendingPlugin &pending = m_pendingPlugins.at(pendingPlugin);
+    QObject *plugin = 0;
+    if (pending.staticInstance) {
+        plugin = pending.staticInstance();
+    } else {
+        plugin = pending.loader->instance();
+        if (!plugin) {
+            qWarning() << "CommonPluginManager: Can't load plugin " << pending.loader->fileName()
+                       << ": " << pending.loader->errorString();
+            return;
+        }
+    }
+
+    if (plugin->thread() != thread())
+        plugin->moveToThread(thread());
+
+    addInstrumentPlugin(plugin);
+    addSymbolPlugin(plugin);
+}
+
+void CommonPluginManager::loadPendingSymbolPlugin(int symbolType) const
+{
+    if (m_pendingSymbolPlugins.isEmpty())
+        return;
+
+    int pendingPlugin = m_pendingSymbolPlugins.value(symbolType, -1);
+    if (pendingPlugin != -1)
+        loadPendingPlugin(pendingPlugin);
+}
+
+void CommonPluginManager::loadPendingInstrumentPlugin(int instrumentType) const
+{
+    if (m_pendingInstruments.isEmpty())
+        return;
+
+    int pendingPlugin = m_pendingInstruments.value(instrumentType).plugin;
+    if (pendingPlugin != -1)
+        loadPendingPlugin(pendingPlugin);
+}
+
+void CommonPluginManager::loadAllPendingPlugins() const
+{
+    while (!m_pendingInstruments.isEmpty()) {
+        loadPendingPlugin(m_pendingInstruments.first().plugin);
+    }
+    while (!m_pendingSymbolPlugins.isEmpty()) {
+        loadPendingPlugin(m_pendingSymbolPlugins.constBegin().value());
+    }
 }
 
-bool CommonPluginManager::addInstrumentPlugin(QObject *plugin)
+bool CommonPluginManager::addInstrumentPlugin(QObject *plugin) const
 {
     InstrumentInterface *iInstrument = qobject_cast<InstrumentInterface *> (plugin);
     if (iInstrument) {
@@ -83,7 +300,7 @@ bool CommonPluginManager::addInstrumentPlugin(QObject *plugin)
     return false;
 }
 
-void CommonPluginManager::addSymbolPlugin(QObject *plugin)
+void CommonPluginManager::addSymbolPlugin(QObject *plugin) const
 {
     SymbolInterface *iSymbols = qobject_cast<SymbolInterface *> (plugin);
     if (iSymbols) {
@@ -92,16 +309,28 @@ void CommonPluginManager::addSymbolPlugin(QObject *plugin)
             SymbolMetaData metaData = iSymbols->symbolMetaDataForType(type);
             if (metaData.isValid()) {
                 m_symbolMetaDatas.insert(type, metaData);
+
+                // The first plugin providing a symbol type creates its symbols, symbol types
+                // of a pending plugin are reserved for it
+                if (!m_symbolDispatch.contains(type) &&
+                        !m_pendingSymbolPlugins.contains(type)) {
+                    SymbolDispatch dispatch;
+                    dispatch.plugin = iSymbols;
+                    dispatch.prototype = QSharedPointer<SymbolBehavior>(iSymbols->symbolBehaviorForType(type));
+                    dispatch.additionalDataRoles = iSymbols->additionalDataForSymbolType(type);
+                    m_symbolDispatch.insert(type, dispatch);
+                }
             }
         }
     }
 }
 
-bool CommonPluginManager::insertInstrumentPlugin(InstrumentInterface *instrument)
+bool CommonPluginManager::insertInstrumentPlugin(InstrumentInterface *instrument) const
 {
     InstrumentMetaData instrumentMeta = instrument->instrumentMetaData();
     int instrumentType = instrument->type();
-    if (m_instrumentMetaDatas.contains(instrumentType))
+    if (m_instrumentMetaDatas.contains(instrumentType) ||
+            isPendingInstrument(instrumentType, instrumentMeta.name()))
         return false;
 
     m_instrumentMetaDatas.insert(instrumentType, instrumentMeta);
@@ -112,10 +341,12 @@ bool CommonPluginManager::insertInstrumentPlugin(InstrumentInterface *instrument
         return false;
     }
     m_instrumentPlugins.insert(instrumentName, instrument);
+    if (!m_instrumentTypes.contains(instrumentName))
+        m_instrumentTypes.insert(instrumentName, instrumentType);
     return true;
 }
 
-void CommonPluginManager::insertInstrumentSymbolPlugin(QObject *plugin, const QString &instrumentName)
+void CommonPluginManager::insertInstrumentSymbolPlugin(QObject *plugin, const QString &instrumentName) const
 {
     SymbolInterface *iSymbols = qobject_cast<SymbolInterface *> (plugin);
     if (iSymbols) {
@@ -125,7 +356,19 @@ void CommonPluginManager::insertInstrumentSymbolPlugin(QObject *plugin, const QS
 
 bool CommonPluginManager::hasInstrumentWithName(const QString &name) const
 {
-    return m_instrumentPlugins.keys().contains(name);
+    return m_instrumentPlugins.contains(name);
+}
+
+bool CommonPluginManager::isPendingInstrument(int type, const QString &name) const
+{
+    if (m_pendingInstruments.contains(type))
+        return true;
+
+    foreach (const PendingInstrument &pendingInstrument, m_pendingInstruments) {
+        if (pendingInstrument.name == name)
+            return true;
+    }
+    return false;
 }
 
 MusicFontPtr CommonPluginManager::musicFont() const
@@ -162,51 +405,82 @@ ItemInteraction *CommonPluginManager::itemInteractionForType(int type)
     return symbolPlugin->itemInteractionForType(type);
 }
 
+/*!
+ * \brief CommonPluginManager::graceNoteStaffPositions Returns the grace notes, which the
+ *        instrument plays for the embellishment before a melody note at melodyStaffPos.
+ */
+QVector<int> CommonPluginManager::graceNoteStaffPositions(int instrumentType, int symbolType,
+                                                          int melodyStaffPos) const
+{
+    QMutexLocker locker(&m_mutex);
+    InstrumentInterface *instrument = m_instrumentPlugins.value(instrumentMetaData(instrumentType).name());
+    if (!instrument)
+        return QVector<int>();
+
+    return instrument->graceNoteStaffPositions(symbolType, melodyStaffPos);
+}
+
+QList<int> CommonPluginManager::instrumentTypes() const
+{
+    QMutexLocker locker(&m_mutex);
+    QList<int> types(m_instrumentMetaDatas.keys());
+    types << m_pendingInstruments.keys();
+    return types;
+}
+
 QStringList CommonPluginManager::instrumentNames() const
 {
+    QMutexLocker locker(&m_mutex);
     QStringList names;
     foreach (const InstrumentMetaData metaData, m_instrumentMetaDatas) {
         names << metaData.name();
     }
+    foreach (const PendingInstrument &pendingInstrument, m_pendingInstruments) {
+        names << pendingInstrument.name;
+    }
 
     return names;
 }
 
+/*!
+ * \brief CommonPluginManager::symbolBehaviorForType Returns a clone of the prototype behavior,
+ *        which was created by the plugin for type when the plugin was loaded.
+ */
 SymbolBehavior *CommonPluginManager::symbolBehaviorForType(int type)
 {
-    SymbolInterface *symbolPlugin = symbolPluginWithSymbol(type);
-    if (!symbolPlugin)
+    QMutexLocker locker(&m_mutex);
+    loadPendingSymbolPlugin(type);
+    QHash<int, SymbolDispatch>::const_iterator it = m_symbolDispatch.constFind(type);
+    if (it == m_symbolDispatch.constEnd() || it->prototype.isNull())
         return 0;
 
-    return symbolPlugin->symbolBehaviorForType(type);
+    return it->prototype->clone();
 }
 
 QVector<int> CommonPluginManager::additionalDataForSymbolType(int symbolType)
 {
-    SymbolInterface *symbolPlugin = symbolPluginWithSymbol(symbolType);
-    if (!symbolPlugin)
+    QMutexLocker locker(&m_mutex);
+    loadPendingSymbolPlugin(symbolType);
+    QHash<int, SymbolDispatch>::const_iterator it = m_symbolDispatch.constFind(symbolType);
+    if (it == m_symbolDispatch.constEnd())
         return QVector<int>();
 
-    return symbolPlugin->additionalDataForSymbolType(symbolType);
+    return it->additionalDataRoles;
 }
 
-SymbolInterface *CommonPluginManager::symbolPluginWithSymbol(int symbolType)
+/*!
+ * \brief CommonPluginManager::symbolPluginWithSymbol Returns the plugin, which was registered
+ *        for symbolType when the plugins were loaded or 0, if there is none.
+ */
+SymbolInterface *CommonPluginManager::symbolPluginWithSymbol(int symbolType) const
 {
-    foreach (SymbolInterface *symbolPlugin, m_symbolPlugins) {
-        if (!symbolPlugin)
-            continue;
-
-        QList<int> symbolTypes(symbolPlugin->symbolTypes());
-
-        if (symbolTypes.contains(symbolType)) {
-            SymbolMetaData symbolMeta = symbolPlugin->symbolMetaDataForType(symbolType);
-            if (symbolMeta.isValid()) {
-                return symbolPlugin;
-            }
-        }
-    }
+    QMutexLocker locker(&m_mutex);
+    loadPendingSymbolPlugin(symbolType);
+    QHash<int, SymbolDispatch>::const_iterator it = m_symbolDispatch.constFind(symbolType);
+    if (it == m_symbolDispatch.constEnd())
+        return 0;
 
-    return 0;
+    return it->plugin;
 }
 PluginManager CommonPluginManager::sharedPluginManager() const
 {
@@ -221,32 +495,47 @@ void CommonPluginManager::setSharedPluginManager(const PluginManager &pluginMana
 
 QList<SymbolMetaData> CommonPluginManager::symbolMetaDatas() const
 {
+    QMutexLocker locker(&m_mutex);
+    loadAllPendingPlugins();
     return m_symbolMetaDatas.values();
 }
 
 SymbolMetaData CommonPluginManager::symbolMetaData(int type) const
 {
+    QMutexLocker locker(&m_mutex);
+    loadPendingSymbolPlugin(type);
     return m_symbolMetaDatas.value(type);
 }
 
 QList<InstrumentMetaData> CommonPluginManager::instrumentMetaDatas() const
 {
+    QMutexLocker locker(&m_mutex);
+    loadAllPendingPlugins();
     return m_instrumentMetaDatas.values();
 }
 
 InstrumentMetaData CommonPluginManager::instrumentMetaData(int type) const
 {
+    QMutexLocker locker(&m_mutex);
+    loadPendingInstrumentPlugin(type);
     return m_instrumentMetaDatas.value(type);
 }
 
 InstrumentMetaData CommonPluginManager::instrumentMetaData(const QString &instrumentName) const
 {
-    foreach (const int type, m_instrumentMetaDatas.keys()) {
-        InstrumentMetaData metaData = instrumentMetaData(type);
-        if (metaData.name() == instrumentName) {
-            return metaData;
-        }
-    }
+    int type = instrumentTypeForName(instrumentName);
+    if (type == LP::NoInstrument)
+        return InstrumentMetaData();
+
+    return instrumentMetaData(type);
+}
 
-    return InstrumentMetaData();
+/*!
+ * \brief CommonPluginManager::instrumentTypeForName Returns the type of the instrument with
+ *        instrumentName or LP::NoInstrument, if there is none. The plugin isn't loaded.
+ */
+int CommonPluginManager::instrumentTypeForName(const QString &instrumentName) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_instrumentTypes.value(instrumentName, LP::NoInstrument);
 }
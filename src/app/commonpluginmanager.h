@@ -11,12 +11,20 @@
 
 #include <QDir>
 #include <QMap>
+#include <QHash>
+#include <QSharedPointer>
+#include <QJsonObject>
+#include <QMutex>
+#include <QVector>
 #include <QStringList>
 #include <QObject>
+#include <QtPlugin>
 #include <common/pluginmanagerinterface.h>
 
 class SymbolInterface;
 class InstrumentInterface;
+class QPluginLoader;
+class QFileInfo;
 
 class CommonPluginManager : public QObject,
                             public PluginManagerInterface
@@ -34,13 +42,15 @@ public:
     QList<InstrumentMetaData> instrumentMetaDatas() const;
     InstrumentMetaData instrumentMetaData(int type) const;
     InstrumentMetaData instrumentMetaData(const QString &instrumentName) const;
+    int instrumentTypeForName(const QString &instrumentName) const;
 
     SymbolBehavior *symbolBehaviorForType(int type);
     QVector<int> additionalDataForSymbolType(int symbolType);
     SymbolGraphicBuilder *symbolGraphicBuilderForType(int type);
     ItemInteraction *itemInteractionForType(int type);
+    QVector<int> graceNoteStaffPositions(int instrumentType, int symbolType, int melodyStaffPos) const;
 
-    QList<int> instrumentTypes() const { return m_instrumentMetaDatas.keys(); }
+    QList<int> instrumentTypes() const;
     QStringList instrumentNames() const;
 
     int staticPluginsCount() const { return m_staticPlugins; }
@@ -56,19 +66,63 @@ public:
     void setSharedPluginManager(const PluginManager &sharedPluginManager);
 
 private:
+    struct SymbolDispatch {
+        SymbolDispatch()
+            : plugin(0) {}
+
+        SymbolInterface *plugin;
+        QSharedPointer<SymbolBehavior> prototype;
+        QVector<int> additionalDataRoles;
+    };
+
+    struct PendingPlugin {
+        PendingPlugin()
+            : loader(0), staticInstance(0) {}
+
+        QPluginLoader *loader;                      // Dynamic plugin
+        QtPluginInstanceFunction staticInstance;    // Static plugin
+    };
+
+    struct PendingInstrument {
+        PendingInstrument()
+            : plugin(-1) {}
+
+        QString name;
+        int plugin;
+    };
+
     void loadStaticPlugins();
     void loadDynamicPlugins();
-    bool addInstrumentPlugin(QObject *plugin);
-    void addSymbolPlugin(QObject *plugin);
-    bool insertInstrumentPlugin(InstrumentInterface *instrument);
-    void insertInstrumentSymbolPlugin(QObject *plugin, const QString &instrumentName);
+    QJsonObject pluginMetaData(const QFileInfo &pluginFile, QJsonObject *cache) const;
+    bool addPendingPlugin(const PendingPlugin &pendingPlugin, const QJsonObject &metaData,
+                          int *instrumentPluginCount);
+    void loadPendingPlugin(int pendingPlugin) const;
+    void loadPendingSymbolPlugin(int symbolType) const;
+    void loadPendingInstrumentPlugin(int instrumentType) const;
+    void loadAllPendingPlugins() const;
+    bool addInstrumentPlugin(QObject *plugin) const;
+    void addSymbolPlugin(QObject *plugin) const;
+    bool insertInstrumentPlugin(InstrumentInterface *instrument) const;
+    void insertInstrumentSymbolPlugin(QObject *plugin, const QString &instrumentName) const;
     bool hasInstrumentWithName(const QString &name) const;
-    SymbolInterface *symbolPluginWithSymbol(int symbolType);
-    QMap<QString, InstrumentInterface*> m_instrumentPlugins;
-    QMap<QString, SymbolInterface*> m_instrumentSymbols;
-    QMap<int, SymbolMetaData> m_symbolMetaDatas;
-    QMap<int, InstrumentMetaData> m_instrumentMetaDatas;
-    QList<SymbolInterface*> m_symbolPlugins;
+    bool isPendingInstrument(int type, const QString &name) const;
+    SymbolInterface *symbolPluginWithSymbol(int symbolType) const;
+
+    // Pending plugins are loaded on first use, which can happen in the const lookups.
+    // The lookups can be called from any thread, all tables are guarded by m_mutex.
+    mutable QMutex m_mutex;
+    mutable QMap<QString, InstrumentInterface*> m_instrumentPlugins;
+    mutable QMap<QString, SymbolInterface*> m_instrumentSymbols;
+    mutable QMap<int, SymbolMetaData> m_symbolMetaDatas;
+    mutable QMap<int, InstrumentMetaData> m_instrumentMetaDatas;
+    mutable QHash<QString, int> m_instrumentTypes;      // Type of every loaded and pending instrument by name
+    mutable QList<SymbolInterface*> m_symbolPlugins;
+    mutable QHash<int, SymbolDispatch> m_symbolDispatch;  // Plugin, prototype behavior and prebuilt data
+                                                          // for every symbol type
+    QVector<PendingPlugin> m_pendingPlugins;                    // Plugins with a catalog in their meta data
+    mutable QMap<int, PendingInstrument> m_pendingInstruments;  // Instruments of not yet loaded plugins
+    mutable QHash<int, int> m_pendingSymbolPlugins;             // Pending plugin of not yet loaded symbol types
+
     int m_staticPlugins;
     int m_dynamicPlugins;
     QDir m_pluginsPath;
@@ -7,9 +7,248 @@
  */
 
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QDir>
 #include <QIcon>
+#include <QTextStream>
+#include <common/itemdataroles.h>
+#include <common/layoutsettings.h>
+#include <common/playback/offlinerenderer.h>
+#include <model/bwwimporter.h>
+#include <model/musicmodel.h>
+#include <model/scoregenerator.h>
+#include <utilities/error.h>
+#include <utilities/memoryaccounting.h>
+#include <utilities/tracer.h>
+#include <views/graphicsitemview/offscreenpageview.h>
+#include <views/graphicsitemview/svgpageexporter.h>
+#include "commonpluginmanager.h"
+#include "SMuFL/smuflloader.h"
 #include "mainwindow.h"
 
+namespace {
+// If set, the hot paths are traced and written to this file on exit
+const char *TraceFileVariable = "LIMEPIPES_TRACE_FILE";
+
+MusicFontPtr loadMusicFont()
+{
+    SMuFLLoader *smuflLoader = new SMuFLLoader();
+    smuflLoader->setFontFromPath(QStringLiteral(":/SMuFL/fonts/Bravura/Bravura.otf"));
+    smuflLoader->setFontPixelSize(4 * LayoutSettings().staffSpacePixel());
+    smuflLoader->loadGlyphnamesFromFile(QStringLiteral(":/SMuFL/glyphnames.json"));
+    smuflLoader->loadFontMetadataFromFile(QStringLiteral(":/SMuFL/fonts/Bravura/metadata.json"));
+    smuflLoader->setFontColor(FontColor::Normal, Qt::black);
+    MusicFontPtr musicFont(smuflLoader);
+    LayoutSettings::setMusicFont(musicFont);
+    return musicFont;
+}
+
+/*!
+ * \brief loadPluginManager Returns the plugin manager for the plugins next to the executable.
+ *        The music font is only set, if one is passed.
+ */
+PluginManager loadPluginManager(const MusicFontPtr &musicFont = MusicFontPtr())
+{
+    QDir pluginsDir(QCoreApplication::applicationDirPath());
+    pluginsDir.cd("plugins");
+    CommonPluginManager *commonPluginManager = new CommonPluginManager(pluginsDir);
+    PluginManager pluginManager(commonPluginManager);
+    commonPluginManager->setSharedPluginManager(pluginManager);
+    if (musicFont)
+        commonPluginManager->setMusicFont(musicFont);
+    return pluginManager;
+}
+
+int exportPages(const QString &documentsDir, const QString &outputDir)
+{
+    MusicFontPtr musicFont(loadMusicFont());
+
+    PluginManager pluginManager(loadPluginManager(musicFont));
+
+    SvgPageExporter exporter;
+    exporter.setPluginManager(pluginManager);
+    int pageCount = exporter.exportDirectory(documentsDir, outputDir);
+
+    QTextStream out(stdout);
+    out << "Exported " << pageCount << " pages to " << outputDir << endl;
+    out << exporter.failedCount() << " documents or pages failed" << endl;
+
+    return exporter.failedCount() ? 1 : 0;
+}
+
+int renderAudio(const QString &documentsDir, const QString &outputDir)
+{
+    QDir dir(documentsDir);
+    if (!dir.exists()) {
+        qWarning() << "Documents directory doesn't exist " << documentsDir;
+        return 1;
+    }
+
+    PluginManager pluginManager(loadPluginManager());
+
+    OfflineRenderer renderer;
+    renderer.setPluginManager(pluginManager);
+    int fileCount = 0;
+    int failedCount = 0;
+    QStringList nameFilters(QStringLiteral("*.lime"));
+    foreach (const QFileInfo &fileInfo, dir.entryInfoList(nameFilters, QDir::Files, QDir::Name)) {
+        MusicModel model;
+        model.setPluginManager(pluginManager);
+        try {
+            model.load(fileInfo.absoluteFilePath());
+        } catch (LP::Error &error) {
+            qWarning() << "Can't load " << fileInfo.absoluteFilePath()
+                       << QString::fromUtf8(error.what());
+            failedCount++;
+            continue;
+        }
+
+        int writtenFiles = renderer.renderScores(&model, outputDir, fileInfo.completeBaseName());
+        failedCount += model.rowCount(QModelIndex()) - writtenFiles;
+        fileCount += writtenFiles;
+    }
+
+    QTextStream out(stdout);
+    out << "Rendered " << fileCount << " audio files to " << outputDir << endl;
+    out << failedCount << " documents or scores failed" << endl;
+
+    return failedCount ? 1 : 0;
+}
+
+int memoryReport(const QString &documentsDir)
+{
+    QDir dir(documentsDir);
+    if (!dir.exists()) {
+        qWarning() << "Documents directory doesn't exist " << documentsDir;
+        return 1;
+    }
+
+    MusicFontPtr musicFont(loadMusicFont());
+
+    PluginManager pluginManager(loadPluginManager(musicFont));
+
+    // All documents stay loaded and laid out on pages, so that the report contains all of
+    // them and the layers of the visual items, graphics items and glyphs
+    QList<MusicModel*> models;
+    QList<OffscreenPageView*> offscreenViews;
+    MemoryAccounting::NamedSizes scoreSizes;
+    int failedCount = 0;
+    QStringList nameFilters(QStringLiteral("*.lime"));
+    foreach (const QFileInfo &fileInfo, dir.entryInfoList(nameFilters, QDir::Files, QDir::Name)) {
+        MusicModel *model = new MusicModel();
+        model->setPluginManager(pluginManager);
+
+        OffscreenPageView *offscreenView = new OffscreenPageView();
+        offscreenView->setPluginManager(pluginManager);
+        offscreenView->setModel(model);
+        try {
+            model->load(fileInfo.absoluteFilePath());
+        } catch (LP::Error &error) {
+            qWarning() << "Can't load " << fileInfo.absoluteFilePath()
+                       << QString::fromUtf8(error.what());
+            delete offscreenView;
+            delete model;
+            failedCount++;
+            continue;
+        }
+        offscreenView->flushPendingLayout();
+
+        for (int row = 0; row < model->rowCount(QModelIndex()); ++row) {
+            QModelIndex score = model->index(row, 0, QModelIndex());
+            scoreSizes << qMakePair(QString("%1: %2").arg(fileInfo.fileName(),
+                                                          score.data(LP::ScoreTitle).toString()),
+                                    model->memoryUsage(score));
+        }
+        models << model;
+        offscreenViews << offscreenView;
+    }
+
+    QTextStream out(stdout);
+    out << MemoryAccounting::report(scoreSizes) << endl;
+    out << models.count() << " documents loaded, " << failedCount << " failed" << endl;
+
+    qDeleteAll(offscreenViews);
+    qDeleteAll(models);
+    return failedCount ? 1 : 0;
+}
+
+int generateScores(int scoreCount, const QString &outputDir)
+{
+    PluginManager pluginManager(loadPluginManager());
+
+    MusicModel model;
+    model.setPluginManager(pluginManager);
+
+    ScoreGenerator generator(pluginManager);
+    generator.setScoreCount(scoreCount);
+    generator.setInstrumentSymbolWeights();
+    if (!generator.insertScores(&model, 0).isValid()) {
+        qWarning() << "Can't generate scores";
+        return 1;
+    }
+
+    QString fileName(QDir(outputDir).absoluteFilePath(QStringLiteral("generated.lime")));
+    try {
+        model.save(fileName);
+    } catch (LP::Error &error) {
+        qWarning() << "Can't save " << fileName << QString::fromUtf8(error.what());
+        return 1;
+    }
+
+    QTextStream out(stdout);
+    out << "Generated " << model.rowCount(QModelIndex()) << " scores to " << fileName << endl;
+
+    return 0;
+}
+
+int importBww(const QString &bwwDir, const QString &outputDir)
+{
+    QDir dir(bwwDir);
+    if (!dir.exists()) {
+        qWarning() << "BWW directory doesn't exist " << bwwDir;
+        return 1;
+    }
+
+    PluginManager pluginManager(loadPluginManager());
+
+    BwwImporter importer(pluginManager);
+    QDir targetDir(outputDir);
+    int fileCount = 0;
+    int failedCount = 0;
+    int noteCount = 0;
+    int skippedTokenCount = 0;
+    QStringList nameFilters({QStringLiteral("*.bww"), QStringLiteral("*.BWW")});
+    foreach (const QFileInfo &fileInfo, dir.entryInfoList(nameFilters, QDir::Files, QDir::Name)) {
+        MusicModel model;
+        model.setPluginManager(pluginManager);
+        if (!importer.importFile(&model, fileInfo.absoluteFilePath(), 0).isValid()) {
+            failedCount++;
+            continue;
+        }
+
+        try {
+            model.save(targetDir.absoluteFilePath(fileInfo.completeBaseName() + ".lime"));
+        } catch (LP::Error &error) {
+            qWarning() << "Can't save " << fileInfo.completeBaseName()
+                       << QString::fromUtf8(error.what());
+            failedCount++;
+            continue;
+        }
+        fileCount++;
+        noteCount += importer.noteCount();
+        skippedTokenCount += importer.skippedTokenCount();
+    }
+
+    QTextStream out(stdout);
+    out << "Imported " << fileCount << " BWW files with " << noteCount << " notes to "
+        << outputDir << endl;
+    out << skippedTokenCount << " tokens skipped, " << failedCount << " files failed" << endl;
+
+    return failedCount ? 1 : 0;
+}
+}
+
 
 int main(int argc, char *argv[])
 {
@@ -20,8 +259,65 @@ int main(int argc, char *argv[])
     QApplication::setOrganizationName("limepipes.org");
     app.setWindowIcon(QIcon(":/application/application_icon"));
 
-    MainWindow w;
-    w.show();
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption exportPagesOption("export-pages",
+                                         QApplication::translate("main", "Export every page of the documents in <directory> as SVG and PNG without opening a window."),
+                                         QApplication::translate("main", "directory"));
+    QCommandLineOption renderAudioOption("render-audio",
+                                         QApplication::translate("main", "Render every score of the documents in <directory> as WAV file without opening a window."),
+                                         QApplication::translate("main", "directory"));
+    QCommandLineOption importBwwOption("import-bww",
+                                       QApplication::translate("main", "Import every Bagpipe Music Writer file in <directory> and save it as LimePipes document without opening a window."),
+                                       QApplication::translate("main", "directory"));
+    QCommandLineOption memoryReportOption("memory-report",
+                                          QApplication::translate("main", "Load and lay out every document in <directory> and print the memory used by each layer and score without opening a window."),
+                                          QApplication::translate("main", "directory"));
+    QCommandLineOption generateScoresOption("generate-scores",
+                                            QApplication::translate("main", "Generate <count> scores with all symbols of the instrument and save them as LimePipes document without opening a window."),
+                                            QApplication::translate("main", "count"));
+    QCommandLineOption outputOption("output",
+                                    QApplication::translate("main", "Output directory of the exported pages, audio files, imported and generated documents."),
+                                    QApplication::translate("main", "directory"),
+                                    QStringLiteral("."));
+    parser.addOption(exportPagesOption);
+    parser.addOption(renderAudioOption);
+    parser.addOption(importBwwOption);
+    parser.addOption(memoryReportOption);
+    parser.addOption(generateScoresOption);
+    parser.addOption(outputOption);
+    parser.process(app);
+
+    QString traceFile = QString::fromLocal8Bit(qgetenv(TraceFileVariable));
+    if (!traceFile.isEmpty())
+        Tracer::setEnabled(true);
+
+    int result = 0;
+    if (parser.isSet(exportPagesOption)) {
+        result = exportPages(parser.value(exportPagesOption), parser.value(outputOption));
+    } else if (parser.isSet(renderAudioOption)) {
+        result = renderAudio(parser.value(renderAudioOption), parser.value(outputOption));
+    } else if (parser.isSet(importBwwOption)) {
+        result = importBww(parser.value(importBwwOption), parser.value(outputOption));
+    } else if (parser.isSet(memoryReportOption)) {
+        result = memoryReport(parser.value(memoryReportOption));
+    } else if (parser.isSet(generateScoresOption)) {
+        bool ok = false;
+        int scoreCount = parser.value(generateScoresOption).toInt(&ok);
+        if (!ok || scoreCount <= 0) {
+            qWarning() << "Invalid score count " << parser.value(generateScoresOption);
+            result = 1;
+        } else {
+            result = generateScores(scoreCount, parser.value(outputOption));
+        }
+    } else {
+        MainWindow w;
+        w.show();
+        result = app.exec();
+    }
+
+    if (!traceFile.isEmpty())
+        Tracer::saveChromeTrace(traceFile);
 
-    return app.exec();
+    return result;
 }
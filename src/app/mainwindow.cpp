@@ -27,11 +27,18 @@
 #include <QtPlugin>
 #include <QMenu>
 #include <QAction>
+#include <QAbstractProxyModel>
 
 #include <utilities/error.h>
+#include <utilities/memoryaccounting.h>
+#include <utilities/tracer.h>
 #include <model/musicmodel.h>
+#include <model/scoregenerator.h>
 #include <common/itemdataroles.h>
 #include <common/layoutsettings.h>
+#include <common/playback/midifilewriter.h>
+#include <common/playback/playbackengine.h>
+#include <common/playback/timelinecompiler.h>
 #include <treeview/musicproxymodel.h>
 #include <views/treeview/treeview.h>
 #include <views/graphicsitemview/graphicsitemview.h>
@@ -78,7 +85,7 @@ MainWindow::MainWindow(QWidget *parent) :
     m_commonApplication = new CommonApplication();
     m_sharedApplication = Application(m_commonApplication);
 
-    LayoutSettings::registerObserver(this);
+    LayoutSettings::registerObserver(this, Settings::Id::StaffSpace);
 
     QDir pluginsDir(QCoreApplication::applicationDirPath());
     if (!pluginsDir.exists(pluginsDirName)) {
@@ -118,6 +125,8 @@ MainWindow::MainWindow(QWidget *parent) :
 
 MainWindow::~MainWindow()
 {
+    LayoutSettings::unregisterObserver(this);
+
     delete ui;
     ui = 0;
 
@@ -197,6 +206,17 @@ void MainWindow::createModelAndView()
 
     m_graphicsItemView->setModel(m_model);
     setCentralWidget(m_graphicsItemView);
+
+    m_timelineCompiler = new TimelineCompiler(this);
+    m_timelineCompiler->setModel(m_model);
+    m_timelineCompiler->setPluginManager(m_pluginManager);
+
+    m_playbackEngine = new PlaybackEngine(this);
+    m_playbackEngine->setTimelineCompiler(m_timelineCompiler);
+    connect(m_playbackEngine, &PlaybackEngine::currentSymbolChanged,
+            m_graphicsItemView, &GraphicsItemView::setCurrentIndex);
+    connect(m_playbackEngine, &PlaybackEngine::playingChanged,
+            ui->playbackPlayAction, &QAction::setChecked);
 }
 
 void MainWindow::createMenusAndToolBars()
@@ -405,6 +425,79 @@ void MainWindow::on_fileSaveAsAction_triggered()
     saveFileAs();
 }
 
+void MainWindow::on_fileExportPdfAction_triggered()
+{
+    MusicModelInterface *model = musicModelFromItemModel(m_proxyModel);
+    QString filename = model->filename();
+    QString dir = filename.isEmpty() ? "." : QFileInfo(filename).path();
+    filename = QFileDialog::getSaveFileName(this,
+                                            tr("%1 - Export PDF").arg(QApplication::applicationName()),
+                                            dir,
+                                            tr("PDF (*.pdf)"));
+    if (filename.isEmpty())
+        return;
+
+    if (!filename.toLower().endsWith(".pdf"))
+        filename += ".pdf";
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    bool exported = m_graphicsItemView->exportPdf(filename);
+    QApplication::restoreOverrideCursor();
+
+    if (exported) {
+        statusBar()->showMessage(tr("Exported %1").arg(filename), StatusTimeout);
+    } else {
+        QMessageBox::warning(this, tr("Export PDF"),
+                             tr("The pages couldn't be exported to %1").arg(filename));
+    }
+}
+
+void MainWindow::on_fileExportMidiAction_triggered()
+{
+    MusicModelInterface *model = musicModelFromItemModel(m_proxyModel);
+    QString filename = model->filename();
+    QString dir = filename.isEmpty() ? "." : QFileInfo(filename).path();
+    filename = QFileDialog::getSaveFileName(this,
+                                            tr("%1 - Export MIDI").arg(QApplication::applicationName()),
+                                            dir,
+                                            tr("MIDI (*.mid)"));
+    if (filename.isEmpty())
+        return;
+
+    if (!filename.toLower().endsWith(".mid"))
+        filename += ".mid";
+
+    MidiFileWriter writer;
+    QModelIndex firstTune = m_model->index(0, 0, m_model->index(0, 0, QModelIndex()));
+    writer.setProgram(MidiFileWriter::programForInstrument(firstTune.data(LP::TuneInstrument).toInt()));
+
+    if (writer.save(m_timelineCompiler->timeline(QModelIndex()), filename)) {
+        statusBar()->showMessage(tr("Exported %1").arg(filename), StatusTimeout);
+    } else {
+        QMessageBox::warning(this, tr("Export MIDI"),
+                             tr("The tunes couldn't be exported to %1").arg(filename));
+    }
+}
+
+void MainWindow::on_playbackPlayAction_toggled(bool checked)
+{
+    if (!checked) {
+        m_playbackEngine->stop();
+        return;
+    }
+
+    if (m_playbackEngine->isPlaying())
+        return;
+
+    QModelIndex start = m_treeView->currentIndex();
+    if (start.isValid())
+        start = static_cast<QAbstractProxyModel*>(m_proxyModel)->mapToSource(start);
+
+    m_graphicsItemView->setFocus();
+    m_playbackEngine->play(start);
+    ui->playbackPlayAction->setChecked(m_playbackEngine->isPlaying());
+}
+
 bool MainWindow::saveFile()
 {
     bool saved = false;
@@ -553,42 +646,65 @@ void MainWindow::on_editSettingsAction_triggered()
 
 void MainWindow::on_editCreateTestScoreAction_triggered()
 {
-    MusicModelInterface *musicModel;
-    musicModel = musicModelFromItemModel(m_proxyModel);
-
+    MusicModel *musicModel = qobject_cast<MusicModel*>(m_model);
     if (!musicModel)
         return;
 
-    musicModel->undoStack()->beginMacro(tr("Add Tune"));
-
-    QModelIndex score = musicModel->appendScore("Test Score");
-    QModelIndex tune = musicModel->appendTuneToScore(score,
-                                                     QStringLiteral("Great Highland Bagpipe"));
-    m_treeView->setCurrentIndex(tune);
+    ScoreGenerator generator(m_pluginManager);
+    generator.setMeasuresPerPart(4);
+    generator.setSymbolsPerMeasure(6);
+    generator.setInstrumentSymbolWeights();
 
-    musicModel->undoStack()->endMacro();
+    QModelIndex score = generator.insertScores(musicModel, musicModel->rowCount(QModelIndex()));
+    if (!score.isValid())
+        return;
 
-    QModelIndex partIndex = musicModel->insertPartIntoTune(0, tune, 4, true);
+    QModelIndex proxyScore = m_proxyModel->index(score.row(), 0, QModelIndex());
+    QModelIndex tune = m_proxyModel->index(0, 0, proxyScore);
+    m_treeView->setCurrentIndex(tune);
+    m_treeView->expandAll();
 
-    QModelIndex measureIndex1 = m_proxyModel->index(0, 0, partIndex);
-    QModelIndex measureIndex2 = m_proxyModel->index(1, 0, partIndex);
-    QModelIndex measureIndex3 = m_proxyModel->index(2, 0, partIndex);
+    updateUi();
+}
 
-    musicModel->insertSymbolIntoMeasure(0, measureIndex1, LP::MelodyNote);
+void MainWindow::on_editRecordTraceAction_toggled(bool checked)
+{
+    if (checked) {
+        Tracer::clear();
+        Tracer::setEnabled(true);
+        return;
+    }
 
-    musicModel->insertSymbolIntoMeasure(0, measureIndex2, LP::MelodyNote);
-    musicModel->insertSymbolIntoMeasure(0, measureIndex2, LP::MelodyNote);
-    musicModel->insertSymbolIntoMeasure(0, measureIndex2, LP::MelodyNote);
+    Tracer::setEnabled(false);
+    QString filename = QFileDialog::getSaveFileName(this,
+                                                    tr("%1 - Save Trace").arg(QApplication::applicationName()),
+                                                    ".",
+                                                    tr("Chrome Trace (*.json)"));
+    if (filename.isEmpty())
+        return;
 
-    musicModel->insertSymbolIntoMeasure(0, measureIndex3, LP::MelodyNote);
-    QModelIndex startTieIndex = musicModel->insertSymbolIntoMeasure(0, measureIndex3, LP::Tie);
-    musicModel->insertSymbolIntoMeasure(startTieIndex.row() + 1, measureIndex3, LP::MelodyNote);
-    musicModel->insertSymbolIntoMeasure(0, measureIndex3, LP::MelodyNote);
-    musicModel->insertSymbolIntoMeasure(0, measureIndex3, LP::MelodyNote);
+    if (!Tracer::saveChromeTrace(filename)) {
+        QMessageBox::warning(this, tr("Save Trace"),
+                             tr("The trace couldn't be saved to %1").arg(filename));
+    }
+}
 
-    m_treeView->expandAll();
+void MainWindow::on_editMemoryReportAction_triggered()
+{
+    MemoryAccounting::NamedSizes scoreSizes;
+    if (MusicModel *musicModel = qobject_cast<MusicModel*>(m_model)) {
+        for (int i = 0; i < musicModel->rowCount(QModelIndex()); ++i) {
+            QModelIndex score = musicModel->index(i, 0, QModelIndex());
+            scoreSizes << qMakePair(score.data(LP::ScoreTitle).toString(),
+                                    musicModel->memoryUsage(score));
+        }
+    }
 
-    updateUi();
+    QMessageBox messageBox(QMessageBox::Information, tr("Memory Report"),
+                           MemoryAccounting::report(scoreSizes),
+                           QMessageBox::Ok, this);
+    messageBox.setStyleSheet(QStringLiteral("QLabel { font-family: monospace; }"));
+    messageBox.exec();
 }
 
 void MainWindow::insertSymbol(int symbolType)
@@ -34,6 +34,8 @@ class SMuFLLoader;
 class ZoomWidget;
 class SymbolDockWidget;
 class TreeView;
+class TimelineCompiler;
+class PlaybackEngine;
 
 namespace Ui {
 class MainWindow;
@@ -55,6 +57,9 @@ private slots:
     void on_fileOpenAction_triggered();
     void on_fileSaveAction_triggered();
     void on_fileSaveAsAction_triggered();
+    void on_fileExportPdfAction_triggered();
+    void on_fileExportMidiAction_triggered();
+    void on_playbackPlayAction_toggled(bool checked);
     void on_editAddTuneAction_triggered();
     void on_editAddTunePartAction_triggered();
     void on_editAddSymbolsAction_triggered();
@@ -63,6 +68,8 @@ private slots:
     void on_helpAboutAction_triggered();
     void on_editSettingsAction_triggered();
     void on_editCreateTestScoreAction_triggered();
+    void on_editRecordTraceAction_toggled(bool checked);
+    void on_editMemoryReportAction_triggered();
     void insertSymbol(int symbolType);
     void setWindowModifiedForUndoStackCleanState(bool clean);
 
@@ -99,6 +106,8 @@ private:
     ZoomWidget *m_zoomWidget;
     QHash<QString, SymbolDockWidget*> m_symbolDockWidgets;
     CommonApplication *m_commonApplication;
+    TimelineCompiler *m_timelineCompiler;
+    PlaybackEngine *m_playbackEngine;
     Application m_sharedApplication;
 };
 
@@ -12,11 +12,62 @@
 #include "datakeys.h"
 #include "itembehavior.h"
 
+namespace {
+// Approximate size of one entry in the data hash
+const qint64 DataEntryCost = sizeof(QVariant) + sizeof(int) + 2 * sizeof(void*);
+}
+
 ItemBehavior::ItemBehavior(LP::ItemType type)
+    : m_accountingLayer(type == LP::ItemType::SymbolType ? MemoryAccounting::PluginBehaviors
+                                                         : MemoryAccounting::ItemBehaviors),
+      m_memoryUsage(sizeof(ItemBehavior))
 {
+    MemoryAccounting::addInstance(m_accountingLayer, m_memoryUsage);
     setType(type);
 }
 
+ItemBehavior::ItemBehavior(const ItemBehavior &other)
+    : m_data(other.m_data),
+      m_supportedData(other.m_supportedData),
+      m_accountingLayer(other.m_accountingLayer),
+      m_memoryUsage(other.m_memoryUsage)
+{
+    MemoryAccounting::addInstance(m_accountingLayer, m_memoryUsage);
+}
+
+ItemBehavior::~ItemBehavior()
+{
+    MemoryAccounting::removeInstance(m_accountingLayer, m_memoryUsage);
+}
+
+/*!
+ * \brief ItemBehavior::operator = Copies the data of other. The accounted memory moves to
+ *        the layer of other.
+ */
+ItemBehavior &ItemBehavior::operator=(const ItemBehavior &other)
+{
+    if (this == &other)
+        return *this;
+
+    MemoryAccounting::removeInstance(m_accountingLayer, m_memoryUsage);
+    m_data = other.m_data;
+    m_supportedData = other.m_supportedData;
+    m_accountingLayer = other.m_accountingLayer;
+    m_memoryUsage = other.m_memoryUsage;
+    MemoryAccounting::addInstance(m_accountingLayer, m_memoryUsage);
+    return *this;
+}
+
+/*!
+ * \brief ItemBehavior::clone Returns a copy of this behavior. The data is implicitly shared
+ *        with this behavior until one of them changes. Subclasses have to reimplement clone
+ *        to return a copy of their own type.
+ */
+ItemBehavior *ItemBehavior::clone() const
+{
+    return new ItemBehavior(*this);
+}
+
 QVariant ItemBehavior::data(int role) const
 {
     return m_data.value(role);
@@ -26,10 +77,12 @@ void ItemBehavior::setData(const QVariant &value, int role)
 {
     if (!value.isValid()) {
         m_data.remove(role);
+        updateMemoryUsage();
         return;
     }
 
     m_data.insert(role, value);
+    updateMemoryUsage();
 }
 
 QJsonObject ItemBehavior::toJson() const
@@ -68,3 +121,22 @@ void ItemBehavior::setType(const LP::ItemType &type)
 {
     setData(static_cast<int>(type), LP::MusicItemType);
 }
+
+/*!
+ * \brief ItemBehavior::memoryUsage Returns the approximate number of bytes of this behavior
+ *        and its data. Implicitly shared data is counted for every behavior.
+ */
+qint64 ItemBehavior::memoryUsage() const
+{
+    return m_memoryUsage;
+}
+
+void ItemBehavior::updateMemoryUsage()
+{
+    qint64 memoryUsage = sizeof(ItemBehavior) + m_data.count() * DataEntryCost;
+    if (memoryUsage == m_memoryUsage)
+        return;
+
+    MemoryAccounting::addBytes(m_accountingLayer, memoryUsage - m_memoryUsage);
+    m_memoryUsage = memoryUsage;
+}
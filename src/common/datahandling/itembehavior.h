@@ -15,12 +15,18 @@
 #include <QJsonObject>
 
 #include "common/defines.h"
+#include <utilities/memoryaccounting.h>
 
 class ItemBehavior
 {
 public:
     ItemBehavior(LP::ItemType type);
-    virtual ~ItemBehavior() {}
+    ItemBehavior(const ItemBehavior &other);
+    virtual ~ItemBehavior();
+
+    ItemBehavior &operator=(const ItemBehavior &other);
+
+    virtual ItemBehavior *clone() const;
 
     QVariant data(int role = Qt::UserRole) const;
     void setData(const QVariant &value, int role);
@@ -35,9 +41,14 @@ public:
     LP::ItemType type() const;
     void setType(const LP::ItemType &type);
 
+    qint64 memoryUsage() const;
+
 private:
+    void updateMemoryUsage();
     QHash<int, QVariant> m_data;
     QList<int> m_supportedData;
+    MemoryAccounting::Layer m_accountingLayer;
+    qint64 m_memoryUsage;
 };
 
 #endif // ITEMBEHAVIOR_H
@@ -0,0 +1,53 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+/*!
+ * @class JsonMimeData
+ * @brief Mime data which holds the json array of the dragged or copied music items.
+ *
+ * Drops within the application take the json array directly. The array is only encoded
+ * with MimeData::encode, if the data of the mime type is requested, e.g. by another
+ * application through the clipboard.
+ */
+
+#include "mimedata.h"
+#include "jsonmimedata.h"
+
+JsonMimeData::JsonMimeData(const QString &mimeType, const QJsonArray &array)
+    : m_mimeType(mimeType),
+      m_jsonArray(array)
+{
+}
+
+QJsonArray JsonMimeData::jsonArray() const
+{
+    return m_jsonArray;
+}
+
+QStringList JsonMimeData::formats() const
+{
+    return QStringList() << m_mimeType;
+}
+
+bool JsonMimeData::hasFormat(const QString &mimeType) const
+{
+    return mimeType == m_mimeType;
+}
+
+QVariant JsonMimeData::retrieveData(const QString &mimeType, QVariant::Type type) const
+{
+    Q_UNUSED(type);
+
+    if (mimeType != m_mimeType)
+        return QVariant();
+
+    if (m_encodedData.isEmpty())
+        m_encodedData = MimeData::encode(m_jsonArray);
+
+    return m_encodedData;
+}
@@ -0,0 +1,37 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#ifndef JSONMIMEDATA_H
+#define JSONMIMEDATA_H
+
+#include <QMimeData>
+#include <QJsonArray>
+#include <QStringList>
+
+class JsonMimeData : public QMimeData
+{
+    Q_OBJECT
+
+public:
+    explicit JsonMimeData(const QString &mimeType, const QJsonArray &array);
+
+    QJsonArray jsonArray() const;
+
+    QStringList formats() const;
+    bool hasFormat(const QString &mimeType) const;
+
+protected:
+    QVariant retrieveData(const QString &mimeType, QVariant::Type type) const;
+
+private:
+    QString m_mimeType;
+    QJsonArray m_jsonArray;
+    mutable QByteArray m_encodedData;
+};
+
+#endif // JSONMIMEDATA_H
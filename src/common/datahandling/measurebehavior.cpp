@@ -17,10 +17,15 @@ MeasureBehavior::MeasureBehavior()
 {
 }
 
+MeasureBehavior *MeasureBehavior::clone() const
+{
+    return new MeasureBehavior(*this);
+}
+
 QJsonObject MeasureBehavior::toJson() const
 {
     QJsonObject json(ItemBehavior::toJson());
-    TimeSignature timeSig = data(LP::TuneTimeSignature).value<TimeSignature>();
+    TimeSignature timeSig = data(LP::MeasureTimeSignature).value<TimeSignature>();
     if (timeSig.isValid()) {
         json.insert(DataKey::TimeSignature, static_cast<int>(timeSig.type()));
     }
@@ -35,4 +40,11 @@ QJsonObject MeasureBehavior::toJson() const
 void MeasureBehavior::fromJson(const QJsonObject &json)
 {
     ItemBehavior::fromJson(json);
+
+    if (json.contains(DataKey::TimeSignature)) {
+        TimeSignature::Type type = static_cast<TimeSignature::Type>(json.value(DataKey::TimeSignature).toInt());
+        setData(QVariant::fromValue<TimeSignature>(TimeSignature(type)), LP::MeasureTimeSignature);
+    }
+    if (json.contains(DataKey::MeasureIsUpbeat))
+        setData(json.value(DataKey::MeasureIsUpbeat).toBool(), LP::MeasureIsUpbeat);
 }
@@ -16,6 +16,8 @@ class MeasureBehavior : public ItemBehavior
 public:
     MeasureBehavior();
 
+    MeasureBehavior *clone() const;
+
     // ItemBehavior interface
 public:
     QJsonObject toJson() const;
@@ -11,9 +11,11 @@
 #include <QMimeData>
 
 #include "datakeys.h"
+#include "jsonmimedata.h"
 #include "mimedata.h"
 
-static const int MaxCompression = 9;
+// The data is mostly small and short-lived, fast compression is more important than size
+static const int Compression = 1;
 
 using namespace LP;
 
@@ -31,27 +33,35 @@ QMimeData *MimeData::fromJsonArray(const QJsonArray &array)
     if (mimeType.isEmpty())
         return 0;
 
-    QJsonDocument jsonDoc;
-    jsonDoc.setArray(array);
-
-    QMimeData *mimeData = new QMimeData;
-    QByteArray data = jsonDoc.toJson(QJsonDocument::Indented);
-    mimeData->setData(mimeType, qCompress(data, MaxCompression));
-
-    return mimeData;
+    return new JsonMimeData(mimeType, array);
 }
 
 QJsonArray MimeData::toJsonArray(const QMimeData *mimeData)
 {
+    if (const JsonMimeData *jsonMimeData = qobject_cast<const JsonMimeData*>(mimeData))
+        return jsonMimeData->jsonArray();
+
     QString mimeType = supportedMimeTypeFromData(mimeData);
     if (mimeType.isEmpty())
         return QJsonArray();
 
-    QByteArray data = qUncompress(mimeData->data(mimeType));
-    QJsonDocument jsonDoc = QJsonDocument::fromJson(data);
-    QJsonArray jsonArray = jsonDoc.array();
+    return decode(mimeData->data(mimeType));
+}
+
+/*!
+ * \brief MimeData::encode Returns the compressed compact json of array. This is the format
+ *        of the data which leaves the application.
+ */
+QByteArray MimeData::encode(const QJsonArray &array)
+{
+    QJsonDocument jsonDoc(array);
+    return qCompress(jsonDoc.toJson(QJsonDocument::Compact), Compression);
+}
 
-    return jsonArray;
+QJsonArray MimeData::decode(const QByteArray &data)
+{
+    QJsonDocument jsonDoc = QJsonDocument::fromJson(qUncompress(data));
+    return jsonDoc.array();
 }
 
 QString MimeData::mimeTypeForItemType(LP::ItemType type)
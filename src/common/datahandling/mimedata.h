@@ -9,6 +9,7 @@
 #ifndef MIMEDATA_H
 #define MIMEDATA_H
 
+#include <QByteArray>
 #include <QJsonArray>
 #include <common/defines.h>
 
@@ -22,6 +23,9 @@ public:
     static QMimeData *fromJsonArray(const QJsonArray &array);
     static QJsonArray toJsonArray(const QMimeData *mimeData);
 
+    static QByteArray encode(const QJsonArray &array);
+    static QJsonArray decode(const QByteArray &data);
+
     static QString mimeTypeForItemType(LP::ItemType type);
     static QString supportedMimeTypeFromData(const QMimeData *data);
 };
@@ -16,6 +16,11 @@ PartBehavior::PartBehavior()
 {
 }
 
+PartBehavior *PartBehavior::clone() const
+{
+    return new PartBehavior(*this);
+}
+
 QJsonObject PartBehavior::toJson() const
 {
     QJsonObject json(ItemBehavior::toJson());
@@ -31,4 +36,10 @@ QJsonObject PartBehavior::toJson() const
 void PartBehavior::fromJson(const QJsonObject &json)
 {
     ItemBehavior::fromJson(json);
+
+    StaffType staffType = static_cast<StaffType>(json.value(DataKey::StaffType).toInt());
+    setData(QVariant::fromValue<StaffType>(staffType), LP::PartStaffType);
+    setData(json.value(DataKey::PartRepeat).toBool(), LP::PartRepeat);
+    ClefType clef = static_cast<ClefType>(json.value(DataKey::ClefType).toInt());
+    setData(QVariant::fromValue<ClefType>(clef), LP::PartClefType);
 }
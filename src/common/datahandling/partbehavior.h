@@ -16,6 +16,8 @@ class PartBehavior : public ItemBehavior
 public:
     PartBehavior();
 
+    PartBehavior *clone() const;
+
     // ItemBehavior interface
 public:
     QJsonObject toJson() const;
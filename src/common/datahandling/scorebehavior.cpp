@@ -18,6 +18,11 @@ ScoreBehavior::ScoreBehavior()
 {
 }
 
+ScoreBehavior *ScoreBehavior::clone() const
+{
+    return new ScoreBehavior(*this);
+}
+
 QJsonObject ScoreBehavior::toJson() const
 {
     QJsonObject json(ItemBehavior::toJson());
@@ -34,6 +39,12 @@ QJsonObject ScoreBehavior::toJson() const
 void ScoreBehavior::fromJson(const QJsonObject &json)
 {
     ItemBehavior::fromJson(json);
+    readScoreData(json, LP::ScoreTitle, DataKey::ScoreTitle);
+    readScoreData(json, LP::ScoreComposer, DataKey::ScoreComposer);
+    readScoreData(json, LP::ScoreArranger, DataKey::ScoreArranger);
+    readScoreData(json, LP::ScoreYear, DataKey::ScoreYear);
+    readScoreData(json, LP::ScoreCopyright, DataKey::ScoreCopyright);
+    readScoreData(json, LP::ScoreType, DataKey::ScoreType);
 }
 
 void ScoreBehavior::insertScoreData(QJsonObject &json, int dataRole, const QString &key) const
@@ -42,3 +53,10 @@ void ScoreBehavior::insertScoreData(QJsonObject &json, int dataRole, const QStri
     if (!scoreData.isEmpty())
         json.insert(key, scoreData);
 }
+
+void ScoreBehavior::readScoreData(const QJsonObject &json, int dataRole, const QString &key)
+{
+    QString scoreData = json.value(key).toString();
+    if (!scoreData.isEmpty())
+        setData(scoreData, dataRole);
+}
@@ -18,6 +18,8 @@ class ScoreBehavior : public ItemBehavior
 public:
     ScoreBehavior();
 
+    ScoreBehavior *clone() const;
+
     // ItemBehavior interface
 public:
     QJsonObject toJson() const;
@@ -25,6 +27,7 @@ public:
 
 private:
     void insertScoreData(QJsonObject &json, int dataRole, const QString &key) const;
+    void readScoreData(const QJsonObject &json, int dataRole, const QString &key);
 };
 
 #endif // SCOREBEHAVIOR_H
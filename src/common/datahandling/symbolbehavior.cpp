@@ -18,6 +18,16 @@ SymbolBehavior::SymbolBehavior()
 {
 }
 
+/*!
+ * \brief SymbolBehavior::clone Returns a copy of this behavior with all its data. The data and
+ *        the supported data are implicitly shared with this behavior until one of them changes.
+ *        Subclasses have to reimplement clone to return a copy of their own type.
+ */
+SymbolBehavior *SymbolBehavior::clone() const
+{
+    return new SymbolBehavior(*this);
+}
+
 QJsonObject SymbolBehavior::toJson() const
 {
     QJsonObject json(ItemBehavior::toJson());
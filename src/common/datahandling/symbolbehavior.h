@@ -26,6 +26,8 @@ public:
     SymbolBehavior();
     virtual ~SymbolBehavior() {}
 
+    virtual SymbolBehavior *clone() const;
+
     int symbolType() const;
     void setSymbolType(int type);
 
@@ -19,6 +19,11 @@ TuneBehavior::TuneBehavior()
 {
 }
 
+TuneBehavior *TuneBehavior::clone() const
+{
+    return new TuneBehavior(*this);
+}
+
 QJsonObject TuneBehavior::toJson() const
 {
     QJsonObject json(ItemBehavior::toJson());
@@ -37,4 +42,13 @@ QJsonObject TuneBehavior::toJson() const
 void TuneBehavior::fromJson(const QJsonObject &json)
 {
     ItemBehavior::fromJson(json);
+
+    int instrumentType = json.value(DataKey::Instrument).toInt();
+    if (instrumentType != LP::NoInstrument)
+        setData(instrumentType, LP::TuneInstrument);
+
+    if (json.contains(DataKey::TimeSignature)) {
+        TimeSignature::Type type = static_cast<TimeSignature::Type>(json.value(DataKey::TimeSignature).toInt());
+        setData(QVariant::fromValue<TimeSignature>(TimeSignature(type)), LP::TuneTimeSignature);
+    }
 }
@@ -16,6 +16,8 @@ class TuneBehavior : public ItemBehavior
 public:
     TuneBehavior();
 
+    TuneBehavior *clone() const;
+
     // ItemBehavior interface
 public:
     QJsonObject toJson() const;
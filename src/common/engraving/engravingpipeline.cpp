@@ -0,0 +1,354 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+/*!
+ * @class EngravingPipeline
+ * @brief Computes the engraving of a score apart from the graphics items.
+ *
+ * A ScoreSnapshot is a copy of all data of a score, which affects the engraving.
+ * It is created from the model in the GUI thread. The engraving of the staves only
+ * depends on the snapshot and the EngravingMetrics, so all staves are engraved in
+ * parallel on the global thread pool. The graphics items only apply the results.
+ *
+ * Ties are numbered per staff. A tie which isn't closed at the end of a staff is
+ * marked with StaffEngraving::tieOpenAtEnd and continues as the first tie of the next
+ * staff of the part. Beam groups are numbered per measure, so the engraving of an
+ * unchanged measure stays equal and the graphics items can skip it.
+ */
+
+#include <QAbstractItemModel>
+#include <QtConcurrent/QtConcurrentMap>
+
+#include <common/itemdataroles.h>
+#include <common/datatypes/pitch.h>
+
+#include "engravingrules.h"
+#include "engravingpipeline.h"
+
+namespace {
+
+struct StaffEngraver
+{
+    typedef StaffEngraving result_type;
+
+    explicit StaffEngraver(const EngravingMetrics &metrics)
+        : m_metrics(metrics) {}
+
+    StaffEngraving operator()(const StaffSnapshot &staff) const
+    {
+        return EngravingPipeline::engraveStaff(staff, m_metrics);
+    }
+
+    EngravingMetrics m_metrics;
+};
+
+}
+
+EngravingPipeline::EngravingPipeline(QObject *parent)
+    : QObject(parent),
+      m_generation(0)
+{
+    qRegisterMetaType<StaffEngraving>();
+    qRegisterMetaType<QVector<StaffEngraving> >();
+    m_watcher = new QFutureWatcher<StaffEngraving>(this);
+    connect(m_watcher, &QFutureWatcher<StaffEngraving>::finished,
+            this, &EngravingPipeline::watcherFinished);
+}
+
+EngravingPipeline::~EngravingPipeline()
+{
+    cancel();
+    waitForFinished();
+}
+
+/*!
+ * \brief EngravingPipeline::snapshotFromModel Copies all data of the score which is needed
+ *        for the engraving. Every part starts a new staff and continues on a new staff after
+ *        EngravingRules::MeasuresPerStaff measures like the VisualPart.
+ * \param measureCache If set, only the measures missing in the cache are read from the
+ *        model and added to it. Changed measures have to be removed from the cache before.
+ * \param readSymbolTypes If set, the symbol types of the measures read from the model are added.
+ */
+ScoreSnapshot EngravingPipeline::snapshotFromModel(const QAbstractItemModel *model, const QModelIndex &scoreIndex,
+                                                   MeasureSnapshotCache *measureCache,
+                                                   QSet<int> *readSymbolTypes)
+{
+    ScoreSnapshot score;
+    if (!model || !scoreIndex.isValid())
+        return score;
+
+    for (int tuneRow = 0; tuneRow < model->rowCount(scoreIndex); ++tuneRow) {
+        QModelIndex tuneIndex = model->index(tuneRow, 0, scoreIndex);
+
+        for (int partRow = 0; partRow < model->rowCount(tuneIndex); ++partRow) {
+            QModelIndex partIndex = model->index(partRow, 0, tuneIndex);
+            StaffType staffType = partIndex.data(LP::PartStaffType).value<StaffType>();
+
+            StaffSnapshot staff;
+            staff.staffType = staffType;
+            int staffCount = 1;
+            bool tieOpen = false;
+            for (int measureRow = 0; measureRow < model->rowCount(partIndex); ++measureRow) {
+                QModelIndex measureIndex = model->index(measureRow, 0, partIndex);
+                if (staff.measures.count() == EngravingRules::MeasuresPerStaff) {
+                    score.staves << staff;
+                    staff.measures.clear();
+                    staff.tieOpenAtStart = tieOpen;
+                    staffCount++;
+                }
+
+                MeasureSnapshot measure;
+                if (measureCache && measureCache->contains(measureIndex)) {
+                    measure = measureCache->value(measureIndex);
+                } else {
+                    measure = measureSnapshotFromModel(measureIndex);
+                    if (measureCache)
+                        measureCache->insert(measureIndex, measure);
+                    if (readSymbolTypes) {
+                        foreach (const SymbolSnapshot &symbol, measure.symbols) {
+                            readSymbolTypes->insert(symbol.symbolType);
+                        }
+                    }
+                }
+
+                foreach (const SymbolSnapshot &symbol, measure.symbols) {
+                    if (symbol.symbolType != LP::Tie)
+                        continue;
+                    if (symbol.spanType == SpanType::Start)
+                        tieOpen = true;
+                    else if (symbol.spanType == SpanType::End)
+                        tieOpen = false;
+                }
+                staff.measures << measure;
+            }
+            score.staves << staff;
+            score.partStaffCounts << staffCount;
+        }
+    }
+
+    return score;
+}
+
+MeasureSnapshot EngravingPipeline::measureSnapshotFromModel(const QModelIndex &measureIndex)
+{
+    const QAbstractItemModel *model = measureIndex.model();
+    MeasureSnapshot measure;
+    measure.timeSignature = measureIndex.data(LP::MeasureTimeSignature)
+            .value<TimeSignature>().type();
+
+    int symbolCount = model->rowCount(measureIndex);
+    measure.symbols.reserve(symbolCount);
+    for (int symbolRow = 0; symbolRow < symbolCount; ++symbolRow) {
+        QModelIndex symbolIndex = model->index(symbolRow, 0, measureIndex);
+
+        SymbolSnapshot symbol;
+        symbol.symbolType = symbolIndex.data(LP::SymbolType).toInt();
+        QVariant lengthData = symbolIndex.data(LP::SymbolLength);
+        if (lengthData.isValid()) {
+            symbol.length = lengthData.value<Length::Value>();
+            symbol.hasLength = true;
+        }
+        QVariant pitchData = symbolIndex.data(LP::SymbolPitch);
+        if (pitchData.isValid()) {
+            symbol.staffPos = pitchData.value<Pitch>().staffPos();
+            symbol.hasPitch = true;
+        }
+        symbol.dots = symbolIndex.data(LP::MelodyNoteDots).toInt();
+        symbol.spanType = symbolIndex.data(LP::SymbolSpanType).value<SpanType>();
+        measure.symbols << symbol;
+    }
+
+    return measure;
+}
+
+/*!
+ * \brief EngravingPipeline::engraveStaff Engraves one staff. This function is reentrant
+ *        and may be called from any thread.
+ */
+StaffEngraving EngravingPipeline::engraveStaff(const StaffSnapshot &staff, const EngravingMetrics &metrics)
+{
+    StaffEngraving staffEngraving;
+    staffEngraving.measures.reserve(staff.measures.count());
+
+    int tieGroupCount = 0;
+    int openTieGroup = -1;
+    if (staff.tieOpenAtStart)
+        openTieGroup = tieGroupCount++;
+
+    foreach (const MeasureSnapshot &measure, staff.measures) {
+        MeasureEngraving measureEngraving;
+        measureEngraving.symbols.reserve(measure.symbols.count());
+        QVector<qreal> widths;
+        widths.reserve(measure.symbols.count());
+
+        foreach (const SymbolSnapshot &symbol, measure.symbols) {
+            SymbolEngraving symbolEngraving;
+            if (symbol.symbolType == LP::MelodyNote) {
+                symbolEngraving = engraveMelodyNote(symbol, staff.staffType, metrics);
+                symbolEngraving.tieGroup = openTieGroup;
+            } else {
+                symbolEngraving.width = metrics.symbolWidths.value(symbol.symbolType, 0);
+            }
+
+            if (symbol.symbolType == LP::Tie) {
+                if (symbol.spanType == SpanType::Start) {
+                    openTieGroup = tieGroupCount++;
+                    symbolEngraving.tieGroup = openTieGroup;
+                } else if (symbol.spanType == SpanType::End) {
+                    symbolEngraving.tieGroup = openTieGroup;
+                    openTieGroup = -1;
+                }
+            }
+
+            widths << symbolEngraving.width;
+            measureEngraving.symbols << symbolEngraving;
+        }
+
+        QList<qreal> positions(EngravingRules::symbolPositions(widths));
+        for (int i = 0; i < positions.count(); ++i) {
+            measureEngraving.symbols[i].x = positions.at(i);
+            measureEngraving.width += widths.at(i);
+        }
+
+        engraveBeams(measure, &measureEngraving, metrics);
+        staffEngraving.measures << measureEngraving;
+    }
+
+    staffEngraving.tieOpenAtEnd = openTieGroup != -1;
+    return staffEngraving;
+}
+
+QVector<StaffEngraving> EngravingPipeline::engraveScore(const ScoreSnapshot &score, const EngravingMetrics &metrics)
+{
+    QVector<StaffEngraving> staves;
+    staves.reserve(score.staves.count());
+    foreach (const StaffSnapshot &staff, score.staves) {
+        staves << engraveStaff(staff, metrics);
+    }
+    return staves;
+}
+
+/*!
+ * \brief EngravingPipeline::engrave Starts engraving the score on the thread pool. A running
+ *        engraving is canceled. The engraved signal is emitted with the returned generation.
+ */
+int EngravingPipeline::engrave(const ScoreSnapshot &score, const EngravingMetrics &metrics)
+{
+    cancel();
+    m_generation++;
+    m_watcher->setFuture(QtConcurrent::mapped(score.staves, StaffEngraver(metrics)));
+    return m_generation;
+}
+
+bool EngravingPipeline::isRunning() const
+{
+    return m_watcher->isRunning();
+}
+
+void EngravingPipeline::cancel()
+{
+    if (m_watcher->isRunning())
+        m_watcher->cancel();
+}
+
+void EngravingPipeline::waitForFinished()
+{
+    m_watcher->waitForFinished();
+}
+
+void EngravingPipeline::watcherFinished()
+{
+    if (m_watcher->isCanceled())
+        return;
+
+    emit engraved(m_generation, m_watcher->future().results().toVector());
+}
+
+SymbolEngraving EngravingPipeline::engraveMelodyNote(const SymbolSnapshot &symbol, StaffType staffType,
+                                                     const EngravingMetrics &metrics)
+{
+    SymbolEngraving engraving;
+    engraving.noteheadGlyph = EngravingRules::noteheadGlyphForLength(symbol.length);
+    engraving.flagGlyph = EngravingRules::flagGlyphForLength(symbol.length,
+                                                             EngravingRules::StemDirection::Downwards);
+    engraving.onLine = EngravingRules::isStaffPosOnLine(symbol.staffPos);
+    engraving.ledgerLines = EngravingRules::ledgerLineCount(symbol.staffPos, staffType);
+    engraving.ledgerLinesAbove = EngravingRules::ledgerLinesAbove(symbol.staffPos);
+    engraving.stemLength = metrics.stemLengthFactor * metrics.staffSpace;
+
+    qreal width = metrics.glyphWidths.value(engraving.noteheadGlyph);
+    if (engraving.ledgerLines)
+        width += 2 * metrics.ledgerLineExtension;
+    if (symbol.dots) {
+        qreal dotWidth = metrics.glyphWidths.value(EngravingRules::augmentationDotGlyph());
+        width += metrics.spaceBetweenNoteheadAndDot +
+                symbol.dots * (dotWidth + metrics.spaceBetweenAugmentationDots);
+    }
+    engraving.width = width;
+
+    return engraving;
+}
+
+/*!
+ * \brief EngravingPipeline::engraveBeams Groups the notes of a measure into beams like the
+ *        BeamEngraver and extends the stems of beamed notes down to the beam.
+ */
+void EngravingPipeline::engraveBeams(const MeasureSnapshot &measure, MeasureEngraving *engraving,
+                                     const EngravingMetrics &metrics)
+{
+    int beamGroupCount = 0;
+    int beatTicks = EngravingRules::beatTicks(measure.timeSignature);
+    qreal halfStaffSpace = metrics.staffSpace / 2;
+    int onset = 0;
+    int groupBeat = -1;
+    QList<int> group;
+
+    for (int i = 0; i <= measure.symbols.count(); ++i) {
+        bool isBeamable = false;
+        int beat = -1;
+        int ticks = 0;
+        if (i < measure.symbols.count()) {
+            const SymbolSnapshot &symbol = measure.symbols.at(i);
+            if (symbol.symbolType != LP::MelodyNote)
+                continue;
+
+            if (symbol.hasLength)
+                ticks = EngravingRules::ticksOfLength(symbol.length, symbol.dots);
+            beat = onset / beatTicks;
+            isBeamable = symbol.hasLength && Length::hasFlag(symbol.length) &&
+                    onset + ticks <= (beat + 1) * beatTicks;
+        }
+
+        if (beat != groupBeat || !isBeamable) {
+            if (group.count() > 1) {
+                int lowestStaffPos = measure.symbols.at(group.first()).staffPos;
+                foreach (int symbolIndex, group) {
+                    lowestStaffPos = qMax(lowestStaffPos, measure.symbols.at(symbolIndex).staffPos);
+                }
+
+                int beamGroup = beamGroupCount++;
+                foreach (int symbolIndex, group) {
+                    SymbolEngraving &symbolEngraving = engraving->symbols[symbolIndex];
+                    int staffPos = measure.symbols.at(symbolIndex).staffPos;
+                    symbolEngraving.beamGroup = beamGroup;
+                    symbolEngraving.beamCount = EngravingRules::beamCountOfLength(
+                                measure.symbols.at(symbolIndex).length);
+                    symbolEngraving.flagGlyph.clear();
+                    symbolEngraving.stemLength = (lowestStaffPos - staffPos) * halfStaffSpace +
+                            metrics.stemLengthFactor * metrics.staffSpace;
+                }
+            }
+            group.clear();
+            groupBeat = beat;
+        }
+
+        if (isBeamable)
+            group << i;
+        onset += ticks;
+    }
+}
@@ -0,0 +1,55 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#ifndef ENGRAVINGPIPELINE_H
+#define ENGRAVINGPIPELINE_H
+
+#include <QObject>
+#include <QHash>
+#include <QVector>
+#include <QFutureWatcher>
+#include <QPersistentModelIndex>
+#include "engravingtypes.h"
+
+class QAbstractItemModel;
+
+typedef QHash<QPersistentModelIndex, MeasureSnapshot> MeasureSnapshotCache;
+
+class EngravingPipeline : public QObject
+{
+    Q_OBJECT
+public:
+    explicit EngravingPipeline(QObject *parent = 0);
+    ~EngravingPipeline();
+
+    static ScoreSnapshot snapshotFromModel(const QAbstractItemModel *model, const QModelIndex &scoreIndex,
+                                           MeasureSnapshotCache *measureCache = 0,
+                                           QSet<int> *readSymbolTypes = 0);
+    static StaffEngraving engraveStaff(const StaffSnapshot &staff, const EngravingMetrics &metrics);
+    static QVector<StaffEngraving> engraveScore(const ScoreSnapshot &score, const EngravingMetrics &metrics);
+
+    int engrave(const ScoreSnapshot &score, const EngravingMetrics &metrics);
+    bool isRunning() const;
+    void cancel();
+    void waitForFinished();
+
+signals:
+    void engraved(int generation, const QVector<StaffEngraving> &staves);
+
+private:
+    static SymbolEngraving engraveMelodyNote(const SymbolSnapshot &symbol, StaffType staffType,
+                                             const EngravingMetrics &metrics);
+    static MeasureSnapshot measureSnapshotFromModel(const QModelIndex &measureIndex);
+    static void engraveBeams(const MeasureSnapshot &measure, MeasureEngraving *engraving,
+                             const EngravingMetrics &metrics);
+    void watcherFinished();
+    QFutureWatcher<StaffEngraving> *m_watcher;
+    int m_generation;
+};
+
+#endif // ENGRAVINGPIPELINE_H
@@ -0,0 +1,146 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#include "engravingrules.h"
+
+static const QString WholeNoteHead("noteheadWhole");
+static const QString HalfNoteHead("noteheadHalf");
+static const QString BlackNoteHead("noteheadBlack");
+static const QString AugmentationDot("augmentationDot");
+
+bool EngravingRules::isStaffPosOnLine(int staffPos)
+{
+    if (staffPos % 2) {
+        return false;
+    }
+    return true;
+}
+
+/*!
+ * \brief EngravingRules::ledgerLineCount Returns the number of ledger lines a note on staffPos needs.
+ */
+int EngravingRules::ledgerLineCount(int staffPos, StaffType staffType)
+{
+    if (staffType == StaffType::Standard) {
+        if (staffPos >= -1 &&
+                staffPos <= 9) {
+            return 0;
+        }
+
+        // Above
+        if (staffPos < 0) {
+            return static_cast<int>(staffPos / 2 * -1);
+        } else {
+        // Below staff
+            return static_cast<int>((staffPos - 8) / 2);
+        }
+    }
+
+    return 0;
+}
+
+bool EngravingRules::ledgerLinesAbove(int staffPos)
+{
+    return staffPos < 0;
+}
+
+QString EngravingRules::noteheadGlyphForLength(Length::Value length)
+{
+    switch (length) {
+    case Length::_1:
+        return WholeNoteHead; break;
+    case Length::_2:
+        return HalfNoteHead; break;
+    default:
+        return BlackNoteHead; break;
+    }
+}
+
+QString EngravingRules::flagGlyphForLength(Length::Value length, StemDirection direction)
+{
+    if (!Length::hasFlag(length))
+        return QString();
+
+    int lengthNumber = Length::toInt(length);
+    QString numerator(QStringLiteral("th"));
+    if (length == Length::_32) {
+        numerator = QStringLiteral("nd");
+    }
+
+    QString nameTemplate("flag%1%2%3");
+    QString directionName = QStringLiteral("Up");
+    if (direction == StemDirection::Downwards) {
+        directionName = QStringLiteral("Down");
+    }
+
+    return nameTemplate.arg(lengthNumber).arg(numerator).arg(directionName);
+}
+
+QString EngravingRules::augmentationDotGlyph()
+{
+    return AugmentationDot;
+}
+
+/*!
+ * \brief EngravingRules::MeasuresPerStaff The number of measures on a staff. A part continues
+ *        on a new staff, if the last staff is full.
+ */
+const int EngravingRules::MeasuresPerStaff = 4;
+
+/*!
+ * \brief EngravingRules::WholeNoteTicks The duration of a whole note in ticks. It can be divided
+ *        by all lengths down to 1/256 and by three for triplets and compound time signatures.
+ */
+const int EngravingRules::WholeNoteTicks = 3 * 1024;
+
+/*!
+ * \brief EngravingRules::beatTicks Returns the length of one beat in ticks. Compound
+ *        time signatures like 6/8 are beamed in dotted quarters.
+ */
+int EngravingRules::beatTicks(TimeSignature::Type type)
+{
+    if (type == TimeSignature::None)
+        return WholeNoteTicks / 4;
+
+    int beatUnit = TimeSignature::beatUnit(type);
+    if (beatUnit == 8 &&
+            TimeSignature::beatCount(type) % 3 == 0)
+        return 3 * WholeNoteTicks / 8;
+
+    return WholeNoteTicks / beatUnit;
+}
+
+int EngravingRules::ticksOfLength(Length::Value length, int dots)
+{
+    int ticks = WholeNoteTicks / Length::toInt(length);
+    return ticks * 2 - (ticks >> dots);
+}
+
+int EngravingRules::beamCountOfLength(Length::Value length)
+{
+    int beamCount = 0;
+    for (int value = Length::_8; value <= Length::toInt(length); value *= 2) {
+        beamCount++;
+    }
+    return beamCount;
+}
+
+/*!
+ * \brief EngravingRules::symbolPositions Places symbols with the given widths back to back.
+ * \return The x positions of the symbols.
+ */
+QList<qreal> EngravingRules::symbolPositions(const QVector<qreal> &widths, qreal leftMargin)
+{
+    QList<qreal> positions;
+    qreal currentX = leftMargin;
+    foreach (qreal width, widths) {
+        positions << currentX;
+        currentX += width;
+    }
+    return positions;
+}
@@ -0,0 +1,53 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#ifndef ENGRAVINGRULES_H
+#define ENGRAVINGRULES_H
+
+#include <QList>
+#include <QVector>
+#include <QString>
+#include <common/defines.h>
+#include <common/datatypes/length.h>
+#include <common/datatypes/timesignature.h>
+
+/*!
+ * \brief The EngravingRules class contains the engraving decisions, which don't depend
+ *        on graphics items. They are used by the graphics items and the EngravingPipeline.
+ *        All methods are reentrant.
+ */
+class EngravingRules
+{
+public:
+    enum class StemDirection {
+        Upwards,
+        Downwards
+    };
+
+    static bool isStaffPosOnLine(int staffPos);
+    static int ledgerLineCount(int staffPos, StaffType staffType);
+    static bool ledgerLinesAbove(int staffPos);
+
+    static QString noteheadGlyphForLength(Length::Value length);
+    static QString flagGlyphForLength(Length::Value length, StemDirection direction);
+    static QString augmentationDotGlyph();
+
+    static const int MeasuresPerStaff;
+
+    static const int WholeNoteTicks;
+    static int beatTicks(TimeSignature::Type type);
+    static int ticksOfLength(Length::Value length, int dots = 0);
+    static int beamCountOfLength(Length::Value length);
+
+    static QList<qreal> symbolPositions(const QVector<qreal> &widths, qreal leftMargin = 0);
+
+private:
+    explicit EngravingRules() {}
+};
+
+#endif // ENGRAVINGRULES_H
@@ -0,0 +1,106 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#include <QStringList>
+#include <QFontMetricsF>
+#include <QScopedPointer>
+#include <common/graphictypes/glyphitem.h>
+#include <common/graphictypes/symbolgraphicbuilder.h>
+#include "engravingrules.h"
+#include "engravingtypes.h"
+
+/*!
+ * \brief EngravingMetrics::fromMusicFont Measures the glyphs of the music font. The widths of
+ *        the symbolTypes, which aren't melody notes, are measured with addSymbolWidths.
+ */
+EngravingMetrics EngravingMetrics::fromMusicFont(const MusicFontPtr &musicFont,
+                                                 const PluginManager &pluginManager,
+                                                 const QSet<int> &symbolTypes)
+{
+    EngravingMetrics metrics;
+    if (musicFont.isNull())
+        return metrics;
+
+    metrics.staffSpace = musicFont->staffSpace();
+    metrics.ledgerLineExtension = musicFont->engravings().legerLineExtension * metrics.staffSpace / 2;
+    metrics.spaceBetweenNoteheadAndDot = musicFont->font().pixelSize() / 14;
+    metrics.spaceBetweenAugmentationDots = musicFont->font().pixelSize() / 24;
+
+    QStringList glyphNames;
+    glyphNames << EngravingRules::noteheadGlyphForLength(Length::_1)
+               << EngravingRules::noteheadGlyphForLength(Length::_2)
+               << EngravingRules::noteheadGlyphForLength(Length::_4)
+               << EngravingRules::augmentationDotGlyph();
+
+    QFontMetricsF fontMetrics(musicFont->font());
+    foreach (const QString &glyphName, glyphNames) {
+        QChar glyph(musicFont->codepointForGlyph(glyphName));
+        metrics.glyphWidths.insert(glyphName, fontMetrics.boundingRect(glyph).width());
+    }
+
+    metrics.addSymbolWidths(musicFont, pluginManager, symbolTypes);
+    return metrics;
+}
+
+/*!
+ * \brief EngravingMetrics::addSymbolWidths Measures the widths of the symbolTypes, which
+ *        haven't been measured yet. Symbols without glyph get a width of 0, so their graphic
+ *        builder is only created once.
+ */
+void EngravingMetrics::addSymbolWidths(const MusicFontPtr &musicFont, const PluginManager &pluginManager,
+                                       const QSet<int> &symbolTypes)
+{
+    if (musicFont.isNull() || pluginManager.isNull())
+        return;
+
+    QFontMetricsF fontMetrics(musicFont->font());
+    foreach (int symbolType, symbolTypes) {
+        if (symbolType == LP::MelodyNote || symbolWidths.contains(symbolType))
+            continue;
+
+        qreal width = 0;
+        QScopedPointer<SymbolGraphicBuilder> builder(pluginManager->symbolGraphicBuilderForType(symbolType));
+        if (!builder.isNull() && builder->glyphItem()) {
+            // Without a symbol graphics item as parent, the glyph item isn't owned by anyone
+            QScopedPointer<GlyphItem> glyphItem(builder->glyphItem());
+            QString glyphName(glyphItem->glyphName());
+            width = glyphItem->boundingRect().width();
+            if (!glyphName.isEmpty())
+                width = fontMetrics.boundingRect(QChar(musicFont->codepointForGlyph(glyphName))).width();
+        }
+        symbolWidths.insert(symbolType, width);
+    }
+}
+
+bool SymbolEngraving::operator==(const SymbolEngraving &other) const
+{
+    return x == other.x &&
+            width == other.width &&
+            noteheadGlyph == other.noteheadGlyph &&
+            flagGlyph == other.flagGlyph &&
+            onLine == other.onLine &&
+            ledgerLines == other.ledgerLines &&
+            ledgerLinesAbove == other.ledgerLinesAbove &&
+            stemLength == other.stemLength &&
+            beamGroup == other.beamGroup &&
+            beamCount == other.beamCount &&
+            tieGroup == other.tieGroup;
+}
+
+QSet<int> ScoreSnapshot::symbolTypes() const
+{
+    QSet<int> types;
+    foreach (const StaffSnapshot &staff, staves) {
+        foreach (const MeasureSnapshot &measure, staff.measures) {
+            foreach (const SymbolSnapshot &symbol, measure.symbols) {
+                types.insert(symbol.symbolType);
+            }
+        }
+    }
+    return types;
+}
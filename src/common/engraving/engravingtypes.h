@@ -0,0 +1,153 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#ifndef ENGRAVINGTYPES_H
+#define ENGRAVINGTYPES_H
+
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QString>
+#include <QMetaType>
+#include <common/defines.h>
+#include <common/pluginmanagerinterface.h>
+#include <common/datatypes/length.h>
+#include <common/datatypes/timesignature.h>
+#include <common/graphictypes/MusicFont/musicfont.h>
+
+/*!
+ * \brief The EngravingMetrics struct contains all font metrics needed by the EngravingPipeline.
+ *        It has to be created in the GUI thread with fromMusicFont.
+ */
+struct EngravingMetrics {
+    EngravingMetrics()
+        : staffSpace(0),
+          stemLengthFactor(3.5),
+          ledgerLineExtension(0),
+          spaceBetweenNoteheadAndDot(0),
+          spaceBetweenAugmentationDots(0)
+    {}
+
+    static EngravingMetrics fromMusicFont(const MusicFontPtr &musicFont,
+                                          const PluginManager &pluginManager = PluginManager(),
+                                          const QSet<int> &symbolTypes = QSet<int>());
+    void addSymbolWidths(const MusicFontPtr &musicFont, const PluginManager &pluginManager,
+                         const QSet<int> &symbolTypes);
+
+    qreal staffSpace;
+    qreal stemLengthFactor;
+    qreal ledgerLineExtension;
+    qreal spaceBetweenNoteheadAndDot;
+    qreal spaceBetweenAugmentationDots;
+    QHash<QString, qreal> glyphWidths;
+    QHash<int, qreal> symbolWidths;     // Widths of symbols which aren't melody notes by symbol type
+};
+
+struct SymbolSnapshot {
+    SymbolSnapshot()
+        : symbolType(0),
+          length(Length::_4),
+          dots(0),
+          staffPos(0),
+          spanType(SpanType::None),
+          hasLength(false),
+          hasPitch(false)
+    {}
+
+    int symbolType;
+    Length::Value length;
+    int dots;
+    int staffPos;
+    SpanType spanType;
+    bool hasLength;
+    bool hasPitch;
+};
+
+struct MeasureSnapshot {
+    MeasureSnapshot()
+        : timeSignature(TimeSignature::None)
+    {}
+
+    QVector<SymbolSnapshot> symbols;
+    TimeSignature::Type timeSignature;
+};
+
+struct StaffSnapshot {
+    StaffSnapshot()
+        : staffType(StaffType::Standard),
+          tieOpenAtStart(false)
+    {}
+
+    QVector<MeasureSnapshot> measures;
+    StaffType staffType;
+    bool tieOpenAtStart;        //!< A tie of the previous staff of the part continues on this staff
+};
+
+struct ScoreSnapshot {
+    QSet<int> symbolTypes() const;
+
+    QVector<StaffSnapshot> staves;
+    QVector<int> partStaffCounts;       //!< Number of staves of every part in the order of the parts
+};
+
+struct SymbolEngraving {
+    SymbolEngraving()
+        : x(0),
+          width(0),
+          onLine(false),
+          ledgerLines(0),
+          ledgerLinesAbove(false),
+          stemLength(0),
+          beamGroup(-1),
+          beamCount(0),
+          tieGroup(-1)
+    {}
+
+    bool operator==(const SymbolEngraving &other) const;
+    bool operator!=(const SymbolEngraving &other) const { return !(*this == other); }
+
+    qreal x;
+    qreal width;
+    QString noteheadGlyph;
+    QString flagGlyph;          //!< Empty, if the note has no flag or is beamed
+    bool onLine;
+    int ledgerLines;
+    bool ledgerLinesAbove;
+    qreal stemLength;
+    int beamGroup;              //!< Id of the beam group in the measure or -1
+    int beamCount;              //!< Number of beams of a beamed note, e.g. 1 for an eighth note
+    int tieGroup;               //!< Id of the tie in the staff or -1
+};
+
+struct MeasureEngraving {
+    MeasureEngraving()
+        : width(0)
+    {}
+
+    bool operator==(const MeasureEngraving &other) const
+    {
+        return width == other.width && symbols == other.symbols;
+    }
+    bool operator!=(const MeasureEngraving &other) const { return !(*this == other); }
+
+    QVector<SymbolEngraving> symbols;
+    qreal width;
+};
+
+struct StaffEngraving {
+    StaffEngraving()
+        : tieOpenAtEnd(false)
+    {}
+
+    QVector<MeasureEngraving> measures;
+    bool tieOpenAtEnd;
+};
+
+Q_DECLARE_METATYPE(StaffEngraving)
+
+#endif // ENGRAVINGTYPES_H
@@ -0,0 +1,245 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+/*!
+ * @class SpacingEngine
+ * @brief Computes the x positions of the symbols of all measures of a staff line from
+ *        the durations of the symbols.
+ *
+ * Every symbol gets at least its width and the minimum distance. The space which is left
+ * on the line is distributed over the symbols by their duration weights, so a longer note
+ * gets more space after it than a shorter one. Symbols without duration are packed tightly.
+ *
+ * The minimum width and the duration weight of every measure are cached. Only measures
+ * which were changed with setMeasure are recomputed by justify. Symbol positions are
+ * computed on request and only if the measure or the stretch has changed.
+ */
+
+#include <QtMath>
+#include <QDebug>
+#include "engravingrules.h"
+#include "spacingengine.h"
+
+namespace {
+const int ShortestTicks = EngravingRules::WholeNoteTicks / 32;
+const qreal MinimumWeight = 0.5;
+}
+
+SpacingEngine::SpacingEngine()
+    : m_minimumDistance(0),
+      m_stretch(0)
+{
+}
+
+int SpacingEngine::measureCount() const
+{
+    return m_measures.count();
+}
+
+void SpacingEngine::insertMeasure(int index)
+{
+    if (index < 0 || index > m_measures.count())
+        index = m_measures.count();
+
+    m_measures.insert(index, MeasureSpacing());
+}
+
+void SpacingEngine::removeMeasure(int index)
+{
+    if (index < 0 || index >= m_measures.count())
+        return;
+
+    m_measures.removeAt(index);
+}
+
+/*!
+ * \brief SpacingEngine::setMeasure Sets the symbols of the measure at index. The measure
+ *        will be recomputed on the next call of justify.
+ * \param leftMargin Space before the first symbol, e.g. for a time signature.
+ */
+void SpacingEngine::setMeasure(int index, const QVector<SpacingEngine::Element> &elements, qreal leftMargin)
+{
+    if (index < 0 || index >= m_measures.count()) {
+        qWarning() << "SpacingEngine: Can't set measure, index out of range";
+        return;
+    }
+
+    MeasureSpacing &measure = m_measures[index];
+    measure.elements = elements;
+    measure.leftMargin = leftMargin;
+    measure.isDirty = true;
+}
+
+qreal SpacingEngine::minimumDistance() const
+{
+    return m_minimumDistance;
+}
+
+void SpacingEngine::setMinimumDistance(qreal distance)
+{
+    if (distance < 0 || distance == m_minimumDistance)
+        return;
+
+    m_minimumDistance = distance;
+    setAllDirty();
+}
+
+qreal SpacingEngine::minimumWidth(int index) const
+{
+    if (index < 0 || index >= m_measures.count())
+        return 0;
+
+    MeasureSpacing &measure = m_measures[index];
+    if (measure.isDirty)
+        updateMeasure(measure);
+
+    return measure.minimumWidth;
+}
+
+/*!
+ * \brief SpacingEngine::minimumWidth Returns the width the staff line needs at least.
+ */
+qreal SpacingEngine::minimumWidth() const
+{
+    qreal width = 0;
+    for (int i = 0; i < m_measures.count(); ++i) {
+        width += minimumWidth(i);
+    }
+    return width;
+}
+
+/*!
+ * \brief SpacingEngine::justify Sets the measure widths, so that all measures fill lineWidth.
+ *        If the line is too short, all measures get their minimum width.
+ */
+void SpacingEngine::justify(qreal lineWidth)
+{
+    qreal minimumLineWidth = 0;
+    qreal lineWeight = 0;
+    for (int i = 0; i < m_measures.count(); ++i) {
+        MeasureSpacing &measure = m_measures[i];
+        if (measure.isDirty)
+            updateMeasure(measure);
+
+        minimumLineWidth += measure.minimumWidth;
+        lineWeight += measure.weight;
+    }
+
+    qreal extraSpace = qMax<qreal>(0, lineWidth - minimumLineWidth);
+    qreal stretch = 0;
+    qreal measureExtraSpace = 0;
+    if (lineWeight > 0) {
+        stretch = extraSpace / lineWeight;
+    } else if (m_measures.count()) {
+        // No durations on the line, the space is shared equally by the measures
+        measureExtraSpace = extraSpace / m_measures.count();
+    }
+
+    bool stretchHasChanged = !qFuzzyCompare(1 + stretch, 1 + m_stretch);
+    m_stretch = stretch;
+
+    for (int i = 0; i < m_measures.count(); ++i) {
+        MeasureSpacing &measure = m_measures[i];
+        measure.width = measure.minimumWidth + stretch * measure.weight + measureExtraSpace;
+        if (stretchHasChanged)
+            measure.positionsAreDirty = true;
+    }
+}
+
+/*!
+ * \brief SpacingEngine::stretch Returns the space per duration weight of the last justify.
+ */
+qreal SpacingEngine::stretch() const
+{
+    return m_stretch;
+}
+
+/*!
+ * \brief SpacingEngine::measureWidth Returns the width of the measure at index after the
+ *        last call of justify.
+ */
+qreal SpacingEngine::measureWidth(int index) const
+{
+    if (index < 0 || index >= m_measures.count())
+        return 0;
+
+    return m_measures.at(index).width;
+}
+
+/*!
+ * \brief SpacingEngine::isMeasureChanged Returns true, if the measure at index was changed
+ *        with setMeasure and its width will be recomputed by the next justify.
+ */
+bool SpacingEngine::isMeasureChanged(int index) const
+{
+    if (index < 0 || index >= m_measures.count())
+        return false;
+
+    return m_measures.at(index).isDirty;
+}
+
+QVector<qreal> SpacingEngine::symbolPositions(int index) const
+{
+    if (index < 0 || index >= m_measures.count())
+        return QVector<qreal>();
+
+    MeasureSpacing &measure = m_measures[index];
+    if (measure.isDirty)
+        updateMeasure(measure);
+    if (measure.positionsAreDirty)
+        updatePositions(measure);
+
+    return measure.positions;
+}
+
+/*!
+ * \brief SpacingEngine::durationWeight Returns the relative space a symbol with ticks gets.
+ *        Doubling the duration adds one unit of space.
+ */
+qreal SpacingEngine::durationWeight(int ticks)
+{
+    if (ticks <= 0)
+        return 0;
+
+    qreal weight = 1 + qLn(static_cast<qreal>(ticks) / ShortestTicks) / M_LN2;
+    return qMax(MinimumWeight, weight);
+}
+
+void SpacingEngine::updateMeasure(MeasureSpacing &measure) const
+{
+    qreal width = measure.leftMargin;
+    qreal weight = 0;
+    foreach (const Element &element, measure.elements) {
+        width += element.width + m_minimumDistance;
+        weight += durationWeight(element.ticks);
+    }
+
+    measure.minimumWidth = width;
+    measure.weight = weight;
+    measure.isDirty = false;
+    measure.positionsAreDirty = true;
+}
+
+void SpacingEngine::updatePositions(MeasureSpacing &measure) const
+{
+    measure.positions.resize(measure.elements.count());
+    qreal currentX = measure.leftMargin;
+    for (int i = 0; i < measure.elements.count(); ++i) {
+        const Element &element = measure.elements.at(i);
+        measure.positions[i] = currentX;
+        currentX += element.width + m_minimumDistance + m_stretch * durationWeight(element.ticks);
+    }
+    measure.positionsAreDirty = false;
+}
+
+void SpacingEngine::setAllDirty()
+{
+    for (int i = 0; i < m_measures.count(); ++i) {
+        m_measures[i].isDirty = true;
+    }
+}
@@ -0,0 +1,74 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#ifndef SPACINGENGINE_H
+#define SPACINGENGINE_H
+
+#include <QList>
+#include <QVector>
+
+class SpacingEngine
+{
+public:
+    struct Element {
+        Element()
+            : width(0), ticks(0) {}
+        Element(qreal width, int ticks)
+            : width(width), ticks(ticks) {}
+
+        qreal width;    //!< Minimum width of the symbol
+        int ticks;      //!< Duration of the symbol or 0, if it has no duration
+    };
+
+    explicit SpacingEngine();
+
+    int measureCount() const;
+    void insertMeasure(int index);
+    void removeMeasure(int index);
+    void setMeasure(int index, const QVector<Element> &elements, qreal leftMargin = 0);
+
+    qreal minimumDistance() const;
+    void setMinimumDistance(qreal distance);
+
+    qreal minimumWidth(int index) const;
+    qreal minimumWidth() const;
+
+    void justify(qreal lineWidth);
+    qreal stretch() const;
+    qreal measureWidth(int index) const;
+    bool isMeasureChanged(int index) const;
+    QVector<qreal> symbolPositions(int index) const;
+
+    static qreal durationWeight(int ticks);
+
+private:
+    struct MeasureSpacing {
+        MeasureSpacing()
+            : leftMargin(0), minimumWidth(0), weight(0), width(0),
+              isDirty(true), positionsAreDirty(true) {}
+
+        QVector<Element> elements;
+        qreal leftMargin;
+        qreal minimumWidth;     // Cached sum of the element widths and distances
+        qreal weight;           // Cached sum of the duration weights
+        qreal width;
+        QVector<qreal> positions;
+        bool isDirty;
+        bool positionsAreDirty;
+    };
+
+    void updateMeasure(MeasureSpacing &measure) const;
+    void updatePositions(MeasureSpacing &measure) const;
+    void setAllDirty();
+
+    mutable QList<MeasureSpacing> m_measures;
+    qreal m_minimumDistance;
+    qreal m_stretch;
+};
+
+#endif // SPACINGENGINE_H
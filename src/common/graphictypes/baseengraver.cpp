@@ -11,6 +11,7 @@
 #include "baseengraver.h"
 
 BaseEngraver::BaseEngraver()
+    : m_engravedByPipeline(false)
 {
     setMusicFont(LayoutSettings::musicFont());
     QObject::connect(LayoutSettings::musicFont().data(), &MusicFont::fontChanged,
@@ -19,6 +20,21 @@ BaseEngraver::BaseEngraver()
     });
 }
 
+bool BaseEngraver::isEngravedByPipeline() const
+{
+    return m_engravedByPipeline;
+}
+
+/*!
+ * \brief BaseEngraver::setEngravedByPipeline If set, the engraver doesn't compute the engraving
+ *        from the data of the builders, but applies the results of the EngravingPipeline.
+ *        It has to be set before builders are inserted.
+ */
+void BaseEngraver::setEngravedByPipeline(bool engravedByPipeline)
+{
+    m_engravedByPipeline = engravedByPipeline;
+}
+
 MusicFontPtr BaseEngraver::musicFont() const
 {
     return m_musicFont;
@@ -9,9 +9,11 @@
 #ifndef BASEENGRAVER_H
 #define BASEENGRAVER_H
 
+#include <QList>
 #include <common/graphictypes/MusicFont/musicfont.h>
 
 class SymbolGraphicBuilder;
+struct MeasureEngraving;
 
 class BaseEngraver
 {
@@ -20,7 +22,21 @@ public:
     virtual ~BaseEngraver() {}
 
     virtual void insertGraphicsBuilder(int index, SymbolGraphicBuilder *builder) {}
-    virtual void removeGraphicsBuilder(SymbolGraphicBuilder *builder) {}
+    virtual void removeGraphicsBuilder(int index, SymbolGraphicBuilder *builder) {}
+
+    bool isEngravedByPipeline() const;
+    void setEngravedByPipeline(bool engravedByPipeline);
+
+    /*!
+     * \brief applyEngraving Applies the result of the EngravingPipeline for the builders of
+     *        a measure. It is only called, if the engraver is engraved by the pipeline.
+     */
+    virtual void applyEngraving(const QList<SymbolGraphicBuilder*> &builders,
+                                const MeasureEngraving &engraving)
+    {
+        Q_UNUSED(builders);
+        Q_UNUSED(engraving);
+    }
 
 protected:
     MusicFontPtr musicFont() const;
@@ -29,6 +45,7 @@ protected:
 private:
     void setMusicFont(const MusicFontPtr &musicFont);
     MusicFontPtr m_musicFont;
+    bool m_engravedByPipeline;
 };
 
 #endif // BASEENGRAVER_H
@@ -0,0 +1,409 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+/*!
+ * @class BeamEngraver
+ * @brief Groups the melody notes of one measure into beams.
+ *
+ * Notes are beamed together, if they have a flag and lie within the same beat of the
+ * measure's TimeSignature. Every note caches its onset in ticks. When a note is inserted,
+ * removed or its length changes, only the beats between the start and the end of the
+ * change are regrouped. The beam groups behind the change are only moved to their new beat,
+ * if the following notes are shifted by whole beats. Otherwise all following beats have
+ * to be regrouped.
+ *
+ * If the engraver is engraved by the EngravingPipeline, the notes aren't grouped here.
+ * The beam items are created from the beam groups of the applied engraving.
+ */
+
+#include <QObject>
+#include <QDebug>
+
+#include <common/itemdataroles.h>
+#include <common/engraving/engravingrules.h>
+#include <common/engraving/engravingtypes.h>
+
+#include "symbolgraphicbuilder.h"
+#include "stemengraver.h"
+#include "beamgraphicsitem.h"
+#include "beamengraver.h"
+
+BeamEngraver::BeamEngraver(StemEngraver *stemEngraver)
+    : m_stemEngraver(stemEngraver)
+{
+}
+
+BeamEngraver::~BeamEngraver()
+{
+    foreach (const QMetaObject::Connection &connection, m_dataChangedConnections) {
+        QObject::disconnect(connection);
+    }
+    qDeleteAll(m_beamItems);
+}
+
+TimeSignature BeamEngraver::timeSignature() const
+{
+    return m_timeSignature;
+}
+
+void BeamEngraver::setTimeSignature(const TimeSignature &timeSignature)
+{
+    if (m_timeSignature.type() == timeSignature.type())
+        return;
+
+    m_timeSignature = timeSignature;
+    if (!isEngravedByPipeline())
+        regroupAll();
+}
+
+int BeamEngraver::beatTicks() const
+{
+    return EngravingRules::beatTicks(m_timeSignature.type());
+}
+
+/*!
+ * \brief BeamEngraver::onsetOfBuilder Returns the onset of a melody note in ticks from the
+ *        start of the measure or -1, if the builder isn't a note of this measure.
+ */
+int BeamEngraver::onsetOfBuilder(SymbolGraphicBuilder *builder) const
+{
+    int noteIndex = noteIndexOfBuilder(builder);
+    if (noteIndex == -1)
+        return -1;
+
+    return m_notes.at(noteIndex).onset;
+}
+
+int BeamEngraver::beamCountOfBuilder(SymbolGraphicBuilder *builder) const
+{
+    int noteIndex = noteIndexOfBuilder(builder);
+    if (noteIndex == -1)
+        return 0;
+
+    return m_notes.at(noteIndex).beamCount;
+}
+
+void BeamEngraver::insertGraphicsBuilder(int index, SymbolGraphicBuilder *builder)
+{
+    if (index < 0 || index > m_graphicBuilder.count())
+        index = m_graphicBuilder.count();
+
+    m_graphicBuilder.insert(index, builder);
+    if (builder->symbolType() != LP::MelodyNote || isEngravedByPipeline())
+        return;
+
+    int noteIndex = noteIndexForBuilderIndex(index);
+    BeamNote note;
+    note.builder = builder;
+    updateNoteDuration(&note);
+    if (noteIndex > 0) {
+        const BeamNote &previousNote = m_notes.at(noteIndex - 1);
+        note.onset = previousNote.onset + previousNote.ticks;
+    }
+    m_notes.insert(noteIndex, note);
+
+    m_dataChangedConnections.insert(builder,
+                                    QObject::connect(builder, &SymbolGraphicBuilder::dataChanged,
+                                                     [this, builder] (const QVariant &data, int role) {
+        Q_UNUSED(data);
+        builderDataChanged(builder, role);
+    }));
+
+    notesChanged(noteIndex + 1, note.onset, note.onset, note.onset + note.ticks);
+}
+
+void BeamEngraver::removeGraphicsBuilder(int index, SymbolGraphicBuilder *builder)
+{
+    if (index >= 0 && index < m_graphicBuilder.count() && m_graphicBuilder.at(index) == builder)
+        m_graphicBuilder.removeAt(index);
+    if (isEngravedByPipeline()) {
+        removeBeamItemsOfBuilder(builder);
+        return;
+    }
+
+    int noteIndex = noteIndexOfBuilder(builder);
+    if (noteIndex == -1)
+        return;
+
+    QObject::disconnect(m_dataChangedConnections.take(builder));
+    BeamNote note = m_notes.takeAt(noteIndex);
+    if (m_stemEngraver)
+        m_stemEngraver->setStemVisible(builder, true);
+
+    notesChanged(noteIndex, note.onset, note.onset + note.ticks, note.onset);
+}
+
+/*!
+ * \brief BeamEngraver::applyEngraving Replaces the beam items by the beam groups of the engraving.
+ */
+void BeamEngraver::applyEngraving(const QList<SymbolGraphicBuilder *> &builders, const MeasureEngraving &engraving)
+{
+    qDeleteAll(m_beamItems);
+    m_beamItems.clear();
+
+    QMap<int, QList<GlyphItem*> > groupGlyphs;
+    QMap<int, QList<int> > groupBeamCounts;
+    for (int i = 0; i < builders.count() && i < engraving.symbols.count(); ++i) {
+        const SymbolEngraving &symbolEngraving = engraving.symbols.at(i);
+        SymbolGraphicBuilder *builder = builders.at(i);
+        if (symbolEngraving.beamGroup == -1 || !builder || !builder->glyphItem())
+            continue;
+
+        groupGlyphs[symbolEngraving.beamGroup] << builder->glyphItem();
+        groupBeamCounts[symbolEngraving.beamGroup] << symbolEngraving.beamCount;
+    }
+
+    QMap<int, QList<GlyphItem*> >::const_iterator it = groupGlyphs.constBegin();
+    for (; it != groupGlyphs.constEnd(); ++it) {
+        if (it.value().count() < 2)
+            continue;
+
+        BeamGraphicsItem *beamItem = new BeamGraphicsItem;
+        beamItem->setMusicFont(musicFont());
+        beamItem->setGlyphs(it.value(), groupBeamCounts.value(it.key()));
+        m_beamItems.insert(it.key(), beamItem);
+    }
+}
+
+void BeamEngraver::musicFontHasChanged(const MusicFontPtr &musicFont)
+{
+    foreach (BeamGraphicsItem *beamItem, m_beamItems) {
+        beamItem->setMusicFont(musicFont);
+    }
+}
+
+void BeamEngraver::builderDataChanged(SymbolGraphicBuilder *builder, int role)
+{
+    if (role != LP::SymbolLength &&
+            role != LP::MelodyNoteDots)
+        return;
+
+    int noteIndex = noteIndexOfBuilder(builder);
+    if (noteIndex == -1)
+        return;
+
+    BeamNote &note = m_notes[noteIndex];
+    int oldEnd = note.onset + note.ticks;
+    int oldBeamCount = note.beamCount;
+    updateNoteDuration(&note);
+    int newEnd = note.onset + note.ticks;
+
+    if (oldEnd == newEnd && oldBeamCount == note.beamCount)
+        return;
+
+    notesChanged(noteIndex + 1, note.onset, oldEnd, newEnd);
+}
+
+int BeamEngraver::noteIndexForBuilderIndex(int builderIndex) const
+{
+    int noteIndex = 0;
+    for (int i = 0; i < builderIndex; ++i) {
+        if (m_graphicBuilder.at(i)->symbolType() == LP::MelodyNote)
+            noteIndex++;
+    }
+    return noteIndex;
+}
+
+int BeamEngraver::noteIndexOfBuilder(SymbolGraphicBuilder *builder) const
+{
+    for (int i = 0; i < m_notes.count(); ++i) {
+        if (m_notes.at(i).builder == builder)
+            return i;
+    }
+    return -1;
+}
+
+/*!
+ * \brief BeamEngraver::firstNoteIndexFromTick Returns the index of the first note with
+ *        an onset greater or equal tick. The onsets are sorted, so a binary search is used.
+ */
+int BeamEngraver::firstNoteIndexFromTick(int tick) const
+{
+    int low = 0;
+    int high = m_notes.count();
+    while (low < high) {
+        int middle = (low + high) / 2;
+        if (m_notes.at(middle).onset < tick)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+void BeamEngraver::updateNoteDuration(BeamNote *note) const
+{
+    QVariant lengthData = note->builder->data(LP::SymbolLength);
+    if (!lengthData.isValid()) {
+        note->ticks = 0;
+        note->beamCount = 0;
+        return;
+    }
+
+    Length::Value length = lengthData.value<Length::Value>();
+    int dots = note->builder->data(LP::MelodyNoteDots).toInt();
+    note->ticks = EngravingRules::ticksOfLength(length, dots);
+    note->beamCount = EngravingRules::beamCountOfLength(length);
+}
+
+/*!
+ * \brief BeamEngraver::notesChanged Updates onsets and beam groups after a change of the notes.
+ * \param firstShiftedNote The index of the first note, whose onset has to be moved.
+ * \param changeStart The first tick affected by the change.
+ * \param oldEnd The tick, where the changed region ended before the change.
+ * \param newEnd The tick, where the changed region ends now.
+ */
+void BeamEngraver::notesChanged(int firstShiftedNote, int changeStart, int oldEnd, int newEnd)
+{
+    int delta = newEnd - oldEnd;
+    for (int i = firstShiftedNote; i < m_notes.count(); ++i) {
+        m_notes[i].onset += delta;
+    }
+
+    int firstBeat = beatOfTick(changeStart);
+    if (delta % beatTicks() != 0) {
+        int lastAffectedBeat = lastBeat();
+        if (!m_beamItems.isEmpty())
+            lastAffectedBeat = qMax(lastAffectedBeat, m_beamItems.lastKey());
+        removeBeamItems(firstBeat, lastAffectedBeat);
+        regroupBeats(firstBeat, lastBeat());
+        return;
+    }
+
+    int oldEndBeat = beatOfTick(oldEnd);
+    removeBeamItems(firstBeat, oldEndBeat);
+
+    int beatDelta = delta / beatTicks();
+    if (beatDelta) {
+        QMultiMap<int, BeamGraphicsItem*> shiftedItems;
+        QMultiMap<int, BeamGraphicsItem*>::iterator it = m_beamItems.upperBound(oldEndBeat);
+        while (it != m_beamItems.end()) {
+            shiftedItems.insert(it.key() + beatDelta, it.value());
+            it = m_beamItems.erase(it);
+        }
+        m_beamItems.unite(shiftedItems);
+    }
+
+    regroupBeats(firstBeat, beatOfTick(newEnd));
+}
+
+void BeamEngraver::removeBeamItems(int firstBeat, int lastBeat)
+{
+    QMultiMap<int, BeamGraphicsItem*>::iterator it = m_beamItems.lowerBound(firstBeat);
+    while (it != m_beamItems.end() && it.key() <= lastBeat) {
+        delete it.value();
+        it = m_beamItems.erase(it);
+    }
+}
+
+void BeamEngraver::removeBeamItemsOfBuilder(SymbolGraphicBuilder *builder)
+{
+    QMultiMap<int, BeamGraphicsItem*>::iterator it = m_beamItems.begin();
+    while (it != m_beamItems.end()) {
+        if (it.value()->glyphs().contains(builder->glyphItem())) {
+            delete it.value();
+            it = m_beamItems.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+/*!
+ * \brief BeamEngraver::regroupBeats Creates the beam groups for all notes with an onset between
+ *        firstBeat and lastBeat. Beam items of these beats have to be removed before.
+ */
+void BeamEngraver::regroupBeats(int firstBeat, int lastBeat)
+{
+    if (lastBeat < firstBeat)
+        return;
+
+    int beatLength = beatTicks();
+    int endTick = (lastBeat + 1) * beatLength;
+    QList<BeamNote> group;
+    int groupBeat = firstBeat;
+
+    for (int i = firstNoteIndexFromTick(firstBeat * beatLength); i < m_notes.count(); ++i) {
+        const BeamNote &note = m_notes.at(i);
+        if (note.onset >= endTick)
+            break;
+
+        int beat = beatOfTick(note.onset);
+        bool fitsIntoBeat = note.onset + note.ticks <= (beat + 1) * beatLength;
+        bool isBeamable = note.beamCount > 0 && fitsIntoBeat &&
+                note.builder->glyphItem();
+
+        if (beat != groupBeat || !isBeamable) {
+            addBeamGroup(groupBeat, group);
+            group.clear();
+            groupBeat = beat;
+        }
+
+        if (isBeamable) {
+            group << note;
+        } else {
+            setStemsVisible(QList<BeamNote>() << note, true);
+        }
+    }
+    addBeamGroup(groupBeat, group);
+}
+
+void BeamEngraver::regroupAll()
+{
+    qDeleteAll(m_beamItems);
+    m_beamItems.clear();
+    regroupBeats(0, lastBeat());
+}
+
+void BeamEngraver::addBeamGroup(int beat, const QList<BeamNote> &notes)
+{
+    if (notes.count() < 2) {
+        setStemsVisible(notes, true);
+        return;
+    }
+
+    QList<GlyphItem*> glyphs;
+    QList<int> beamCounts;
+    foreach (const BeamNote &note, notes) {
+        glyphs << note.builder->glyphItem();
+        beamCounts << note.beamCount;
+    }
+
+    // BeamGraphicsItem will have no parent item per default.
+    // It will add itself to the graphics scene, when glyphs are set
+    BeamGraphicsItem *beamItem = new BeamGraphicsItem;
+    beamItem->setMusicFont(musicFont());
+    beamItem->setGlyphs(glyphs, beamCounts);
+    m_beamItems.insert(beat, beamItem);
+
+    setStemsVisible(notes, false);
+}
+
+void BeamEngraver::setStemsVisible(const QList<BeamNote> &notes, bool visible)
+{
+    if (!m_stemEngraver)
+        return;
+
+    foreach (const BeamNote &note, notes) {
+        m_stemEngraver->setStemVisible(note.builder, visible);
+    }
+}
+
+int BeamEngraver::beatOfTick(int tick) const
+{
+    return tick / beatTicks();
+}
+
+int BeamEngraver::lastBeat() const
+{
+    if (m_notes.isEmpty())
+        return -1;
+
+    const BeamNote &lastNote = m_notes.last();
+    return beatOfTick(qMax(lastNote.onset, lastNote.onset + lastNote.ticks - 1));
+}
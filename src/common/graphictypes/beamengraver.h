@@ -0,0 +1,85 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#ifndef BEAMENGRAVER_H
+#define BEAMENGRAVER_H
+
+#include <QList>
+#include <QHash>
+#include <QMultiMap>
+#include <QMetaObject>
+
+#include <common/datatypes/length.h>
+#include <common/datatypes/timesignature.h>
+
+#include "baseengraver.h"
+
+class StemEngraver;
+class BeamGraphicsItem;
+
+class BeamEngraver : public BaseEngraver
+{
+public:
+    explicit BeamEngraver(StemEngraver *stemEngraver = 0);
+    ~BeamEngraver();
+
+    // BaseEngraver interface
+    void insertGraphicsBuilder(int index, SymbolGraphicBuilder *builder);
+    void removeGraphicsBuilder(int index, SymbolGraphicBuilder *builder);
+    void applyEngraving(const QList<SymbolGraphicBuilder*> &builders, const MeasureEngraving &engraving);
+
+    TimeSignature timeSignature() const;
+    void setTimeSignature(const TimeSignature &timeSignature);
+
+    int beatTicks() const;
+    int onsetOfBuilder(SymbolGraphicBuilder *builder) const;
+    int beamCountOfBuilder(SymbolGraphicBuilder *builder) const;
+
+protected:
+    void musicFontHasChanged(const MusicFontPtr &musicFont);
+
+private:
+    struct BeamNote {
+        BeamNote()
+            : builder(0),
+              onset(0),
+              ticks(0),
+              beamCount(0)
+        {}
+
+        SymbolGraphicBuilder *builder;
+        int onset;
+        int ticks;
+        int beamCount;
+    };
+
+    void builderDataChanged(SymbolGraphicBuilder *builder, int role);
+    int noteIndexForBuilderIndex(int builderIndex) const;
+    int noteIndexOfBuilder(SymbolGraphicBuilder *builder) const;
+    int firstNoteIndexFromTick(int tick) const;
+    void updateNoteDuration(BeamNote *note) const;
+    void notesChanged(int firstShiftedNote, int changeStart, int oldEnd, int newEnd);
+    void removeBeamItems(int firstBeat, int lastBeat);
+    void removeBeamItemsOfBuilder(SymbolGraphicBuilder *builder);
+    void regroupBeats(int firstBeat, int lastBeat);
+    void regroupAll();
+    void addBeamGroup(int beat, const QList<BeamNote> &notes);
+    void setStemsVisible(const QList<BeamNote> &notes, bool visible);
+    int beatOfTick(int tick) const;
+    int lastBeat() const;
+
+    QList<SymbolGraphicBuilder*> m_graphicBuilder;
+    QList<BeamNote> m_notes;
+    QHash<SymbolGraphicBuilder*, QMetaObject::Connection> m_dataChangedConnections;
+    QMultiMap<int, BeamGraphicsItem*> m_beamItems;   // Beam groups keyed by their beat or by their
+                                                     // beam group, if engraved by the pipeline
+    TimeSignature m_timeSignature;
+    StemEngraver *m_stemEngraver;
+};
+
+#endif // BEAMENGRAVER_H
@@ -0,0 +1,178 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+/*!
+ * @class BeamGraphicsItem
+ * @brief Draws the downward stems and the beams of a group of beamed notes.
+ *
+ * The path is built in scene coordinates, so the item has no parent and adds itself
+ * to the scene of the first glyph.
+ */
+
+#include <QDebug>
+#include <QObject>
+#include <QGraphicsScene>
+
+#include "glyphitem.h"
+#include "beamgraphicsitem.h"
+
+BeamGraphicsItem::BeamGraphicsItem(QGraphicsItem *parent)
+    : QGraphicsPathItem(parent),
+      m_stemLengthFactor(3.5)
+{
+    setBrush(Qt::black);
+    setPen(Qt::NoPen);
+}
+
+BeamGraphicsItem::~BeamGraphicsItem()
+{
+    disconnectGlyphs();
+}
+
+/*!
+ * \brief BeamGraphicsItem::setGlyphs Sets the note glyphs of the group.
+ * \param beamCounts The number of beams for every glyph, e.g. 1 for an eighth note.
+ *        A glyph with no beam interrupts the beams.
+ */
+void BeamGraphicsItem::setGlyphs(const QList<GlyphItem *> &glyphs, const QList<int> &beamCounts)
+{
+    if (glyphs.count() != beamCounts.count()) {
+        qWarning() << "BeamGraphicsItem: Glyph and beam count don't match";
+        return;
+    }
+
+    disconnectGlyphs();
+    m_glyphs = glyphs;
+    m_beamCounts = beamCounts;
+
+    foreach (GlyphItem *glyph, m_glyphs) {
+        glyph->setScenePosChangeEnabled(true);
+        m_scenePosConnections << QObject::connect(glyph, &GlyphItem::scenePosChanged,
+                                                  [this] {
+            updatePath();
+        });
+    }
+
+    updatePath();
+}
+
+QList<GlyphItem *> BeamGraphicsItem::glyphs() const
+{
+    return m_glyphs;
+}
+
+MusicFontPtr BeamGraphicsItem::musicFont() const
+{
+    return m_musicFont;
+}
+
+void BeamGraphicsItem::setMusicFont(const MusicFontPtr &musicFont)
+{
+    m_musicFont = musicFont;
+    updatePath();
+}
+
+void BeamGraphicsItem::setStemLengthFactor(qreal staffSpaceFactor)
+{
+    m_stemLengthFactor = staffSpaceFactor;
+    updatePath();
+}
+
+void BeamGraphicsItem::disconnectGlyphs()
+{
+    foreach (const QMetaObject::Connection &connection, m_scenePosConnections) {
+        QObject::disconnect(connection);
+    }
+    m_scenePosConnections.clear();
+}
+
+void BeamGraphicsItem::updatePath()
+{
+    if (m_glyphs.isEmpty() || m_musicFont.isNull()) {
+        if (scene()) {
+            scene()->removeItem(this);
+        }
+        return;
+    }
+
+    qreal staffSpace = m_musicFont->staffSpace();
+    Engravings engravings(m_musicFont->engravings());
+    qreal stemThickness = engravings.stemThickness * staffSpace;
+
+    QList<QPointF> stemBases;
+    foreach (const GlyphItem *glyph, m_glyphs) {
+        stemBases << glyph->mapToScene(glyph->itemGlyphData().stemDownNW);
+    }
+
+    qreal beamY = stemBases.at(0).y();
+    foreach (const QPointF &stemBase, stemBases) {
+        beamY = qMax(beamY, stemBase.y());
+    }
+    beamY += m_stemLengthFactor * staffSpace;
+
+    QPainterPath path;
+    QList<qreal> stemXs;
+    int maxBeamCount = 0;
+    for (int i = 0; i < stemBases.count(); ++i) {
+        QPointF stemBase(stemBases.at(i));
+        path.addRect(stemBase.x(), stemBase.y(), stemThickness, beamY - stemBase.y());
+        stemXs << stemBase.x();
+        maxBeamCount = qMax(maxBeamCount, m_beamCounts.at(i));
+    }
+
+    qreal beamThickness = engravings.beamThickness * staffSpace;
+    qreal beamDistance = beamThickness + engravings.beamSpacing * staffSpace;
+    for (int level = 1; level <= maxBeamCount; ++level) {
+        qreal levelY = beamY - beamThickness - (level - 1) * beamDistance;
+        addBeamLevel(&path, stemXs, level, levelY);
+    }
+
+    setPath(path);
+
+    if (!scene() && m_glyphs.at(0)->scene()) {
+        m_glyphs.at(0)->scene()->addItem(this);
+        setVisible(true);
+    }
+}
+
+/*!
+ * \brief BeamGraphicsItem::addBeamLevel Adds the beams of one level. Consecutive notes with at least
+ *        level beams are connected. A single note gets a partial beam to its left neighbour.
+ */
+void BeamGraphicsItem::addBeamLevel(QPainterPath *path, const QList<qreal> &stemXs, int level, qreal y)
+{
+    qreal staffSpace = m_musicFont->staffSpace();
+    Engravings engravings(m_musicFont->engravings());
+    qreal stemThickness = engravings.stemThickness * staffSpace;
+    qreal beamThickness = engravings.beamThickness * staffSpace;
+
+    int runStart = -1;
+    for (int i = 0; i <= m_beamCounts.count(); ++i) {
+        bool inRun = i < m_beamCounts.count() && m_beamCounts.at(i) >= level;
+        if (inRun && runStart == -1) {
+            runStart = i;
+            continue;
+        }
+        if (inRun || runStart == -1)
+            continue;
+
+        int runEnd = i - 1;
+        qreal left = stemXs.at(runStart);
+        qreal right = stemXs.at(runEnd) + stemThickness;
+        if (runStart == runEnd) {
+            qreal partialWidth = staffSpace;
+            if (runStart > 0) {
+                left = right - partialWidth;
+            } else {
+                right = left + partialWidth;
+            }
+        }
+        path->addRect(left, y, right - left, beamThickness);
+        runStart = -1;
+    }
+}
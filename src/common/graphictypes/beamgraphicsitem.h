@@ -0,0 +1,45 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#ifndef BEAMGRAPHICSITEM_H
+#define BEAMGRAPHICSITEM_H
+
+#include <QList>
+#include <QMetaObject>
+#include <QGraphicsPathItem>
+
+#include <common/graphictypes/MusicFont/musicfont.h>
+
+class GlyphItem;
+
+class BeamGraphicsItem : public QGraphicsPathItem
+{
+public:
+    explicit BeamGraphicsItem(QGraphicsItem *parent = 0);
+    ~BeamGraphicsItem();
+
+    void setGlyphs(const QList<GlyphItem*> &glyphs, const QList<int> &beamCounts);
+    QList<GlyphItem*> glyphs() const;
+
+    MusicFontPtr musicFont() const;
+    void setMusicFont(const MusicFontPtr &musicFont);
+
+    void setStemLengthFactor(qreal staffSpaceFactor);
+
+private:
+    void disconnectGlyphs();
+    void updatePath();
+    void addBeamLevel(QPainterPath *path, const QList<qreal> &stemXs, int level, qreal y);
+    QList<GlyphItem*> m_glyphs;
+    QList<int> m_beamCounts;
+    QList<QMetaObject::Connection> m_scenePosConnections;
+    MusicFontPtr m_musicFont;
+    qreal m_stemLengthFactor;
+};
+
+#endif // BEAMGRAPHICSITEM_H
@@ -11,27 +11,38 @@
 #include <QDebug>
 
 #include <common/layoutsettings.h>
+#include <utilities/memoryaccounting.h>
+#include <utilities/tracer.h>
 
 #include "MusicFont/musicfont.h"
 #include "glyphitem.h"
 
 GlyphItem::GlyphItem(QGraphicsItem *parent)
     : QGraphicsObject(parent),
-      m_colorRole(FontColor::Normal)
+      m_colorRole(FontColor::Normal),
+      m_glyphPainted(true)
 {
+    MemoryAccounting::addInstance(MemoryAccounting::GlyphItems, sizeof(GlyphItem));
     setFlag(QGraphicsItem::ItemIsSelectable);
     initMusicFont();
 }
 
 GlyphItem::GlyphItem(const QString &glyphName, QGraphicsItem *parent)
     : QGraphicsObject(parent),
-      m_colorRole(FontColor::Normal)
+      m_colorRole(FontColor::Normal),
+      m_glyphPainted(true)
 {
+    MemoryAccounting::addInstance(MemoryAccounting::GlyphItems, sizeof(GlyphItem));
     setFlag(QGraphicsItem::ItemIsSelectable);
     initMusicFont();
     setGlyphName(glyphName);
 }
 
+GlyphItem::~GlyphItem()
+{
+    MemoryAccounting::removeInstance(MemoryAccounting::GlyphItems, sizeof(GlyphItem));
+}
+
 void GlyphItem::initMusicFont()
 {
     setMusicFont(LayoutSettings::musicFont());
@@ -84,6 +95,33 @@ void GlyphItem::setScenePosChangeEnabled(bool enabled)
     setFlag(QGraphicsItem::ItemSendsScenePositionChanges, enabled);
 }
 
+/*!
+ * \brief GlyphItem::glyphChar Returns the character of the music font that is painted
+ *        by this item or a null character, if the item only contains other glyph items.
+ */
+QChar GlyphItem::glyphChar() const
+{
+    return m_char;
+}
+
+bool GlyphItem::isGlyphPainted() const
+{
+    return m_glyphPainted;
+}
+
+/*!
+ * \brief GlyphItem::setGlyphPainted If set to false, the glyph isn't painted but the item keeps
+ *        its geometry. Used by exporters which write the glyphs themselves.
+ */
+void GlyphItem::setGlyphPainted(bool painted)
+{
+    if (m_glyphPainted == painted)
+        return;
+
+    m_glyphPainted = painted;
+    update();
+}
+
 MusicFontPtr GlyphItem::musicFont() const
 {
     return m_musicFont;
@@ -200,7 +238,8 @@ QRectF GlyphItem::boundingRect() const
 
 void GlyphItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
 {
-    if (m_musicFont.isNull() || m_char.isNull())
+    LP_TRACE_SCOPE("GlyphItem::paint");
+    if (m_musicFont.isNull() || m_char.isNull() || !m_glyphPainted)
         return;
 
     QColor color(m_musicFont->fontColor(m_colorRole));
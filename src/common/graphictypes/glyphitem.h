@@ -21,6 +21,7 @@ class GlyphItem : public QGraphicsObject
 public:
     explicit GlyphItem(QGraphicsItem *parent = 0);
     explicit GlyphItem(const QString& glyphName, QGraphicsItem *parent = 0);
+    virtual ~GlyphItem();
 
     enum { Type = SymbolGlyphItemType };
     int type() const { return Type; }
@@ -45,6 +46,11 @@ public:
 
     void setGlyphName(const QString &glyphName);
 
+    QChar glyphChar() const;
+
+    bool isGlyphPainted() const;
+    void setGlyphPainted(bool painted);
+
     FontColor colorRole() const;
 
     void connectColorRoleToGlyph(GlyphItem *glyph);
@@ -76,6 +82,7 @@ private:
     MusicFontPtr m_musicFont;
     QRectF m_boundingRect;
     FontColor m_colorRole;
+    bool m_glyphPainted;
 };
 
 #endif // GLYPHITEM_H
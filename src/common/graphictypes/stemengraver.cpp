@@ -6,13 +6,27 @@
  *
  */
 
+/*!
+ * @class StemEngraver
+ * @brief Creates the StemGlyphItems for the melody notes of one measure.
+ *
+ * Changes of length or pitch only mark the stem of a note as dirty. All dirty
+ * stems of the measure are recomputed once, when control returns to the event loop.
+ * This way changing all notes of a measure recomputes every stem only once.
+ *
+ * If the engraver is engraved by the EngravingPipeline, stems aren't updated
+ * on data changes. They are hidden until the engraving is applied.
+ */
+
 #include <QObject>
+#include <QTimer>
 #include <QDebug>
 
 #include <common/itemdataroles.h>
 #include <common/datatypes/length.h>
 #include <common/datatypes/pitch.h>
 #include <common/graphictypes/glyphitem.h>
+#include <common/engraving/engravingtypes.h>
 
 #include "symbolgraphicbuilder.h"
 #include "stemglyphitem.h"
@@ -20,10 +34,27 @@
 
 StemEngraver::StemEngraver()
 {
+    m_updateTimer = new QTimer();
+    m_updateTimer->setSingleShot(true);
+    m_updateTimer->setInterval(0);
+    QObject::connect(m_updateTimer, &QTimer::timeout,
+                     [this] {
+        updateStems();
+    });
+}
+
+StemEngraver::~StemEngraver()
+{
+    foreach (const StemData &data, m_stemDatas) {
+        QObject::disconnect(data.dataChangedConnection);
+    }
+    delete m_updateTimer;
 }
 
 void StemEngraver::insertGraphicsBuilder(int index, SymbolGraphicBuilder *builder)
 {
+    Q_UNUSED(index);
+
     if (builder->symbolType() != LP::MelodyNote)
         return;
 
@@ -32,69 +63,127 @@ void StemEngraver::insertGraphicsBuilder(int index, SymbolGraphicBuilder *builde
         return;
     }
 
+    if (m_stemDatas.contains(builder))
+        return;
+
     StemData data;
     data.graphicBuilder = builder;
     data.glyphItem = new StemGlyphItem;
-    if (builder->glyphItem()) {
-        data.glyphItem->connectColorRoleToGlyph(builder->glyphItem());
-    }
-
+    data.glyphItem->connectColorRoleToGlyph(builder->glyphItem());
     data.glyphItem->setStemDirection(StemGlyphItem::Downwards);
+    data.glyphItem->setParentItem(builder->glyphItem());
 
-    m_stemDatas.insert(index, data);
-    GlyphItem *builderItem = builder->glyphItem();
-    if (builderItem) {
-        data.glyphItem->setParentItem(builderItem);
+    if (isEngravedByPipeline()) {
+        data.glyphItem->setVisible(false);
+        m_stemDatas.insert(builder, data);
+        return;
     }
-    QObject::connect(builder, &SymbolGraphicBuilder::dataChanged,
-                     [this, builder] (const QVariant& data, int role) {
+
+    data.dataChangedConnection = QObject::connect(builder, &SymbolGraphicBuilder::dataChanged,
+                                                  [this, builder] (const QVariant& data, int role) {
         builderDataChanged(builder, data, role);
     });
 
+    m_stemDatas.insert(builder, data);
+
     // Init
-    builderDataChanged(builder, builder->data(LP::SymbolLength), LP::SymbolLength);
-    builderDataChanged(builder, builder->data(LP::SymbolPitch), LP::SymbolPitch);
+    m_dirtyBuilders.insert(builder);
+    m_updateTimer->start();
 }
 
-void StemEngraver::removeGraphicsBuilder(SymbolGraphicBuilder *builder)
+void StemEngraver::removeGraphicsBuilder(int index, SymbolGraphicBuilder *builder)
 {
-    StemData dataToRemove = stemDataWithGraphicBuilder(builder);
-    StemGlyphItem *stemGlyph = dataToRemove.glyphItem;
-    if (!stemGlyph)
+    Q_UNUSED(index);
+
+    StemData dataToRemove = m_stemDatas.take(builder);
+    m_dirtyBuilders.remove(builder);
+    if (!dataToRemove.glyphItem)
         return;
 
+    QObject::disconnect(dataToRemove.dataChangedConnection);
     delete dataToRemove.glyphItem;
-    dataToRemove.glyphItem = 0;
 }
 
-void StemEngraver::builderDataChanged(SymbolGraphicBuilder *builder, const QVariant &data, int role)
+/*!
+ * \brief StemEngraver::applyEngraving Sets the stem length and flag of the engraving on the
+ *        stems. Stems of beamed notes are drawn by the beam, so they are hidden.
+ */
+void StemEngraver::applyEngraving(const QList<SymbolGraphicBuilder *> &builders, const MeasureEngraving &engraving)
 {
-    if (!data.isValid())
-        return;
-
-    if (role == LP::SymbolLength) {
-        Length::Value length = data.value<Length::Value>();
-        StemData stemData = stemDataWithGraphicBuilder(builder);
+    for (int i = 0; i < builders.count() && i < engraving.symbols.count(); ++i) {
+        StemData stemData = stemDataWithGraphicBuilder(builders.at(i));
         if (!stemData.glyphItem)
-            return;
-        stemData.glyphItem->setLength(length);
+            continue;
+
+        const SymbolEngraving &symbolEngraving = engraving.symbols.at(i);
+        stemData.glyphItem->setEngraving(symbolEngraving.stemLength, symbolEngraving.flagGlyph);
+        stemData.glyphItem->setVisible(symbolEngraving.beamGroup == -1);
     }
-    if (role == LP::SymbolPitch) {
-        Pitch pitch = data.value<Pitch>();
+}
+
+/*!
+ * \brief StemEngraver::updateStems Recomputes all stems, whose length or pitch has changed
+ *        since the last update.
+ */
+void StemEngraver::updateStems()
+{
+    m_updateTimer->stop();
+
+    foreach (SymbolGraphicBuilder *builder, m_dirtyBuilders) {
         StemData stemData = stemDataWithGraphicBuilder(builder);
         if (!stemData.glyphItem)
-            return;
-        stemData.glyphItem->setPitch(pitch);
+            continue;
+        updateStem(stemData);
     }
+    m_dirtyBuilders.clear();
+}
+
+/*!
+ * \brief StemEngraver::setStemVisible Hides or shows the stem and flag of a note. Beamed notes
+ *        have their stems drawn by the beam.
+ */
+void StemEngraver::setStemVisible(SymbolGraphicBuilder *builder, bool visible)
+{
+    StemData stemData = stemDataWithGraphicBuilder(builder);
+    if (!stemData.glyphItem)
+        return;
+
+    stemData.glyphItem->setVisible(visible);
+}
+
+void StemEngraver::builderDataChanged(SymbolGraphicBuilder *builder, const QVariant &data, int role)
+{
+    if (!data.isValid())
+        return;
+
+    if (role != LP::SymbolLength &&
+            role != LP::SymbolPitch)
+        return;
+
+    if (!m_stemDatas.contains(builder))
+        return;
+
+    m_dirtyBuilders.insert(builder);
+    m_updateTimer->start();
 }
 
-StemData StemEngraver::stemDataWithGraphicBuilder(SymbolGraphicBuilder *builder)
+void StemEngraver::updateStem(const StemData &stemData)
 {
-    foreach (StemData data, m_stemDatas) {
-        if (data.graphicBuilder == builder) {
-            return data;
-        }
+    SymbolGraphicBuilder *builder = stemData.graphicBuilder;
+
+    // setLength lays out flag and stem, so the pitch only has to be set without a length
+    QVariant lengthData = builder->data(LP::SymbolLength);
+    if (lengthData.isValid()) {
+        stemData.glyphItem->setLength(lengthData.value<Length::Value>());
+        return;
     }
 
-    return StemData();
+    QVariant pitchData = builder->data(LP::SymbolPitch);
+    if (pitchData.isValid())
+        stemData.glyphItem->setPitch(pitchData.value<Pitch>());
+}
+
+StemData StemEngraver::stemDataWithGraphicBuilder(SymbolGraphicBuilder *builder) const
+{
+    return m_stemDatas.value(builder);
 }
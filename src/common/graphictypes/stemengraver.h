@@ -9,10 +9,13 @@
 #ifndef STEMENGRAVER_H
 #define STEMENGRAVER_H
 
-#include <QList>
+#include <QHash>
+#include <QSet>
+#include <QMetaObject>
 
 #include "baseengraver.h"
 
+class QTimer;
 class StemGlyphItem;
 
 struct StemData {
@@ -23,21 +26,29 @@ struct StemData {
 
     SymbolGraphicBuilder *graphicBuilder;
     StemGlyphItem *glyphItem;
+    QMetaObject::Connection dataChangedConnection;
 };
 
 class StemEngraver : public BaseEngraver
 {
 public:
     explicit StemEngraver();
-    virtual ~StemEngraver() {}
+    virtual ~StemEngraver();
 
     void insertGraphicsBuilder(int index, SymbolGraphicBuilder *builder);
-    void removeGraphicsBuilder(SymbolGraphicBuilder *builder);
+    void removeGraphicsBuilder(int index, SymbolGraphicBuilder *builder);
+    void applyEngraving(const QList<SymbolGraphicBuilder*> &builders, const MeasureEngraving &engraving);
+
+    void updateStems();
+    void setStemVisible(SymbolGraphicBuilder *builder, bool visible);
 
 private:
     void builderDataChanged(SymbolGraphicBuilder *builder, const QVariant &data, int role);
-    StemData stemDataWithGraphicBuilder(SymbolGraphicBuilder *builder);
-    QList<StemData> m_stemDatas;
+    void updateStem(const StemData &stemData);
+    StemData stemDataWithGraphicBuilder(SymbolGraphicBuilder *builder) const;
+    QHash<SymbolGraphicBuilder*, StemData> m_stemDatas;
+    QSet<SymbolGraphicBuilder*> m_dirtyBuilders;
+    QTimer *m_updateTimer;
 };
 
 #endif // STEMENGRAVER_H
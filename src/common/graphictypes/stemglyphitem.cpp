@@ -8,6 +8,7 @@
 
 #include <QPen>
 #include <QGraphicsLineItem>
+#include <common/engraving/engravingrules.h>
 #include "stemglyphitem.h"
 
 /*!
@@ -16,7 +17,8 @@
  */
 StemGlyphItem::StemGlyphItem()
     : m_stemDirection(Upwards),
-      m_stemLengthFactor(3.5)
+      m_stemLengthFactor(3.5),
+      m_engravedStemLength(0)
 {
     m_flagItem = new GlyphItem(this);
     m_flagItem->connectColorRoleToGlyph(this);
@@ -54,6 +56,26 @@ void StemGlyphItem::setFlagGlyph(Length::Value length)
     m_flagItem->setGlyphName(flagGlyphName);
 }
 
+/*!
+ * \brief StemGlyphItem::setEngraving Sets the stem length and flag computed by the
+ *        EngravingPipeline. The stem and flag are hidden, if the note has no flag.
+ */
+void StemGlyphItem::setEngraving(qreal stemLength, const QString &flagGlyph)
+{
+    bool hasFlag = !flagGlyph.isEmpty();
+
+    m_flagItem->setVisible(hasFlag);
+    m_stemItem->setVisible(hasFlag);
+    m_engravedStemLength = stemLength;
+
+    if (!hasFlag) {
+        return;
+    }
+
+    m_flagItem->setGlyphName(flagGlyph);
+    layoutFlagGlyphAndStem();
+}
+
 StemGlyphItem::Direction StemGlyphItem::stemDirection() const
 {
     return m_stemDirection;
@@ -66,19 +88,12 @@ void StemGlyphItem::setStemDirection(const Direction &stemDirection)
 
 QString StemGlyphItem::flagGlyphNameFromLength(Length::Value length)
 {
-    int lengthNumber = Length::toInt(length);
-    QString numerator(QStringLiteral("th"));
-    if (length == Length::_32) {
-        numerator = QStringLiteral("nd");
-    }
-
-    QString nameTemplate("flag%1%2%3");
-    QString direction = QStringLiteral("Up");
+    EngravingRules::StemDirection direction = EngravingRules::StemDirection::Upwards;
     if (m_stemDirection == Downwards) {
-        direction = QStringLiteral("Down");
+        direction = EngravingRules::StemDirection::Downwards;
     }
 
-    return nameTemplate.arg(lengthNumber).arg(numerator).arg(direction);
+    return EngravingRules::flagGlyphForLength(length, direction);
 }
 
 void StemGlyphItem::layoutFlagGlyphAndStem()
@@ -94,6 +109,8 @@ void StemGlyphItem::layoutFlagGlyphAndStem()
     GlyphData parentData = parentGlyph->itemGlyphData();
 
     qreal stemLength = m_stemLengthFactor * musicFont()->staffSpace();
+    if (m_engravedStemLength > 0)
+        stemLength = m_engravedStemLength;
     QPointF basePos(parentData.stemDownNW);
     if (m_stemDirection == Upwards) {
         stemLength *= -1;
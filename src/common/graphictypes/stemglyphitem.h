@@ -37,6 +37,8 @@ public:
 
     void setFlagGlyph(Length::Value length);
 
+    void setEngraving(qreal stemLength, const QString &flagGlyph);
+
     // GlyphItem interface
 protected:
     void musicFontHasChanged(const MusicFontPtr &musicFont);
@@ -49,6 +51,7 @@ private:
     QGraphicsLineItem *m_stemItem;
     Direction m_stemDirection;
     qreal m_stemLengthFactor;
+    qreal m_engravedStemLength;
 };
 
 #endif // STEMGLYPHITEM_H
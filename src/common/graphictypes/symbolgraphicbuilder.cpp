@@ -24,7 +24,8 @@
 #include "symbolgraphicbuilder.h"
 
 SymbolGraphicBuilder::SymbolGraphicBuilder()
-    : m_symbolType(0)
+    : m_symbolType(0),
+      m_engravedByPipeline(false)
 {
 }
 
@@ -64,3 +65,13 @@ void SymbolGraphicBuilder::setSymbolType(int symbolType)
 {
     m_symbolType = symbolType;
 }
+
+bool SymbolGraphicBuilder::isEngravedByPipeline() const
+{
+    return m_engravedByPipeline;
+}
+
+void SymbolGraphicBuilder::setEngravedByPipeline(bool engravedByPipeline)
+{
+    m_engravedByPipeline = engravedByPipeline;
+}
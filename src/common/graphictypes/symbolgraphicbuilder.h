@@ -16,6 +16,7 @@
 #include <common/pluginmanagerinterface.h>
 
 class GlyphItem;
+struct SymbolEngraving;
 
 class SymbolGraphicBuilder : public QObject
 {
@@ -48,6 +49,19 @@ public:
         Q_UNUSED(pluginManager);
     }
 
+    bool isEngravedByPipeline() const;
+    void setEngravedByPipeline(bool engravedByPipeline);
+
+    /*!
+     * \brief applyEngraving Applies the result of the EngravingPipeline to the graphic.
+     *        Subclasses, which skip parts of the engraving in updateSymbolGraphic while
+     *        isEngravedByPipeline is set, have to reimplement it.
+     */
+    virtual void applyEngraving(const SymbolEngraving &engraving)
+    {
+        Q_UNUSED(engraving);
+    }
+
 signals:
     void dataChanged(const QVariant& data, int role);
 
@@ -61,6 +75,7 @@ protected:
 private:
     QHash<int, QVariant> m_graphicData;
     int m_symbolType;
+    bool m_engravedByPipeline;
 };
 
 #endif // SYMBOLGRAPHICBUILDER_H
@@ -6,6 +6,23 @@
  *
  */
 
+/*!
+ * @class TieEngraver
+ * @brief Creates TieGraphicsItems for the tie symbols of one measure.
+ *
+ * The tie builders are kept in order together with their distance to the previous tie
+ * builder. A Fenwick tree of the distances finds the position of a tie builder and the
+ * tie enclosing a position in O(log k) for k tie builders. Inserting or removing a symbol
+ * only changes the distance of the following tie builder. The tree is rebuilt in O(k),
+ * if a tie builder is inserted or removed.
+ * Engravers of consecutive measures can be chained with setPreviousEngraver and
+ * setNextEngraver. A tie which isn't closed at the end of a measure is continued
+ * in the following measure.
+ *
+ * Ties span measures, so if the engraver is engraved by the EngravingPipeline,
+ * the VisualPart creates the TieGraphicsItems and the engraver ignores the builders.
+ */
+
 #include <common/defines.h>
 #include <common/itemdataroles.h>
 #include <common/graphictypes/symbolgraphicbuilder.h>
@@ -14,128 +31,172 @@
 #include "tieengraver.h"
 
 TieEngraver::TieEngraver()
+    : m_previousEngraver(0),
+      m_nextEngraver(0),
+      m_precedingTieItem(0)
 {
 }
 
-SpanType TieEngraver::spanTypeOfBuilder(SymbolGraphicBuilder *builder)
+TieEngraver::~TieEngraver()
+{
+    foreach (SymbolGraphicBuilder *builder, m_tiedBuilders.keys()) {
+        setTieItemOfBuilder(builder, 0);
+    }
+    unlink();
+
+    foreach (SymbolGraphicBuilder *builder, m_spanBuilders) {
+        if (spanTypeOfBuilder(builder) == SpanType::Start) {
+            delete m_tieItems.value(builder);
+        }
+    }
+}
+
+SpanType TieEngraver::spanTypeOfBuilder(SymbolGraphicBuilder *builder) const
 {
     SpanType spanType = builder->data(LP::SymbolSpanType).value<SpanType>();
 
     return spanType;
 }
 
-SymbolGraphicBuilder *TieEngraver::startItemBuilderBefore(int index)
+TieEngraver *TieEngraver::previousEngraver() const
 {
-    if (!m_graphicBuilder.count())
-        return 0;
+    return m_previousEngraver;
+}
+
+void TieEngraver::setPreviousEngraver(TieEngraver *engraver)
+{
+    if (m_previousEngraver == engraver)
+        return;
+
+    if (m_previousEngraver)
+        m_previousEngraver->m_nextEngraver = 0;
 
-    SymbolGraphicBuilder *startItemBuilder;
-    for (int i = index; i >= 0; --i) {
-        startItemBuilder = m_graphicBuilder.at(i);
-        if (spanTypeOfBuilder(startItemBuilder) == SpanType::Start ||
-                spanTypeOfBuilder(startItemBuilder) == SpanType::End) {
-            break;
+    TieEngraver *detachedEngraver = 0;
+    m_previousEngraver = engraver;
+    if (engraver) {
+        if (engraver->m_nextEngraver) {
+            detachedEngraver = engraver->m_nextEngraver;
+            detachedEngraver->m_previousEngraver = 0;
         }
+        engraver->m_nextEngraver = this;
     }
-    return startItemBuilder;
+
+    tieBuildersFrom(0, enclosingTieItem(0));
+    if (detachedEngraver)
+        detachedEngraver->tieBuildersFrom(0, 0);
 }
 
-SymbolGraphicBuilder *TieEngraver::endItemBuilderAfter(int index)
+TieEngraver *TieEngraver::nextEngraver() const
 {
-    if (!m_graphicBuilder.count())
-        return 0;
+    return m_nextEngraver;
+}
 
-    SymbolGraphicBuilder *endItemBuilder;
-    for (int i = 0; i <= index; ++i) {
-        endItemBuilder = m_graphicBuilder.at(i);
-        if (spanTypeOfBuilder(endItemBuilder) == SpanType::Start ||
-                spanTypeOfBuilder(endItemBuilder) == SpanType::End) {
-            break;
-        }
+void TieEngraver::setNextEngraver(TieEngraver *engraver)
+{
+    if (engraver) {
+        engraver->setPreviousEngraver(this);
+        return;
+    }
+
+    if (m_nextEngraver) {
+        TieEngraver *oldNext = m_nextEngraver;
+        m_nextEngraver = 0;
+        oldNext->setPreviousEngraver(0);
     }
-    return endItemBuilder;
+}
+
+/*!
+ * \brief TieEngraver::openTieItem Returns the tie item which isn't closed at the end
+ *        of this measure or 0, if there is none.
+ */
+TieGraphicsItem *TieEngraver::openTieItem() const
+{
+    return enclosingTieItem(m_graphicBuilder.count());
+}
+
+/*!
+ * \brief TieEngraver::tieItemAt Returns the tie item the symbol at index belongs to or 0,
+ *        if it isn't tied.
+ */
+TieGraphicsItem *TieEngraver::tieItemAt(int index) const
+{
+    return enclosingTieItem(index);
+}
+
+/*!
+ * \brief TieEngraver::tieItemOfBuilder Returns the tie item a tie start or tie end builder
+ *        belongs to or 0, if the builder isn't paired.
+ */
+TieGraphicsItem *TieEngraver::tieItemOfBuilder(SymbolGraphicBuilder *builder) const
+{
+    return m_tieItems.value(builder);
 }
 
 void TieEngraver::insertGraphicsBuilder(int index, SymbolGraphicBuilder *builder)
 {
-    if (builder->symbolType() == LP::Tie) {
-        SpanType spanType = spanTypeOfBuilder(builder);
-        if (spanType == SpanType::Start) {
-            // TieGraphicsItem will have no parent item per default.
-            // It will add itself to the graphics scene, when items are added
-            TieGraphicsItem *tieItem = new TieGraphicsItem;
-            tieItem->setMusicFont(musicFont());
-            m_tieItems.insert(builder, tieItem);
-
-            SymbolGraphicBuilder *endItemBuilder = endItemBuilderAfter(index);
-            if (!endItemBuilder)
-                return;
-
-            if (spanTypeOfBuilder(endItemBuilder) == SpanType::End) {
-                m_tieItems.insert(endItemBuilder, tieItem);
-            }
-        } else {
-            SymbolGraphicBuilder *startItemBuilder = startItemBuilderBefore(index);
-            if (!startItemBuilder)
-                return;
-
-            if (spanTypeOfBuilder(startItemBuilder) == SpanType::Start) {
-                TieGraphicsItem *tieItem = m_tieItems.value(startItemBuilder);
-                if (!tieItem) {
-                    qWarning() << "TieEngraver: Tie Start graphics builder has no tie item";
-                    return;
-                }
-                m_tieItems.insert(builder, tieItem);
-            }
-        }
-        QString spanTypeName = QStringLiteral("start");
-        if (spanType == SpanType::End)
-            spanTypeName = "end";
+    if (isEngravedByPipeline())
+        return;
 
-        qDebug() << "TieEngraver: Inserted Tie " << spanTypeName << " symbol at "
-                    << index;
-    }
+    if (index < 0 || index > m_graphicBuilder.count())
+        index = m_graphicBuilder.count();
 
+    int span = spanFrom(index);
     m_graphicBuilder.insert(index, builder);
 
-    if (builder->symbolType() == LP::Tie) {
+    if (builder->symbolType() != LP::Tie) {
+        if (span < m_spanBuilders.count())
+            addToSpanDistance(span, 1);
+        setTieItemOfBuilder(builder, enclosingTieItem(index));
         return;
     }
 
-    if (builder->glyphItem()) {
-        SymbolGraphicBuilder *tieStart = 0;
+    SpanType spanType = spanTypeOfBuilder(builder);
+    TieGraphicsItem *enclosingTie = enclosingTieItem(index);
+    insertSpan(span, index, builder);
 
-        // Search for tie start directly before newly inserted symbol
-        for (int i = index; i >= 0; --i) {
-            tieStart = m_graphicBuilder.at(i);
-            SpanType spanType = spanTypeOfBuilder(tieStart);
+    if (spanType == SpanType::Start) {
+        // TieGraphicsItem will have no parent item per default.
+        // It will add itself to the graphics scene, when items are added
+        TieGraphicsItem *tieItem = new TieGraphicsItem;
+        tieItem->setMusicFont(musicFont());
+        m_tieItems.insert(builder, tieItem);
 
-            if (spanType == SpanType::Start) {
-                break;
-            }
-            if (spanType == SpanType::End ||
-                    i == 0) {
-                tieStart = 0;
-                break;
-            }
-        }
+        tieBuildersFrom(index + 1, tieItem);
+    } else if (spanType == SpanType::End) {
+        if (enclosingTie)
+            m_tieItems.insert(builder, enclosingTie);
 
-        if (!tieStart) {
-            return;
-        }
-
-        TieGraphicsItem *tieItem = m_tieItems.value(tieStart);
-        if (!tieItem)
-            return;
-
-        tieItem->addGlyph(builder->glyphItem());
+        tieBuildersFrom(index + 1, 0);
     }
 }
 
-void TieEngraver::removeGraphicsBuilder(SymbolGraphicBuilder *builder)
+void TieEngraver::removeGraphicsBuilder(int index, SymbolGraphicBuilder *builder)
 {
-    m_graphicBuilder.removeAll(builder);
-    m_tieItems.remove(builder);
+    if (isEngravedByPipeline())
+        return;
+
+    if (index < 0 || index >= m_graphicBuilder.count() ||
+            m_graphicBuilder.at(index) != builder)
+        return;
+
+    m_graphicBuilder.removeAt(index);
+    setTieItemOfBuilder(builder, 0);
+
+    int span = spanFrom(index);
+    if (span == m_spanBuilders.count())
+        return;
+
+    if (m_spanBuilders.at(span) != builder) {
+        addToSpanDistance(span, -1);
+        return;
+    }
+
+    removeSpan(span);
+    TieGraphicsItem *tieItem = m_tieItems.take(builder);
+    tieBuildersFrom(index, enclosingTieItem(index));
+
+    if (spanTypeOfBuilder(builder) == SpanType::Start)
+        delete tieItem;
 }
 
 void TieEngraver::musicFontHasChanged(const MusicFontPtr &musicFont)
@@ -144,3 +205,169 @@ void TieEngraver::musicFontHasChanged(const MusicFontPtr &musicFont)
         tieGraphic->setMusicFont(musicFont);
     }
 }
+
+/*!
+ * \brief TieEngraver::spanFrom Returns the number of the first tie builder at or behind index
+ *        or the number of tie builders, if there is none.
+ */
+int TieEngraver::spanFrom(int index) const
+{
+    int spanCount = m_spanBuilders.count();
+    int highestStep = 1;
+    while (highestStep * 2 <= spanCount)
+        highestStep *= 2;
+
+    // Searches the first tie builder, whose position is greater or equal index
+    int span = 0;
+    int remaining = index + 1;
+    for (int step = highestStep; step; step /= 2) {
+        if (span + step <= spanCount && m_spanDistanceTree.at(span + step) < remaining) {
+            span += step;
+            remaining -= m_spanDistanceTree.at(span);
+        }
+    }
+    return span;
+}
+
+/*!
+ * \brief TieEngraver::spanPosition Returns the index of the tie builder with the number span
+ *        in m_graphicBuilder.
+ */
+int TieEngraver::spanPosition(int span) const
+{
+    int position = -1;
+    for (int i = span + 1; i > 0; i -= i & -i) {
+        position += m_spanDistanceTree.at(i);
+    }
+    return position;
+}
+
+void TieEngraver::addToSpanDistance(int span, int offset)
+{
+    m_spanDistances[span] += offset;
+    for (int i = span + 1; i < m_spanDistanceTree.count(); i += i & -i) {
+        m_spanDistanceTree[i] += offset;
+    }
+}
+
+void TieEngraver::insertSpan(int span, int index, SymbolGraphicBuilder *builder)
+{
+    int distance = index - (span > 0 ? spanPosition(span - 1) : -1);
+    if (span < m_spanBuilders.count())
+        m_spanDistances[span] -= distance - 1;
+
+    m_spanBuilders.insert(span, builder);
+    m_spanDistances.insert(span, distance);
+    rebuildSpanDistanceTree();
+}
+
+void TieEngraver::removeSpan(int span)
+{
+    int distance = m_spanDistances.takeAt(span);
+    m_spanBuilders.removeAt(span);
+    if (span < m_spanBuilders.count())
+        m_spanDistances[span] += distance - 1;
+
+    rebuildSpanDistanceTree();
+}
+
+void TieEngraver::rebuildSpanDistanceTree()
+{
+    m_spanDistanceTree.fill(0, m_spanDistances.count() + 1);
+    for (int i = 1; i < m_spanDistanceTree.count(); ++i) {
+        m_spanDistanceTree[i] += m_spanDistances.at(i - 1);
+        int parent = i + (i & -i);
+        if (parent < m_spanDistanceTree.count())
+            m_spanDistanceTree[parent] += m_spanDistanceTree.at(i);
+    }
+}
+
+/*!
+ * \brief TieEngraver::enclosingTieItem Returns the tie item a symbol at index belongs to.
+ *        If there is no tie builder before index, the open tie of the previous measure is used.
+ */
+TieGraphicsItem *TieEngraver::enclosingTieItem(int index) const
+{
+    int span = spanFrom(index);
+    if (span == 0) {
+        if (m_previousEngraver)
+            return m_previousEngraver->openTieItem();
+        return 0;
+    }
+
+    SymbolGraphicBuilder *spanBuilder = m_spanBuilders.at(span - 1);
+    if (spanTypeOfBuilder(spanBuilder) == SpanType::Start)
+        return m_tieItems.value(spanBuilder);
+
+    return 0;
+}
+
+/*!
+ * \brief TieEngraver::tieBuildersFrom Adds all symbols from index up to the next tie builder
+ *        to tieItem. A following tie end will be paired with tieItem. If there is no tie builder
+ *        left in this measure, the symbols of the next measure are processed as well, unless
+ *        they already belong to tieItem. So only the measures whose tie has changed are visited.
+ * \param tieItem The new tie item of the symbols or 0, if they aren't tied.
+ */
+void TieEngraver::tieBuildersFrom(int index, TieGraphicsItem *tieItem)
+{
+    if (index == 0)
+        m_precedingTieItem = tieItem;
+
+    int endIndex = m_graphicBuilder.count();
+    int nextSpan = spanFrom(index);
+    if (nextSpan < m_spanBuilders.count())
+        endIndex = spanPosition(nextSpan);
+
+    for (int i = index; i < endIndex; ++i) {
+        setTieItemOfBuilder(m_graphicBuilder.at(i), tieItem);
+    }
+
+    if (nextSpan == m_spanBuilders.count()) {
+        if (m_nextEngraver && m_nextEngraver->m_precedingTieItem != tieItem)
+            m_nextEngraver->tieBuildersFrom(0, tieItem);
+        return;
+    }
+
+    SymbolGraphicBuilder *spanBuilder = m_spanBuilders.at(nextSpan);
+    if (spanTypeOfBuilder(spanBuilder) == SpanType::End) {
+        if (tieItem)
+            m_tieItems.insert(spanBuilder, tieItem);
+        else
+            m_tieItems.remove(spanBuilder);
+    }
+}
+
+void TieEngraver::setTieItemOfBuilder(SymbolGraphicBuilder *builder, TieGraphicsItem *tieItem)
+{
+    TieGraphicsItem *currentTieItem = m_tiedBuilders.value(builder);
+    if (currentTieItem == tieItem)
+        return;
+
+    GlyphItem *glyph = builder->glyphItem();
+    if (!glyph)
+        return;
+
+    if (currentTieItem) {
+        currentTieItem->removeGlyph(glyph);
+        m_tiedBuilders.remove(builder);
+    }
+
+    if (tieItem) {
+        tieItem->addGlyph(glyph);
+        m_tiedBuilders.insert(builder, tieItem);
+    }
+}
+
+void TieEngraver::unlink()
+{
+    TieEngraver *previous = m_previousEngraver;
+    if (m_nextEngraver) {
+        m_nextEngraver->setPreviousEngraver(previous);
+    } else if (previous) {
+        previous->m_nextEngraver = 0;
+    }
+
+    m_previousEngraver = 0;
+    m_nextEngraver = 0;
+}
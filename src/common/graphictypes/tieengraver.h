@@ -11,6 +11,7 @@
 
 #include <QList>
 #include <QHash>
+#include <QVector>
 
 #include <common/defines.h>
 
@@ -23,23 +24,50 @@ class TieEngraver : public BaseEngraver
 {
 public:
     TieEngraver();
+    ~TieEngraver();
 
     // BaseEngraver interface
 public:
     void insertGraphicsBuilder(int index, SymbolGraphicBuilder *builder);
-    void removeGraphicsBuilder(SymbolGraphicBuilder *builder);
+    void removeGraphicsBuilder(int index, SymbolGraphicBuilder *builder);
 
-    SpanType spanTypeOfBuilder(SymbolGraphicBuilder *builder);
+    SpanType spanTypeOfBuilder(SymbolGraphicBuilder *builder) const;
+
+    TieEngraver *previousEngraver() const;
+    void setPreviousEngraver(TieEngraver *engraver);
+    TieEngraver *nextEngraver() const;
+    void setNextEngraver(TieEngraver *engraver);
+
+    TieGraphicsItem *openTieItem() const;
+    TieGraphicsItem *tieItemAt(int index) const;
+    TieGraphicsItem *tieItemOfBuilder(SymbolGraphicBuilder *builder) const;
 
 protected:
     void musicFontHasChanged(const MusicFontPtr &musicFont);
 
 private:
-    SymbolGraphicBuilder *startItemBuilderBefore(int index);
-    SymbolGraphicBuilder *endItemBuilderAfter(int index);
+    int spanFrom(int index) const;
+    int spanPosition(int span) const;
+    void addToSpanDistance(int span, int offset);
+    void insertSpan(int span, int index, SymbolGraphicBuilder *builder);
+    void removeSpan(int span);
+    void rebuildSpanDistanceTree();
+    TieGraphicsItem *enclosingTieItem(int index) const;
+    void tieBuildersFrom(int index, TieGraphicsItem *tieItem);
+    void setTieItemOfBuilder(SymbolGraphicBuilder *builder, TieGraphicsItem *tieItem);
+    void unlink();
+
     QList<SymbolGraphicBuilder*> m_graphicBuilder;
+    QList<SymbolGraphicBuilder*> m_spanBuilders; // Tie builders in the order of m_graphicBuilder
+    QVector<int> m_spanDistances;      // Distance of every tie builder to the previous one
+    QVector<int> m_spanDistanceTree;   // Fenwick tree of m_spanDistances, starting at 1
     QHash<SymbolGraphicBuilder*, TieGraphicsItem*> m_tieItems; // Contains pointers to TieGraphicsItems
                                                                // for every tie graphic builder
+    QHash<SymbolGraphicBuilder*, TieGraphicsItem*> m_tiedBuilders; // Tie item a note glyph was added to
+    TieEngraver *m_previousEngraver;
+    TieEngraver *m_nextEngraver;
+    TieGraphicsItem *m_precedingTieItem;  // Open tie of the previous measure, the symbols at the
+                                          // start of this measure were added to
 };
 
 #endif // TIEENGRAVER_H
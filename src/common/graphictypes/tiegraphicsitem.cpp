@@ -18,15 +18,31 @@ TieGraphicsItem::TieGraphicsItem(QGraphicsItem *parent)
     setBrush(Qt::black);
 }
 
+TieGraphicsItem::~TieGraphicsItem()
+{
+    foreach (const QMetaObject::Connection &connection, m_scenePosConnections) {
+        QObject::disconnect(connection);
+    }
+    foreach (const QMetaObject::Connection &connection, m_destroyedConnections) {
+        QObject::disconnect(connection);
+    }
+}
+
 void TieGraphicsItem::addGlyph(GlyphItem *item)
 {
     if (!m_spanningGlyphs.contains(item)) {
         m_spanningGlyphs.append(item);
         item->setScenePosChangeEnabled(true);
-        QObject::connect(item, &GlyphItem::scenePosChanged,
-                         [this, item] {
+        QMetaObject::Connection connection =
+                QObject::connect(item, &GlyphItem::scenePosChanged,
+                                 [this, item] {
             checkIfHasGlyphAndUpdate(item);
         });
+        m_scenePosConnections.insert(item, connection);
+        m_destroyedConnections.insert(item, QObject::connect(item, &QObject::destroyed,
+                                                             [this, item] {
+            glyphDestroyed(item);
+        }));
         updatePath();
         reposition();
     }
@@ -38,6 +54,8 @@ void TieGraphicsItem::removeGlyph(GlyphItem *item)
         return;
 
     m_spanningGlyphs.removeAll(item);
+    QObject::disconnect(m_scenePosConnections.take(item));
+    QObject::disconnect(m_destroyedConnections.take(item));
     item->setScenePosChangeEnabled(false);
     updatePath();
     reposition();
@@ -78,7 +96,7 @@ void TieGraphicsItem::updatePath()
 //    qDebug() << "TieGraphicsItem: bounding rect path: " << path.boundingRect();
 //    qDebug() << "TieGraphicsItem: bounding rect: " << boundingRect();
 
-    if (!scene()) {
+    if (!scene() && m_spanningGlyphs.at(0)->scene()) {
         m_spanningGlyphs.at(0)->scene()->addItem(this);
         setVisible(true);
     }
@@ -110,3 +128,14 @@ void TieGraphicsItem::checkIfHasGlyphAndUpdate(GlyphItem *item)
     updatePath();
 }
 
+/*!
+ * \brief TieGraphicsItem::glyphDestroyed Forgets a glyph, which was deleted without being removed.
+ *        The glyph is partly destroyed, so it must not be accessed. The path is updated with the
+ *        next change of the remaining glyphs.
+ */
+void TieGraphicsItem::glyphDestroyed(GlyphItem *item)
+{
+    m_spanningGlyphs.removeAll(item);
+    m_scenePosConnections.remove(item);
+    m_destroyedConnections.remove(item);
+}
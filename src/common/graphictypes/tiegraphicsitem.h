@@ -10,6 +10,8 @@
 #define TIEGRAPHICSITEM_H
 
 #include <QList>
+#include <QHash>
+#include <QMetaObject>
 #include <QGraphicsPathItem>
 
 #include <common/graphictypes/MusicFont/musicfont.h>
@@ -20,6 +22,7 @@ class TieGraphicsItem : public QGraphicsPathItem
 {
 public:
     explicit TieGraphicsItem(QGraphicsItem *parent = 0);
+    ~TieGraphicsItem();
 
     void addGlyph(GlyphItem *item);
     void removeGlyph(GlyphItem *item);
@@ -29,9 +32,12 @@ public:
 
 private:
     void checkIfHasGlyphAndUpdate(GlyphItem *item);
+    void glyphDestroyed(GlyphItem *item);
     void updatePath();
     void reposition();
     QList<GlyphItem*> m_spanningGlyphs;
+    QHash<GlyphItem*, QMetaObject::Connection> m_scenePosConnections;
+    QHash<GlyphItem*, QMetaObject::Connection> m_destroyedConnections;
     MusicFontPtr m_musicFont;
 };
 
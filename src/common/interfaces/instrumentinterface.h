@@ -15,6 +15,7 @@
 #define INSTRUMENT_INTERFACE_H
 
 #include <QtPlugin>
+#include <QVector>
 
 #include <common/datatypes/instrument.h>
 
@@ -28,6 +29,19 @@ public:
     virtual int type() const = 0;
     virtual InstrumentMetaData instrumentMetaData() const = 0;
     virtual QString name() const = 0;
+
+    /*!
+     * \brief graceNoteStaffPositions Returns the staff positions of the grace notes, which are
+     *        played for an embellishment before the melody note
+     * \param symbolType The type of the embellishment
+     * \param melodyStaffPos The staff position of the following melody note
+     */
+    virtual QVector<int> graceNoteStaffPositions(int symbolType, int melodyStaffPos) const
+    {
+        Q_UNUSED(symbolType);
+        Q_UNUSED(melodyStaffPos);
+        return QVector<int>();
+    }
 };
 
 #define InstrumentInterfaceIID "org.limepipes.LimePipes.InstrumentInterface/0.2"
@@ -6,10 +6,26 @@
  *
  */
 
+/*!
+ * @class ObservableSettings
+ * @brief Base class of all settings which notify their observers about changes.
+ *
+ * Observers subscribe to a whole settings category or to single ids of their category.
+ * A notification only reaches the observers of the category and the id which were
+ * notified. Registering and unregistering an observer doesn't depend on the number of
+ * other observers.
+ *
+ * Observers registered with NotifyCoalesced are notified in the next event loop turn,
+ * once for every id which was notified in the meantime. They need a running event loop.
+ */
+
+#include <QTimer>
 #include "settingsobserver.h"
 #include "observablesettings.h"
 
-QList<SettingsObserver*> ObservableSettings::m_settingsObserver;
+QHash<int, ObservableSettings::Observers> ObservableSettings::m_observers;
+QHash<SettingsObserver*, ObservableSettings::Subscription> ObservableSettings::m_subscriptions;
+QHash<SettingsObserver*, QSet<int> > ObservableSettings::m_pendingNotifications;
 
 using namespace Settings;
 
@@ -18,31 +34,118 @@ ObservableSettings::ObservableSettings(QObject *parent)
 {
 }
 
-void ObservableSettings::registerObserver(SettingsObserver *settingsObserver)
+/*!
+ * \brief ObservableSettings::registerObserver Registers settingsObserver for all ids of its
+ *        settings category.
+ */
+void ObservableSettings::registerObserver(SettingsObserver *settingsObserver, NotificationMode mode)
+{
+    registerObserver(settingsObserver, Id::None, mode);
+}
+
+/*!
+ * \brief ObservableSettings::registerObserver Registers settingsObserver only for id of its
+ *        settings category. Id::None registers it for all ids. An observer can be registered
+ *        for several ids.
+ */
+void ObservableSettings::registerObserver(SettingsObserver *settingsObserver, Id id, NotificationMode mode)
 {
     if (settingsObserver->settingCategory() == Category::NoCategory) {
         qWarning("Settings observer with not settings category can't be registered");
         return;
     }
 
-    m_settingsObserver.append(settingsObserver);
+    subscribe(settingsObserver, subscriptionKey(settingsObserver->settingCategory(), id), mode);
 }
 
 void ObservableSettings::unregisterObserver(SettingsObserver *settingsObserver)
 {
-    m_settingsObserver.removeAll(settingsObserver);
+    QHash<SettingsObserver*, Subscription>::iterator it = m_subscriptions.find(settingsObserver);
+    if (it == m_subscriptions.end())
+        return;
+
+    foreach (int key, it.value().keys) {
+        Observers &observers = m_observers[key];
+        observers.remove(settingsObserver);
+        if (observers.isEmpty())
+            m_observers.remove(key);
+    }
+
+    m_subscriptions.erase(it);
+    m_pendingNotifications.remove(settingsObserver);
 }
 
 void ObservableSettings::notify(Settings::Category category, Settings::Id id)
 {
-    foreach (SettingsObserver *settingsObserver, m_settingsObserver) {
-        if (settingsObserver->settingCategory() == category) {
+    notifyObservers(m_observers.value(subscriptionKey(category, Id::None)), id);
+    if (id != Id::None)
+        notifyObservers(m_observers.value(subscriptionKey(category, id)), id);
+}
+
+bool ObservableSettings::isObserverRegistered(SettingsObserver *settingsObserver)
+{
+    return m_subscriptions.contains(settingsObserver);
+}
+
+int ObservableSettings::subscriptionKey(Category category, Id id)
+{
+    return (static_cast<int>(category) << 16) | static_cast<int>(id);
+}
+
+void ObservableSettings::subscribe(SettingsObserver *settingsObserver, int key, NotificationMode mode)
+{
+    Subscription &subscription = m_subscriptions[settingsObserver];
+    subscription.keys.insert(key);
+    subscription.mode = mode;
+
+    m_observers[key].insert(settingsObserver);
+}
+
+/*!
+ * \brief ObservableSettings::notifyObservers Notifies the observers registered at the
+ *        time notify was called. Observers can be unregistered while they are notified.
+ */
+void ObservableSettings::notifyObservers(const Observers &observers, Settings::Id id)
+{
+    foreach (SettingsObserver *settingsObserver, observers) {
+        QHash<SettingsObserver*, Subscription>::const_iterator it = m_subscriptions.constFind(settingsObserver);
+        if (it == m_subscriptions.constEnd())
+            continue;
+
+        if (it.value().mode == NotifyImmediately) {
             settingsObserver->notify(id);
+            continue;
         }
+
+        if (m_pendingNotifications.isEmpty())
+            QTimer::singleShot(0, &ObservableSettings::deliverCoalescedNotifications);
+
+        m_pendingNotifications[settingsObserver].insert(static_cast<int>(id));
     }
 }
 
-bool ObservableSettings::isObserverRegistered(SettingsObserver *settingsObserver)
+/*!
+ * \brief ObservableSettings::deliverCoalescedNotifications Notifies all observers with pending
+ *        ids. Notifications which are caused by this are delivered in the next event loop turn.
+ */
+void ObservableSettings::deliverCoalescedNotifications()
+{
+    QHash<SettingsObserver*, QSet<int> > pendingNotifications(m_pendingNotifications);
+    m_pendingNotifications.clear();
+
+    QHash<SettingsObserver*, QSet<int> >::const_iterator it = pendingNotifications.constBegin();
+    for (; it != pendingNotifications.constEnd(); ++it) {
+        foreach (int id, it.value()) {
+            if (!isObserverRegistered(it.key()))
+                break;
+            it.key()->notify(static_cast<Settings::Id>(id));
+        }
+    }
+}
+
+void ObservableSettings::removeAllObservers()
 {
-    return m_settingsObserver.contains(settingsObserver);
+    m_observers.clear();
+    m_subscriptions.clear();
+    m_pendingNotifications.clear();
 }
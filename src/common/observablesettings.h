@@ -10,8 +10,8 @@
 #define OBSERVABLESETTINGS_H
 
 #include <QObject>
-#include <QList>
-#include <QPointer>
+#include <QHash>
+#include <QSet>
 #include "settingdefines.h"
 
 class SettingsObserver;
@@ -22,10 +22,16 @@ class ObservableSettings : public QObject
     friend class ObservableSettingsTest;
 
 public:
+    enum NotificationMode {
+        NotifyImmediately,  //!< The observer is notified within notify
+        NotifyCoalesced     //!< The observer is notified once per id in the next event loop turn
+    };
+
     explicit ObservableSettings(QObject *parent = 0);
     virtual ~ObservableSettings() {}
 
-    static void registerObserver(SettingsObserver *settingsObserver);
+    static void registerObserver(SettingsObserver *settingsObserver, NotificationMode mode = NotifyImmediately);
+    static void registerObserver(SettingsObserver *settingsObserver, Settings::Id id, NotificationMode mode = NotifyImmediately);
     static void unregisterObserver(SettingsObserver *settingsObserver);
     static bool isObserverRegistered(SettingsObserver *settingsObserver);
 
@@ -33,7 +39,25 @@ protected:
     static void notify(Settings::Category category, Settings::Id id);
 
 private:
-    static QList<SettingsObserver*> m_settingsObserver;
+    typedef QSet<SettingsObserver*> Observers;
+
+    struct Subscription {
+        Subscription()
+            : mode(NotifyImmediately) {}
+
+        QSet<int> keys;
+        NotificationMode mode;
+    };
+
+    static int subscriptionKey(Settings::Category category, Settings::Id id);
+    static void subscribe(SettingsObserver *settingsObserver, int key, NotificationMode mode);
+    static void notifyObservers(const Observers &observers, Settings::Id id);
+    static void deliverCoalescedNotifications();
+    static void removeAllObservers();
+
+    static QHash<int, Observers> m_observers;                   // Observers for every subscription key
+    static QHash<SettingsObserver*, Subscription> m_subscriptions;
+    static QHash<SettingsObserver*, QSet<int> > m_pendingNotifications;    // Coalesced ids per observer
 };
 
 #endif // OBSERVABLESETTINGS_H
@@ -0,0 +1,125 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+/*!
+ * @class AudioOutput
+ * @brief Pulls the samples of the sequencer into the default audio device.
+ *
+ * The audio output has to be moved into its own thread. The device pulls the samples in
+ * this thread, so a busy GUI thread doesn't interrupt the playback. The buffer of the device
+ * is kept short, which keeps the latency from starting to hearing the first note low.
+ */
+
+#include <QAudioOutput>
+#include <QAudioDeviceInfo>
+#include <QDebug>
+#include "sequencer.h"
+#include "audiooutput.h"
+
+namespace {
+
+const int BufferMilliseconds = 20;
+
+}
+
+SequencerDevice::SequencerDevice(Sequencer *sequencer, QObject *parent)
+    : QIODevice(parent),
+      m_sequencer(sequencer)
+{
+}
+
+bool SequencerDevice::isSequential() const
+{
+    return true;
+}
+
+qint64 SequencerDevice::bytesAvailable() const
+{
+    return m_sequencer->sampleRate() * sizeof(qint16) + QIODevice::bytesAvailable();
+}
+
+qint64 SequencerDevice::readData(char *data, qint64 maxlen)
+{
+    int frameCount = maxlen / sizeof(qint16);
+    m_sequencer->render(reinterpret_cast<qint16*>(data), frameCount);
+    return frameCount * sizeof(qint16);
+}
+
+qint64 SequencerDevice::writeData(const char *data, qint64 len)
+{
+    Q_UNUSED(data)
+    Q_UNUSED(len)
+    return -1;
+}
+
+AudioOutput::AudioOutput(Sequencer *sequencer, const QAudioFormat &format, QObject *parent)
+    : QObject(parent),
+      m_sequencer(sequencer),
+      m_format(format),
+      m_output(0),
+      m_device(0)
+{
+}
+
+/*!
+ * \brief AudioOutput::preferredFormat Returns mono 16 bit samples with the sample rate
+ *        of the default output device.
+ */
+QAudioFormat AudioOutput::preferredFormat()
+{
+    QAudioFormat format;
+    format.setSampleRate(44100);
+    format.setChannelCount(1);
+    format.setSampleSize(16);
+    format.setSampleType(QAudioFormat::SignedInt);
+    format.setByteOrder(QAudioFormat::LittleEndian);
+    format.setCodec(QStringLiteral("audio/pcm"));
+
+    QAudioDeviceInfo device = QAudioDeviceInfo::defaultOutputDevice();
+    if (!device.isFormatSupported(format))
+        format.setSampleRate(device.nearestFormat(format).sampleRate());
+
+    return format;
+}
+
+/*!
+ * \brief AudioOutput::open Opens the audio device and suspends it until playback starts.
+ *        Has to be called in the thread of the audio output.
+ */
+void AudioOutput::open()
+{
+    if (m_output)
+        return;
+
+    QAudioDeviceInfo device = QAudioDeviceInfo::defaultOutputDevice();
+    if (!device.isFormatSupported(m_format)) {
+        qWarning() << "AudioOutput: Audio format isn't supported by" << device.deviceName();
+        return;
+    }
+
+    m_device = new SequencerDevice(m_sequencer, this);
+    m_device->open(QIODevice::ReadOnly);
+
+    m_output = new QAudioOutput(device, m_format, this);
+    m_output->setBufferSize(m_format.bytesForDuration(BufferMilliseconds * 1000));
+    m_output->start(m_device);
+    m_output->suspend();
+}
+
+void AudioOutput::resume()
+{
+    open();
+    if (m_output)
+        m_output->resume();
+}
+
+void AudioOutput::suspend()
+{
+    if (m_output)
+        m_output->suspend();
+}
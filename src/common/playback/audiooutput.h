@@ -0,0 +1,59 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#ifndef AUDIOOUTPUT_H
+#define AUDIOOUTPUT_H
+
+#include <QObject>
+#include <QAudioFormat>
+#include <QIODevice>
+
+class QAudioOutput;
+class Sequencer;
+
+/*!
+ * \brief The SequencerDevice class is a sequential device, which reads the samples
+ *        rendered by the sequencer.
+ */
+class SequencerDevice : public QIODevice
+{
+public:
+    explicit SequencerDevice(Sequencer *sequencer, QObject *parent = 0);
+
+    bool isSequential() const;
+    qint64 bytesAvailable() const;
+
+protected:
+    qint64 readData(char *data, qint64 maxlen);
+    qint64 writeData(const char *data, qint64 len);
+
+private:
+    Sequencer *m_sequencer;
+};
+
+class AudioOutput : public QObject
+{
+    Q_OBJECT
+public:
+    explicit AudioOutput(Sequencer *sequencer, const QAudioFormat &format, QObject *parent = 0);
+
+    static QAudioFormat preferredFormat();
+
+public slots:
+    void open();
+    void resume();
+    void suspend();
+
+private:
+    Sequencer *m_sequencer;
+    QAudioFormat m_format;
+    QAudioOutput *m_output;
+    SequencerDevice *m_device;
+};
+
+#endif // AUDIOOUTPUT_H
@@ -0,0 +1,73 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#ifndef EVENTQUEUE_H
+#define EVENTQUEUE_H
+
+#include <QAtomicInteger>
+#include <QVector>
+
+/*!
+ * \brief The EventQueue class is a lock-free ring buffer for exactly one producer and one
+ *        consumer thread. Neither push nor pop allocate or block, so the consumer can be
+ *        a real-time audio thread. The capacity is rounded up to a power of two.
+ */
+template <typename T>
+class EventQueue
+{
+public:
+    explicit EventQueue(int capacity)
+        : m_head(0),
+          m_tail(0)
+    {
+        int size = 2;
+        while (size < capacity)
+            size *= 2;
+        m_items.resize(size);
+        m_mask = size - 1;
+    }
+
+    int capacity() const { return m_items.count(); }
+
+    int count() const { return int(m_tail.loadAcquire() - m_head.loadAcquire()); }
+
+    bool isEmpty() const { return count() == 0; }
+
+    //! Called only by the producer thread
+    bool tryPush(const T &item)
+    {
+        quint32 tail = m_tail.load();
+        if (tail - m_head.loadAcquire() == quint32(m_items.count()))
+            return false;
+
+        m_items[tail & m_mask] = item;
+        m_tail.storeRelease(tail + 1);
+        return true;
+    }
+
+    //! Called only by the consumer thread
+    bool tryPop(T *item)
+    {
+        quint32 head = m_head.load();
+        if (head == m_tail.loadAcquire())
+            return false;
+
+        *item = m_items.at(head & m_mask);
+        m_head.storeRelease(head + 1);
+        return true;
+    }
+
+private:
+    Q_DISABLE_COPY(EventQueue)
+    QVector<T> m_items;
+    quint32 m_mask;
+    QAtomicInteger<quint32> m_head;  // Next item to pop, written by the consumer
+    QAtomicInteger<quint32> m_tail;  // Next free slot, written by the producer
+};
+
+#endif // EVENTQUEUE_H
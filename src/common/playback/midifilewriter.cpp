@@ -0,0 +1,183 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+/*!
+ * @class MidiFileWriter
+ * @brief Writes a Timeline as Standard MIDI File of format 0 with one channel.
+ */
+
+#include <QByteArray>
+#include <QDebug>
+#include <QFile>
+#include <algorithm>
+#include <common/defines.h>
+#include "midifilewriter.h"
+
+namespace {
+
+const int MidiChannel = 0;
+
+struct MidiMessage {
+    quint32 tick;
+    quint8 status;
+    quint8 note;
+    quint8 velocity;
+};
+
+// Note offs are sorted before note ons at the same tick
+bool midiMessageLessThan(const MidiMessage &first, const MidiMessage &second)
+{
+    if (first.tick != second.tick)
+        return first.tick < second.tick;
+    return first.status < second.status;
+}
+
+void appendVariableLength(QByteArray *data, quint32 value)
+{
+    quint8 bytes[5];
+    int count = 0;
+    do {
+        bytes[count++] = value & 0x7F;
+        value >>= 7;
+    } while (value);
+
+    while (count > 1) {
+        data->append(static_cast<char>(bytes[--count] | 0x80));
+    }
+    data->append(static_cast<char>(bytes[0]));
+}
+
+void appendBigEndian(QByteArray *data, quint32 value, int byteCount)
+{
+    for (int i = byteCount - 1; i >= 0; --i) {
+        data->append(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+}
+
+MidiFileWriter::MidiFileWriter()
+    : m_tempo(80),
+      m_program(0)
+{
+}
+
+int MidiFileWriter::tempo() const
+{
+    return m_tempo;
+}
+
+/*!
+ * \brief MidiFileWriter::setTempo Sets the tempo in quarter notes per minute.
+ */
+void MidiFileWriter::setTempo(int beatsPerMinute)
+{
+    if (beatsPerMinute <= 0) {
+        qWarning() << "MidiFileWriter: Tempo has to be greater than zero";
+        return;
+    }
+    m_tempo = beatsPerMinute;
+}
+
+int MidiFileWriter::program() const
+{
+    return m_program;
+}
+
+/*!
+ * \brief MidiFileWriter::setProgram Sets the General MIDI program number, starting at 0.
+ */
+void MidiFileWriter::setProgram(int program)
+{
+    m_program = qBound(0, program, 127);
+}
+
+bool MidiFileWriter::write(const Timeline &timeline, QIODevice *device) const
+{
+    if (!device || !device->isWritable()) {
+        qWarning() << "MidiFileWriter: Can't write MIDI file, device isn't writable";
+        return false;
+    }
+
+    QVector<MidiMessage> messages;
+    messages.reserve(timeline.events.count() * 2);
+    foreach (const NoteEvent &event, timeline.events) {
+        MidiMessage noteOn = { event.start, static_cast<quint8>(0x90 | MidiChannel),
+                               event.note, event.velocity };
+        MidiMessage noteOff = { event.start + event.duration, static_cast<quint8>(0x80 | MidiChannel),
+                                event.note, 0 };
+        messages << noteOn << noteOff;
+    }
+    std::stable_sort(messages.begin(), messages.end(), midiMessageLessThan);
+
+    QByteArray track;
+    // Tempo in microseconds per quarter note
+    appendVariableLength(&track, 0);
+    track.append("\xFF\x51\x03", 3);
+    appendBigEndian(&track, 60000000 / m_tempo, 3);
+
+    appendVariableLength(&track, 0);
+    track.append(static_cast<char>(0xC0 | MidiChannel));
+    track.append(static_cast<char>(m_program));
+
+    quint32 lastTick = 0;
+    foreach (const MidiMessage &message, messages) {
+        appendVariableLength(&track, message.tick - lastTick);
+        track.append(static_cast<char>(message.status));
+        track.append(static_cast<char>(message.note));
+        track.append(static_cast<char>(message.velocity));
+        lastTick = message.tick;
+    }
+
+    appendVariableLength(&track, qMax(timeline.length, lastTick) - lastTick);
+    track.append("\xFF\x2F\x00", 3);
+
+    QByteArray file("MThd");
+    appendBigEndian(&file, 6, 4);
+    appendBigEndian(&file, 0, 2);       // Format 0
+    appendBigEndian(&file, 1, 2);       // One track
+    appendBigEndian(&file, Playback::TicksPerQuarter, 2);
+    file.append("MTrk");
+    appendBigEndian(&file, track.size(), 4);
+    file.append(track);
+
+    return device->write(file) == file.size();
+}
+
+bool MidiFileWriter::save(const Timeline &timeline, const QString &filename) const
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "MidiFileWriter: Can't open MIDI file " << filename;
+        return false;
+    }
+
+    return write(timeline, &file);
+}
+
+/*!
+ * \brief MidiFileWriter::programForInstrument Returns the General MIDI program of the
+ *        instrument, starting at 0.
+ */
+int MidiFileWriter::programForInstrument(int instrumentType)
+{
+    switch (instrumentType) {
+    case LP::GreatHighlandBagpipe:
+        return 109;     // Bag pipe
+    case LP::TinWhistle:
+        return 72;      // Piccolo
+    case LP::ScottishSideDrum:
+    case LP::BassDrum:
+    case LP::TenorDrum:
+        return 116;     // Taiko drum
+    case LP::Vocals:
+        return 52;      // Choir aahs
+    default:
+        return 0;
+    }
+}
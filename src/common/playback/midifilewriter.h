@@ -0,0 +1,38 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#ifndef MIDIFILEWRITER_H
+#define MIDIFILEWRITER_H
+
+#include <QString>
+#include "timelinetypes.h"
+
+class QIODevice;
+
+class MidiFileWriter
+{
+public:
+    MidiFileWriter();
+
+    int tempo() const;
+    void setTempo(int beatsPerMinute);
+
+    int program() const;
+    void setProgram(int program);
+
+    bool write(const Timeline &timeline, QIODevice *device) const;
+    bool save(const Timeline &timeline, const QString &filename) const;
+
+    static int programForInstrument(int instrumentType);
+
+private:
+    int m_tempo;
+    int m_program;
+};
+
+#endif // MIDIFILEWRITER_H
@@ -0,0 +1,443 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+/*!
+ * @class OfflineRenderer
+ * @brief Renders timelines into samples with the sound of the Synthesizer.
+ *
+ * The samples are split into chunks, which are rendered in parallel. Every sample is
+ * computed from its absolute frame and the voices of the timeline only, so the result
+ * doesn't depend on the chunk size or the number of threads. A long tune is rendered by
+ * all cores as well as a score with many short tunes.
+ *
+ * With SSE2 the oscillators compute the envelopes of four frames at once and mix them into
+ * the block. Only the wave table lookups are scalar, as SSE2 has no gather. The conversion
+ * into 16 bit samples uses SSE2 as well. The scalar loops for the remaining frames do the
+ * same operations, so the samples don't depend on the alignment of the voices.
+ */
+
+#include <QAbstractItemModel>
+#include <QDebug>
+#include <QDir>
+#include <QtConcurrent>
+#include <QtMath>
+#include <algorithm>
+#include <cmath>
+#include <common/defines.h>
+#include <common/itemdataroles.h>
+#include <utilities/tracer.h>
+#include "synthesizer.h"
+#include "timelinecompiler.h"
+#include "wavfilewriter.h"
+#include "offlinerenderer.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+const int BlockFrames = 256;
+const int PhaseShift = 32 - Synthesizer::WaveTableBits;
+
+/*
+ * Adds an oscillator with attack and release to the buffer. time is the frame of the first
+ * sample from the start of the attack and releaseTime from the start of the release.
+ */
+void addOscillator(const float *wave, quint32 firstPhase, quint32 increment, int time,
+                   int releaseTime, float attackStep, float releaseStep, float level,
+                   int frameCount, float *buffer)
+{
+    int i = 0;
+#ifdef __SSE2__
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 attackSteps = _mm_set1_ps(attackStep);
+    const __m128 releaseSteps = _mm_set1_ps(releaseStep);
+    const __m128 levels = _mm_set1_ps(level);
+    const __m128i times = _mm_add_epi32(_mm_set1_epi32(time), _mm_set_epi32(3, 2, 1, 0));
+    const __m128i releaseTimes = _mm_add_epi32(_mm_set1_epi32(releaseTime), _mm_set_epi32(3, 2, 1, 0));
+    const __m128i phaseStep = _mm_set1_epi32(static_cast<int>(4 * increment));
+    __m128i phases = _mm_set_epi32(static_cast<int>(firstPhase + 3 * increment),
+                                   static_cast<int>(firstPhase + 2 * increment),
+                                   static_cast<int>(firstPhase + increment),
+                                   static_cast<int>(firstPhase));
+    quint32 indexes[4];
+    for (; i + 4 <= frameCount; i += 4) {
+        __m128i frames = _mm_set1_epi32(i);
+        __m128 frameTimes = _mm_cvtepi32_ps(_mm_add_epi32(times, frames));
+        __m128 frameReleaseTimes = _mm_cvtepi32_ps(_mm_add_epi32(releaseTimes, frames));
+        __m128 attack = _mm_min_ps(one, _mm_mul_ps(_mm_add_ps(frameTimes, one), attackSteps));
+        __m128 release = _mm_max_ps(zero, _mm_min_ps(one, _mm_sub_ps(one, _mm_mul_ps(frameReleaseTimes,
+                                                                                    releaseSteps))));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(indexes), _mm_srli_epi32(phases, PhaseShift));
+        __m128 samples = _mm_set_ps(wave[indexes[3]], wave[indexes[2]], wave[indexes[1]], wave[indexes[0]]);
+        __m128 mixed = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(samples, attack), release), levels);
+        _mm_storeu_ps(buffer + i, _mm_add_ps(_mm_loadu_ps(buffer + i), mixed));
+        phases = _mm_add_epi32(phases, phaseStep);
+    }
+#endif
+    for (; i < frameCount; ++i) {
+        float attack = qMin(1.0f, (static_cast<float>(time + i) + 1) * attackStep);
+        float release = qBound(0.0f, 1.0f - static_cast<float>(releaseTime + i) * releaseStep, 1.0f);
+        quint32 phase = firstPhase + increment * static_cast<quint32>(i);
+        buffer[i] += wave[phase >> PhaseShift] * attack * release * level;
+    }
+}
+
+}
+
+OfflineRenderer::OfflineRenderer()
+    : m_sampleRate(44100),
+      m_tempo(80),
+      m_dronesEnabled(true),
+      m_droneNote(57),
+      m_chunkFrames(5 * 44100)
+{
+}
+
+int OfflineRenderer::sampleRate() const
+{
+    return m_sampleRate;
+}
+
+void OfflineRenderer::setSampleRate(int sampleRate)
+{
+    if (sampleRate <= 0) {
+        qWarning() << "OfflineRenderer: Sample rate has to be greater than zero";
+        return;
+    }
+    m_sampleRate = sampleRate;
+}
+
+int OfflineRenderer::tempo() const
+{
+    return m_tempo;
+}
+
+/*!
+ * \brief OfflineRenderer::setTempo Sets the tempo in quarter notes per minute.
+ */
+void OfflineRenderer::setTempo(int beatsPerMinute)
+{
+    if (beatsPerMinute <= 0) {
+        qWarning() << "OfflineRenderer: Tempo has to be greater than zero";
+        return;
+    }
+    m_tempo = beatsPerMinute;
+}
+
+bool OfflineRenderer::dronesEnabled() const
+{
+    return m_dronesEnabled;
+}
+
+void OfflineRenderer::setDronesEnabled(bool enabled)
+{
+    m_dronesEnabled = enabled;
+}
+
+int OfflineRenderer::droneNote() const
+{
+    return m_droneNote;
+}
+
+void OfflineRenderer::setDroneNote(int note)
+{
+    m_droneNote = note;
+}
+
+int OfflineRenderer::chunkFrames() const
+{
+    return m_chunkFrames;
+}
+
+/*!
+ * \brief OfflineRenderer::setChunkFrames Sets the number of frames, which are rendered
+ *        by one task.
+ */
+void OfflineRenderer::setChunkFrames(int frames)
+{
+    m_chunkFrames = qMax(BlockFrames, frames);
+}
+
+/*!
+ * \brief OfflineRenderer::setPluginManager Sets the plugin manager, which expands the
+ *        embellishments of the rendered scores.
+ */
+void OfflineRenderer::setPluginManager(const PluginManager &pluginManager)
+{
+    m_pluginManager = pluginManager;
+}
+
+/*!
+ * \brief OfflineRenderer::render Returns the mono samples of the timeline including the
+ *        release of the last note. If the drones are enabled, they sound over the whole timeline.
+ */
+QVector<qint16> OfflineRenderer::render(const Timeline &timeline) const
+{
+    QVector<DroneSpan> droneSpans;
+    if (m_dronesEnabled) {
+        DroneSpan span;
+        span.start = 0;
+        span.end = timeline.length;
+        droneSpans << span;
+    }
+    return render(timeline, droneSpans);
+}
+
+/*!
+ * \brief OfflineRenderer::render Returns the mono samples of the timeline with drones in the
+ *        spans, which are sorted and don't overlap. Adjacent spans sound without a new attack.
+ */
+QVector<qint16> OfflineRenderer::render(const Timeline &timeline, const QVector<DroneSpan> &droneSpans) const
+{
+    LP_TRACE_SCOPE("OfflineRenderer::render");
+
+    RenderContext context;
+    context.voices = voicesForTimeline(timeline);
+    foreach (const DroneSpan &span, droneSpans) {
+        if (span.end <= span.start)
+            continue;
+
+        if (!context.drones.isEmpty() && context.drones.last().end == frameForTick(span.start)) {
+            context.drones.last().end = frameForTick(span.end);
+            continue;
+        }
+
+        DroneFrames drones;
+        drones.start = frameForTick(span.start);
+        drones.end = frameForTick(span.end);
+        context.drones << drones;
+    }
+    context.droneIncrements[0] = Synthesizer::phaseIncrement(Synthesizer::frequency(m_droneNote - 12),
+                                                             m_sampleRate);
+    context.droneIncrements[1] = Synthesizer::phaseIncrement(Synthesizer::frequency(m_droneNote) *
+                                                             (1 - Synthesizer::TenorDroneDetune),
+                                                             m_sampleRate);
+    context.droneIncrements[2] = Synthesizer::phaseIncrement(Synthesizer::frequency(m_droneNote) *
+                                                             (1 + Synthesizer::TenorDroneDetune),
+                                                             m_sampleRate);
+    context.chanterWave = Synthesizer::chanterWaveTable();
+    context.droneWave = Synthesizer::droneWaveTable();
+
+    qint64 frameCount = frameForTick(timeline.length);
+    if (!context.voices.isEmpty())
+        frameCount = qMax(frameCount, context.voices.last().end);
+    if (!context.drones.isEmpty())
+        frameCount = qMax(frameCount, context.drones.last().end +
+                          qCeil(Synthesizer::DroneReleaseTime * m_sampleRate));
+
+    QVector<qint16> samples(frameCount);
+    context.samples = samples.data();
+
+    QVector<Chunk> chunks;
+    for (qint64 first = 0; first < frameCount; first += m_chunkFrames) {
+        Chunk chunk;
+        chunk.firstFrame = first;
+        chunk.frameCount = static_cast<int>(qMin<qint64>(m_chunkFrames, frameCount - first));
+        chunks << chunk;
+    }
+
+    QtConcurrent::blockingMap(chunks, [this, &context] (const Chunk &chunk) {
+        renderChunk(context, chunk);
+    });
+
+    return samples;
+}
+
+/*!
+ * \brief OfflineRenderer::renderScores Writes every score of the model into the WAV file
+ *        baseName-n.wav, where n is the number of the score. The drones sound during the
+ *        tunes of the Great Highland Bagpipe only.
+ * \return The number of written files
+ */
+int OfflineRenderer::renderScores(QAbstractItemModel *model, const QString &outputDir,
+                                  const QString &baseName) const
+{
+    LP_TRACE_SCOPE("OfflineRenderer::renderScores");
+
+    if (!model)
+        return 0;
+
+    QDir dir(outputDir);
+    if (!dir.exists() && !dir.mkpath(".")) {
+        qWarning() << "OfflineRenderer: Can't create output directory " << outputDir;
+        return 0;
+    }
+
+    TimelineCompiler compiler;
+    compiler.setModel(model);
+    compiler.setPluginManager(m_pluginManager);
+    WavFileWriter writer;
+    writer.setSampleRate(m_sampleRate);
+
+    int writtenFiles = 0;
+    for (int row = 0; row < model->rowCount(); ++row) {
+        QModelIndex score = model->index(row, 0);
+
+        // The tunes follow each other in the timeline of the score
+        QVector<DroneSpan> droneSpans;
+        quint32 tuneStart = 0;
+        for (int tuneRow = 0; tuneRow < model->rowCount(score); ++tuneRow) {
+            QModelIndex tune = model->index(tuneRow, 0, score);
+            DroneSpan span;
+            span.start = tuneStart;
+            span.end = tuneStart + compiler.timeline(tune).length;
+            if (m_dronesEnabled &&
+                    tune.data(LP::TuneInstrument).toInt() == LP::GreatHighlandBagpipe)
+                droneSpans << span;
+            tuneStart = span.end;
+        }
+
+        QVector<qint16> samples = render(compiler.timeline(score), droneSpans);
+        QString filename = dir.filePath(QString("%1-%2.wav").arg(baseName).arg(row + 1));
+        if (writer.save(samples, filename))
+            writtenFiles++;
+    }
+    return writtenFiles;
+}
+
+/*!
+ * \brief OfflineRenderer::convertSamples Converts samples between -1 and 1 into 16 bit
+ *        samples. Samples outside are clipped.
+ */
+void OfflineRenderer::convertSamples(const float *source, qint16 *target, int count)
+{
+    int i = 0;
+#ifdef __SSE2__
+    const __m128 scale = _mm_set1_ps(32767.0f);
+    const __m128 minimum = _mm_set1_ps(-1.0f);
+    const __m128 maximum = _mm_set1_ps(1.0f);
+    for (; i + 8 <= count; i += 8) {
+        __m128 low = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(source + i), minimum), maximum);
+        __m128 high = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(source + i + 4), minimum), maximum);
+        __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(_mm_mul_ps(low, scale)),
+                                         _mm_cvtps_epi32(_mm_mul_ps(high, scale)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(target + i), packed);
+    }
+#endif
+    // Rounds to nearest even like the SSE2 conversion
+    for (; i < count; ++i) {
+        target[i] = static_cast<qint16>(std::lrint(qBound(-1.0f, source[i], 1.0f) * 32767.0f));
+    }
+}
+
+qint64 OfflineRenderer::frameForTick(quint32 tick) const
+{
+    return static_cast<qint64>(tick) * 60 * m_sampleRate / (m_tempo * Playback::TicksPerQuarter);
+}
+
+/*!
+ * \brief OfflineRenderer::voicesForTimeline Returns the voices of the monophonic chanter.
+ *        Every voice ends with its release or the start of the next voice.
+ */
+QVector<OfflineRenderer::Voice> OfflineRenderer::voicesForTimeline(const Timeline &timeline) const
+{
+    qint64 releaseFrames = qCeil(Synthesizer::ChanterReleaseTime * m_sampleRate);
+
+    QVector<Voice> voices;
+    voices.reserve(timeline.events.count());
+    foreach (const NoteEvent &event, timeline.events) {
+        Voice voice;
+        voice.start = frameForTick(event.start);
+        voice.noteOff = frameForTick(event.start + event.duration);
+        voice.end = voice.noteOff + releaseFrames;
+        voice.increment = Synthesizer::phaseIncrement(Synthesizer::frequency(event.note), m_sampleRate);
+        voice.level = Synthesizer::ChanterGain * qMin<int>(event.velocity, 127) / 127.0f;
+        voice.legato = false;
+
+        if (!voices.isEmpty()) {
+            Voice &previous = voices.last();
+            voice.legato = previous.noteOff >= voice.start;
+            previous.end = qMin(previous.end, voice.start);
+        }
+        voices << voice;
+    }
+    return voices;
+}
+
+void OfflineRenderer::renderChunk(const OfflineRenderer::RenderContext &context,
+                                  const OfflineRenderer::Chunk &chunk) const
+{
+    float buffer[BlockFrames];
+    qint64 chunkEnd = chunk.firstFrame + chunk.frameCount;
+
+    // The ends of the voices are sorted, because every voice ends before the next starts
+    QVector<Voice>::const_iterator voice =
+            std::upper_bound(context.voices.constBegin(), context.voices.constEnd(), chunk.firstFrame,
+                             [] (qint64 frame, const Voice &voice) { return frame < voice.end; });
+
+    for (qint64 blockStart = chunk.firstFrame; blockStart < chunkEnd; blockStart += BlockFrames) {
+        int blockFrames = static_cast<int>(qMin<qint64>(BlockFrames, chunkEnd - blockStart));
+        qint64 blockEnd = blockStart + blockFrames;
+        std::fill(buffer, buffer + blockFrames, 0.0f);
+
+        while (voice != context.voices.constEnd() && voice->end <= blockStart) {
+            ++voice;
+        }
+        for (QVector<Voice>::const_iterator it = voice;
+             it != context.voices.constEnd() && it->start < blockEnd; ++it) {
+            qint64 first = qMax(it->start, blockStart);
+            qint64 last = qMin(it->end, blockEnd);
+            if (first < last)
+                renderVoice(context, *it, first, static_cast<int>(last - first), buffer + (first - blockStart));
+        }
+
+        if (!context.drones.isEmpty())
+            renderDrones(context, blockStart, blockFrames, buffer);
+
+        convertSamples(buffer, context.samples + blockStart, blockFrames);
+    }
+}
+
+void OfflineRenderer::renderVoice(const OfflineRenderer::RenderContext &context,
+                                  const OfflineRenderer::Voice &voice,
+                                  qint64 firstFrame, int frameCount, float *buffer) const
+{
+    const float attackStep = voice.legato ? 1.0f : 1.0f / (Synthesizer::ChanterAttackTime * m_sampleRate);
+    const float releaseStep = 1.0f / (Synthesizer::ChanterReleaseTime * m_sampleRate);
+    const qint64 offset = firstFrame - voice.start;
+    const quint32 firstPhase = static_cast<quint32>(voice.increment * static_cast<quint64>(offset));
+
+    addOscillator(context.chanterWave.constData(), firstPhase, voice.increment,
+                  static_cast<int>(offset), static_cast<int>(firstFrame - voice.noteOff),
+                  attackStep, releaseStep, voice.level, frameCount, buffer);
+}
+
+void OfflineRenderer::renderDrones(const OfflineRenderer::RenderContext &context,
+                                   qint64 firstFrame, int frameCount, float *buffer) const
+{
+    const qint64 releaseFrames = qCeil(Synthesizer::DroneReleaseTime * m_sampleRate);
+    foreach (const DroneFrames &drones, context.drones) {
+        qint64 first = qMax(firstFrame, drones.start);
+        qint64 last = qMin(firstFrame + frameCount, drones.end + releaseFrames);
+        if (first < last)
+            renderDroneSpan(context, drones, first, static_cast<int>(last - first), buffer + (first - firstFrame));
+    }
+}
+
+void OfflineRenderer::renderDroneSpan(const OfflineRenderer::RenderContext &context,
+                                      const OfflineRenderer::DroneFrames &drones,
+                                      qint64 firstFrame, int frameCount, float *buffer) const
+{
+    const float attackStep = 1.0f / (Synthesizer::DroneAttackTime * m_sampleRate);
+    const float releaseStep = 1.0f / (Synthesizer::DroneReleaseTime * m_sampleRate);
+    const float gains[3] = { Synthesizer::BassDroneGain,
+                             Synthesizer::TenorDroneGain,
+                             Synthesizer::TenorDroneGain };
+
+    for (int drone = 0; drone < 3; ++drone) {
+        const quint32 increment = context.droneIncrements[drone];
+        const quint32 firstPhase = static_cast<quint32>(increment * static_cast<quint64>(firstFrame));
+        addOscillator(context.droneWave.constData(), firstPhase, increment,
+                      static_cast<int>(firstFrame - drones.start), static_cast<int>(firstFrame - drones.end),
+                      attackStep, releaseStep, gains[drone], frameCount, buffer);
+    }
+}
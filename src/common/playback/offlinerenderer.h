@@ -0,0 +1,100 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#ifndef OFFLINERENDERER_H
+#define OFFLINERENDERER_H
+
+#include <QString>
+#include <QVector>
+#include <common/pluginmanagerinterface.h>
+#include "timelinetypes.h"
+
+class QAbstractItemModel;
+
+class OfflineRenderer
+{
+public:
+    /*!
+     * \brief The DroneSpan struct is a range of ticks, in which the drones sound.
+     */
+    struct DroneSpan {
+        quint32 start;
+        quint32 end;
+    };
+
+    OfflineRenderer();
+
+    int sampleRate() const;
+    void setSampleRate(int sampleRate);
+
+    int tempo() const;
+    void setTempo(int beatsPerMinute);
+
+    bool dronesEnabled() const;
+    void setDronesEnabled(bool enabled);
+
+    int droneNote() const;
+    void setDroneNote(int note);
+
+    int chunkFrames() const;
+    void setChunkFrames(int frames);
+
+    void setPluginManager(const PluginManager &pluginManager);
+
+    QVector<qint16> render(const Timeline &timeline) const;
+    QVector<qint16> render(const Timeline &timeline, const QVector<DroneSpan> &droneSpans) const;
+    int renderScores(QAbstractItemModel *model, const QString &outputDir, const QString &baseName) const;
+
+    static void convertSamples(const float *source, qint16 *target, int count);
+
+private:
+    struct Voice {
+        qint64 start;
+        qint64 noteOff;
+        qint64 end;         // End of the release or start of the next voice
+        quint32 increment;
+        float level;
+        bool legato;        // Starts without attack, because the previous voice still sounds
+    };
+
+    struct Chunk {
+        qint64 firstFrame;
+        int frameCount;
+    };
+
+    struct DroneFrames {
+        qint64 start;
+        qint64 end;         // Start of the release
+    };
+
+    struct RenderContext {
+        QVector<Voice> voices;
+        QVector<DroneFrames> drones;
+        quint32 droneIncrements[3];
+        QVector<float> chanterWave;
+        QVector<float> droneWave;
+        qint16 *samples;
+    };
+
+    qint64 frameForTick(quint32 tick) const;
+    QVector<Voice> voicesForTimeline(const Timeline &timeline) const;
+    void renderChunk(const RenderContext &context, const Chunk &chunk) const;
+    void renderVoice(const RenderContext &context, const Voice &voice,
+                     qint64 firstFrame, int frameCount, float *buffer) const;
+    void renderDrones(const RenderContext &context, qint64 firstFrame, int frameCount, float *buffer) const;
+    void renderDroneSpan(const RenderContext &context, const DroneFrames &drones,
+                         qint64 firstFrame, int frameCount, float *buffer) const;
+    int m_sampleRate;
+    int m_tempo;
+    bool m_dronesEnabled;
+    int m_droneNote;
+    int m_chunkFrames;
+    PluginManager m_pluginManager;
+};
+
+#endif // OFFLINERENDERER_H
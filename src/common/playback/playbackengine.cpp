@@ -0,0 +1,348 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+/*!
+ * @class PlaybackEngine
+ * @brief Plays tunes in real time and reports the sounding symbol.
+ *
+ * The sequencer renders in the audio thread of the AudioOutput. The engine feeds it from
+ * the GUI thread through the lock-free queue of the sequencer and never waits for the
+ * audio thread. Only the first tune is compiled before playing starts, all following tunes
+ * are compiled, when the queue needs more events. This keeps the latency from play to the
+ * first note independent of the size of the document.
+ *
+ * The symbols of the events aren't persistent indexes. Therefore, playing stops as soon as
+ * rows of the model are inserted or removed.
+ */
+
+#include <QThread>
+#include <QAbstractItemModel>
+#include <common/defines.h>
+#include <common/itemdataroles.h>
+#include <utilities/tracer.h>
+#include "audiooutput.h"
+#include "sequencer.h"
+#include "timelinecompiler.h"
+#include "playbackengine.h"
+
+namespace {
+
+const int UpdateInterval = 15;
+const int ReleaseMilliseconds = 250;
+
+LP::ItemType itemType(const QModelIndex &index)
+{
+    if (!index.isValid())
+        return LP::ItemType::RootItemType;
+
+    return static_cast<LP::ItemType>(index.data(LP::MusicItemType).toInt());
+}
+
+bool isInside(const QModelIndex &symbol, const QModelIndex &ancestor)
+{
+    QModelIndex index = symbol;
+    while (index.isValid()) {
+        if (index == ancestor)
+            return true;
+        index = index.parent();
+    }
+    return false;
+}
+
+}
+
+PlaybackEngine::PlaybackEngine(QObject *parent)
+    : QObject(parent),
+      m_compiler(0),
+      m_sequencer(0),
+      m_audioOutput(0),
+      m_audioThread(0),
+      m_playing(false),
+      m_dronesEnabled(true),
+      m_generation(0),
+      m_startQueued(false),
+      m_endQueued(false),
+      m_startTick(0),
+      m_nextEvent(0),
+      m_tickOffset(0),
+      m_currentEvent(-1)
+{
+    QAudioFormat format = AudioOutput::preferredFormat();
+    m_sequencer = new Sequencer(format.sampleRate());
+
+    m_audioThread = new QThread(this);
+    m_audioOutput = new AudioOutput(m_sequencer, format);
+    m_audioOutput->moveToThread(m_audioThread);
+    connect(m_audioThread, &QThread::finished,
+            m_audioOutput, &QObject::deleteLater);
+    m_audioThread->start(QThread::TimeCriticalPriority);
+
+    // Opening the device takes longer than playing the first note
+    QMetaObject::invokeMethod(m_audioOutput, "open", Qt::QueuedConnection);
+
+    m_updateTimer.setInterval(UpdateInterval);
+    connect(&m_updateTimer, &QTimer::timeout,
+            this, &PlaybackEngine::update);
+}
+
+PlaybackEngine::~PlaybackEngine()
+{
+    m_audioThread->quit();
+    m_audioThread->wait();
+    delete m_sequencer;
+}
+
+/*!
+ * \brief PlaybackEngine::setTimelineCompiler Sets the compiler of the played timelines.
+ *        Playing stops, if rows of the model of the compiler are inserted or removed.
+ */
+void PlaybackEngine::setTimelineCompiler(TimelineCompiler *compiler)
+{
+    stop();
+    if (m_compiler && m_compiler->model())
+        m_compiler->model()->disconnect(this);
+
+    m_compiler = compiler;
+    if (!m_compiler || !m_compiler->model())
+        return;
+
+    QAbstractItemModel *model = m_compiler->model();
+    connect(model, &QAbstractItemModel::rowsAboutToBeInserted,
+            this, &PlaybackEngine::stop);
+    connect(model, &QAbstractItemModel::rowsAboutToBeRemoved,
+            this, &PlaybackEngine::stop);
+    connect(model, &QAbstractItemModel::modelAboutToBeReset,
+            this, &PlaybackEngine::stop);
+}
+
+TimelineCompiler *PlaybackEngine::timelineCompiler() const
+{
+    return m_compiler;
+}
+
+int PlaybackEngine::tempo() const
+{
+    return m_sequencer->tempo();
+}
+
+/*!
+ * \brief PlaybackEngine::setTempo Sets the tempo in quarter notes per minute. It can be
+ *        changed while playing.
+ */
+void PlaybackEngine::setTempo(int beatsPerMinute)
+{
+    m_sequencer->setTempo(beatsPerMinute);
+}
+
+bool PlaybackEngine::dronesEnabled() const
+{
+    return m_dronesEnabled;
+}
+
+/*!
+ * \brief PlaybackEngine::setDronesEnabled Sets, if the drones sound while playing
+ *        tunes of the Great Highland Bagpipe.
+ */
+void PlaybackEngine::setDronesEnabled(bool enabled)
+{
+    m_dronesEnabled = enabled;
+}
+
+bool PlaybackEngine::isPlaying() const
+{
+    return m_playing;
+}
+
+/*!
+ * \brief PlaybackEngine::play Plays from the index to the end of the document. For a symbol,
+ *        measure or part, playing starts with its first note, for a score or tune with
+ *        the first note of the tune. An invalid index plays the whole document.
+ */
+void PlaybackEngine::play(const QModelIndex &index)
+{
+    LP_TRACE_SCOPE("PlaybackEngine::play");
+
+    stop();
+    if (!m_compiler || !m_compiler->model())
+        return;
+
+    m_pendingTunes = tunesFrom(index);
+    if (m_pendingTunes.isEmpty())
+        return;
+
+    int instrumentType = m_pendingTunes.first().data(LP::TuneInstrument).toInt();
+    m_sequencer->setDronesEnabled(m_dronesEnabled && instrumentType == LP::GreatHighlandBagpipe);
+
+    m_generation = m_sequencer->restart();
+    m_startQueued = false;
+    m_endQueued = false;
+    m_startTick = 0;
+    m_tickOffset = 0;
+    m_timeline = Timeline();
+    m_symbols.clear();
+    m_currentEvent = -1;
+    loadNextTune();
+
+    if (itemType(index) != LP::ItemType::TuneType && itemType(index) != LP::ItemType::ScoreType) {
+        for (int i = 0; i < m_timeline.symbols.count(); ++i) {
+            if (isInside(m_timeline.symbols.at(i), index)) {
+                m_nextEvent = i;
+                m_startTick = m_timeline.events.at(i).start;
+                break;
+            }
+        }
+    }
+
+    m_playing = true;
+    refillQueue();
+    QMetaObject::invokeMethod(m_audioOutput, "resume", Qt::QueuedConnection);
+    m_updateTimer.start();
+    emit playingChanged(true);
+}
+
+void PlaybackEngine::stop()
+{
+    if (!m_playing)
+        return;
+
+    m_sequencer->restart();
+    finishPlaying();
+}
+
+void PlaybackEngine::update()
+{
+    refillQueue();
+
+    int current = m_sequencer->currentEvent();
+    if (current != m_currentEvent) {
+        m_currentEvent = current;
+        if (current >= 0 && current < m_symbols.count())
+            emit currentSymbolChanged(m_symbols.at(current));
+    }
+
+    if (m_sequencer->isFinished(m_generation))
+        finishPlaying();
+}
+
+/*!
+ * \brief PlaybackEngine::tunesFrom Returns the tune of the index and all tunes after it.
+ */
+QList<QPersistentModelIndex> PlaybackEngine::tunesFrom(const QModelIndex &index) const
+{
+    QAbstractItemModel *model = m_compiler->model();
+
+    QModelIndex startTune = index;
+    while (startTune.isValid() && itemType(startTune) != LP::ItemType::TuneType) {
+        startTune = startTune.parent();
+    }
+
+    QModelIndex startScore = startTune.isValid() ? startTune.parent() : index;
+    bool collecting = !startTune.isValid();
+
+    QList<QPersistentModelIndex> tunes;
+    for (int scoreRow = qMax(0, startScore.row()); scoreRow < model->rowCount(); ++scoreRow) {
+        QModelIndex score = model->index(scoreRow, 0);
+        for (int tuneRow = 0; tuneRow < model->rowCount(score); ++tuneRow) {
+            QModelIndex tune = model->index(tuneRow, 0, score);
+            if (tune == startTune)
+                collecting = true;
+            if (collecting)
+                tunes << tune;
+        }
+    }
+    return tunes;
+}
+
+/*!
+ * \brief PlaybackEngine::loadNextTune Compiles the next pending tune, which starts
+ *        at the end of the current one.
+ */
+bool PlaybackEngine::loadNextTune()
+{
+    m_tickOffset += m_timeline.length;
+    m_timeline = Timeline();
+    m_nextEvent = 0;
+
+    while (!m_pendingTunes.isEmpty()) {
+        QPersistentModelIndex tune = m_pendingTunes.takeFirst();
+        if (!tune.isValid())
+            continue;
+
+        m_timeline = m_compiler->timeline(tune);
+        m_symbols << m_timeline.symbols;
+        return true;
+    }
+    return false;
+}
+
+/*!
+ * \brief PlaybackEngine::refillQueue Queues events, until the queue of the sequencer is full.
+ *        At most one more tune is compiled per call.
+ */
+void PlaybackEngine::refillQueue()
+{
+    if (!m_playing)
+        return;
+
+    SequencerEvent event;
+    event.generation = m_generation;
+
+    if (!m_startQueued) {
+        event.type = SequencerEvent::Start;
+        event.note.start = m_startTick;
+        if (!m_sequencer->enqueue(event))
+            return;
+        m_startQueued = true;
+    }
+
+    bool tuneLoaded = false;
+    while (!m_endQueued) {
+        if (m_nextEvent >= m_timeline.events.count()) {
+            if (tuneLoaded)
+                return;
+
+            if (!loadNextTune()) {
+                event.type = SequencerEvent::End;
+                event.note = NoteEvent();
+                event.note.start = m_tickOffset;
+                if (m_sequencer->enqueue(event))
+                    m_endQueued = true;
+                return;
+            }
+            tuneLoaded = true;
+            continue;
+        }
+
+        event.type = SequencerEvent::Note;
+        event.note = m_timeline.events.at(m_nextEvent);
+        event.note.start += m_tickOffset;
+        event.index = m_symbols.count() - m_timeline.symbols.count() + m_nextEvent;
+        if (!m_sequencer->enqueue(event))
+            return;
+        m_nextEvent++;
+    }
+}
+
+void PlaybackEngine::finishPlaying()
+{
+    m_playing = false;
+    m_updateTimer.stop();
+    m_pendingTunes.clear();
+    m_timeline = Timeline();
+    m_symbols.clear();
+    m_currentEvent = -1;
+
+    // Let the notes fade out, before the device is suspended
+    QTimer::singleShot(ReleaseMilliseconds, this, [this] () {
+        if (!m_playing)
+            QMetaObject::invokeMethod(m_audioOutput, "suspend", Qt::QueuedConnection);
+    });
+
+    emit currentSymbolChanged(QModelIndex());
+    emit playingChanged(false);
+}
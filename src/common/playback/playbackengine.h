@@ -0,0 +1,75 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#ifndef PLAYBACKENGINE_H
+#define PLAYBACKENGINE_H
+
+#include <QObject>
+#include <QPersistentModelIndex>
+#include <QTimer>
+#include "timelinetypes.h"
+
+class QThread;
+class AudioOutput;
+class Sequencer;
+class TimelineCompiler;
+
+class PlaybackEngine : public QObject
+{
+    Q_OBJECT
+public:
+    explicit PlaybackEngine(QObject *parent = 0);
+    ~PlaybackEngine();
+
+    void setTimelineCompiler(TimelineCompiler *compiler);
+    TimelineCompiler *timelineCompiler() const;
+
+    int tempo() const;
+    void setTempo(int beatsPerMinute);
+
+    bool dronesEnabled() const;
+    void setDronesEnabled(bool enabled);
+
+    bool isPlaying() const;
+
+public slots:
+    void play(const QModelIndex &index = QModelIndex());
+    void stop();
+
+signals:
+    void currentSymbolChanged(const QModelIndex &symbol);
+    void playingChanged(bool playing);
+
+private slots:
+    void update();
+
+private:
+    QList<QPersistentModelIndex> tunesFrom(const QModelIndex &index) const;
+    bool loadNextTune();
+    void refillQueue();
+    void finishPlaying();
+    TimelineCompiler *m_compiler;
+    Sequencer *m_sequencer;
+    AudioOutput *m_audioOutput;
+    QThread *m_audioThread;
+    QTimer m_updateTimer;
+    bool m_playing;
+    bool m_dronesEnabled;
+    int m_generation;
+    bool m_startQueued;
+    bool m_endQueued;
+    quint32 m_startTick;
+    QList<QPersistentModelIndex> m_pendingTunes;
+    Timeline m_timeline;            // Timeline of the tune, which is queued
+    int m_nextEvent;                // Next event of m_timeline to queue
+    quint32 m_tickOffset;           // Start of m_timeline
+    QVector<QModelIndex> m_symbols; // Symbols of all queued events
+    int m_currentEvent;
+};
+
+#endif // PLAYBACKENGINE_H
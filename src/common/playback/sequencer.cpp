@@ -0,0 +1,250 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+/*!
+ * @class Sequencer
+ * @brief Plays note events with the Synthesizer in the audio thread.
+ *
+ * The GUI thread feeds the events through a lock-free EventQueue and reads the index of
+ * the sounding event and the end of playback from atomic integers. Nothing in render
+ * allocates, locks or waits for the GUI thread. If the queue runs empty before the
+ * End event, the position is held until more events arrive.
+ *
+ * Restarting increments the generation. The audio thread stops all notes as soon as it
+ * notices the new generation and drops the remaining events of older generations.
+ */
+
+#include <QtMath>
+#include "sequencer.h"
+
+Sequencer::Sequencer(int sampleRate, int queueCapacity)
+    : m_queue(queueCapacity),
+      m_generation(0),
+      m_tempo(80),
+      m_dronesEnabled(0),
+      m_currentEvent(-1),
+      m_finishedGeneration(-1),
+      m_synthesizer(sampleRate),
+      m_playingGeneration(0),
+      m_playing(false),
+      m_tick(0),
+      m_endTick(0),
+      m_hasEnd(false),
+      m_hasNextEvent(false),
+      m_noteOffCount(0)
+{
+}
+
+/*!
+ * \brief Sequencer::restart Stops playing and returns the generation for the events
+ *        of the next playback, which has to begin with a Start event.
+ */
+int Sequencer::restart()
+{
+    return m_generation.fetchAndAddOrdered(1) + 1;
+}
+
+bool Sequencer::enqueue(const SequencerEvent &event)
+{
+    return m_queue.tryPush(event);
+}
+
+int Sequencer::freeQueueSpace() const
+{
+    return m_queue.capacity() - m_queue.count();
+}
+
+int Sequencer::tempo() const
+{
+    return m_tempo.loadAcquire();
+}
+
+/*!
+ * \brief Sequencer::setTempo Sets the tempo in quarter notes per minute. It can be
+ *        changed while playing.
+ */
+void Sequencer::setTempo(int beatsPerMinute)
+{
+    if (beatsPerMinute <= 0)
+        return;
+
+    m_tempo.storeRelease(beatsPerMinute);
+}
+
+bool Sequencer::dronesEnabled() const
+{
+    return m_dronesEnabled.loadAcquire();
+}
+
+void Sequencer::setDronesEnabled(bool enabled)
+{
+    m_dronesEnabled.storeRelease(enabled);
+}
+
+/*!
+ * \brief Sequencer::currentEvent Returns the index of the last started note or -1,
+ *        if nothing is played.
+ */
+int Sequencer::currentEvent() const
+{
+    return m_currentEvent.loadAcquire();
+}
+
+bool Sequencer::isFinished(int generation) const
+{
+    return m_finishedGeneration.loadAcquire() == generation;
+}
+
+void Sequencer::render(qint16 *samples, int frameCount)
+{
+    if (m_playingGeneration != m_generation.loadAcquire()) {
+        stop();
+        m_playingGeneration = m_generation.loadAcquire();
+    }
+
+    if (m_playing && m_synthesizer.dronesEnabled() != dronesEnabled())
+        m_synthesizer.setDronesEnabled(dronesEnabled());
+
+    int frame = 0;
+    while (frame < frameCount) {
+        if (!m_hasNextEvent)
+            fetchNextEvent();
+
+        double nextTick = nextEventTick();
+        if (!m_playing || nextTick < 0) {
+            m_synthesizer.render(samples + frame, frameCount - frame);
+            return;
+        }
+
+        double ticksPerFrame = tempo() * Playback::TicksPerQuarter /
+                (60.0 * m_synthesizer.sampleRate());
+        int frames = qBound(0, static_cast<int>(qCeil((nextTick - m_tick) / ticksPerFrame)),
+                            frameCount - frame);
+        if (frames > 0) {
+            m_synthesizer.render(samples + frame, frames);
+            frame += frames;
+            m_tick += frames * ticksPerFrame;
+        }
+
+        processEventsUntil(m_tick);
+    }
+}
+
+int Sequencer::sampleRate() const
+{
+    return m_synthesizer.sampleRate();
+}
+
+bool Sequencer::fetchNextEvent()
+{
+    SequencerEvent event;
+    while (m_queue.tryPop(&event)) {
+        if (event.generation != m_playingGeneration) {
+            // Restarted while rendering
+            if (event.generation != m_generation.loadAcquire())
+                continue;
+            stop();
+            m_playingGeneration = event.generation;
+        }
+
+        switch (event.type) {
+        case SequencerEvent::Start:
+            startGeneration(event);
+            break;
+        case SequencerEvent::End:
+            m_hasEnd = true;
+            m_endTick = event.note.start;
+            break;
+        case SequencerEvent::Note:
+            if (!m_playing)
+                break;
+            m_nextEvent = event;
+            m_hasNextEvent = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Sequencer::startGeneration(const SequencerEvent &event)
+{
+    stop();
+    m_playing = true;
+    m_tick = event.note.start;
+    m_synthesizer.setDronesEnabled(dronesEnabled());
+}
+
+void Sequencer::stop()
+{
+    m_synthesizer.allNotesOff();
+    m_playing = false;
+    m_hasEnd = false;
+    m_hasNextEvent = false;
+    m_noteOffCount = 0;
+    m_currentEvent.storeRelease(-1);
+}
+
+/*!
+ * \brief Sequencer::nextEventTick Returns the tick of the next note on, note off or end
+ *        or -1, if the sequencer has to wait for more events.
+ */
+double Sequencer::nextEventTick() const
+{
+    double tick = -1;
+    for (int i = 0; i < m_noteOffCount; ++i) {
+        if (tick < 0 || m_noteOffs[i].tick < tick)
+            tick = m_noteOffs[i].tick;
+    }
+
+    double eventTick = -1;
+    if (m_hasNextEvent)
+        eventTick = m_nextEvent.note.start;
+    else if (m_hasEnd)
+        eventTick = m_endTick;
+
+    if (eventTick >= 0 && (tick < 0 || eventTick < tick))
+        tick = eventTick;
+
+    return tick;
+}
+
+void Sequencer::processEventsUntil(double tick)
+{
+    // Note offs first, so that repeated notes are started again
+    for (int i = m_noteOffCount - 1; i >= 0; --i) {
+        if (m_noteOffs[i].tick <= tick) {
+            m_synthesizer.noteOff(m_noteOffs[i].note);
+            m_noteOffs[i] = m_noteOffs[--m_noteOffCount];
+        }
+    }
+
+    int generation = m_playingGeneration;
+    while (m_hasNextEvent && m_nextEvent.note.start <= tick) {
+        const NoteEvent &note = m_nextEvent.note;
+        if (m_noteOffCount == MaxPendingNoteOffs) {
+            m_synthesizer.noteOff(m_noteOffs[0].note);
+            m_noteOffs[0] = m_noteOffs[--m_noteOffCount];
+        }
+        m_noteOffs[m_noteOffCount].tick = note.start + note.duration;
+        m_noteOffs[m_noteOffCount].note = note.note;
+        m_noteOffCount++;
+
+        m_synthesizer.noteOn(note.note, note.velocity);
+        m_currentEvent.storeRelease(m_nextEvent.index);
+
+        m_hasNextEvent = false;
+        fetchNextEvent();
+        if (m_playingGeneration != generation)
+            return;
+    }
+
+    if (m_hasEnd && !m_hasNextEvent && tick >= m_endTick) {
+        stop();
+        m_finishedGeneration.storeRelease(m_playingGeneration);
+    }
+}
@@ -0,0 +1,100 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#ifndef SEQUENCER_H
+#define SEQUENCER_H
+
+#include <QAtomicInt>
+#include "eventqueue.h"
+#include "synthesizer.h"
+#include "timelinetypes.h"
+
+/*!
+ * \brief The SequencerEvent struct is sent from the GUI thread to the sequencer.
+ *        Start begins playing at the tick in note.start, Note plays note and End stops
+ *        at the tick in note.start. Events of an older generation than the last
+ *        Sequencer::restart are dropped.
+ */
+struct SequencerEvent {
+    enum Type {
+        Start,
+        Note,
+        End
+    };
+
+    SequencerEvent()
+        : type(Note),
+          generation(0),
+          index(-1)
+    {}
+
+    Type type;
+    int generation;
+    NoteEvent note;
+    int index;      //!< Index of the note in the played timeline
+};
+
+Q_DECLARE_TYPEINFO(SequencerEvent, Q_PRIMITIVE_TYPE);
+
+class Sequencer
+{
+public:
+    explicit Sequencer(int sampleRate = 44100, int queueCapacity = 4096);
+
+    // Called from the GUI thread
+    int restart();
+    bool enqueue(const SequencerEvent &event);
+    int freeQueueSpace() const;
+
+    int tempo() const;
+    void setTempo(int beatsPerMinute);
+
+    bool dronesEnabled() const;
+    void setDronesEnabled(bool enabled);
+
+    int currentEvent() const;
+    bool isFinished(int generation) const;
+
+    // Called from the audio thread
+    void render(qint16 *samples, int frameCount);
+    int sampleRate() const;
+
+private:
+    struct PendingNoteOff {
+        double tick;
+        int note;
+    };
+
+    enum { MaxPendingNoteOffs = 16 };
+
+    bool fetchNextEvent();
+    void startGeneration(const SequencerEvent &event);
+    void stop();
+    double nextEventTick() const;
+    void processEventsUntil(double tick);
+    EventQueue<SequencerEvent> m_queue;
+    QAtomicInt m_generation;
+    QAtomicInt m_tempo;
+    QAtomicInt m_dronesEnabled;
+    QAtomicInt m_currentEvent;
+    QAtomicInt m_finishedGeneration;
+
+    // Only used by the audio thread
+    Synthesizer m_synthesizer;
+    int m_playingGeneration;
+    bool m_playing;
+    double m_tick;
+    double m_endTick;
+    bool m_hasEnd;
+    SequencerEvent m_nextEvent;
+    bool m_hasNextEvent;
+    PendingNoteOff m_noteOffs[MaxPendingNoteOffs];
+    int m_noteOffCount;
+};
+
+#endif // SEQUENCER_H
@@ -0,0 +1,239 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+/*!
+ * @class Synthesizer
+ * @brief A small wavetable synthesizer with a monophonic chanter and three drones.
+ *
+ * The chanter plays one note at a time. A new note replaces the sounding one without a gap,
+ * like on a bagpipe chanter. The drones are tuned to the drone note and one octave below.
+ *
+ * Rendering neither allocates nor locks, so it can run in the audio thread. All methods
+ * have to be called from the same thread.
+ */
+
+#include <QtMath>
+#include "synthesizer.h"
+
+namespace {
+
+const int WaveTableSize = 1 << Synthesizer::WaveTableBits;
+
+/*!
+ * Returns one period of a waveform with the given amplitudes of the harmonics,
+ * normalized to a peak of 1.
+ */
+QVector<float> waveTable(const QVector<float> &harmonics)
+{
+    QVector<float> table(WaveTableSize);
+    float peak = 0;
+    for (int i = 0; i < WaveTableSize; ++i) {
+        qreal phase = 2 * M_PI * i / WaveTableSize;
+        float value = 0;
+        for (int harmonic = 0; harmonic < harmonics.count(); ++harmonic) {
+            value += harmonics.at(harmonic) * qSin((harmonic + 1) * phase);
+        }
+        table[i] = value;
+        peak = qMax(peak, qAbs(value));
+    }
+
+    if (peak > 0) {
+        for (int i = 0; i < WaveTableSize; ++i) {
+            table[i] /= peak;
+        }
+    }
+    return table;
+}
+
+}
+
+const float Synthesizer::ChanterGain = 0.45f;
+const float Synthesizer::BassDroneGain = 0.16f;
+const float Synthesizer::TenorDroneGain = 0.12f;
+const float Synthesizer::TenorDroneDetune = 0.0005f;
+const float Synthesizer::ChanterAttackTime = 0.003f;
+const float Synthesizer::ChanterReleaseTime = 0.02f;
+const float Synthesizer::DroneAttackTime = 0.15f;
+const float Synthesizer::DroneReleaseTime = 0.1f;
+
+Synthesizer::Synthesizer(int sampleRate)
+    : m_sampleRate(qMax(1, sampleRate)),
+      m_dronesEnabled(false),
+      m_droneNote(57),
+      m_currentNote(-1)
+{
+    m_chanterWave = chanterWaveTable();
+    m_droneWave = droneWaveTable();
+
+    m_chanterAttack = 1.0f / (ChanterAttackTime * m_sampleRate);
+    m_chanterRelease = 1.0f / (ChanterReleaseTime * m_sampleRate);
+    m_droneAttack = 1.0f / (DroneAttackTime * m_sampleRate);
+    m_droneRelease = 1.0f / (DroneReleaseTime * m_sampleRate);
+
+    setDroneNote(m_droneNote);
+}
+
+int Synthesizer::sampleRate() const
+{
+    return m_sampleRate;
+}
+
+bool Synthesizer::dronesEnabled() const
+{
+    return m_dronesEnabled;
+}
+
+void Synthesizer::setDronesEnabled(bool enabled)
+{
+    m_dronesEnabled = enabled;
+    setDroneTargets();
+}
+
+int Synthesizer::droneNote() const
+{
+    return m_droneNote;
+}
+
+/*!
+ * \brief Synthesizer::setDroneNote Sets the note of the two tenor drones.
+ *        The bass drone sounds one octave lower.
+ */
+void Synthesizer::setDroneNote(int note)
+{
+    m_droneNote = note;
+    m_drones[0].increment = phaseIncrement(frequency(note - 12), m_sampleRate);
+    // The tenor drones are slightly detuned against each other, which makes them beat
+    m_drones[1].increment = phaseIncrement(frequency(note) * (1 - TenorDroneDetune), m_sampleRate);
+    m_drones[2].increment = phaseIncrement(frequency(note) * (1 + TenorDroneDetune), m_sampleRate);
+}
+
+void Synthesizer::noteOn(int note, int velocity)
+{
+    if (velocity <= 0) {
+        noteOff(note);
+        return;
+    }
+
+    m_currentNote = note;
+    m_chanter.increment = phaseIncrement(frequency(note), m_sampleRate);
+    m_chanter.target = qMin(velocity, 127) / 127.0f;
+}
+
+void Synthesizer::noteOff(int note)
+{
+    if (note != m_currentNote)
+        return;
+
+    m_currentNote = -1;
+    m_chanter.target = 0;
+}
+
+/*!
+ * \brief Synthesizer::allNotesOff Stops the chanter and the drones.
+ */
+void Synthesizer::allNotesOff()
+{
+    m_currentNote = -1;
+    m_chanter.target = 0;
+    m_dronesEnabled = false;
+    setDroneTargets();
+}
+
+/*!
+ * \brief Synthesizer::currentNote Returns the sounding note of the chanter or -1.
+ */
+int Synthesizer::currentNote() const
+{
+    return m_currentNote;
+}
+
+/*!
+ * \brief Synthesizer::isSounding Returns true, until the chanter and drones have faded out.
+ */
+bool Synthesizer::isSounding() const
+{
+    if (m_chanter.level > 0 || m_chanter.target > 0)
+        return true;
+
+    for (int i = 0; i < 3; ++i) {
+        if (m_drones[i].level > 0 || m_drones[i].target > 0)
+            return true;
+    }
+    return false;
+}
+
+/*!
+ * \brief Synthesizer::render Writes frameCount mono samples.
+ */
+void Synthesizer::render(qint16 *samples, int frameCount)
+{
+    for (int frame = 0; frame < frameCount; ++frame) {
+        float value = ChanterGain *
+                renderOscillator(&m_chanter, m_chanterWave, m_chanterAttack, m_chanterRelease);
+        value += BassDroneGain *
+                renderOscillator(&m_drones[0], m_droneWave, m_droneAttack, m_droneRelease);
+        value += TenorDroneGain *
+                renderOscillator(&m_drones[1], m_droneWave, m_droneAttack, m_droneRelease);
+        value += TenorDroneGain *
+                renderOscillator(&m_drones[2], m_droneWave, m_droneAttack, m_droneRelease);
+
+        samples[frame] = static_cast<qint16>(qBound(-1.0f, value, 1.0f) * 32767);
+    }
+}
+
+/*!
+ * \brief Synthesizer::frequency Returns the frequency of the MIDI note with A4 at 440 Hz.
+ */
+qreal Synthesizer::frequency(int note)
+{
+    return 440.0 * qPow(2.0, (note - 69) / 12.0);
+}
+
+/*!
+ * \brief Synthesizer::phaseIncrement Returns the increment per sample of a 32 bit phase,
+ *        which wraps around once per period.
+ */
+quint32 Synthesizer::phaseIncrement(qreal frequency, int sampleRate)
+{
+    return static_cast<quint32>(frequency / sampleRate * 4294967296.0);
+}
+
+QVector<float> Synthesizer::chanterWaveTable()
+{
+    // Reeds are rich in odd harmonics
+    return waveTable(QVector<float>() << 1.0f << 0.45f << 0.6f << 0.3f << 0.4f
+                                      << 0.2f << 0.25f << 0.12f << 0.15f << 0.08f);
+}
+
+QVector<float> Synthesizer::droneWaveTable()
+{
+    return waveTable(QVector<float>() << 1.0f << 0.5f << 0.35f << 0.2f << 0.12f << 0.06f);
+}
+
+void Synthesizer::setDroneTargets()
+{
+    for (int i = 0; i < 3; ++i) {
+        m_drones[i].target = m_dronesEnabled ? 1.0f : 0.0f;
+    }
+}
+
+float Synthesizer::renderOscillator(Synthesizer::Oscillator *oscillator, const QVector<float> &waveTable,
+                                    float attackStep, float releaseStep)
+{
+    if (oscillator->level < oscillator->target)
+        oscillator->level = qMin(oscillator->target, oscillator->level + attackStep);
+    else if (oscillator->level > oscillator->target)
+        oscillator->level = qMax(oscillator->target, oscillator->level - releaseStep);
+
+    if (oscillator->level <= 0)
+        return 0;
+
+    float value = waveTable.at(oscillator->phase >> (32 - WaveTableBits));
+    oscillator->phase += oscillator->increment;
+    return value * oscillator->level;
+}
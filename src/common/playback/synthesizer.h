@@ -0,0 +1,80 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#ifndef SYNTHESIZER_H
+#define SYNTHESIZER_H
+
+#include <QVector>
+#include <QtGlobal>
+
+class Synthesizer
+{
+public:
+    explicit Synthesizer(int sampleRate = 44100);
+
+    int sampleRate() const;
+
+    bool dronesEnabled() const;
+    void setDronesEnabled(bool enabled);
+
+    int droneNote() const;
+    void setDroneNote(int note);
+
+    void noteOn(int note, int velocity);
+    void noteOff(int note);
+    void allNotesOff();
+
+    int currentNote() const;
+    bool isSounding() const;
+
+    void render(qint16 *samples, int frameCount);
+
+    static qreal frequency(int note);
+    static quint32 phaseIncrement(qreal frequency, int sampleRate);
+
+    static QVector<float> chanterWaveTable();
+    static QVector<float> droneWaveTable();
+
+    // Shared with the OfflineRenderer, so that both sound the same
+    static const int WaveTableBits = 11;
+    static const float ChanterGain;
+    static const float BassDroneGain;
+    static const float TenorDroneGain;
+    static const float TenorDroneDetune;
+    static const float ChanterAttackTime;   // Seconds
+    static const float ChanterReleaseTime;
+    static const float DroneAttackTime;
+    static const float DroneReleaseTime;
+
+private:
+    struct Oscillator {
+        Oscillator() : phase(0), increment(0), level(0), target(0) {}
+        quint32 phase;
+        quint32 increment;
+        float level;
+        float target;
+    };
+
+    void setDroneTargets();
+    float renderOscillator(Oscillator *oscillator, const QVector<float> &waveTable,
+                           float attackStep, float releaseStep);
+    int m_sampleRate;
+    bool m_dronesEnabled;
+    int m_droneNote;
+    int m_currentNote;
+    Oscillator m_chanter;
+    Oscillator m_drones[3];
+    QVector<float> m_chanterWave;
+    QVector<float> m_droneWave;
+    float m_chanterAttack;
+    float m_chanterRelease;
+    float m_droneAttack;
+    float m_droneRelease;
+};
+
+#endif // SYNTHESIZER_H
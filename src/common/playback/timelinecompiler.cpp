@@ -0,0 +1,486 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+/*!
+ * @class TimelineCompiler
+ * @brief Flattens tunes into a timeline of note events.
+ *
+ * Every measure is compiled on its own into events relative to the start of the measure.
+ * Embellishments are expanded into grace notes, which take their time from the following
+ * melody note. The instrument plugin returns the grace notes of an embellishment.
+ * The timeline of a tune concatenates the compiled measures, plays repeated parts twice
+ * and merges tied notes of the same pitch, also across bar lines.
+ *
+ * The compiled measures are cached per tune. If a symbol or measure changes, only its
+ * measure is compiled again. Changes of parts and tunes compile the whole tune again.
+ */
+
+#include <QAbstractItemModel>
+#include <common/itemdataroles.h>
+#include <common/datatypes/length.h>
+#include <common/datatypes/pitch.h>
+#include <common/datatypes/timesignature.h>
+#include <utilities/tracer.h>
+#include "timelinecompiler.h"
+
+namespace {
+
+const quint8 MelodyNoteVelocity = 100;
+const quint8 GraceNoteVelocity = 90;
+
+// Semitones of C, D, E, F, G, A, B above C
+const int StepSemitones[] = { 0, 2, 4, 5, 7, 9, 11 };
+
+}
+
+TimelineCompiler::TimelineCompiler(QObject *parent)
+    : QObject(parent),
+      m_model(0),
+      m_compiledMeasureCount(0)
+{
+}
+
+void TimelineCompiler::setModel(QAbstractItemModel *model)
+{
+    if (m_model == model)
+        return;
+
+    if (m_model)
+        m_model->disconnect(this);
+
+    m_model = model;
+    m_tunes.clear();
+
+    if (!m_model)
+        return;
+
+    connect(m_model, &QAbstractItemModel::dataChanged,
+            this, &TimelineCompiler::dataChanged);
+    connect(m_model, &QAbstractItemModel::rowsInserted,
+            this, &TimelineCompiler::rowsInserted);
+    connect(m_model, &QAbstractItemModel::rowsRemoved,
+            this, &TimelineCompiler::rowsRemoved);
+    connect(m_model, &QAbstractItemModel::modelReset,
+            this, &TimelineCompiler::modelReset);
+}
+
+QAbstractItemModel *TimelineCompiler::model() const
+{
+    return m_model;
+}
+
+/*!
+ * \brief TimelineCompiler::setPluginManager Sets the plugin manager, which expands
+ *        embellishments into grace notes. Without, embellishments aren't played.
+ */
+void TimelineCompiler::setPluginManager(const PluginManager &pluginManager)
+{
+    m_pluginManager = pluginManager;
+    m_tunes.clear();
+}
+
+/*!
+ * \brief TimelineCompiler::timeline Returns the timeline of a tune. For a score, the timelines
+ *        of all tunes are played after another, for an invalid index all scores.
+ */
+Timeline TimelineCompiler::timeline(const QModelIndex &index)
+{
+    LP_TRACE_SCOPE("TimelineCompiler::timeline");
+
+    if (!m_model)
+        return Timeline();
+
+    LP::ItemType type = itemType(index);
+    if (type == LP::ItemType::TuneType)
+        return tuneTimeline(index);
+
+    Timeline timeline;
+    if (index.isValid() && type != LP::ItemType::ScoreType)
+        return timeline;
+
+    for (int row = 0; row < m_model->rowCount(index); ++row) {
+        Timeline childTimeline = this->timeline(m_model->index(row, 0, index));
+        timeline.events.reserve(timeline.events.count() + childTimeline.events.count());
+        foreach (NoteEvent event, childTimeline.events) {
+            event.start += timeline.length;
+            timeline.events << event;
+        }
+        timeline.symbols << childTimeline.symbols;
+        timeline.length += childTimeline.length;
+    }
+    return timeline;
+}
+
+/*!
+ * \brief TimelineCompiler::compiledMeasureCount Returns the number of measures compiled since
+ *        the compiler was created.
+ */
+int TimelineCompiler::compiledMeasureCount() const
+{
+    return m_compiledMeasureCount;
+}
+
+/*!
+ * \brief TimelineCompiler::midiNote Returns the MIDI note number of the staff position.
+ *        Staff position 0 is the top line, positions increase downwards. The notes
+ *        of the Great Highland Bagpipe are played with F and C sharp.
+ */
+int TimelineCompiler::midiNote(int staffPos, ClefType clef, int instrumentType)
+{
+    // Diatonic steps above C0 of the top line
+    int topLine = 5 * 7 + 3;     // F5
+    if (clef == ClefType::Bass)
+        topLine = 3 * 7 + 5;     // A3
+    else if (clef == ClefType::Alto)
+        topLine = 4 * 7 + 4;     // G4
+
+    int diatonic = topLine - staffPos;
+    int octave = diatonic >= 0 ? diatonic / 7 : (diatonic - 6) / 7;
+    int step = diatonic - octave * 7;
+
+    int note = (octave + 1) * 12 + StepSemitones[step];
+    if (instrumentType == LP::GreatHighlandBagpipe && (step == 0 || step == 3))
+        note++;
+
+    return qBound(0, note, 127);
+}
+
+quint32 TimelineCompiler::ticksForLength(int lengthValue, int dots)
+{
+    if (lengthValue <= 0)
+        return 0;
+
+    quint32 ticks = 4 * Playback::TicksPerQuarter / lengthValue;
+    quint32 dotTicks = ticks;
+    for (int i = 0; i < dots; ++i) {
+        dotTicks /= 2;
+        ticks += dotTicks;
+    }
+    return ticks;
+}
+
+void TimelineCompiler::dataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+        QModelIndex index = topLeft.sibling(row, 0);
+        switch (itemType(index)) {
+        case LP::ItemType::SymbolType:
+            measureChanged(index.parent());
+            break;
+        case LP::ItemType::MeasureType:
+            measureChanged(index);
+            break;
+        case LP::ItemType::PartType:
+        case LP::ItemType::TuneType:
+            invalidateTuneOf(index);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void TimelineCompiler::rowsInserted(const QModelIndex &parent, int first, int last)
+{
+    Q_UNUSED(first)
+    Q_UNUSED(last)
+
+    LP::ItemType type = itemType(parent);
+    if (type == LP::ItemType::MeasureType)
+        measureChanged(parent);
+    else if (type == LP::ItemType::PartType || type == LP::ItemType::TuneType)
+        invalidateTuneOf(parent);
+}
+
+void TimelineCompiler::rowsRemoved(const QModelIndex &parent, int first, int last)
+{
+    Q_UNUSED(first)
+    Q_UNUSED(last)
+
+    LP::ItemType type = itemType(parent);
+    if (type == LP::ItemType::MeasureType)
+        measureChanged(parent);
+    else if (type == LP::ItemType::PartType || type == LP::ItemType::TuneType)
+        invalidateTuneOf(parent);
+    else
+        removeInvalidTunes();
+}
+
+void TimelineCompiler::modelReset()
+{
+    m_tunes.clear();
+}
+
+Timeline TimelineCompiler::tuneTimeline(const QModelIndex &tuneIndex)
+{
+    QHash<quintptr, CompiledTune>::iterator it = m_tunes.find(tuneIndex.internalId());
+    if (it == m_tunes.end())
+        it = m_tunes.insert(tuneIndex.internalId(), compileTune(tuneIndex));
+
+    if (!it->timelineValid)
+        flattenTune(&it.value());
+
+    return it->timeline;
+}
+
+TimelineCompiler::CompiledTune TimelineCompiler::compileTune(const QModelIndex &tuneIndex)
+{
+    LP_TRACE_SCOPE("TimelineCompiler::compileTune");
+
+    CompiledTune tune;
+    tune.index = tuneIndex;
+    int instrumentType = tuneIndex.data(LP::TuneInstrument).toInt();
+
+    int partCount = m_model->rowCount(tuneIndex);
+    tune.parts.reserve(partCount);
+    for (int partRow = 0; partRow < partCount; ++partRow) {
+        QModelIndex partIndex = m_model->index(partRow, 0, tuneIndex);
+        ClefType clef = partIndex.data(LP::PartClefType).value<ClefType>();
+
+        CompiledPart part;
+        part.repeat = partIndex.data(LP::PartRepeat).toBool();
+        int measureCount = m_model->rowCount(partIndex);
+        part.measures.reserve(measureCount);
+        for (int measureRow = 0; measureRow < measureCount; ++measureRow) {
+            QModelIndex measureIndex = m_model->index(measureRow, 0, partIndex);
+            part.measures << compileMeasure(measureIndex, clef, instrumentType);
+        }
+        tune.parts << part;
+    }
+    return tune;
+}
+
+TimelineCompiler::CompiledMeasure TimelineCompiler::compileMeasure(const QModelIndex &measureIndex,
+                                                                   ClefType clef, int instrumentType)
+{
+    m_compiledMeasureCount++;
+
+    CompiledMeasure measure;
+    quint32 position = 0;
+    QModelIndex embellishmentIndex;
+    bool tieStartPending = false;
+    int lastNote = -1;
+
+    int symbolCount = m_model->rowCount(measureIndex);
+    measure.events.reserve(symbolCount);
+    measure.symbols.reserve(symbolCount);
+    for (int row = 0; row < symbolCount; ++row) {
+        QModelIndex symbolIndex = m_model->index(row, 0, measureIndex);
+        int symbolType = symbolIndex.data(LP::SymbolType).toInt();
+
+        if (symbolType == LP::Tie) {
+            SpanType spanType = symbolIndex.data(LP::SymbolSpanType).value<SpanType>();
+            if (spanType == SpanType::Start)
+                tieStartPending = true;
+            else if (spanType == SpanType::End && lastNote != -1)
+                measure.events[lastNote].flags |= Playback::TieEnd;
+            else if (spanType == SpanType::End)
+                measure.tieEndBeforeNotes = true;
+            continue;
+        }
+
+        // Symbols without length can be embellishments of the next melody note
+        QVariant lengthData = symbolIndex.data(LP::SymbolLength);
+        if (!lengthData.isValid()) {
+            embellishmentIndex = symbolIndex;
+            continue;
+        }
+
+        quint32 length = ticksForLength(lengthData.value<Length::Value>(),
+                                        symbolIndex.data(LP::MelodyNoteDots).toInt());
+        QVariant pitchData = symbolIndex.data(LP::SymbolPitch);
+        if (pitchData.isValid()) {
+            int staffPos = pitchData.value<Pitch>().staffPos();
+            quint32 graceOffset = 0;
+
+            QVector<int> graceNotes;
+            if (embellishmentIndex.isValid() && !m_pluginManager.isNull()) {
+                int embellishmentType = embellishmentIndex.data(LP::SymbolType).toInt();
+                graceNotes = m_pluginManager->graceNoteStaffPositions(instrumentType, embellishmentType,
+                                                                      staffPos);
+            }
+
+            foreach (int graceStaffPos, graceNotes) {
+                if (graceOffset + Playback::GraceNoteTicks >= length)
+                    break;
+
+                NoteEvent grace;
+                grace.start = position + graceOffset;
+                grace.duration = Playback::GraceNoteTicks;
+                grace.note = midiNote(graceStaffPos, clef, instrumentType);
+                grace.velocity = GraceNoteVelocity;
+                grace.flags = Playback::GraceNote;
+                measure.events << grace;
+                measure.symbols << embellishmentIndex;
+                graceOffset += Playback::GraceNoteTicks;
+            }
+
+            NoteEvent note;
+            note.start = position + graceOffset;
+            note.duration = length - graceOffset;
+            note.note = midiNote(staffPos, clef, instrumentType);
+            note.velocity = MelodyNoteVelocity;
+            if (tieStartPending)
+                note.flags = Playback::TieStart;
+            lastNote = measure.events.count();
+            measure.events << note;
+            measure.symbols << symbolIndex;
+        }
+
+        position += length;
+        embellishmentIndex = QModelIndex();
+        tieStartPending = false;
+    }
+
+    measure.tieStartAfterNotes = tieStartPending;
+
+    if (measureIndex.data(LP::MeasureIsUpbeat).toBool())
+        measure.length = position;
+    else
+        measure.length = qMax(position, timeSignatureLength(measureIndex));
+
+    return measure;
+}
+
+void TimelineCompiler::flattenTune(TimelineCompiler::CompiledTune *tune)
+{
+    LP_TRACE_SCOPE("TimelineCompiler::flattenTune");
+
+    Timeline timeline;
+    int eventCount = 0;
+    foreach (const CompiledPart &part, tune->parts) {
+        foreach (const CompiledMeasure &measure, part.measures) {
+            eventCount += measure.events.count() * (part.repeat ? 2 : 1);
+        }
+    }
+    timeline.events.reserve(eventCount);
+    timeline.symbols.reserve(eventCount);
+
+    bool inTie = false;
+    bool tieStartPending = false;
+    int lastNote = -1;
+    foreach (const CompiledPart &part, tune->parts) {
+        int passes = part.repeat ? 2 : 1;
+        for (int pass = 0; pass < passes; ++pass) {
+            foreach (const CompiledMeasure &measure, part.measures) {
+                if (measure.tieEndBeforeNotes)
+                    inTie = false;
+
+                for (int i = 0; i < measure.events.count(); ++i) {
+                    NoteEvent event = measure.events.at(i);
+                    event.start += timeline.length;
+
+                    bool isGraceNote = event.flags & Playback::GraceNote;
+                    if (tieStartPending && !isGraceNote) {
+                        event.flags |= Playback::TieStart;
+                        tieStartPending = false;
+                    }
+                    bool continuesTie = inTie && !isGraceNote && lastNote != -1 &&
+                            !(event.flags & Playback::TieStart) &&
+                            timeline.events.at(lastNote).note == event.note &&
+                            timeline.events.at(lastNote).start + timeline.events.at(lastNote).duration == event.start;
+
+                    if (continuesTie) {
+                        timeline.events[lastNote].duration += event.duration;
+                    } else {
+                        if (!isGraceNote)
+                            lastNote = timeline.events.count();
+                        timeline.events << event;
+                        timeline.symbols << measure.symbols.at(i);
+                    }
+
+                    if (event.flags & Playback::TieStart)
+                        inTie = true;
+                    if (event.flags & Playback::TieEnd)
+                        inTie = false;
+                }
+                if (measure.tieStartAfterNotes)
+                    tieStartPending = true;
+                timeline.length += measure.length;
+            }
+        }
+    }
+
+    tune->timeline = timeline;
+    tune->timelineValid = true;
+}
+
+void TimelineCompiler::measureChanged(const QModelIndex &measureIndex)
+{
+    QModelIndex partIndex = measureIndex.parent();
+    QModelIndex tuneIndex = partIndex.parent();
+    QHash<quintptr, CompiledTune>::iterator it = m_tunes.find(tuneIndex.internalId());
+    if (it == m_tunes.end())
+        return;
+
+    int partRow = partIndex.row();
+    int measureRow = measureIndex.row();
+    if (partRow >= it->parts.count() ||
+            measureRow >= it->parts.at(partRow).measures.count()) {
+        m_tunes.erase(it);
+        return;
+    }
+
+    ClefType clef = partIndex.data(LP::PartClefType).value<ClefType>();
+    int instrumentType = tuneIndex.data(LP::TuneInstrument).toInt();
+    it->parts[partRow].measures[measureRow] = compileMeasure(measureIndex, clef, instrumentType);
+    it->timelineValid = false;
+}
+
+void TimelineCompiler::invalidateTuneOf(const QModelIndex &index)
+{
+    QModelIndex tuneIndex = ancestorOfType(index, LP::ItemType::TuneType);
+    if (tuneIndex.isValid())
+        m_tunes.remove(tuneIndex.internalId());
+}
+
+void TimelineCompiler::removeInvalidTunes()
+{
+    QHash<quintptr, CompiledTune>::iterator it = m_tunes.begin();
+    while (it != m_tunes.end()) {
+        if (it->index.isValid())
+            ++it;
+        else
+            it = m_tunes.erase(it);
+    }
+}
+
+LP::ItemType TimelineCompiler::itemType(const QModelIndex &index) const
+{
+    if (!index.isValid())
+        return LP::ItemType::RootItemType;
+
+    return static_cast<LP::ItemType>(index.data(LP::MusicItemType).toInt());
+}
+
+QModelIndex TimelineCompiler::ancestorOfType(const QModelIndex &index, LP::ItemType type) const
+{
+    QModelIndex ancestor = index;
+    while (ancestor.isValid() && itemType(ancestor) != type) {
+        ancestor = ancestor.parent();
+    }
+    return ancestor;
+}
+
+/*!
+ * \brief TimelineCompiler::timeSignatureLength Returns the length of a full measure with the
+ *        time signature of the measure or, if it has none, of the tune.
+ */
+quint32 TimelineCompiler::timeSignatureLength(const QModelIndex &measureIndex) const
+{
+    TimeSignature timeSignature = measureIndex.data(LP::MeasureTimeSignature).value<TimeSignature>();
+    if (!timeSignature.isValid()) {
+        QModelIndex tuneIndex = ancestorOfType(measureIndex, LP::ItemType::TuneType);
+        timeSignature = tuneIndex.data(LP::TuneTimeSignature).value<TimeSignature>();
+    }
+
+    if (!timeSignature.isValid() || timeSignature.beatUnit() <= 0)
+        return 0;
+
+    return timeSignature.beatCount() * 4 * Playback::TicksPerQuarter / timeSignature.beatUnit();
+}
@@ -0,0 +1,84 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#ifndef TIMELINECOMPILER_H
+#define TIMELINECOMPILER_H
+
+#include <QObject>
+#include <QHash>
+#include <QPersistentModelIndex>
+#include <common/defines.h>
+#include <common/pluginmanagerinterface.h>
+#include "timelinetypes.h"
+
+class QAbstractItemModel;
+
+class TimelineCompiler : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TimelineCompiler(QObject *parent = 0);
+
+    void setModel(QAbstractItemModel *model);
+    QAbstractItemModel *model() const;
+
+    void setPluginManager(const PluginManager &pluginManager);
+
+    Timeline timeline(const QModelIndex &index);
+    int compiledMeasureCount() const;
+
+    static int midiNote(int staffPos, ClefType clef, int instrumentType);
+    static quint32 ticksForLength(int lengthValue, int dots);
+
+private slots:
+    void dataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+    void rowsInserted(const QModelIndex &parent, int first, int last);
+    void rowsRemoved(const QModelIndex &parent, int first, int last);
+    void modelReset();
+
+private:
+    struct CompiledMeasure {
+        CompiledMeasure() : length(0), tieEndBeforeNotes(false), tieStartAfterNotes(false) {}
+        QVector<NoteEvent> events;  // Start relative to the measure
+        QVector<QModelIndex> symbols;
+        quint32 length;
+        bool tieEndBeforeNotes;     // Ends a tie of the previous measure
+        bool tieStartAfterNotes;    // Starts a tie with the first note of the next measure
+    };
+
+    struct CompiledPart {
+        CompiledPart() : repeat(false) {}
+        QVector<CompiledMeasure> measures;
+        bool repeat;
+    };
+
+    struct CompiledTune {
+        CompiledTune() : timelineValid(false) {}
+        QPersistentModelIndex index;
+        QVector<CompiledPart> parts;
+        Timeline timeline;
+        bool timelineValid;
+    };
+
+    Timeline tuneTimeline(const QModelIndex &tuneIndex);
+    CompiledTune compileTune(const QModelIndex &tuneIndex);
+    CompiledMeasure compileMeasure(const QModelIndex &measureIndex, ClefType clef, int instrumentType);
+    void flattenTune(CompiledTune *tune);
+    void measureChanged(const QModelIndex &measureIndex);
+    void invalidateTuneOf(const QModelIndex &index);
+    void removeInvalidTunes();
+    LP::ItemType itemType(const QModelIndex &index) const;
+    QModelIndex ancestorOfType(const QModelIndex &index, LP::ItemType type) const;
+    quint32 timeSignatureLength(const QModelIndex &measureIndex) const;
+    QAbstractItemModel *m_model;
+    PluginManager m_pluginManager;
+    QHash<quintptr, CompiledTune> m_tunes;     // By internal id of the tune index
+    int m_compiledMeasureCount;
+};
+
+#endif // TIMELINECOMPILER_H
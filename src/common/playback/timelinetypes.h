@@ -0,0 +1,67 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#ifndef TIMELINETYPES_H
+#define TIMELINETYPES_H
+
+#include <QModelIndex>
+#include <QVector>
+#include <QtGlobal>
+
+namespace Playback {
+
+const int TicksPerQuarter = 480;
+const int GraceNoteTicks = TicksPerQuarter / 16;
+
+enum NoteFlag {
+    NoFlags = 0x00,
+    GraceNote = 0x01,
+    TieStart = 0x02,    //!< First note after the start of a tie
+    TieEnd = 0x04       //!< Last note before the end of a tie
+};
+
+}
+
+/*!
+ * \brief The NoteEvent struct is one played note. Start and duration are in ticks with
+ *        Playback::TicksPerQuarter ticks per quarter note.
+ */
+struct NoteEvent {
+    NoteEvent()
+        : start(0),
+          duration(0),
+          note(0),
+          velocity(0),
+          flags(Playback::NoFlags)
+    {}
+
+    quint32 start;
+    quint32 duration;
+    quint8 note;        //!< MIDI note number
+    quint8 velocity;
+    quint8 flags;       //!< Playback::NoteFlag
+};
+
+Q_DECLARE_TYPEINFO(NoteEvent, Q_PRIMITIVE_TYPE);
+
+/*!
+ * \brief The Timeline struct contains the note events sorted by start and the length,
+ *        which includes rests at the end. Symbols holds the symbol index of every event,
+ *        grace notes belong to their embellishment.
+ */
+struct Timeline {
+    Timeline()
+        : length(0)
+    {}
+
+    QVector<NoteEvent> events;
+    QVector<QModelIndex> symbols;
+    quint32 length;
+};
+
+#endif // TIMELINETYPES_H
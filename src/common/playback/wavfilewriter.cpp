@@ -0,0 +1,102 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+/*!
+ * @class WavFileWriter
+ * @brief Writes mono 16 bit samples as RIFF WAVE file.
+ */
+
+#include <QByteArray>
+#include <QDebug>
+#include <QFile>
+#include <QtEndian>
+#include "wavfilewriter.h"
+
+namespace {
+
+const int HeaderSize = 44;
+
+void appendLittleEndian(QByteArray *data, quint32 value, int byteCount)
+{
+    for (int i = 0; i < byteCount; ++i) {
+        data->append(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+}
+
+WavFileWriter::WavFileWriter()
+    : m_sampleRate(44100)
+{
+}
+
+int WavFileWriter::sampleRate() const
+{
+    return m_sampleRate;
+}
+
+void WavFileWriter::setSampleRate(int sampleRate)
+{
+    if (sampleRate <= 0) {
+        qWarning() << "WavFileWriter: Sample rate has to be greater than zero";
+        return;
+    }
+    m_sampleRate = sampleRate;
+}
+
+bool WavFileWriter::write(const QVector<qint16> &samples, QIODevice *device) const
+{
+    if (!device || !device->isWritable()) {
+        qWarning() << "WavFileWriter: Can't write WAV file, device isn't writable";
+        return false;
+    }
+
+    const int channelCount = 1;
+    const int bytesPerSample = sizeof(qint16);
+    quint32 dataSize = samples.count() * bytesPerSample;
+
+    QByteArray header("RIFF");
+    header.reserve(HeaderSize);
+    appendLittleEndian(&header, HeaderSize - 8 + dataSize, 4);
+    header.append("WAVEfmt ");
+    appendLittleEndian(&header, 16, 4);
+    appendLittleEndian(&header, 1, 2);                  // PCM
+    appendLittleEndian(&header, channelCount, 2);
+    appendLittleEndian(&header, m_sampleRate, 4);
+    appendLittleEndian(&header, m_sampleRate * channelCount * bytesPerSample, 4);
+    appendLittleEndian(&header, channelCount * bytesPerSample, 2);
+    appendLittleEndian(&header, 8 * bytesPerSample, 2);
+    header.append("data");
+    appendLittleEndian(&header, dataSize, 4);
+
+    if (device->write(header) != header.size())
+        return false;
+
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    const char *data = reinterpret_cast<const char*>(samples.constData());
+    return device->write(data, dataSize) == qint64(dataSize);
+#else
+    QVector<qint16> littleEndian(samples.count());
+    for (int i = 0; i < samples.count(); ++i) {
+        littleEndian[i] = qToLittleEndian(samples.at(i));
+    }
+    const char *data = reinterpret_cast<const char*>(littleEndian.constData());
+    return device->write(data, dataSize) == qint64(dataSize);
+#endif
+}
+
+bool WavFileWriter::save(const QVector<qint16> &samples, const QString &filename) const
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "WavFileWriter: Can't open WAV file " << filename;
+        return false;
+    }
+
+    return write(samples, &file);
+}
@@ -0,0 +1,32 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#ifndef WAVFILEWRITER_H
+#define WAVFILEWRITER_H
+
+#include <QString>
+#include <QVector>
+
+class QIODevice;
+
+class WavFileWriter
+{
+public:
+    WavFileWriter();
+
+    int sampleRate() const;
+    void setSampleRate(int sampleRate);
+
+    bool write(const QVector<qint16> &samples, QIODevice *device) const;
+    bool save(const QVector<qint16> &samples, const QString &filename) const;
+
+private:
+    int m_sampleRate;
+};
+
+#endif // WAVFILEWRITER_H
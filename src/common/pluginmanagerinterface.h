@@ -35,12 +35,15 @@ public:
     virtual InstrumentMetaData instrumentMetaData(int type) const = 0;
     // TODO Overloaded method with instrument name parameter maybe useless (translation)
     virtual InstrumentMetaData instrumentMetaData(const QString &instrumentName) const = 0;
+    virtual int instrumentTypeForName(const QString &instrumentName) const = 0;
 
     virtual SymbolBehavior *symbolBehaviorForType(int type) = 0;
 //    virtual Symbol *symbolForType(int type) = 0;
     virtual QVector<int> additionalDataForSymbolType(int symbolType) = 0;
     virtual SymbolGraphicBuilder *symbolGraphicBuilderForType(int type) = 0;
     virtual ItemInteraction *itemInteractionForType(int type) = 0;
+    virtual QVector<int> graceNoteStaffPositions(int instrumentType, int symbolType,
+                                                 int melodyStaffPos) const = 0;
 
     virtual QStringList instrumentNames() const = 0;
     virtual QList<int> instrumentTypes() const = 0;
@@ -6,6 +6,16 @@
  *
  */
 
+/*!
+ * @class ScoreSettings
+ * @brief Reads and writes the appearance of the score header and footer items.
+ *
+ * The values are cached in one process wide cache, so QSettings is only read once for
+ * every value. The cache is a settings observer of the score category and is cleared
+ * whenever score settings are notified as changed. The cache is not thread safe, score
+ * settings are only used from the GUI thread.
+ */
+
 #include <QFont>
 #include <QSettings>
 #include <QDebug>
@@ -136,6 +146,20 @@ QVariant ScoreSettings::value(Appearance appearance)
 }
 
 QVariant ScoreSettings::value(Area area, LP::ScoreDataRole dataRole, Appearance appearance)
+{
+    QHash<int, QVariant> &cachedValues = valueCache().values;
+    int key = cacheKey(area, dataRole, appearance);
+
+    QHash<int, QVariant>::const_iterator it = cachedValues.constFind(key);
+    if (it != cachedValues.constEnd())
+        return it.value();
+
+    QVariant value = valueFromSettings(area, dataRole, appearance);
+    cachedValues.insert(key, value);
+    return value;
+}
+
+QVariant ScoreSettings::valueFromSettings(Area area, LP::ScoreDataRole dataRole, Appearance appearance)
 {
     QString valueKey(getKey(area, dataRole, appearance));
     QVariant value = m_settings->value(valueKey, defaultValue(valueKey));
@@ -162,6 +186,7 @@ void ScoreSettings::setValue(Area area, LP::ScoreDataRole dataRole, Appearance a
         writeValue = alignmentToString(value.value<Settings::TextAlignment>());
 
     m_settings->setValue(valueKey, writeValue);
+    valueCache().values.remove(cacheKey(area, dataRole, appearance));
     notify(Settings::Category::Score, Settings::Id::ScoreData);
 }
 
@@ -174,6 +199,7 @@ void ScoreSettings::remove(Area area, LP::ScoreDataRole dataRole, Appearance app
 {
     QString valueKey(getKey(area, dataRole, appearance));
     m_settings->remove(valueKey);
+    valueCache().values.remove(cacheKey(area, dataRole, appearance));
 }
 
 Area ScoreSettings::scoreArea() const
@@ -199,6 +225,7 @@ void ScoreSettings::setDataRole(LP::ScoreDataRole dataRole)
 void ScoreSettings::clear()
 {
     m_settings->clear();
+    valueCache().values.clear();
 }
 
 void ScoreSettings::sync()
@@ -211,6 +238,34 @@ QString ScoreSettings::fileName()
     return m_settings->fileName();
 }
 
+ScoreSettings::ValueCache::ValueCache()
+    : SettingsObserver(Settings::Category::Score)
+{
+    ObservableSettings::registerObserver(this, Settings::Id::ScoreData);
+}
+
+ScoreSettings::ValueCache::~ValueCache()
+{
+    ObservableSettings::unregisterObserver(this);
+}
+
+void ScoreSettings::ValueCache::notify(Settings::Id id)
+{
+    if (id == Settings::Id::ScoreData)
+        values.clear();
+}
+
+ScoreSettings::ValueCache &ScoreSettings::valueCache()
+{
+    static ValueCache cache;
+    return cache;
+}
+
+int ScoreSettings::cacheKey(Area area, LP::ScoreDataRole dataRole, Appearance appearance)
+{
+    return (area << 24) | (appearance << 16) | dataRole;
+}
+
 QString ScoreSettings::getKey(Area area, LP::ScoreDataRole dataRole, Appearance appearance)
 {
     QString key;
@@ -14,6 +14,7 @@
 #include <QString>
 #include <QVariant>
 #include "observablesettings.h"
+#include "settingsobserver.h"
 
 class QSettings;
 
@@ -41,6 +42,20 @@ public:
     void setDataRole(LP::ScoreDataRole dataRole);
 
 private:
+    class ValueCache : public SettingsObserver
+    {
+    public:
+        ValueCache();
+        ~ValueCache();
+        void notify(Settings::Id id);
+
+        QHash<int, QVariant> values;
+    };
+
+    static ValueCache &valueCache();
+    static int cacheKey(Settings::Score::Area area, LP::ScoreDataRole dataRole, Settings::Score::Appearance appearance);
+    QVariant valueFromSettings(Settings::Score::Area area, LP::ScoreDataRole dataRole, Settings::Score::Appearance appearance);
+
     static QString getKey(Settings::Score::Area area, LP::ScoreDataRole dataRole, Settings::Score::Appearance appearance);
     static QVariant defaultValue(const QString& key);
     static QHash <QString, QVariant> m_defaultValues;
@@ -0,0 +1,539 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+/*!
+ * @class BwwImporter
+ * @brief Imports Bagpipe Music Writer (BWW) files.
+ *
+ * The file is read line by line and every token is added to the item tree right away,
+ * so there is no intermediate representation of the whole file. Scores, tunes, parts and
+ * measures are created when their first symbol arrives, bar lines close them again.
+ * A new title header after music starts a new score. All scores of a file are inserted
+ * into the model with one undo command.
+ *
+ * Melody notes, dots, doublings, ties, repeats and time signatures are imported. Other
+ * embellishments, rests and triplets have no symbol yet and are counted as skipped tokens.
+ */
+
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QIODevice>
+#include <QTextStream>
+#include <common/itemdataroles.h>
+#include <common/datatypes/instrument.h>
+#include <common/datatypes/length.h>
+#include <common/datatypes/pitchcontext.h>
+#include <plugins/GreatHighlandBagpipe/ghb_symboltypes.h>
+#include <utilities/tracer.h>
+#include "musicmodel.h"
+#include "score.h"
+#include "tune.h"
+#include "part.h"
+#include "measure.h"
+#include "symbol.h"
+#include "bwwimporter.h"
+
+namespace {
+const int MaxLength = 64;
+
+struct BwwPitch {
+    const char *bwwName;
+    const char *pitchName;
+};
+
+const BwwPitch BwwPitches[] = {
+    { "LG", "Low G" },
+    { "LA", "Low A" },
+    { "B",  "B" },
+    { "C",  "C" },
+    { "D",  "D" },
+    { "E",  "E" },
+    { "F",  "F" },
+    { "HG", "High G" },
+    { "HA", "High A" }
+};
+}
+
+BwwImporter::BwwImporter(const PluginManager &pluginManager)
+    : m_pluginManager(pluginManager),
+      m_instrumentType(LP::GreatHighlandBagpipe),
+      m_score(0),
+      m_tune(0),
+      m_part(0),
+      m_measure(0),
+      m_lastNote(0),
+      m_inStaff(false),
+      m_repeatPending(false),
+      m_tieOpen(false),
+      m_tieEndPending(false),
+      m_noteCount(0),
+      m_skippedTokenCount(0)
+{
+    if (m_pluginManager.isNull())
+        return;
+
+    PitchContextPtr pitchContext = m_pluginManager->instrumentMetaData(m_instrumentType).pitchContext();
+    if (pitchContext.isNull())
+        return;
+
+    for (uint i = 0; i < sizeof(BwwPitches) / sizeof(BwwPitches[0]); ++i) {
+        QString bwwName(QLatin1String(BwwPitches[i].bwwName));
+        m_pitches.insert(bwwName, pitchContext->pitchForName(QLatin1String(BwwPitches[i].pitchName)));
+
+        // Doublings, thumb doublings and half doublings
+        QString lowerName(bwwName.toLower());
+        m_doublings << QStringLiteral("db") + lowerName
+                    << QStringLiteral("tdb") + lowerName
+                    << QStringLiteral("hdb") + lowerName;
+    }
+}
+
+/*!
+ * \brief BwwImporter::readScores Reads all scores from the device. The caller takes ownership
+ *        of the returned items.
+ */
+QList<MusicItem *> BwwImporter::readScores(QIODevice *device)
+{
+    LP_TRACE_SCOPE("BwwImporter::readScores");
+
+    m_scores.clear();
+    m_score = 0;
+    m_tune = 0;
+    m_part = 0;
+    m_measure = 0;
+    m_lastNote = 0;
+    m_timeSignature = TimeSignature();
+    m_inStaff = false;
+    m_repeatPending = false;
+    m_tieOpen = false;
+    m_tieEndPending = false;
+    m_noteCount = 0;
+    m_skippedTokenCount = 0;
+
+    if (m_pitches.isEmpty()) {
+        qWarning() << "BwwImporter: Great Highland Bagpipe plugin isn't loaded";
+        return m_scores;
+    }
+
+    if (!device || !device->isReadable()) {
+        qWarning() << "BwwImporter: Device isn't readable";
+        return m_scores;
+    }
+
+    QTextStream stream(device);
+    while (!stream.atEnd()) {
+        QString line(stream.readLine());
+        if (line.startsWith(QLatin1Char('"'))) {
+            readHeaderLine(line);
+            continue;
+        }
+
+        int position = 0;
+        int lineLength = line.length();
+        while (position < lineLength) {
+            while (position < lineLength && line.at(position).isSpace())
+                position++;
+
+            int tokenStart = position;
+            while (position < lineLength && !line.at(position).isSpace())
+                position++;
+
+            if (position == tokenStart)
+                break;
+
+            QString token(line.mid(tokenStart, position - tokenStart));
+            if (token == QLatin1String("&")) {
+                m_inStaff = true;
+                continue;
+            }
+
+            // Lines before the first staff are settings like MIDINoteMappings
+            if (!m_inStaff)
+                break;
+
+            readToken(token);
+        }
+    }
+    finishScore();
+
+    QList<MusicItem*> scores(m_scores);
+    m_scores.clear();
+    return scores;
+}
+
+/*!
+ * \brief BwwImporter::importFile Reads the BWW file and inserts its scores at row into
+ *        the model with one undo command. Scores without title are named after the file.
+ * \return The index of the first score or an invalid index, if nothing was imported.
+ */
+QModelIndex BwwImporter::importFile(MusicModel *model, const QString &fileName, int row)
+{
+    if (!model)
+        return QModelIndex();
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qWarning() << "BwwImporter: Can't open " << fileName << file.errorString();
+        return QModelIndex();
+    }
+
+    QList<MusicItem*> scores = readScores(&file);
+    if (scores.isEmpty()) {
+        qWarning() << "BwwImporter: No tunes in " << fileName;
+        return QModelIndex();
+    }
+
+    foreach (MusicItem *score, scores) {
+        if (score->data(LP::ScoreTitle).toString().isEmpty())
+            score->setData(QFileInfo(fileName).completeBaseName(), LP::ScoreTitle);
+    }
+
+    QModelIndex firstScore = model->insertScores(row, scores);
+    if (!firstScore.isValid())
+        qDeleteAll(scores);
+
+    return firstScore;
+}
+
+/*!
+ * \brief BwwImporter::noteCount Returns the number of melody notes of the last read file.
+ */
+int BwwImporter::noteCount() const
+{
+    return m_noteCount;
+}
+
+/*!
+ * \brief BwwImporter::skippedTokenCount Returns the number of tokens of the last read file,
+ *        which couldn't be mapped onto a symbol.
+ */
+int BwwImporter::skippedTokenCount() const
+{
+    return m_skippedTokenCount;
+}
+
+/*!
+ * \brief BwwImporter::readHeaderLine Reads lines like "Title",(T,L,0,0,Times New Roman,...)
+ */
+void BwwImporter::readHeaderLine(const QString &line)
+{
+    int textEnd = line.indexOf(QLatin1Char('"'), 1);
+    if (textEnd == -1 || line.midRef(textEnd, 3) != QLatin1String("\",("))
+        return;
+
+    QString text(line.mid(1, textEnd - 1));
+    QChar type(line.at(qMin(textEnd + 3, line.length() - 1)));
+    int role = -1;
+    if (type == QLatin1Char('T'))
+        role = LP::ScoreTitle;
+    else if (type == QLatin1Char('Y'))
+        role = LP::ScoreType;
+    else if (type == QLatin1Char('M'))
+        role = LP::ScoreComposer;
+
+    if (role == -1 || text.isEmpty())
+        return;
+
+    if (role == LP::ScoreTitle && m_score && m_score->hasChildren())
+        finishScore();
+
+    if (!m_score)
+        startScore();
+
+    m_score->setData(text, role);
+}
+
+void BwwImporter::readToken(const QString &token)
+{
+    if (readBarLine(token) ||
+            readTimeSignature(token) ||
+            readMelodyNote(token) ||
+            readDots(token) ||
+            readTie(token))
+        return;
+
+    if (m_doublings.contains(token)) {
+        appendSymbol(createSymbol(GHB::Doubling));
+        return;
+    }
+
+    m_skippedTokenCount++;
+}
+
+bool BwwImporter::readBarLine(const QString &token)
+{
+    if (token == QLatin1String("!") || token == QLatin1String("!t")) {
+        finishMeasure();
+    } else if (token == QLatin1String("I!''")) {
+        finishPart();
+        m_repeatPending = true;
+    } else if (token == QLatin1String("I!")) {
+        finishPart();
+    } else if (token == QLatin1String("''!I")) {
+        if (m_part)
+            m_part->setData(true, LP::PartRepeat);
+        finishPart();
+    } else if (token == QLatin1String("!I")) {
+        finishPart();
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool BwwImporter::readTimeSignature(const QString &token)
+{
+    TimeSignature timeSignature;
+    if (token == QLatin1String("C")) {
+        timeSignature.setSignature(TimeSignature::_4_4);
+    } else if (token == QLatin1String("C_")) {
+        timeSignature.setSignature(TimeSignature::_2_2);
+    } else {
+        int separator = token.indexOf(QLatin1Char('_'));
+        if (separator == -1)
+            return false;
+
+        bool beatCountOk = false;
+        bool beatUnitOk = false;
+        int beatCount = token.left(separator).toInt(&beatCountOk);
+        int beatUnit = token.mid(separator + 1).toInt(&beatUnitOk);
+        if (!beatCountOk || !beatUnitOk)
+            return false;
+
+        timeSignature.setSignature(beatCount, beatUnit);
+    }
+
+    if (!timeSignature.isValid())
+        return false;
+
+    m_timeSignature = timeSignature;
+    QVariant timeSignatureData(QVariant::fromValue<TimeSignature>(m_timeSignature));
+    if (m_tune && !m_tune->hasChildren())
+        m_tune->setData(timeSignatureData, LP::TuneTimeSignature);
+    if (m_measure && !m_measure->hasChildren())
+        m_measure->setData(timeSignatureData, LP::MeasureTimeSignature);
+
+    return true;
+}
+
+/*!
+ * \brief BwwImporter::readMelodyNote Reads notes like LA_4 or HGr_16. The r and l suffixes
+ *        of beamed notes are ignored, beams follow from the lengths.
+ */
+bool BwwImporter::readMelodyNote(const QString &token)
+{
+    if (!token.at(0).isUpper())
+        return false;
+
+    int separator = token.indexOf(QLatin1Char('_'));
+    if (separator < 1)
+        return false;
+
+    QString pitchName(token.left(separator));
+    if (pitchName.length() > 1 &&
+            (pitchName.endsWith(QLatin1Char('r')) || pitchName.endsWith(QLatin1Char('l'))))
+        pitchName.chop(1);
+
+    QHash<QString, Pitch>::const_iterator pitch = m_pitches.constFind(pitchName);
+    if (pitch == m_pitches.constEnd())
+        return false;
+
+    bool ok = false;
+    int length = token.mid(separator + 1).toInt(&ok);
+    if (!ok || length < 1 || length > MaxLength || (length & (length - 1)))
+        return false;
+
+    MusicItem *note = createSymbol(LP::MelodyNote);
+    if (!note)
+        return true;
+
+    note->setData(QVariant::fromValue<Pitch>(pitch.value()), LP::SymbolPitch);
+    note->setData(QVariant::fromValue<Length::Value>(static_cast<Length::Value>(length)),
+                  LP::SymbolLength);
+    appendSymbol(note);
+    m_lastNote = note;
+    m_noteCount++;
+
+    if (m_tieEndPending) {
+        appendSymbol(createTie(SpanType::End));
+        m_tieEndPending = false;
+        m_tieOpen = false;
+    }
+
+    return true;
+}
+
+/*!
+ * \brief BwwImporter::readDots Reads dots like 'la or ''la, which follow their note.
+ */
+bool BwwImporter::readDots(const QString &token)
+{
+    int dots = 0;
+    while (dots < token.length() && token.at(dots) == QLatin1Char('\''))
+        dots++;
+
+    if (!dots || !m_pitches.contains(token.mid(dots).toUpper()))
+        return false;
+
+    if (m_lastNote)
+        m_lastNote->setData(dots, LP::MelodyNoteDots);
+
+    return true;
+}
+
+/*!
+ * \brief BwwImporter::readTie Reads ties in the old format ^ts ... ^te around the notes and
+ *        in the new format ^tla after the first note.
+ */
+bool BwwImporter::readTie(const QString &token)
+{
+    if (!token.startsWith(QLatin1String("^t")))
+        return false;
+
+    // ^te is the end of an old tie or a new tie on E
+    if (token == QLatin1String("^ts")) {
+        appendSymbol(createTie(SpanType::Start));
+        m_tieOpen = true;
+    } else if (token == QLatin1String("^te") && m_tieOpen && !m_tieEndPending) {
+        appendSymbol(createTie(SpanType::End));
+        m_tieOpen = false;
+    } else if (m_pitches.contains(token.mid(2).toUpper())) {
+        if (!m_lastNote || m_tieOpen)
+            return true;
+
+        MusicItem *tieStart = createTie(SpanType::Start);
+        if (!tieStart)
+            return true;
+
+        MusicItem *measure = m_lastNote->parent();
+        measure->insertChild(measure->rowOfChild(m_lastNote), tieStart);
+        m_tieOpen = true;
+        m_tieEndPending = true;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void BwwImporter::startScore()
+{
+    m_score = new Score();
+}
+
+void BwwImporter::finishScore()
+{
+    finishPart();
+
+    if (m_score) {
+        if (m_score->hasChildren())
+            m_scores << m_score;
+        else
+            delete m_score;
+    }
+
+    m_score = 0;
+    m_tune = 0;
+    m_timeSignature = TimeSignature();
+    m_inStaff = false;
+    m_repeatPending = false;
+}
+
+MusicItem *BwwImporter::currentTune()
+{
+    if (!m_tune) {
+        if (!m_score)
+            startScore();
+
+        m_tune = new Tune(m_instrumentType);
+        if (m_timeSignature.isValid())
+            m_tune->setData(QVariant::fromValue<TimeSignature>(m_timeSignature), LP::TuneTimeSignature);
+        m_score->addChild(m_tune);
+    }
+    return m_tune;
+}
+
+MusicItem *BwwImporter::currentPart()
+{
+    if (!m_part) {
+        InstrumentMetaData metaData = m_pluginManager->instrumentMetaData(m_instrumentType);
+        Part *part = new Part();
+        part->setStaffType(metaData.staffType());
+        part->setClefType(metaData.defaultClef());
+        if (m_repeatPending)
+            part->setData(true, LP::PartRepeat);
+
+        m_part = part;
+        m_repeatPending = false;
+        currentTune()->addChild(m_part);
+    }
+    return m_part;
+}
+
+MusicItem *BwwImporter::currentMeasure()
+{
+    if (!m_measure) {
+        m_measure = new Measure(m_pluginManager);
+        if (m_timeSignature.isValid())
+            m_measure->setData(QVariant::fromValue<TimeSignature>(m_timeSignature), LP::MeasureTimeSignature);
+        currentPart()->addChild(m_measure);
+    }
+    return m_measure;
+}
+
+void BwwImporter::finishMeasure()
+{
+    m_measure = 0;
+}
+
+/*!
+ * \brief BwwImporter::finishPart Closes the current part. A tie must not be left open at
+ *        the end of the part.
+ */
+void BwwImporter::finishPart()
+{
+    if (m_tieOpen && m_lastNote) {
+        MusicItem *tieEnd = createTie(SpanType::End);
+        if (tieEnd)
+            m_lastNote->parent()->addChild(tieEnd);
+    }
+
+    m_tieOpen = false;
+    m_tieEndPending = false;
+    m_lastNote = 0;
+    m_measure = 0;
+    m_part = 0;
+}
+
+void BwwImporter::appendSymbol(MusicItem *symbol)
+{
+    if (symbol)
+        currentMeasure()->addChild(symbol);
+}
+
+MusicItem *BwwImporter::createSymbol(int symbolType)
+{
+    SymbolBehavior *behavior = m_pluginManager->symbolBehaviorForType(symbolType);
+    if (!behavior) {
+        qWarning() << "BwwImporter: PluginManager returned 0 for symbol type " << symbolType;
+        return 0;
+    }
+
+    Symbol *symbol = new Symbol();
+    symbol->setSymbolBehavior(behavior);
+    symbol->setData(m_instrumentType, LP::SymbolInstrument);
+    return symbol;
+}
+
+MusicItem *BwwImporter::createTie(SpanType spanType)
+{
+    MusicItem *tie = createSymbol(LP::Tie);
+    if (tie)
+        tie->setData(QVariant::fromValue<SpanType>(spanType), LP::SymbolSpanType);
+    return tie;
+}
@@ -0,0 +1,78 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#ifndef BWWIMPORTER_H
+#define BWWIMPORTER_H
+
+#include <QHash>
+#include <QList>
+#include <QModelIndex>
+#include <QSet>
+#include <QString>
+#include <common/defines.h>
+#include <common/pluginmanagerinterface.h>
+#include <common/datatypes/pitch.h>
+#include <common/datatypes/timesignature.h>
+
+class QIODevice;
+class MusicItem;
+class MusicModel;
+
+class BwwImporter
+{
+public:
+    explicit BwwImporter(const PluginManager &pluginManager);
+
+    QList<MusicItem*> readScores(QIODevice *device);
+    QModelIndex importFile(MusicModel *model, const QString &fileName, int row);
+
+    int noteCount() const;
+    int skippedTokenCount() const;
+
+private:
+    void readHeaderLine(const QString &line);
+    void readToken(const QString &token);
+    bool readBarLine(const QString &token);
+    bool readTimeSignature(const QString &token);
+    bool readMelodyNote(const QString &token);
+    bool readDots(const QString &token);
+    bool readTie(const QString &token);
+
+    void startScore();
+    void finishScore();
+    MusicItem *currentTune();
+    MusicItem *currentPart();
+    MusicItem *currentMeasure();
+    void finishMeasure();
+    void finishPart();
+    void appendSymbol(MusicItem *symbol);
+    MusicItem *createSymbol(int symbolType);
+    MusicItem *createTie(SpanType spanType);
+
+    PluginManager m_pluginManager;
+    int m_instrumentType;
+    QHash<QString, Pitch> m_pitches;
+    QSet<QString> m_doublings;
+
+    // State of the file being read
+    QList<MusicItem*> m_scores;
+    MusicItem *m_score;
+    MusicItem *m_tune;
+    MusicItem *m_part;
+    MusicItem *m_measure;
+    MusicItem *m_lastNote;
+    TimeSignature m_timeSignature;
+    bool m_inStaff;
+    bool m_repeatPending;
+    bool m_tieOpen;
+    bool m_tieEndPending;   // A tie in the new format ends after the next note
+    int m_noteCount;
+    int m_skippedTokenCount;
+};
+
+#endif // BWWIMPORTER_H
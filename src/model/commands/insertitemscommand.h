@@ -9,55 +9,30 @@
 #ifndef INSERTITEMSCOMMAND_H
 #define INSERTITEMSCOMMAND_H
 
-#include <QAbstractItemModel>
 #include <QList>
 #include <QModelIndex>
-#include <QUndoCommand>
 #include <musicitem.h>
 #include <musicmodel.h>
+#include "itemscommand.h"
 
-class InsertItemsCommand : public QUndoCommand
+class InsertItemsCommand : public ItemsCommand
 {
 public:
     InsertItemsCommand(MusicModel *model, const QString &text, const QModelIndex &parentIndex, int row, const QList<MusicItem*> &items, QUndoCommand *parent = 0)
-        : QUndoCommand(text, parent), m_model(model), m_row(row), m_items(items)
+        : ItemsCommand(model, text, parentIndex, row, parent)
     {
-        Q_ASSERT(m_row >= 0);
-        Q_ASSERT(m_items.count());
-        m_parentItem = m_model->itemForIndex(parentIndex);
+        Q_ASSERT(row >= 0);
+        Q_ASSERT(items.count());
+        setItems(items);
     }
 
     void redo() {
-        Q_ASSERT(m_items.count());
-        Q_ASSERT(m_parentItem->childType() == m_items.at(0)->type());
-
-        QListIterator<MusicItem*> i(m_items);
-        i.toBack();
-
-        m_model->beginInsertRows(m_model->indexForItem(m_parentItem), m_row, m_row + m_items.count() - 1);
-        while (i.hasPrevious()) {
-            MusicItem *newItem = i.previous();
-            m_parentItem->insertChild(m_row, newItem);
-        }
-        m_model->endInsertRows();
+        insertItems();
     }
 
     void undo() {
-        Q_ASSERT(m_parentItem->childCount() >= m_row + m_items.count());
-        m_model->beginRemoveRows(m_model->indexForItem(m_parentItem), m_row, m_row + m_items.count() - 1);
-        for (int i = 0; i < m_items.count(); ++i) {
-            MusicItem *takenChild = m_parentItem->takeChild(m_row);
-            Q_ASSERT(m_items.at(i) == takenChild);
-            Q_UNUSED(takenChild)
-        }
-        m_model->endRemoveRows();
+        takeItems(itemCount());
     }
-
-private:
-    MusicModel *m_model;
-    int m_row;
-    MusicItem *m_parentItem;
-    QList<MusicItem*> m_items;
 };
 
 #endif // INSERTITEMSCOMMAND_H
@@ -0,0 +1,276 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+/*!
+ * @class ItemsCommand
+ * @brief Base class of the undo commands which insert or remove music items.
+ *
+ * While the items of a command aren't in the model, the command owns them. To save memory
+ * the items can be compacted into compressed json with compact. The compact form can be
+ * moved into the spill file of the model with spill. The items are read back from the
+ * compact form when they are inserted into the model again.
+ *
+ * The memory cost is computed, when the items are taken, compacted or spilled. Every change
+ * is reported to the model, which keeps the total of all commands. The owned items are
+ * counted in the MemoryAccounting by their own layers, so the exclusive memory cost, which
+ * the model reports for the undo stack, is only the command and its compact items.
+ *
+ * The parent item is stored as the rows from the root item, because the parent can be
+ * an item which was compacted by another command and read back as a new item.
+ */
+
+#include <QDebug>
+#include <QIODevice>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <common/datahandling/mimedata.h>
+#include <utilities/tracer.h>
+#include <musicitem.h>
+#include <musicmodel.h>
+
+#include "itemscommand.h"
+
+ItemsCommand::ItemsCommand(MusicModel *model, const QString &text, const QModelIndex &parentIndex, int row, QUndoCommand *parent)
+    : QUndoCommand(text, parent),
+      m_model(model),
+      m_row(row),
+      m_itemCount(0),
+      m_itemsAreInModel(false),
+      m_itemsCost(0),
+      m_memoryCost(sizeof(ItemsCommand)),
+      m_exclusiveCost(sizeof(ItemsCommand)),
+      m_spillDevice(0),
+      m_spillPosition(-1),
+      m_spillSize(0)
+{
+    MusicItem *item = m_model->itemForIndex(parentIndex);
+    while (item && item->parent()) {
+        m_parentRows.prepend(item->parent()->rowOfChild(item));
+        item = item->parent();
+    }
+
+    m_model->registerItemsCommand(this);
+}
+
+ItemsCommand::~ItemsCommand()
+{
+    releaseSpilledItems();
+    m_model->unregisterItemsCommand(this);
+
+    if (!m_itemsAreInModel)
+        qDeleteAll(m_items);
+}
+
+/*!
+ * \brief ItemsCommand::memoryCost Returns the approximate number of bytes, this command keeps
+ *        in memory. Items in the model and spilled items don't count.
+ */
+qint64 ItemsCommand::memoryCost() const
+{
+    return m_memoryCost;
+}
+
+/*!
+ * \brief ItemsCommand::exclusiveMemoryCost Returns the number of bytes of the memory cost,
+ *        which aren't counted for the music items and their behaviors.
+ */
+qint64 ItemsCommand::exclusiveMemoryCost() const
+{
+    return m_exclusiveCost;
+}
+
+/*!
+ * \brief ItemsCommand::compact Replaces the items owned by this command with their compressed
+ *        json. Returns false, if there was nothing to compact.
+ */
+bool ItemsCommand::compact()
+{
+    if (m_itemsAreInModel || m_items.isEmpty())
+        return false;
+
+    QJsonArray jsonArray;
+    foreach (const MusicItem *item, m_items) {
+        jsonArray.append(item->toJson());
+    }
+
+    m_compactItems = MimeData::encode(jsonArray);
+    qDeleteAll(m_items);
+    m_items.clear();
+    m_itemsCost = 0;
+    updateMemoryCost();
+    return true;
+}
+
+/*!
+ * \brief ItemsCommand::spill Writes the compact items into the spill file of the model and
+ *        releases them from memory. Their space in the file is released, when the items are
+ *        read back or the command is deleted.
+ */
+bool ItemsCommand::spill()
+{
+    if (m_compactItems.isEmpty())
+        return false;
+
+    QIODevice *device = m_model->undoSpillDevice();
+    if (!device)
+        return false;
+
+    qint64 size = m_compactItems.size();
+    qint64 position = m_model->allocateUndoSpillSpace(size);
+    if (!device->seek(position) ||
+            device->write(m_compactItems) != size) {
+        qWarning() << "ItemsCommand: Can't spill items: " << device->errorString();
+        m_model->releaseUndoSpillSpace(position, size);
+        return false;
+    }
+
+    m_spillDevice = device;
+    m_spillPosition = position;
+    m_spillSize = size;
+    m_compactItems.clear();
+    updateMemoryCost();
+    return true;
+}
+
+void ItemsCommand::insertItems()
+{
+    LP_TRACE_SCOPE("ItemsCommand::insertItems");
+    if (!restoreItems())
+        return;
+
+    MusicItem *parent = parentItem();
+    Q_ASSERT(parent);
+    Q_ASSERT(m_items.count());
+    Q_ASSERT(parent->childType() == m_items.at(0)->type());
+
+    m_model->beginInsertRows(m_model->indexForItem(parent), m_row, m_row + m_items.count() - 1);
+    for (int i = m_items.count() - 1; i >= 0; --i) {
+        parent->insertChild(m_row, m_items.at(i));
+    }
+    m_model->endInsertRows();
+
+    m_itemsAreInModel = true;
+    m_items.clear();
+    m_itemsCost = 0;
+    updateMemoryCost();
+}
+
+void ItemsCommand::takeItems(int count)
+{
+    LP_TRACE_SCOPE("ItemsCommand::takeItems");
+    MusicItem *parent = parentItem();
+    Q_ASSERT(parent);
+    Q_ASSERT(parent->childCount() >= m_row + count);
+
+    m_model->beginRemoveRows(m_model->indexForItem(parent), m_row, m_row + count - 1);
+    for (int i = 0; i < count; ++i) {
+        MusicItem *item = parent->takeChild(m_row);
+        m_itemsCost += m_model->memoryUsageOfItem(item);
+        m_items.append(item);
+    }
+    m_model->endRemoveRows();
+
+    m_itemCount = count;
+    m_itemsAreInModel = false;
+    updateMemoryCost();
+}
+
+/*!
+ * \brief ItemsCommand::setItems Sets the items which aren't in the model yet. The command
+ *        takes the ownership of the items.
+ */
+void ItemsCommand::setItems(const QList<MusicItem *> &items)
+{
+    m_items = items;
+    m_itemCount = items.count();
+    m_itemsAreInModel = false;
+
+    m_itemsCost = 0;
+    foreach (const MusicItem *item, m_items) {
+        m_itemsCost += m_model->memoryUsageOfItem(item);
+    }
+    updateMemoryCost();
+}
+
+int ItemsCommand::itemCount() const
+{
+    return m_itemCount;
+}
+
+MusicItem *ItemsCommand::parentItem() const
+{
+    MusicItem *item = m_model->itemForIndex(QModelIndex());
+    foreach (int row, m_parentRows) {
+        if (!item)
+            break;
+        item = item->childAt(row);
+    }
+    return item;
+}
+
+bool ItemsCommand::restoreItems()
+{
+    if (m_items.count())
+        return true;
+
+    if (m_spillDevice) {
+        if (!m_spillDevice->seek(m_spillPosition)) {
+            qWarning() << "ItemsCommand: Can't read spilled items: " << m_spillDevice->errorString();
+            return false;
+        }
+        m_compactItems = m_spillDevice->read(m_spillSize);
+        releaseSpilledItems();
+    }
+
+    QJsonArray jsonArray = MimeData::decode(m_compactItems);
+    m_compactItems.clear();
+    foreach (const QJsonValue &value, jsonArray) {
+        if (MusicItem *item = m_model->itemFromJsonObject(value.toObject())) {
+            m_itemsCost += m_model->memoryUsageOfItem(item);
+            m_items.append(item);
+        }
+    }
+
+    if (m_items.count() != m_itemCount) {
+        qWarning() << "ItemsCommand: Can't restore compacted items";
+        qDeleteAll(m_items);
+        m_items.clear();
+        m_itemsCost = 0;
+        updateMemoryCost();
+        return false;
+    }
+    updateMemoryCost();
+    return true;
+}
+
+void ItemsCommand::releaseSpilledItems()
+{
+    if (!m_spillDevice)
+        return;
+
+    m_model->releaseUndoSpillSpace(m_spillPosition, m_spillSize);
+    m_spillDevice = 0;
+    m_spillPosition = -1;
+    m_spillSize = 0;
+}
+
+/*!
+ * \brief ItemsCommand::updateMemoryCost Reports the change of the memory cost to the model.
+ *        Items in the model and spilled items don't count.
+ */
+void ItemsCommand::updateMemoryCost()
+{
+    qint64 exclusiveCost = sizeof(ItemsCommand) + m_compactItems.size();
+    qint64 cost = exclusiveCost;
+    if (!m_itemsAreInModel)
+        cost += m_itemsCost;
+
+    m_model->addUndoMemoryUsage(cost - m_memoryCost, exclusiveCost - m_exclusiveCost);
+    m_memoryCost = cost;
+    m_exclusiveCost = exclusiveCost;
+}
@@ -0,0 +1,59 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#ifndef ITEMSCOMMAND_H
+#define ITEMSCOMMAND_H
+
+#include <QByteArray>
+#include <QList>
+#include <QModelIndex>
+#include <QUndoCommand>
+
+class QIODevice;
+class MusicItem;
+class MusicModel;
+
+class ItemsCommand : public QUndoCommand
+{
+public:
+    ItemsCommand(MusicModel *model, const QString &text, const QModelIndex &parentIndex, int row, QUndoCommand *parent = 0);
+    ~ItemsCommand();
+
+    qint64 memoryCost() const;
+    qint64 exclusiveMemoryCost() const;
+    bool compact();
+    bool spill();
+
+protected:
+    void insertItems();
+    void takeItems(int count);
+    void setItems(const QList<MusicItem*> &items);
+    int itemCount() const;
+
+private:
+    MusicItem *parentItem() const;
+    bool restoreItems();
+    void releaseSpilledItems();
+    void updateMemoryCost();
+
+    MusicModel *m_model;
+    QList<int> m_parentRows;    // Rows of the parent item and its ancestors from the root item
+    int m_row;
+    int m_itemCount;
+    bool m_itemsAreInModel;
+    QList<MusicItem*> m_items;  // Only valid if the items aren't in the model and not compacted
+    qint64 m_itemsCost;         // Memory usage of m_items
+    qint64 m_memoryCost;        // Last cost reported to the model
+    qint64 m_exclusiveCost;     // Last cost without the items reported to the model
+    QByteArray m_compactItems;
+    QIODevice *m_spillDevice;
+    qint64 m_spillPosition;
+    qint64 m_spillSize;
+};
+
+#endif // ITEMSCOMMAND_H
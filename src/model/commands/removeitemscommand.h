@@ -9,56 +9,30 @@
 #ifndef REMOVEITEMSCOMMAND_H
 #define REMOVEITEMSCOMMAND_H
 
-#include <QAbstractItemModel>
-#include <QList>
 #include <QModelIndex>
-#include <QUndoCommand>
 #include <musicitem.h>
 #include <musicmodel.h>
+#include "itemscommand.h"
 
-class RemoveItemsCommand : public QUndoCommand
+class RemoveItemsCommand : public ItemsCommand
 {
 public:
     RemoveItemsCommand(MusicModel *model, const QString &text, const QModelIndex &parentIndex, int row, int count, QUndoCommand *parent = 0)
-        : QUndoCommand(text, parent), m_model(model), m_row(row), m_removedItemCount(count), isFirstRemove(true)
+        : ItemsCommand(model, text, parentIndex, row, parent), m_removedItemCount(count)
     {
-        m_parentItem = m_model->itemForIndex(parentIndex);
         Q_ASSERT(m_removedItemCount > 0);
     }
 
     void redo() {
-        m_model->beginRemoveRows(m_model->indexForItem(m_parentItem), m_row, m_row + m_removedItemCount - 1);
-        for (int i = 0; i < m_removedItemCount; ++i) {
-            MusicItem *takenChild = m_parentItem->takeChild(m_row);
-
-            if (isFirstRemove)
-                m_removedItems.append(takenChild);
-        }
-        m_model->endRemoveRows();
-        isFirstRemove = false;
+        takeItems(m_removedItemCount);
     }
 
     void undo() {
-        Q_ASSERT(m_removedItemCount > 0);
-        m_model->beginInsertRows(m_model->indexForItem(m_parentItem), m_row, m_row + m_removedItemCount - 1);
-
-        QListIterator<MusicItem*> i(m_removedItems);
-        i.toBack();
-        while (i.hasPrevious()) {
-            MusicItem *undoItem = i.previous();
-            m_parentItem->insertChild(m_row, undoItem);
-        }
-
-        m_model->endInsertRows();
+        insertItems();
     }
 
 private:
-    MusicModel *m_model;
-    MusicItem *m_parentItem;
-    int m_row;
     int m_removedItemCount;
-    QList<MusicItem*> m_removedItems;
-    bool isFirstRemove;
 };
 
 #endif // REMOVEITEMSCOMMAND_H
@@ -33,6 +33,11 @@ void Measure::initItem()
     setItemBehavior(behavior);
 }
 
+Measure *Measure::clone() const
+{
+    return new Measure(*this);
+}
+
 bool Measure::itemSupportsWritingOfData(int role) const
 {
     if (LP::allMeasureDataRoles.contains(static_cast<LP::MeasureDataRole>(role)))
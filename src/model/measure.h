@@ -18,6 +18,8 @@ public:
     explicit Measure(MusicItem *parent = 0);
     explicit Measure(const PluginManager &pluginManager, MusicItem *parent=0);
 
+    Measure *clone() const;
+
     bool itemSupportsWritingOfData(int role) const;
     bool okToInsertChild(const MusicItem *item, int row);
 
@@ -17,6 +17,9 @@
   * @param item The item to be inserted.
   * @return True by default.
   *
+  * Copies of items, e.g. for pasting, are created with clone. A clone shares the data of
+  * all items of the subtree with the original items until one side changes it.
+  *
   * @fn void MusicItem::initData(const QVariant &value, int role)
   * @brief Subclasses can initialize read only data with this method.
   */
@@ -24,6 +27,7 @@
 #include <QDebug>
 #include <QJsonArray>
 #include <common/datahandling/datakeys.h>
+#include <utilities/memoryaccounting.h>
 
 #include "musicitem.h"
 
@@ -33,16 +37,47 @@ MusicItem::MusicItem(LP::ItemType type, LP::ItemType childType, MusicItem *paren
     : m_type(type), m_childType(childType), m_parent(parent),
       m_itemBehavior(0)
 {
+    MemoryAccounting::addInstance(MemoryAccounting::MusicItems, sizeof(MusicItem));
     if (m_parent)
         m_parent->addChild(this);
     else
         m_parent = 0;
 }
 
+/*!
+ * \brief MusicItem::MusicItem Copies the item with clones of its behavior and its children.
+ *        The copy has no parent.
+ */
+MusicItem::MusicItem(const MusicItem &other)
+    : m_type(other.m_type), m_childType(other.m_childType), m_parent(0),
+      m_itemBehavior(0)
+{
+    MemoryAccounting::addInstance(MemoryAccounting::MusicItems, sizeof(MusicItem));
+    if (other.m_itemBehavior)
+        m_itemBehavior = other.m_itemBehavior->clone();
+
+    foreach (const MusicItem *child, other.m_children) {
+        if (MusicItem *childClone = child->clone())
+            addChild(childClone);
+    }
+}
+
 MusicItem::~MusicItem()
 {
     qDeleteAll(m_children);
     delete m_itemBehavior;
+    MemoryAccounting::removeInstance(MemoryAccounting::MusicItems, sizeof(MusicItem));
+}
+
+/*!
+ * \brief MusicItem::clone Returns a copy of this item and all of its children without parent.
+ *        The copy shares the data with this item until one of them changes.
+ *        Subclasses have to reimplement clone to return a copy of their own type.
+ */
+MusicItem *MusicItem::clone() const
+{
+    qWarning() << "MusicItem: Can't clone item of type " << static_cast<int>(m_type);
+    return 0;
 }
 
 void MusicItem::setParent(MusicItem *parent)
@@ -26,6 +26,8 @@ public:
                        MusicItem *parent=0);
     virtual ~MusicItem();
 
+    virtual MusicItem *clone() const;
+
     LP::ItemType type() const { return m_type; }
     LP::ItemType childType() const { return m_childType; }
 
@@ -55,6 +57,7 @@ public:
     void setItemBehavior(ItemBehavior *itemBehavior);
 
 protected:
+    MusicItem(const MusicItem &other);
     void initData(const QVariant &value, int role) { writeData(value, role); }
     virtual void beforeWritingData(QVariant &value, int role);
     virtual void afterWritingData(int role);
@@ -80,6 +83,11 @@ public:
         m_childType = other.childType();
     }
     bool itemSupportsWritingOfData(int role) const { Q_UNUSED(role) return true; }
+    NullMusicItem *clone() const { return new NullMusicItem(*this); }
+
+private:
+    NullMusicItem(const NullMusicItem &other)
+        : MusicItem(other) {}
 };
 
 #endif // MUSICITEM_H
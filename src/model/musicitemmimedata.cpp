@@ -0,0 +1,80 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+/*!
+ * @class MusicItemMimeData
+ * @brief Mime data with clones of the dragged or copied music items.
+ *
+ * The clones are taken when the mime data is created, so later changes of the original
+ * items don't change the mime data. Every drop within the application clones the items
+ * again. All clones share the item data until one of them changes.
+ *
+ * The items are only converted to json, if the data of the mime type is requested,
+ * e.g. by another application through the clipboard.
+ */
+
+#include <QJsonArray>
+#include <common/datahandling/mimedata.h>
+#include "musicitem.h"
+#include "musicitemmimedata.h"
+
+MusicItemMimeData::MusicItemMimeData(const QString &mimeType, const QList<const MusicItem*> &items)
+    : m_mimeType(mimeType)
+{
+    foreach (const MusicItem *item, items) {
+        if (MusicItem *itemClone = item->clone())
+            m_items.append(itemClone);
+    }
+}
+
+MusicItemMimeData::~MusicItemMimeData()
+{
+    qDeleteAll(m_items);
+}
+
+/*!
+ * \brief MusicItemMimeData::cloneItems Returns new clones of the items. The caller takes
+ *        ownership of the items.
+ */
+QList<MusicItem*> MusicItemMimeData::cloneItems() const
+{
+    QList<MusicItem*> items;
+    foreach (const MusicItem *item, m_items) {
+        if (MusicItem *itemClone = item->clone())
+            items.append(itemClone);
+    }
+    return items;
+}
+
+QStringList MusicItemMimeData::formats() const
+{
+    return QStringList() << m_mimeType;
+}
+
+bool MusicItemMimeData::hasFormat(const QString &mimeType) const
+{
+    return mimeType == m_mimeType;
+}
+
+QVariant MusicItemMimeData::retrieveData(const QString &mimeType, QVariant::Type type) const
+{
+    Q_UNUSED(type);
+
+    if (mimeType != m_mimeType)
+        return QVariant();
+
+    if (m_encodedData.isEmpty()) {
+        QJsonArray jsonArray;
+        foreach (const MusicItem *item, m_items) {
+            jsonArray.append(item->toJson());
+        }
+        m_encodedData = MimeData::encode(jsonArray);
+    }
+
+    return m_encodedData;
+}
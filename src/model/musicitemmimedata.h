@@ -0,0 +1,40 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#ifndef MUSICITEMMIMEDATA_H
+#define MUSICITEMMIMEDATA_H
+
+#include <QMimeData>
+#include <QList>
+#include <QStringList>
+
+class MusicItem;
+
+class MusicItemMimeData : public QMimeData
+{
+    Q_OBJECT
+
+public:
+    explicit MusicItemMimeData(const QString &mimeType, const QList<const MusicItem*> &items);
+    ~MusicItemMimeData();
+
+    QList<MusicItem*> cloneItems() const;
+
+    QStringList formats() const;
+    bool hasFormat(const QString &mimeType) const;
+
+protected:
+    QVariant retrieveData(const QString &mimeType, QVariant::Type type) const;
+
+private:
+    QString m_mimeType;
+    QList<MusicItem*> m_items;
+    mutable QByteArray m_encodedData;
+};
+
+#endif // MUSICITEMMIMEDATA_H
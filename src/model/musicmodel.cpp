@@ -22,24 +22,29 @@
 #include <QPair>
 #include <QString>
 #include <QUndoStack>
+#include <QTemporaryFile>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QJsonDocument>
 
 #include <commands/insertitemscommand.h>
 #include <commands/removeitemscommand.h>
+#include <commands/itemscommand.h>
 #include <common/defines.h>
 #include <common/datatypes/timesignature.h>
 #include <common/datahandling/mimedata.h>
 #include <common/datahandling/datakeys.h>
 #include <common/datahandling/symbolbehavior.h>
 #include <utilities/error.h>
+#include <utilities/memoryaccounting.h>
+#include <utilities/tracer.h>
 
 #include "rootitem.h"
 #include "score.h"
 #include "tune.h"
 #include "part.h"
 #include "measure.h"
+#include "musicitemmimedata.h"
 #include "musicmodel.h"
 
 namespace {
@@ -70,17 +75,31 @@ QHash<LP::ItemType, QString> MusicModel::initItemTypeTags()
     return typeTags;
 }
 
+namespace {
+const qint64 DefaultUndoMemoryLimit = 64 * 1024 * 1024;
+}
+
 MusicModel::MusicModel(QObject *parent)
     : QAbstractItemModel(parent), m_rootItem(0), m_columnCount(1),
+      m_undoMemoryLimit(DefaultUndoMemoryLimit),
+      m_itemsCommandCount(0),
+      m_undoMemoryUsage(0),
+      m_undoExclusiveMemoryUsage(0),
+      m_undoSpillFile(0),
       m_dropMimeDataOccured(false),
       m_noDropOccured(false)
 {
     m_undoStack = new QUndoStack(this);
+    connect(m_undoStack, &QUndoStack::indexChanged,
+            this, &MusicModel::limitUndoMemory);
 }
 
 MusicModel::~MusicModel()
 {
+    // The commands unregister from this model
+    delete m_undoStack;
     delete m_rootItem;
+    MemoryAccounting::addBytes(MemoryAccounting::UndoStack, -m_undoExclusiveMemoryUsage);
 }
 
 Qt::ItemFlags MusicModel::flags(const QModelIndex &index) const
@@ -211,14 +230,21 @@ QMimeData *MusicModel::mimeData(const QModelIndexList &indexes) const
     if (!allModelIndexesHaveTheSameMusicItemType(indexes))
         return 0;
 
-    QJsonArray jsonArray;
+    QList<const MusicItem*> items;
     foreach (QModelIndex index, indexes) {
         if (MusicItem *item = itemForIndex(index)) {
-            jsonArray.append(item->toJson());
+            items.append(item);
         }
     }
 
-    return MimeData::fromJsonArray(jsonArray);
+    if (items.isEmpty())
+        return 0;
+
+    QString mimeType = MimeData::mimeTypeForItemType(items.first()->type());
+    if (mimeType.isEmpty())
+        return 0;
+
+    return new MusicItemMimeData(mimeType, items);
 }
 
 bool MusicModel::allModelIndexesHaveTheSameMusicItemType(const QModelIndexList &indexes) const
@@ -289,14 +315,22 @@ bool MusicModel::dropMimeData(const QMimeData *mimeData, Qt::DropAction action,
 
         NullMusicItem tempParentItem(*parentItem);
 
-        QJsonArray jsonArray = MimeData::toJsonArray(mimeData);
-        foreach (const QJsonValue &value, jsonArray) {
-            QJsonObject json = value.toObject();
-            if (json.isEmpty())
-                continue;
-
-            MusicItem *item = itemFromJsonObject(json);
-            tempParentItem.addChild(item);
+        // Items from within the application are cloned instead of being read from json
+        const MusicItemMimeData *itemMimeData = qobject_cast<const MusicItemMimeData*>(mimeData);
+        if (itemMimeData) {
+            foreach (MusicItem *item, itemMimeData->cloneItems()) {
+                tempParentItem.addChild(item);
+            }
+        } else {
+            QJsonArray jsonArray = MimeData::toJsonArray(mimeData);
+            foreach (const QJsonValue &value, jsonArray) {
+                QJsonObject json = value.toObject();
+                if (json.isEmpty())
+                    continue;
+
+                MusicItem *item = itemFromJsonObject(json);
+                tempParentItem.addChild(item);
+            }
         }
 
         if (!tempParentItem.childCount())
@@ -340,7 +374,7 @@ MusicItem *MusicModel::itemFromJsonObject(const QJsonObject &json)
         break;
     }
     case LP::ItemType::MeasureType: {
-        Measure *measure = new Measure;
+        Measure *measure = new Measure(m_pluginManager);
         measure->fromJson(json);
         item = measure;
         break;
@@ -384,7 +418,7 @@ MusicItem *MusicModel::itemFromJsonObject(const QJsonObject &json)
             continue;
 
         MusicItem *childItem = itemFromJsonObject(childObject);
-        if (childItem)
+        if (!childItem)
             continue;
 
         item->addChild(childItem);
@@ -497,19 +531,21 @@ QModelIndex MusicModel::insertTuneIntoScore(int row, const QModelIndex &score, c
         return QModelIndex();
     }
 
-    QList<int> instrumentTypes = m_pluginManager->instrumentTypes();
-    int tuneInstrument = LP::NoInstrument;
-    foreach (const int instrumentType, instrumentTypes) {
-        if (m_pluginManager->instrumentMetaData(instrumentType).name() ==
-                instrumentName) {
-            tuneInstrument = instrumentType;
-        }
-    }
+    int instrumentType = m_pluginManager->instrumentTypeForName(instrumentName);
+    return insertTuneIntoScore(row, score, instrumentType);
+}
 
-    if (tuneInstrument == LP::NoInstrument)
+/*!
+ * \brief MusicModel::insertTuneIntoScore Inserts a tune for the instrument with instrumentType.
+ *        Use this method instead of the one with the instrument name, if the type is known
+ *        e.g. while importing many tunes.
+ */
+QModelIndex MusicModel::insertTuneIntoScore(int row, const QModelIndex &score, int instrumentType)
+{
+    if (instrumentType == LP::NoInstrument)
         return QModelIndex();
 
-    return insertItem("Insert tune into score", score, row, new Tune(tuneInstrument));
+    return insertItem("Insert tune into score", score, row, new Tune(instrumentType));
 }
 
 QModelIndex MusicModel::appendTuneToScore(const QModelIndex &score, const QString &instrumentName)
@@ -520,11 +556,30 @@ QModelIndex MusicModel::appendTuneToScore(const QModelIndex &score, const QStrin
     return QModelIndex();
 }
 
+QModelIndex MusicModel::appendTuneToScore(const QModelIndex &score, int instrumentType)
+{
+    if (MusicItem *item = itemForIndex(score)) {
+        return insertTuneIntoScore(item->childCount(), score, instrumentType);
+    }
+    return QModelIndex();
+}
+
 QModelIndex MusicModel::insertTuneWithScore(int rowOfScore, const QString &scoreTitle, const QString &instrumentName)
+{
+    if (m_pluginManager.isNull()) {
+        qWarning("No plugin manager installed. Can't insert tune with score.");
+        return QModelIndex();
+    }
+
+    int instrumentType = m_pluginManager->instrumentTypeForName(instrumentName);
+    return insertTuneWithScore(rowOfScore, scoreTitle, instrumentType);
+}
+
+QModelIndex MusicModel::insertTuneWithScore(int rowOfScore, const QString &scoreTitle, int instrumentType)
 {
     m_undoStack->beginMacro(tr("Insert tune with score"));
     QModelIndex score = insertScore(rowOfScore, scoreTitle);
-    QModelIndex tune = insertTuneIntoScore(0, score, instrumentName);
+    QModelIndex tune = insertTuneIntoScore(0, score, instrumentType);
     m_undoStack->endMacro();
     return tune;
 }
@@ -694,6 +749,27 @@ MusicItem *MusicModel::itemForIndex(const QModelIndex &index) const
     return m_rootItem;
 }
 
+/*!
+ * \brief MusicModel::insertScores Inserts complete scores with all their children at row
+ *        with one undo command. The model takes ownership of the scores, if they were inserted.
+ * \return The index of the first score or an invalid index.
+ */
+QModelIndex MusicModel::insertScores(int row, const QList<MusicItem *> &scores)
+{
+    createRootItemIfNotPresent();
+    if (scores.isEmpty())
+        return QModelIndex();
+
+    foreach (const MusicItem *score, scores) {
+        if (score->type() != ItemType::ScoreType) {
+            qWarning() << "MusicModel: Can't insert scores, at least one item isn't a score";
+            return QModelIndex();
+        }
+    }
+
+    return insertItems(tr("Insert %n score(s)", "", scores.count()), QModelIndex(), row, scores);
+}
+
 QModelIndex MusicModel::indexForItem(MusicItem *item) const
 {
     MusicItem *itemPtr = item;
@@ -710,6 +786,177 @@ QModelIndex MusicModel::indexForItem(MusicItem *item) const
     return indexOfItem;
 }
 
+qint64 MusicModel::undoMemoryLimit() const
+{
+    return m_undoMemoryLimit;
+}
+
+/*!
+ * \brief MusicModel::setUndoMemoryLimit Sets the approximate number of bytes the undo commands
+ *        can keep in memory. If the limit is exceeded, the items of the oldest commands are
+ *        compacted and then moved into a temporary file. A limit of 0 disables this.
+ */
+void MusicModel::setUndoMemoryLimit(qint64 bytes)
+{
+    if (bytes < 0 || bytes == m_undoMemoryLimit)
+        return;
+
+    m_undoMemoryLimit = bytes;
+    limitUndoMemory();
+}
+
+/*!
+ * \brief MusicModel::undoMemoryUsage Returns the approximate number of bytes kept in memory
+ *        by all undo commands.
+ */
+qint64 MusicModel::undoMemoryUsage() const
+{
+    return m_undoMemoryUsage;
+}
+
+void MusicModel::registerItemsCommand(ItemsCommand *command)
+{
+    quint64 number = m_itemsCommandCount++;
+    m_itemsCommands.insert(number, command);
+    m_itemsCommandNumbers.insert(command, number);
+    addUndoMemoryUsage(command->memoryCost(), command->exclusiveMemoryCost());
+}
+
+void MusicModel::unregisterItemsCommand(ItemsCommand *command)
+{
+    m_itemsCommands.remove(m_itemsCommandNumbers.take(command));
+    addUndoMemoryUsage(-command->memoryCost(), -command->exclusiveMemoryCost());
+}
+
+void MusicModel::limitUndoMemory()
+{
+    if (!m_undoMemoryLimit || m_undoMemoryUsage <= m_undoMemoryLimit)
+        return;
+
+    foreach (ItemsCommand *command, m_itemsCommands) {
+        if (m_undoMemoryUsage <= m_undoMemoryLimit)
+            return;
+
+        command->compact();
+    }
+
+    foreach (ItemsCommand *command, m_itemsCommands) {
+        if (m_undoMemoryUsage <= m_undoMemoryLimit)
+            return;
+
+        command->spill();
+    }
+}
+
+/*!
+ * \brief MusicModel::addUndoMemoryUsage Adds the change of the memory cost of an items command
+ *        to the total. Only the exclusive bytes are added to the undo stack layer of the
+ *        MemoryAccounting, the items owned by the command are counted in their own layers.
+ */
+void MusicModel::addUndoMemoryUsage(qint64 bytes, qint64 exclusiveBytes)
+{
+    m_undoMemoryUsage += bytes;
+    m_undoExclusiveMemoryUsage += exclusiveBytes;
+    MemoryAccounting::addBytes(MemoryAccounting::UndoStack, exclusiveBytes);
+}
+
+/*!
+ * \brief MusicModel::undoSpillDevice Returns the temporary file for the spilled items of the
+ *        undo commands. The file is opened on first use.
+ */
+QIODevice *MusicModel::undoSpillDevice()
+{
+    if (!m_undoSpillFile) {
+        m_undoSpillFile = new QTemporaryFile(this);
+        if (!m_undoSpillFile->open()) {
+            qWarning() << "MusicModel: Can't open file for undo commands: "
+                       << m_undoSpillFile->errorString();
+            delete m_undoSpillFile;
+            m_undoSpillFile = 0;
+        }
+    }
+    return m_undoSpillFile;
+}
+
+/*!
+ * \brief MusicModel::allocateUndoSpillSpace Returns the position of size bytes in the spill
+ *        file. Space released by other commands is reused first.
+ */
+qint64 MusicModel::allocateUndoSpillSpace(qint64 size)
+{
+    QMap<qint64, qint64>::iterator it;
+    for (it = m_freeUndoSpillSpace.begin(); it != m_freeUndoSpillSpace.end(); ++it) {
+        if (it.value() < size)
+            continue;
+
+        qint64 position = it.key();
+        qint64 freeSize = it.value() - size;
+        m_freeUndoSpillSpace.erase(it);
+        if (freeSize)
+            m_freeUndoSpillSpace.insert(position + size, freeSize);
+        return position;
+    }
+
+    return m_undoSpillFile ? m_undoSpillFile->size() : 0;
+}
+
+/*!
+ * \brief MusicModel::releaseUndoSpillSpace Marks the space as unused. Unused space at the end
+ *        of the spill file is truncated.
+ */
+void MusicModel::releaseUndoSpillSpace(qint64 position, qint64 size)
+{
+    if (!m_undoSpillFile || size <= 0)
+        return;
+
+    // Merge with the adjacent unused space
+    QMap<qint64, qint64>::iterator next = m_freeUndoSpillSpace.find(position + size);
+    if (next != m_freeUndoSpillSpace.end()) {
+        size += next.value();
+        m_freeUndoSpillSpace.erase(next);
+    }
+    QMap<qint64, qint64>::iterator previous = m_freeUndoSpillSpace.lowerBound(position);
+    if (previous != m_freeUndoSpillSpace.begin()) {
+        --previous;
+        if (previous.key() + previous.value() == position) {
+            position = previous.key();
+            size += previous.value();
+            m_freeUndoSpillSpace.erase(previous);
+        }
+    }
+
+    if (position + size >= m_undoSpillFile->size()) {
+        m_undoSpillFile->resize(position);
+        return;
+    }
+    m_freeUndoSpillSpace.insert(position, size);
+}
+
+/*!
+ * \brief MusicModel::memoryUsage Returns the approximate number of bytes of the item at index
+ *        and all its children.
+ */
+qint64 MusicModel::memoryUsage(const QModelIndex &index) const
+{
+    MusicItem *item = itemForIndex(index);
+    if (!item)
+        return 0;
+
+    return memoryUsageOfItem(item);
+}
+
+qint64 MusicModel::memoryUsageOfItem(const MusicItem *item) const
+{
+    qint64 usage = sizeof(MusicItem);
+    if (item->itemBehavior())
+        usage += item->itemBehavior()->memoryUsage();
+
+    for (int i = 0; i < item->childCount(); ++i) {
+        usage += memoryUsageOfItem(item->childAt(i));
+    }
+    return usage;
+}
+
 void MusicModel::clear()
 {
     beginResetModel();
@@ -726,8 +973,14 @@ void MusicModel::save(const QString &filename)
     if (m_filename.isEmpty())
         throw LP::Error(tr("no filename specified"));
 
+    createRootItemIfNotPresent();
+    QJsonDocument document(m_rootItem->toJson());
+
     QFile file(m_filename);
-    if (!file.open(QIODevice::WriteOnly|QIODevice::Text))
+    if (!file.open(QIODevice::WriteOnly))
+        throw LP::Error(file.errorString());
+
+    if (file.write(document.toJson(QJsonDocument::Compact)) == -1)
         throw LP::Error(file.errorString());
 }
 
@@ -739,12 +992,67 @@ void MusicModel::load(const QString &filename)
     if (m_filename.isEmpty())
         throw LP::Error(tr("no filename specified"));
 
-    QFile file(m_filename);
+    setScores(readScores(m_filename));
+}
+
+/*!
+ * \brief MusicModel::readScores Reads the scores of a LimePipes document without changing the
+ *        model. The caller takes ownership of the scores. As the model isn't touched, documents
+ *        can be read on other threads, if the plugin manager can be used from any thread.
+ */
+QList<MusicItem *> MusicModel::readScores(const QString &filename)
+{
+    LP_TRACE_SCOPE("MusicModel::readScores");
+
+    if (m_pluginManager.isNull())
+        throw LP::Error(tr("no plugin manager set"));
+
+    QFile file(filename);
     if (!file.open(QIODevice::ReadOnly))
         throw LP::Error(file.errorString());
 
+    QJsonParseError parseError;
+    QJsonDocument document(QJsonDocument::fromJson(file.readAll(), &parseError));
+    if (parseError.error != QJsonParseError::NoError)
+        throw LP::Error(parseError.errorString());
+
+    QJsonObject json(document.object());
+    if (static_cast<ItemType>(json.value(DataKey::ItemType).toInt()) != ItemType::RootItemType)
+        throw LP::Error(tr("no LimePipes document"));
+
+    QList<MusicItem*> scores;
+    foreach (const QJsonValue &value, json.value(DataKey::ItemChildren).toArray()) {
+        MusicItem *score = itemFromJsonObject(value.toObject());
+        if (!score)
+            continue;
+
+        if (score->type() == ItemType::ScoreType)
+            scores << score;
+        else
+            delete score;
+    }
+    return scores;
+}
+
+/*!
+ * \brief MusicModel::setScores Replaces all scores and the undo history. The model takes
+ *        ownership of the scores. Views get one rowsInserted for all scores.
+ */
+void MusicModel::setScores(const QList<MusicItem *> &scores)
+{
+    // The commands of the old document refer to its items
+    m_undoStack->clear();
     clear();
     createRootItemIfNotPresent();
+
+    if (scores.isEmpty())
+        return;
+
+    beginInsertRows(QModelIndex(), 0, scores.count() - 1);
+    foreach (MusicItem *score, scores) {
+        m_rootItem->addChild(score);
+    }
+    endInsertRows();
 }
 
 void MusicModel::setPluginManager(const PluginManager &pluginManager)
@@ -819,6 +1127,7 @@ QModelIndex MusicModel::insertItem(const QString &text, const QModelIndex &paren
 QModelIndex MusicModel::insertItems(const QString &text, const QModelIndex &parent, int row,
                                     const QList<MusicItem*> &items)
 {
+    LP_TRACE_SCOPE("MusicModel::insertItems");
     MusicItem *parentItem = itemForIndex(parent);
     if (!parentItem) {
         return QModelIndex();
@@ -11,11 +11,15 @@
 
 #include <QAbstractItemModel>
 #include <QHash>
+#include <QMap>
 #include "musicmodelinterface.h"
 #include <musicitem.h>
 #include <common/pluginmanagerinterface.h>
 
 class QUndoStack;
+class QIODevice;
+class QTemporaryFile;
+class ItemsCommand;
 
 namespace LP {
 uint qHash(const LP::ItemType &itemType);
@@ -28,6 +32,7 @@ class MusicModel : public QAbstractItemModel,
 
     friend class InsertItemsCommand;
     friend class RemoveItemsCommand;
+    friend class ItemsCommand;
 
 public:
     explicit MusicModel(QObject *parent = 0);
@@ -57,6 +62,9 @@ public:
     QModelIndex insertTuneIntoScore(int row, const QModelIndex &score, const QString &instrumentName);
     QModelIndex appendTuneToScore(const QModelIndex &score, const QString &instrumentName);
     QModelIndex insertTuneWithScore(int rowOfScore, const QString &scoreTitle, const QString &instrumentName);
+    QModelIndex insertTuneIntoScore(int row, const QModelIndex &score, int instrumentType);
+    QModelIndex appendTuneToScore(const QModelIndex &score, int instrumentType);
+    QModelIndex insertTuneWithScore(int rowOfScore, const QString &scoreTitle, int instrumentType);
     QModelIndex insertPartIntoTune(int row, const QModelIndex &tune, int measures, bool withRepeat=false);
     QModelIndex appendPartToTune(const QModelIndex &tune, int measures, bool withRepeat=false);
     QModelIndex insertMeasureIntoPart(int row, const QModelIndex &part);
@@ -64,6 +72,8 @@ public:
     QModelIndex insertSymbolIntoMeasure(int row, const QModelIndex &measure, int type);
     QModelIndex appendSymbolToMeasure(const QModelIndex &measure, int type);
 
+    QModelIndex insertScores(int row, const QList<MusicItem*> &scores);
+
     MusicItem *itemForIndex(const QModelIndex& index) const;
     QModelIndex indexForItem(MusicItem *item) const;
 
@@ -78,9 +88,17 @@ public:
 
     void save(const QString &filename);
     void load(const QString &filename);
+    QList<MusicItem*> readScores(const QString &filename);
+    void setScores(const QList<MusicItem*> &scores);
 
     QUndoStack *undoStack() const { return m_undoStack; }
 
+    qint64 undoMemoryLimit() const;
+    void setUndoMemoryLimit(qint64 bytes);
+    qint64 undoMemoryUsage() const;
+
+    qint64 memoryUsage(const QModelIndex &index) const;
+
     void setPluginManager(const PluginManager& pluginManager);
 
 private:
@@ -100,6 +118,15 @@ private:
 
     MusicItem *itemFromJsonObject(const QJsonObject &json);
 
+    void registerItemsCommand(ItemsCommand *command);
+    void unregisterItemsCommand(ItemsCommand *command);
+    void limitUndoMemory();
+    void addUndoMemoryUsage(qint64 bytes, qint64 exclusiveBytes);
+    QIODevice *undoSpillDevice();
+    qint64 allocateUndoSpillSpace(qint64 size);
+    void releaseUndoSpillSpace(qint64 position, qint64 size);
+    qint64 memoryUsageOfItem(const MusicItem *item) const;
+
     // Candidate for public api
     QModelIndex insertSpanningSymbolIntoMeasure(int row, const QModelIndex &measure, int type);
 
@@ -107,6 +134,14 @@ private:
     int m_columnCount;
     PluginManager m_pluginManager;
     QUndoStack *m_undoStack;
+    qint64 m_undoMemoryLimit;
+    quint64 m_itemsCommandCount;
+    QMap<quint64, ItemsCommand*> m_itemsCommands;   // All items commands, the oldest first
+    QHash<ItemsCommand*, quint64> m_itemsCommandNumbers;
+    qint64 m_undoMemoryUsage;      // Total memory cost of all items commands
+    qint64 m_undoExclusiveMemoryUsage;  // Part of the total, which isn't counted for the items
+    QTemporaryFile *m_undoSpillFile;
+    QMap<qint64, qint64> m_freeUndoSpillSpace;    // Size of the unused space by position
     bool m_dropMimeDataOccured;
 
     // Fixes Qt Bug #6679.
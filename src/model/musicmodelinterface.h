@@ -28,6 +28,9 @@ public:
     virtual QModelIndex insertTuneIntoScore(int row, const QModelIndex &score, const QString &instrumentName) = 0;
     virtual QModelIndex appendTuneToScore(const QModelIndex &score, const QString &instrumentName) = 0;
     virtual QModelIndex insertTuneWithScore(int rowOfScore, const QString &scoreTitle, const QString &instrumentName) = 0;
+    virtual QModelIndex insertTuneIntoScore(int row, const QModelIndex &score, int instrumentType) = 0;
+    virtual QModelIndex appendTuneToScore(const QModelIndex &score, int instrumentType) = 0;
+    virtual QModelIndex insertTuneWithScore(int rowOfScore, const QString &scoreTitle, int instrumentType) = 0;
 
     virtual QModelIndex insertPartIntoTune(int row, const QModelIndex &tune, int measures, bool withRepeat=false) = 0;
     virtual QModelIndex appendPartToTune(const QModelIndex &tune, int measures, bool withRepeat=false) = 0;
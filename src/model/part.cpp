@@ -37,6 +37,11 @@ void Part::initItem()
     setItemBehavior(behavior);
 }
 
+Part *Part::clone() const
+{
+    return new Part(*this);
+}
+
 bool Part::itemSupportsWritingOfData(int role) const
 {
     if (LP::allPartDataRoles.contains(static_cast<LP::PartDataRole>(role)))
@@ -20,6 +20,8 @@ public:
     void setStaffType(StaffType staffType);
     void setClefType(ClefType clef);
 
+    Part *clone() const;
+
     bool itemSupportsWritingOfData(int role) const;
 
 private:
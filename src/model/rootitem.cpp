@@ -11,6 +11,9 @@
   * The root item of the tree of @ref MusicItem "MusicItems".
   */
 
+#include <QJsonArray>
+#include <QJsonObject>
+#include <common/datahandling/datakeys.h>
 #include "rootitem.h"
 
 using namespace LP;
@@ -20,8 +23,34 @@ RootItem::RootItem()
 {
 }
 
+RootItem *RootItem::clone() const
+{
+    return new RootItem(*this);
+}
+
 bool RootItem::itemSupportsWritingOfData(int role) const
 {
     Q_UNUSED(role)
     return false;
 }
+
+/*!
+ * \brief RootItem::toJson The root item has no item behavior, so the json of the scores is
+ *        written here.
+ */
+QJsonObject RootItem::toJson() const
+{
+    QJsonObject json;
+    json.insert(DataKey::ItemType, static_cast<int>(type()));
+
+    QJsonArray childArray;
+    foreach (const MusicItem *childItem, children()) {
+        QJsonObject childObject(childItem->toJson());
+        if (childObject.isEmpty())
+            continue;
+        childArray.append(childObject);
+    }
+    json.insert(DataKey::ItemChildren, childArray);
+
+    return json;
+}
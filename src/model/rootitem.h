@@ -16,7 +16,11 @@ class RootItem : public MusicItem
 public:
     explicit RootItem();
 
+    RootItem *clone() const;
+
     bool itemSupportsWritingOfData(int role) const;
+
+    QJsonObject toJson() const;
 };
 
 #endif // ROOTITEM_H
@@ -43,6 +43,11 @@ void Score::setTitle(const QString &title)
     setData(title, LP::ScoreTitle);
 }
 
+Score *Score::clone() const
+{
+    return new Score(*this);
+}
+
 bool Score::itemSupportsWritingOfData(int role) const
 {
     if (LP::allScoreDataRoles.contains(static_cast<LP::ScoreDataRole>(role)))
@@ -19,6 +19,8 @@ public:
     explicit Score(MusicItem *parent=0);
     explicit Score(const QString &title);
 
+    Score *clone() const;
+
     bool itemSupportsWritingOfData(int role) const;
 
 private:
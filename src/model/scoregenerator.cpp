@@ -0,0 +1,357 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+/*!
+ * @class ScoreGenerator
+ * @brief Creates scores with a configurable size and symbol mix, e.g. for stress tests
+ *        and benchmarks.
+ *
+ * The items are created without a model and inserted as a whole with one undo command.
+ * Symbol types are chosen by their weights, pitches are taken randomly from the pitch
+ * context of the instrument. Spanning symbols like ties are closed after a few symbols.
+ * The same seed and parameters always create the same scores.
+ */
+
+#include <QDebug>
+#include <common/defines.h>
+#include <common/itemdataroles.h>
+#include <common/datatypes/instrument.h>
+#include "musicmodel.h"
+#include "score.h"
+#include "tune.h"
+#include "part.h"
+#include "measure.h"
+#include "symbol.h"
+#include "scoregenerator.h"
+
+namespace {
+const quint32 DefaultSeed = 0x4c696d65;
+const int SpannedSymbolCount = 2;
+const int MelodyNoteWeight = 8;
+const int SpanningSymbolWeight = 1;
+const int OtherSymbolWeight = 2;
+}
+
+ScoreGenerator::ScoreGenerator(const PluginManager &pluginManager)
+    : m_pluginManager(pluginManager),
+      m_seed(DefaultSeed),
+      m_randomState(DefaultSeed),
+      m_instrumentName(QStringLiteral("Great Highland Bagpipe")),
+      m_scoreCount(1),
+      m_tunesPerScore(1),
+      m_partsPerTune(2),
+      m_measuresPerPart(8),
+      m_symbolsPerMeasure(8)
+{
+    m_symbolWeights.insert(LP::MelodyNote, 1);
+}
+
+quint32 ScoreGenerator::seed() const
+{
+    return m_seed;
+}
+
+void ScoreGenerator::setSeed(quint32 seed)
+{
+    // xorshift never leaves the state 0
+    m_seed = seed ? seed : DefaultSeed;
+}
+
+QString ScoreGenerator::instrumentName() const
+{
+    return m_instrumentName;
+}
+
+void ScoreGenerator::setInstrumentName(const QString &instrumentName)
+{
+    m_instrumentName = instrumentName;
+}
+
+int ScoreGenerator::scoreCount() const
+{
+    return m_scoreCount;
+}
+
+void ScoreGenerator::setScoreCount(int count)
+{
+    m_scoreCount = qMax(0, count);
+}
+
+int ScoreGenerator::tunesPerScore() const
+{
+    return m_tunesPerScore;
+}
+
+void ScoreGenerator::setTunesPerScore(int count)
+{
+    m_tunesPerScore = qMax(0, count);
+}
+
+int ScoreGenerator::partsPerTune() const
+{
+    return m_partsPerTune;
+}
+
+void ScoreGenerator::setPartsPerTune(int count)
+{
+    m_partsPerTune = qMax(0, count);
+}
+
+int ScoreGenerator::measuresPerPart() const
+{
+    return m_measuresPerPart;
+}
+
+void ScoreGenerator::setMeasuresPerPart(int count)
+{
+    m_measuresPerPart = qMax(0, count);
+}
+
+int ScoreGenerator::symbolsPerMeasure() const
+{
+    return m_symbolsPerMeasure;
+}
+
+void ScoreGenerator::setSymbolsPerMeasure(int count)
+{
+    m_symbolsPerMeasure = qMax(0, count);
+}
+
+int ScoreGenerator::symbolWeight(int symbolType) const
+{
+    return m_symbolWeights.value(symbolType);
+}
+
+/*!
+ * \brief ScoreGenerator::setSymbolWeight Sets how often a symbol type is chosen relative to
+ *        the other symbol types. A weight of 0 removes the symbol type from the mix.
+ */
+void ScoreGenerator::setSymbolWeight(int symbolType, int weight)
+{
+    if (weight > 0)
+        m_symbolWeights.insert(symbolType, weight);
+    else
+        m_symbolWeights.remove(symbolType);
+}
+
+/*!
+ * \brief ScoreGenerator::setInstrumentSymbolWeights Replaces the symbol mix by all symbols,
+ *        the instrument supports. Melody notes are chosen most often, spanning symbols least often.
+ */
+void ScoreGenerator::setInstrumentSymbolWeights()
+{
+    if (m_pluginManager.isNull()) {
+        qWarning() << "ScoreGenerator: Can't get symbols without plugin manager";
+        return;
+    }
+
+    int instrumentType = m_pluginManager->instrumentTypeForName(m_instrumentName);
+    if (instrumentType == LP::NoInstrument) {
+        qWarning() << "ScoreGenerator: No instrument with name " << m_instrumentName;
+        return;
+    }
+
+    m_symbolWeights.clear();
+    foreach (int symbolType, m_pluginManager->instrumentMetaData(instrumentType).supportedSymbols()) {
+        SymbolCategory category = m_pluginManager->symbolMetaData(symbolType).category();
+        if (symbolType == LP::MelodyNote)
+            m_symbolWeights.insert(symbolType, MelodyNoteWeight);
+        else if (category == SymbolCategory::Spanning)
+            m_symbolWeights.insert(symbolType, SpanningSymbolWeight);
+        else if (category != SymbolCategory::None)
+            m_symbolWeights.insert(symbolType, OtherSymbolWeight);
+    }
+}
+
+/*!
+ * \brief ScoreGenerator::createScores Returns new scores without parent. The caller takes
+ *        ownership of the items.
+ */
+QList<MusicItem *> ScoreGenerator::createScores()
+{
+    QList<MusicItem*> scores;
+    if (m_pluginManager.isNull()) {
+        qWarning() << "ScoreGenerator: Can't create scores without plugin manager";
+        return scores;
+    }
+
+    int instrumentType = m_pluginManager->instrumentTypeForName(m_instrumentName);
+    if (instrumentType == LP::NoInstrument) {
+        qWarning() << "ScoreGenerator: No instrument with name " << m_instrumentName;
+        return scores;
+    }
+
+    m_randomState = m_seed;
+    m_pitchContext = m_pluginManager->instrumentMetaData(instrumentType).pitchContext();
+    m_pitchNames = m_pitchContext.isNull() ? QStringList() : m_pitchContext->pitchNames();
+    m_spanningTypes.clear();
+    foreach (int symbolType, m_symbolWeights.keys()) {
+        if (m_pluginManager->symbolMetaData(symbolType).category() == SymbolCategory::Spanning)
+            m_spanningTypes.insert(symbolType);
+    }
+
+    for (int i = 0; i < m_scoreCount; ++i) {
+        MusicItem *score = createScore(i + 1);
+        for (int j = 0; j < m_tunesPerScore; ++j) {
+            score->addChild(createTune(instrumentType));
+        }
+        scores << score;
+    }
+
+    return scores;
+}
+
+/*!
+ * \brief ScoreGenerator::insertScores Creates the scores and inserts them at row into the
+ *        model with one undo command.
+ * \return The index of the first score or an invalid index, if the scores couldn't be inserted.
+ */
+QModelIndex ScoreGenerator::insertScores(MusicModel *model, int row)
+{
+    if (!model)
+        return QModelIndex();
+
+    QList<MusicItem*> scores = createScores();
+    if (scores.isEmpty())
+        return QModelIndex();
+
+    QModelIndex firstScore = model->insertScores(row, scores);
+    if (!firstScore.isValid())
+        qDeleteAll(scores);
+
+    return firstScore;
+}
+
+MusicItem *ScoreGenerator::createScore(int number)
+{
+    return new Score(QString("Generated Score %1").arg(number));
+}
+
+MusicItem *ScoreGenerator::createTune(int instrumentType)
+{
+    Tune *tune = new Tune(instrumentType);
+    m_timeSignature = tune->data(LP::TuneTimeSignature);
+
+    for (int i = 0; i < m_partsPerTune; ++i) {
+        tune->addChild(createPart(instrumentType));
+    }
+    return tune;
+}
+
+MusicItem *ScoreGenerator::createPart(int instrumentType)
+{
+    InstrumentMetaData metaData = m_pluginManager->instrumentMetaData(instrumentType);
+    Part *part = new Part();
+    part->setStaffType(metaData.staffType());
+    part->setClefType(metaData.defaultClef());
+
+    int openSpanType = LP::NoSymbolType;
+    int symbolsUntilSpanEnd = 0;
+    MusicItem *measure = 0;
+    for (int i = 0; i < m_measuresPerPart; ++i) {
+        measure = new Measure(m_pluginManager);
+        measure->setData(m_timeSignature, LP::MeasureTimeSignature);
+        part->addChild(measure);
+
+        for (int j = 0; j < m_symbolsPerMeasure; ++j) {
+            int symbolType = LP::NoSymbolType;
+            SpanType spanType = SpanType::None;
+            if (openSpanType != LP::NoSymbolType && symbolsUntilSpanEnd == 0) {
+                symbolType = openSpanType;
+                spanType = SpanType::End;
+                openSpanType = LP::NoSymbolType;
+            } else {
+                symbolType = randomSymbolType(openSpanType == LP::NoSymbolType);
+                if (m_spanningTypes.contains(symbolType)) {
+                    spanType = SpanType::Start;
+                    openSpanType = symbolType;
+                    symbolsUntilSpanEnd = SpannedSymbolCount;
+                } else if (openSpanType != LP::NoSymbolType) {
+                    symbolsUntilSpanEnd--;
+                }
+            }
+
+            MusicItem *symbol = createSymbol(symbolType, instrumentType);
+            if (!symbol)
+                continue;
+
+            if (spanType != SpanType::None)
+                symbol->setData(QVariant::fromValue<SpanType>(spanType), LP::SymbolSpanType);
+            measure->addChild(symbol);
+        }
+    }
+
+    // A span must not be left open at the end of the part
+    if (measure && openSpanType != LP::NoSymbolType) {
+        MusicItem *spanEnd = createSymbol(openSpanType, instrumentType);
+        if (spanEnd) {
+            spanEnd->setData(QVariant::fromValue<SpanType>(SpanType::End), LP::SymbolSpanType);
+            measure->addChild(spanEnd);
+        }
+    }
+
+    return part;
+}
+
+MusicItem *ScoreGenerator::createSymbol(int symbolType, int instrumentType)
+{
+    SymbolBehavior *behavior = m_pluginManager->symbolBehaviorForType(symbolType);
+    if (!behavior) {
+        qWarning() << "ScoreGenerator: PluginManager returned 0 for symbol type " << symbolType;
+        return 0;
+    }
+
+    Symbol *symbol = new Symbol();
+    symbol->setSymbolBehavior(behavior);
+    symbol->setData(instrumentType, LP::SymbolInstrument);
+
+    if (symbol->hasPitch() && !m_pitchNames.isEmpty()) {
+        QString pitchName = m_pitchNames.at(nextRandom() % m_pitchNames.count());
+        Pitch pitch = m_pitchContext->pitchForName(pitchName);
+        symbol->setData(QVariant::fromValue<Pitch>(pitch), LP::SymbolPitch);
+    }
+
+    return symbol;
+}
+
+int ScoreGenerator::randomSymbolType(bool spanningAllowed)
+{
+    quint32 totalWeight = 0;
+    QMap<int, int>::const_iterator it;
+    for (it = m_symbolWeights.constBegin(); it != m_symbolWeights.constEnd(); ++it) {
+        if (spanningAllowed || !m_spanningTypes.contains(it.key()))
+            totalWeight += it.value();
+    }
+
+    if (!totalWeight)
+        return LP::MelodyNote;
+
+    quint32 value = nextRandom() % totalWeight;
+    for (it = m_symbolWeights.constBegin(); it != m_symbolWeights.constEnd(); ++it) {
+        if (!spanningAllowed && m_spanningTypes.contains(it.key()))
+            continue;
+
+        if (value < static_cast<quint32>(it.value()))
+            return it.key();
+        value -= it.value();
+    }
+
+    return LP::MelodyNote;
+}
+
+/*!
+ * \brief ScoreGenerator::nextRandom Returns the next number of a xorshift generator. Unlike
+ *        qrand, the sequence is the same on every platform.
+ */
+quint32 ScoreGenerator::nextRandom()
+{
+    m_randomState ^= m_randomState << 13;
+    m_randomState ^= m_randomState >> 17;
+    m_randomState ^= m_randomState << 5;
+    return m_randomState;
+}
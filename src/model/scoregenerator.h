@@ -0,0 +1,76 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#ifndef SCOREGENERATOR_H
+#define SCOREGENERATOR_H
+
+#include <QList>
+#include <QMap>
+#include <QModelIndex>
+#include <QSet>
+#include <QStringList>
+#include <common/pluginmanagerinterface.h>
+#include <common/datatypes/pitchcontext.h>
+
+class MusicItem;
+class MusicModel;
+
+class ScoreGenerator
+{
+public:
+    explicit ScoreGenerator(const PluginManager &pluginManager);
+
+    quint32 seed() const;
+    void setSeed(quint32 seed);
+
+    QString instrumentName() const;
+    void setInstrumentName(const QString &instrumentName);
+
+    int scoreCount() const;
+    void setScoreCount(int count);
+    int tunesPerScore() const;
+    void setTunesPerScore(int count);
+    int partsPerTune() const;
+    void setPartsPerTune(int count);
+    int measuresPerPart() const;
+    void setMeasuresPerPart(int count);
+    int symbolsPerMeasure() const;
+    void setSymbolsPerMeasure(int count);
+
+    int symbolWeight(int symbolType) const;
+    void setSymbolWeight(int symbolType, int weight);
+    void setInstrumentSymbolWeights();
+
+    QList<MusicItem*> createScores();
+    QModelIndex insertScores(MusicModel *model, int row);
+
+private:
+    MusicItem *createScore(int number);
+    MusicItem *createTune(int instrumentType);
+    MusicItem *createPart(int instrumentType);
+    MusicItem *createSymbol(int symbolType, int instrumentType);
+    int randomSymbolType(bool spanningAllowed);
+    quint32 nextRandom();
+
+    PluginManager m_pluginManager;
+    quint32 m_seed;
+    quint32 m_randomState;
+    QString m_instrumentName;
+    int m_scoreCount;
+    int m_tunesPerScore;
+    int m_partsPerTune;
+    int m_measuresPerPart;
+    int m_symbolsPerMeasure;
+    QMap<int, int> m_symbolWeights;     // Ordered by symbol type, so the mix is reproducible
+    QSet<int> m_spanningTypes;
+    PitchContextPtr m_pitchContext;
+    QStringList m_pitchNames;
+    QVariant m_timeSignature;
+};
+
+#endif // SCOREGENERATOR_H
@@ -33,10 +33,21 @@ Symbol::Symbol(int type, const QString &name, MusicItem *parent)
     Q_UNUSED(parent)
 }
 
+Symbol::Symbol(const Symbol &other)
+    : MusicItem(other),
+      m_behavior(static_cast<SymbolBehavior*>(itemBehavior()))
+{
+}
+
 Symbol::~Symbol()
 {
 }
 
+Symbol *Symbol::clone() const
+{
+    return new Symbol(*this);
+}
+
 int Symbol::symbolType() const
 {
     if (!m_behavior)
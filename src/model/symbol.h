@@ -25,6 +25,8 @@ public:
     explicit Symbol(int type, const QString &name, MusicItem *parent=0);
     virtual ~Symbol();
 
+    Symbol *clone() const;
+
     int symbolType() const;
 
     bool hasPitch() const;
@@ -39,6 +41,7 @@ public:
     void setSymbolBehavior(SymbolBehavior *symbolBehavior);
 
 private:
+    Symbol(const Symbol &other);
     SymbolBehavior *m_behavior;
 };
 
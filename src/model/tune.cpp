@@ -51,6 +51,11 @@ void Tune::setInstrument(int instrumentType)
     initData(instrumentType, LP::TuneInstrument);
 }
 
+Tune *Tune::clone() const
+{
+    return new Tune(*this);
+}
+
 bool Tune::itemSupportsWritingOfData(int role) const
 {
     if (role == LP::TuneInstrument)
@@ -23,6 +23,8 @@ public:
     int instrument() const { return data(LP::TuneInstrument).toInt(); }
     void setInstrument(int instrumentType);
 
+    Tune *clone() const;
+
     bool itemSupportsWritingOfData(int role) const;
 
 private:
@@ -14,6 +14,11 @@ DoublingBehavior::DoublingBehavior()
     setSymbolType(GHB::Doubling);
 }
 
+SymbolBehavior *DoublingBehavior::clone() const
+{
+    return new DoublingBehavior(*this);
+}
+
 QJsonObject DoublingBehavior::toJson() const
 {
     QJsonObject json(SymbolBehavior::toJson());
@@ -16,6 +16,8 @@ class DoublingBehavior : public SymbolBehavior
 public:
     DoublingBehavior();
 
+    SymbolBehavior *clone() const;
+
     // ItemBehavior interface
 public:
     QJsonObject toJson() const;
@@ -54,6 +54,37 @@ InstrumentMetaData GreatHighlandBagpipe::instrumentMetaData() const
     return m_metaData;
 }
 
+/*!
+ * \brief GreatHighlandBagpipe::graceNoteStaffPositions Returns the grace notes of a doubling
+ *        on the melody note.
+ */
+QVector<int> GreatHighlandBagpipe::graceNoteStaffPositions(int symbolType, int melodyStaffPos) const
+{
+    if (symbolType != GHB::Doubling)
+        return QVector<int>();
+
+    const int HighA = -2;
+    const int HighG = -1;
+    const int F = 0;
+    const int E = 1;
+    const int D = 2;
+
+    switch (melodyStaffPos) {
+    case HighA:
+        return QVector<int>() << HighG;
+    case HighG:
+        return QVector<int>() << F;
+    case F:
+        return QVector<int>() << HighG << F << HighG;
+    case E:
+        return QVector<int>() << HighG << E << F;
+    case D:
+        return QVector<int>() << HighG << D << E;
+    default:
+        return QVector<int>() << HighG << melodyStaffPos << D;
+    }
+}
+
 SymbolGraphicBuilder *GreatHighlandBagpipe::symbolGraphicBuilderForType(int type)
 {
     Q_UNUSED(type);
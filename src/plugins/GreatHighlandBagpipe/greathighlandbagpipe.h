@@ -29,6 +29,7 @@ public:
     int type() const;
     InstrumentMetaData instrumentMetaData() const;
     QString name() const { return QString("Great Highland Bagpipe"); }
+    QVector<int> graceNoteStaffPositions(int symbolType, int melodyStaffPos) const;
 
     // Symbols interface
     SymbolMetaData symbolMetaDataForType(int type);
@@ -20,6 +20,11 @@ MelodyNoteBehavior::MelodyNoteBehavior()
     setOptions(SymbolBehavior::HasLength | SymbolBehavior::HasPitch);
 }
 
+SymbolBehavior *MelodyNoteBehavior::clone() const
+{
+    return new MelodyNoteBehavior(*this);
+}
+
 QJsonObject MelodyNoteBehavior::toJson() const
 {
     QJsonObject json(SymbolBehavior::toJson());
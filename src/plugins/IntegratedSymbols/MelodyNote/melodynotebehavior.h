@@ -16,6 +16,8 @@ class MelodyNoteBehavior : public SymbolBehavior
 public:
     MelodyNoteBehavior();
 
+    SymbolBehavior *clone() const;
+
     // ItemBehavior interface
 public:
     QJsonObject toJson() const;
@@ -9,13 +9,10 @@
 #include <QString>
 #include <QPen>
 #include <QDebug>
+#include <common/engraving/engravingrules.h>
 #include "../integratedsymbolsdefines.h"
 #include "melodynoteglyphitem.h"
 
-static const QString WholeNoteHead("noteheadWhole");
-static const QString HalfNoteHead("noteheadHalf");
-static const QString BlackNoteHead("noteheadBlack");
-static const QString AugmentationDot("augmentationDot");
 
 MelodyNoteGlyphItem::MelodyNoteGlyphItem()
     : GlyphItem(),
@@ -76,7 +73,7 @@ void MelodyNoteGlyphItem::setDotGlyphCount(int dotCount)
 
     if (m_augmentationDots.count() < dotCount) {
         while (m_augmentationDots.count() < dotCount) {
-            GlyphItem *newDot = new GlyphItem(AugmentationDot, this);
+            GlyphItem *newDot = new GlyphItem(EngravingRules::augmentationDotGlyph(), this);
             newDot->connectColorRoleToGlyph(this);
             newDot->setVisible(false);
             newDot->setColorRole(colorRole());
@@ -232,14 +229,7 @@ qreal MelodyNoteGlyphItem::ledgerLineExtensionWidth() const
 
 QString MelodyNoteGlyphItem::noteheadForLength(Length::Value length)
 {
-    switch (length) {
-    case Length::_1:
-        return WholeNoteHead; break;
-    case Length::_2:
-        return HalfNoteHead; break;
-    default:
-        return BlackNoteHead; break;
-    }
+    return EngravingRules::noteheadGlyphForLength(length);
 }
 
 void MelodyNoteGlyphItem::musicFontHasChanged(const MusicFontPtr &musicFont)
@@ -10,6 +10,8 @@
 #include <common/datatypes/length.h>
 #include <common/itemdataroles.h>
 #include <common/graphictypes/glyphitem.h>
+#include <common/engraving/engravingrules.h>
+#include <common/engraving/engravingtypes.h>
 #include <MelodyNote/melodynoteglyphitem.h>
 #include <QPainter>
 #include <QPixmap>
@@ -26,7 +28,8 @@ void MelodyNoteGraphicBuilder::updateSymbolGraphic(const QVariant &value, int ke
         Length::Value length = value.value<Length::Value>();
         m_glyph->setLength(length);
     }
-    if (key == LP::SymbolPitch) {
+    // Ledger lines are applied with the engraving of the pipeline
+    if (key == LP::SymbolPitch && !isEngravedByPipeline()) {
         Pitch pitch = value.value<Pitch>();
         m_glyph->setNoteIsOnLine(isPitchOnLine(pitch));
         setLedgerLinesForPitch(pitch);
@@ -41,12 +44,15 @@ void MelodyNoteGraphicBuilder::updateSymbolGraphic(const QVariant &value, int ke
     }
 }
 
+void MelodyNoteGraphicBuilder::applyEngraving(const SymbolEngraving &engraving)
+{
+    m_glyph->setNoteIsOnLine(engraving.onLine);
+    m_glyph->setLedgerLines(engraving.ledgerLines, engraving.ledgerLinesAbove);
+}
+
 bool MelodyNoteGraphicBuilder::isPitchOnLine(const Pitch &pitch) const
 {
-    if (pitch.staffPos() % 2) {
-        return false;
-    }
-    return true;
+    return EngravingRules::isStaffPosOnLine(pitch.staffPos());
 }
 
 void MelodyNoteGraphicBuilder::setLedgerLinesForPitch(const Pitch &pitch)
@@ -56,7 +62,7 @@ void MelodyNoteGraphicBuilder::setLedgerLinesForPitch(const Pitch &pitch)
 
     int staffPos = pitch.staffPos();
     int ledgerLineCount = ledgerLineCountForStaffPos(staffPos);
-    m_glyph->setLedgerLines(ledgerLineCount, staffPos < 0);
+    m_glyph->setLedgerLines(ledgerLineCount, EngravingRules::ledgerLinesAbove(staffPos));
 }
 
 int MelodyNoteGraphicBuilder::ledgerLineCountForStaffPos(int staffPos)
@@ -64,23 +70,7 @@ int MelodyNoteGraphicBuilder::ledgerLineCountForStaffPos(int staffPos)
     if (m_pitchContext.isNull())
         return 0;
 
-    StaffType staffType = m_pitchContext->staffType();
-    if (staffType == StaffType::Standard) {
-        if (staffPos >= -1 &&
-                staffPos <= 9) {
-            return 0;
-        }
-
-        // Above
-        if (staffPos < 0) {
-            return static_cast<int>(staffPos / 2 * -1);
-        } else {
-        // Below staff
-            return static_cast<int>((staffPos - 8) / 2);
-        }
-    }
-
-    return 0;
+    return EngravingRules::ledgerLineCount(staffPos, m_pitchContext->staffType());
 }
 
 QVector<int> MelodyNoteGraphicBuilder::graphicDataRoles() const
@@ -24,6 +24,7 @@ public:
     QVector<int> graphicDataRoles() const;
     GlyphItem *glyphItem() const;
     void setPluginManager(const PluginManager &pluginManager);
+    void applyEngraving(const SymbolEngraving &engraving);
 
 private:
     bool isPitchOnLine(const Pitch &pitch) const;
@@ -0,0 +1,132 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+/*!
+ * @class MemoryAccounting
+ * @brief Counts the instances and the approximate bytes of every layer of a document.
+ *
+ * The classes of a layer add their size on construction and remove it on destruction.
+ * Layers without instances, like the undo stack, only add or remove bytes. The sizes
+ * are estimates from sizeof and the number of stored values, not heap measurements.
+ */
+
+#include <QAtomicInteger>
+#include <QStringList>
+#include "memoryaccounting.h"
+
+namespace {
+
+struct LayerCounter {
+    QAtomicInteger<qint64> bytes;
+    QAtomicInteger<qint64> instances;
+};
+
+LayerCounter s_counters[MemoryAccounting::LayerCount];
+
+QString formattedBytes(qint64 bytes)
+{
+    if (qAbs(bytes) < 1024)
+        return QString("%1 B").arg(bytes);
+    if (qAbs(bytes) < 1024 * 1024)
+        return QString("%1 KiB").arg(bytes / 1024.0, 0, 'f', 1);
+    return QString("%1 MiB").arg(bytes / (1024.0 * 1024.0), 0, 'f', 1);
+}
+
+}
+
+void MemoryAccounting::addInstance(MemoryAccounting::Layer layer, qint64 bytes)
+{
+    s_counters[layer].instances.fetchAndAddRelaxed(1);
+    s_counters[layer].bytes.fetchAndAddRelaxed(bytes);
+}
+
+void MemoryAccounting::removeInstance(MemoryAccounting::Layer layer, qint64 bytes)
+{
+    s_counters[layer].instances.fetchAndAddRelaxed(-1);
+    s_counters[layer].bytes.fetchAndAddRelaxed(-bytes);
+}
+
+/*!
+ * \brief MemoryAccounting::addBytes Adds bytes to the layer without changing the instance
+ *        count. Negative values remove bytes.
+ */
+void MemoryAccounting::addBytes(MemoryAccounting::Layer layer, qint64 bytes)
+{
+    s_counters[layer].bytes.fetchAndAddRelaxed(bytes);
+}
+
+qint64 MemoryAccounting::bytes(MemoryAccounting::Layer layer)
+{
+    return s_counters[layer].bytes.load();
+}
+
+qint64 MemoryAccounting::instanceCount(MemoryAccounting::Layer layer)
+{
+    return s_counters[layer].instances.load();
+}
+
+qint64 MemoryAccounting::totalBytes()
+{
+    qint64 total = 0;
+    for (int i = 0; i < LayerCount; ++i) {
+        total += bytes(static_cast<Layer>(i));
+    }
+    return total;
+}
+
+QString MemoryAccounting::layerName(MemoryAccounting::Layer layer)
+{
+    switch (layer) {
+    case MusicItems:
+        return QStringLiteral("Music items");
+    case ItemBehaviors:
+        return QStringLiteral("Item behaviors");
+    case PluginBehaviors:
+        return QStringLiteral("Plugin behaviors");
+    case VisualItems:
+        return QStringLiteral("Visual items");
+    case GraphicsItems:
+        return QStringLiteral("Graphics items");
+    case GlyphItems:
+        return QStringLiteral("Glyph items");
+    case UndoStack:
+        return QStringLiteral("Undo stack");
+    case FontMetadata:
+        return QStringLiteral("Font metadata");
+    default:
+        return QString();
+    }
+}
+
+/*!
+ * \brief MemoryAccounting::report Returns a plain text table with the bytes and instances
+ *        of every layer, followed by the given sizes of the scores.
+ */
+QString MemoryAccounting::report(const MemoryAccounting::NamedSizes &scoreSizes)
+{
+    QStringList lines;
+    for (int i = 0; i < LayerCount; ++i) {
+        Layer layer = static_cast<Layer>(i);
+        QString line = QString("%1 %2").arg(layerName(layer), -18)
+                                       .arg(formattedBytes(bytes(layer)), 12);
+        if (instanceCount(layer))
+            line += QString("  (%1 instances)").arg(instanceCount(layer));
+        lines << line;
+    }
+    lines << QString("%1 %2").arg("Total", -18).arg(formattedBytes(totalBytes()), 12);
+
+    if (!scoreSizes.isEmpty()) {
+        lines << QString();
+        for (int i = 0; i < scoreSizes.count(); ++i) {
+            lines << QString("%1 %2").arg(scoreSizes.at(i).first, -18)
+                                     .arg(formattedBytes(scoreSizes.at(i).second), 12);
+        }
+    }
+
+    return lines.join('\n');
+}
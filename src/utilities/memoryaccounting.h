@@ -0,0 +1,48 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#ifndef MEMORYACCOUNTING_H
+#define MEMORYACCOUNTING_H
+
+#include <QList>
+#include <QPair>
+#include <QString>
+
+class MemoryAccounting
+{
+public:
+    enum Layer {
+        MusicItems,
+        ItemBehaviors,
+        PluginBehaviors,
+        VisualItems,
+        GraphicsItems,
+        GlyphItems,
+        UndoStack,
+        FontMetadata,
+        LayerCount
+    };
+
+    typedef QList<QPair<QString, qint64> > NamedSizes;
+
+    static void addInstance(Layer layer, qint64 bytes);
+    static void removeInstance(Layer layer, qint64 bytes);
+    static void addBytes(Layer layer, qint64 bytes);
+
+    static qint64 bytes(Layer layer);
+    static qint64 instanceCount(Layer layer);
+    static qint64 totalBytes();
+
+    static QString layerName(Layer layer);
+    static QString report(const NamedSizes &scoreSizes = NamedSizes());
+
+private:
+    MemoryAccounting() {}
+};
+
+#endif // MEMORYACCOUNTING_H
@@ -0,0 +1,253 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+/*!
+ * @class Tracer
+ * @brief Collects the durations of scoped trace points and writes them in the Chrome trace
+ *        event format, which can be opened with chrome://tracing or Perfetto.
+ *
+ * Trace points are set with LP_TRACE_SCOPE. As long as tracing is disabled, a trace point
+ * only checks one flag. Events are recorded from every thread. Every thread records into
+ * its own ring buffer of fixed size, so threads don't wait for each other. If the buffer is
+ * full, the oldest event of the thread is dropped and the memory of a long trace stays bounded.
+ */
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QThreadStorage>
+#include <QVector>
+#include "tracer.h"
+
+namespace {
+
+const int DefaultMaxEventsPerThread = 65536;
+
+struct TraceEvent {
+    const char *name;
+    qint64 start;
+    qint64 duration;
+};
+
+struct ThreadBuffer {
+    ThreadBuffer(int threadId, int maxEvents)
+        : threadId(threadId),
+          maxEvents(maxEvents),
+          next(0),
+          dropped(0) {}
+
+    void append(const TraceEvent &event)
+    {
+        if (events.count() < maxEvents) {
+            events.append(event);
+            return;
+        }
+
+        events[next] = event;
+        next = (next + 1) % maxEvents;
+        dropped++;
+    }
+
+    // The index of the oldest event is next, once the buffer is full
+    const TraceEvent &at(int i) const { return events.at((next + i) % events.count()); }
+
+    void clear(int newMaxEvents)
+    {
+        events.clear();
+        maxEvents = newMaxEvents;
+        next = 0;
+        dropped = 0;
+    }
+
+    QMutex mutex;   // Only contended while the trace is written or cleared
+    int threadId;
+    int maxEvents;
+    int next;
+    int dropped;
+    QVector<TraceEvent> events;
+};
+
+typedef QSharedPointer<ThreadBuffer> ThreadBufferPtr;
+
+struct TraceData {
+    TraceData()
+        : maxEventsPerThread(DefaultMaxEventsPerThread)
+    {
+        timer.start();
+    }
+
+    QMutex mutex;   // Guards the list of buffers and maxEventsPerThread
+    QElapsedTimer timer;
+    QList<ThreadBufferPtr> buffers;     // Kept after the thread has finished
+    QThreadStorage<ThreadBufferPtr> threadBuffer;
+    int maxEventsPerThread;
+};
+
+TraceData *traceData()
+{
+    static TraceData data;
+    return &data;
+}
+
+ThreadBuffer *threadBuffer(TraceData *data)
+{
+    if (!data->threadBuffer.hasLocalData()) {
+        QMutexLocker locker(&data->mutex);
+        ThreadBufferPtr buffer(new ThreadBuffer(data->buffers.count() + 1,
+                                                data->maxEventsPerThread));
+        data->buffers.append(buffer);
+        data->threadBuffer.setLocalData(buffer);
+    }
+    return data->threadBuffer.localData().data();
+}
+
+}
+
+QAtomicInt Tracer::s_enabled(0);
+
+void Tracer::setEnabled(bool enabled)
+{
+    // Start the timer before the first event
+    traceData();
+    s_enabled.store(enabled ? 1 : 0);
+}
+
+int Tracer::eventCount()
+{
+    TraceData *data = traceData();
+    QMutexLocker locker(&data->mutex);
+    int count = 0;
+    foreach (const ThreadBufferPtr &buffer, data->buffers) {
+        QMutexLocker bufferLocker(&buffer->mutex);
+        count += buffer->events.count();
+    }
+    return count;
+}
+
+/*!
+ * \brief Tracer::droppedEventCount Returns the number of events, which were dropped because
+ *        the buffer of their thread was full.
+ */
+int Tracer::droppedEventCount()
+{
+    TraceData *data = traceData();
+    QMutexLocker locker(&data->mutex);
+    int count = 0;
+    foreach (const ThreadBufferPtr &buffer, data->buffers) {
+        QMutexLocker bufferLocker(&buffer->mutex);
+        count += buffer->dropped;
+    }
+    return count;
+}
+
+void Tracer::clear()
+{
+    TraceData *data = traceData();
+    QMutexLocker locker(&data->mutex);
+    foreach (const ThreadBufferPtr &buffer, data->buffers) {
+        QMutexLocker bufferLocker(&buffer->mutex);
+        buffer->clear(data->maxEventsPerThread);
+    }
+}
+
+int Tracer::maxEventsPerThread()
+{
+    TraceData *data = traceData();
+    QMutexLocker locker(&data->mutex);
+    return data->maxEventsPerThread;
+}
+
+/*!
+ * \brief Tracer::setMaxEventsPerThread Sets the size of the ring buffer of every thread.
+ *        The recorded events are cleared.
+ */
+void Tracer::setMaxEventsPerThread(int count)
+{
+    {
+        TraceData *data = traceData();
+        QMutexLocker locker(&data->mutex);
+        data->maxEventsPerThread = qMax(1, count);
+    }
+    clear();
+}
+
+/*!
+ * \brief Tracer::timestamp Returns the microseconds since the tracer was used first.
+ */
+qint64 Tracer::timestamp()
+{
+    return traceData()->timer.nsecsElapsed() / 1000;
+}
+
+/*!
+ * \brief Tracer::addEvent Adds an event with start and duration in microseconds.
+ * \param name Must be valid until the trace is written, e.g. a string literal.
+ */
+void Tracer::addEvent(const char *name, qint64 start, qint64 duration)
+{
+    ThreadBuffer *buffer = threadBuffer(traceData());
+    QMutexLocker locker(&buffer->mutex);
+
+    TraceEvent event;
+    event.name = name;
+    event.start = start;
+    event.duration = duration;
+    buffer->append(event);
+}
+
+bool Tracer::writeChromeTrace(QIODevice *device)
+{
+    if (!device || !device->isWritable()) {
+        qWarning() << "Tracer: Can't write trace, device isn't writable";
+        return false;
+    }
+
+    QJsonArray traceEvents;
+    {
+        TraceData *data = traceData();
+        QMutexLocker locker(&data->mutex);
+        foreach (const ThreadBufferPtr &buffer, data->buffers) {
+            QMutexLocker bufferLocker(&buffer->mutex);
+            for (int i = 0; i < buffer->events.count(); ++i) {
+                const TraceEvent &event = buffer->at(i);
+                QJsonObject json;
+                json.insert("name", QString::fromLatin1(event.name));
+                json.insert("cat", QStringLiteral("limepipes"));
+                json.insert("ph", QStringLiteral("X"));
+                json.insert("ts", static_cast<double>(event.start));
+                json.insert("dur", static_cast<double>(event.duration));
+                json.insert("pid", 1);
+                json.insert("tid", buffer->threadId);
+                traceEvents.append(json);
+            }
+        }
+    }
+
+    QJsonObject trace;
+    trace.insert("traceEvents", traceEvents);
+    trace.insert("displayTimeUnit", QStringLiteral("ms"));
+
+    return device->write(QJsonDocument(trace).toJson(QJsonDocument::Compact)) != -1;
+}
+
+bool Tracer::saveChromeTrace(const QString &filename)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Tracer: Can't open trace file " << filename;
+        return false;
+    }
+
+    return writeChromeTrace(&file);
+}
@@ -0,0 +1,62 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <QAtomicInt>
+#include <QString>
+
+class QIODevice;
+
+class Tracer
+{
+public:
+    static bool isEnabled() { return s_enabled.load(); }
+    static void setEnabled(bool enabled);
+
+    static int eventCount();
+    static int droppedEventCount();
+    static void clear();
+
+    static int maxEventsPerThread();
+    static void setMaxEventsPerThread(int count);
+
+    static bool writeChromeTrace(QIODevice *device);
+    static bool saveChromeTrace(const QString &filename);
+
+    static qint64 timestamp();
+    static void addEvent(const char *name, qint64 start, qint64 duration);
+
+private:
+    Tracer() {}
+    static QAtomicInt s_enabled;
+};
+
+class TraceScope
+{
+public:
+    explicit TraceScope(const char *name)
+        : m_name(name),
+          m_start(Tracer::isEnabled() ? Tracer::timestamp() : -1) {}
+    ~TraceScope()
+    {
+        if (m_start >= 0)
+            Tracer::addEvent(m_name, m_start, Tracer::timestamp() - m_start);
+    }
+
+private:
+    Q_DISABLE_COPY(TraceScope)
+    const char *m_name;
+    qint64 m_start;
+};
+
+// Records the time until the end of the enclosing scope, if tracing is enabled
+#define LP_TRACE_SCOPE(name) TraceScope traceScope(name)
+
+#endif // TRACER_H
@@ -22,6 +22,7 @@
 #include "graphicsscene.h"
 #include "pageviewitem/pageviewitem.h"
 #include "visualmusicpresenter.h"
+#include "pageexporter.h"
 #include "visualmusicmodel/visualmusicmodel.h"
 #include "graphicsitemview.h"
 
@@ -52,6 +53,7 @@ GraphicsItemView::GraphicsItemView(QWidget *parent)
     m_graphicsScene->setVisualMusicModel(m_visualMusicModel);
 
     m_graphicsView->setScene(m_graphicsScene);
+    setFocusProxy(m_graphicsView);
     m_musicPresenter->setPageView(m_pageView);
     m_graphicsScene->addItem(m_pageView);
 }
@@ -90,3 +92,25 @@ void GraphicsItemView::setApplication(const Application &application)
     m_graphicsScene->setApplication(application);
 }
 
+/*!
+ * \brief GraphicsItemView::setCurrentIndex Highlights the item of the index and scrolls
+ *        it into view. An invalid index clears the highlight.
+ */
+void GraphicsItemView::setCurrentIndex(const QModelIndex &index)
+{
+    m_visualMusicModel->setCurrent(index);
+
+    QGraphicsItem *item = m_visualMusicModel->itemForIndex(index);
+    if (item)
+        m_graphicsView->ensureVisible(item);
+}
+
+/*!
+ * \brief GraphicsItemView::exportPdf Writes all pages into a PDF with the page layout
+ *        of the layout settings. The pages are written as vector graphics.
+ */
+bool GraphicsItemView::exportPdf(const QString &filename)
+{
+    PageExporter exporter(m_pageView);
+    return exporter.exportPdf(filename);
+}
@@ -37,8 +37,11 @@ public:
 
     void setApplication(const Application &application);
 
+    bool exportPdf(const QString &filename);
+
 public slots:
     void scale(qreal level);
+    void setCurrentIndex(const QModelIndex &index);
 
 private:
     GraphicsScene *m_graphicsScene;
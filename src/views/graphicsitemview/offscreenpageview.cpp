@@ -0,0 +1,82 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+/*!
+ * @class OffscreenPageView
+ * @brief Lays out a model on pages like the GraphicsItemView, but without a widget.
+ *
+ * The model has to be set before scores are inserted, the visual items are only
+ * created for inserted rows. Without a running event loop, flushPendingLayout has to be
+ * called before the pages are painted.
+ */
+
+#include <visualmusicmodel/visualmusicmodel.h>
+#include <visualmusicmodel/visualitemfactory.h>
+#include "graphicsscene.h"
+#include "pageviewitem/pageviewitem.h"
+#include "visualmusicpresenter.h"
+#include "offscreenpageview.h"
+
+OffscreenPageView::OffscreenPageView(QObject *parent)
+    : QObject(parent),
+      m_graphicsScene(0),
+      m_pageView(0),
+      m_musicPresenter(0),
+      m_visualMusicModel(0),
+      m_visualItemFactory(0)
+{
+    m_pageView = new PageViewItem();
+    m_graphicsScene = new GraphicsScene(this);
+
+    m_visualItemFactory = new VisualItemFactory();
+    m_visualMusicModel = new VisualMusicModel(m_visualItemFactory, this);
+    m_musicPresenter = new VisualMusicPresenter(this);
+    m_musicPresenter->setVisualMusicModel(m_visualMusicModel);
+    m_graphicsScene->setVisualMusicModel(m_visualMusicModel);
+
+    m_musicPresenter->setPageView(m_pageView);
+    m_graphicsScene->addItem(m_pageView);
+}
+
+OffscreenPageView::~OffscreenPageView()
+{
+    delete m_visualItemFactory;
+}
+
+void OffscreenPageView::setModel(QAbstractItemModel *model)
+{
+    if (m_visualMusicModel->model() != model &&
+            model != 0) {
+         m_visualMusicModel->setModel(model);
+    }
+}
+
+void OffscreenPageView::setPluginManager(PluginManager pluginManager)
+{
+    m_visualItemFactory->setPluginManager(pluginManager);
+    m_visualMusicModel->setPluginManager(pluginManager);
+}
+
+/*!
+ * \brief OffscreenPageView::flushPendingLayout Engraves and lays out all changes of the model,
+ *        which are otherwise laid out on return to the event loop.
+ */
+void OffscreenPageView::flushPendingLayout()
+{
+    m_visualMusicModel->flushPendingLayout();
+}
+
+GraphicsScene *OffscreenPageView::scene() const
+{
+    return m_graphicsScene;
+}
+
+PageViewItem *OffscreenPageView::pageView() const
+{
+    return m_pageView;
+}
@@ -0,0 +1,44 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#ifndef OFFSCREENPAGEVIEW_H
+#define OFFSCREENPAGEVIEW_H
+
+#include <QObject>
+#include <common/pluginmanagerinterface.h>
+
+class QAbstractItemModel;
+class GraphicsScene;
+class PageViewItem;
+class VisualMusicModel;
+class VisualMusicPresenter;
+class VisualItemFactory;
+
+class OffscreenPageView : public QObject
+{
+    Q_OBJECT
+public:
+    explicit OffscreenPageView(QObject *parent = 0);
+    ~OffscreenPageView();
+
+    void setModel(QAbstractItemModel *model);
+    void setPluginManager(PluginManager pluginManager);
+    void flushPendingLayout();
+
+    GraphicsScene *scene() const;
+    PageViewItem *pageView() const;
+
+private:
+    GraphicsScene *m_graphicsScene;
+    PageViewItem *m_pageView;
+    VisualMusicPresenter *m_musicPresenter;
+    VisualMusicModel *m_visualMusicModel;
+    VisualItemFactory *m_visualItemFactory;
+};
+
+#endif // OFFSCREENPAGEVIEW_H
@@ -0,0 +1,222 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+/*!
+ * @class PageExporter
+ * @brief Writes the pages of a PageViewItem into a PDF.
+ *
+ * Every page is recorded into a QPicture and written as soon as it is done, so the
+ * size of the book doesn't change the memory needed for the export. Recording uses
+ * the graphics items and has to be done in the GUI thread.
+ *
+ * Pages are written as vector graphics by default. Vector exports write the recorded pages
+ * with the painter of the PDF writer, which can't be shared between threads. They are
+ * written one after another in the GUI thread.
+ *
+ * Rasterized exports are meant for batch exports, where the speed matters more than the
+ * size and quality of the PDF. They replay the recorded pages into images on the thread
+ * pool. At most maxPagesInFlight pages are recorded ahead of the page that is written.
+ */
+
+#include <QDebug>
+#include <QFile>
+#include <QFuture>
+#include <QGraphicsScene>
+#include <QPainter>
+#include <QPdfWriter>
+#include <QQueue>
+#include <QThread>
+#include <QtConcurrent/QtConcurrentRun>
+#include <common/layoutsettings.h>
+#include <utilities/tracer.h>
+#include "pageviewitem/pageviewitem.h"
+#include "pageexporter.h"
+
+PageExporter::PageExporter(PageViewItem *pageView, QObject *parent)
+    : QObject(parent),
+      m_pageView(pageView),
+      m_resolution(300),
+      m_rasterized(false),
+      m_maxPagesInFlight(QThread::idealThreadCount())
+{
+    LayoutSettings settings;
+    m_pageLayout = settings.pageLayout();
+}
+
+QPageLayout PageExporter::pageLayout() const
+{
+    return m_pageLayout;
+}
+
+void PageExporter::setPageLayout(const QPageLayout &pageLayout)
+{
+    m_pageLayout = pageLayout;
+}
+
+int PageExporter::resolution() const
+{
+    return m_resolution;
+}
+
+void PageExporter::setResolution(int resolution)
+{
+    if (resolution <= 0) {
+        qWarning() << "PageExporter: Resolution has to be greater than zero";
+        return;
+    }
+    m_resolution = resolution;
+}
+
+bool PageExporter::isRasterized() const
+{
+    return m_rasterized;
+}
+
+/*!
+ * \brief PageExporter::setRasterized If true, pages are written as images with the
+ *        export resolution in parallel. If false, pages are written as vector graphics
+ *        in the GUI thread. The default is false.
+ */
+void PageExporter::setRasterized(bool rasterized)
+{
+    m_rasterized = rasterized;
+}
+
+int PageExporter::maxPagesInFlight() const
+{
+    return m_maxPagesInFlight;
+}
+
+void PageExporter::setMaxPagesInFlight(int count)
+{
+    m_maxPagesInFlight = qMax(1, count);
+}
+
+bool PageExporter::exportPdf(const QString &filename)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "PageExporter: Can't open file " << filename;
+        return false;
+    }
+
+    return exportPdf(&file);
+}
+
+bool PageExporter::exportPdf(QIODevice *device)
+{
+    LP_TRACE_SCOPE("PageExporter::exportPdf");
+
+    if (!device || !device->isWritable()) {
+        qWarning() << "PageExporter: Can't export, device isn't writable";
+        return false;
+    }
+
+    if (!m_pageView || !m_pageView->scene()) {
+        qWarning() << "PageExporter: Can't export, page view isn't in a scene";
+        return false;
+    }
+
+    // The page rects of the page view contain the margins
+    QPdfWriter writer(device);
+    writer.setResolution(m_resolution);
+    writer.setPageLayout(QPageLayout(m_pageLayout.pageSize(), m_pageLayout.orientation(),
+                                     QMarginsF()));
+
+    QPainter painter;
+    if (!painter.begin(&writer)) {
+        qWarning() << "PageExporter: Can't paint on pdf writer";
+        return false;
+    }
+
+    m_pageView->setPageDecorationsVisible(false);
+    writePages(&writer, &painter);
+    m_pageView->setPageDecorationsVisible(true);
+
+    return painter.end();
+}
+
+/*!
+ * \brief PageExporter::recordPage Records the page with the given index in page coordinates.
+ *        Must be called from the GUI thread.
+ */
+QPicture PageExporter::recordPage(PageViewItem *pageView, int index)
+{
+    LP_TRACE_SCOPE("PageExporter::recordPage");
+
+    QPicture picture;
+    QRectF sourceRect = pageView->pageSceneRect(index);
+    if (sourceRect.isEmpty() || !pageView->scene())
+        return picture;
+
+    QPainter painter(&picture);
+    pageView->scene()->render(&painter, QRectF(QPointF(), sourceRect.size()), sourceRect);
+    painter.end();
+    return picture;
+}
+
+/*!
+ * \brief PageExporter::rasterizePage Replays a recorded page into a white image of the
+ *        given size. Can be called from any thread.
+ */
+QImage PageExporter::rasterizePage(const QPicture &picture, const QSizeF &pageSize, const QSize &imageSize)
+{
+    LP_TRACE_SCOPE("PageExporter::rasterizePage");
+
+    QImage image(imageSize, QImage::Format_RGB32);
+    image.fill(Qt::white);
+
+    QPainter painter(&image);
+    painter.setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing |
+                           QPainter::SmoothPixmapTransform);
+    playPage(&painter, picture, pageSize, imageSize);
+    painter.end();
+    return image;
+}
+
+void PageExporter::playPage(QPainter *painter, const QPicture &picture,
+                            const QSizeF &pageSize, const QSizeF &targetSize)
+{
+    if (pageSize.isEmpty())
+        return;
+
+    painter->save();
+    painter->scale(targetSize.width() / pageSize.width(),
+                   targetSize.height() / pageSize.height());
+    painter->drawPicture(0, 0, picture);
+    painter->restore();
+}
+
+void PageExporter::writePages(QPdfWriter *writer, QPainter *painter)
+{
+    int pageCount = m_pageView->pageCount();
+    QRect targetRect(0, 0, writer->width(), writer->height());
+    QQueue<QFuture<QImage> > pendingPages;
+    int nextPageToRecord = 0;
+
+    for (int i = 0; i < pageCount; ++i) {
+        if (i > 0)
+            writer->newPage();
+
+        if (m_rasterized) {
+            while (nextPageToRecord < pageCount &&
+                   pendingPages.count() < m_maxPagesInFlight) {
+                QSizeF pageSize = m_pageView->pageSceneRect(nextPageToRecord).size();
+                pendingPages.enqueue(QtConcurrent::run(&PageExporter::rasterizePage,
+                                                       recordPage(m_pageView, nextPageToRecord),
+                                                       pageSize, targetRect.size()));
+                nextPageToRecord++;
+            }
+            painter->drawImage(targetRect, pendingPages.dequeue().result());
+        } else {
+            playPage(painter, recordPage(m_pageView, i), m_pageView->pageSceneRect(i).size(), targetRect.size());
+        }
+
+        emit pageExported(i, pageCount);
+    }
+}
@@ -0,0 +1,60 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#ifndef PAGEEXPORTER_H
+#define PAGEEXPORTER_H
+
+#include <QObject>
+#include <QPageLayout>
+#include <QPicture>
+#include <QImage>
+
+class QIODevice;
+class QPainter;
+class QPdfWriter;
+class PageViewItem;
+
+class PageExporter : public QObject
+{
+    Q_OBJECT
+public:
+    explicit PageExporter(PageViewItem *pageView, QObject *parent = 0);
+
+    QPageLayout pageLayout() const;
+    void setPageLayout(const QPageLayout &pageLayout);
+
+    int resolution() const;
+    void setResolution(int resolution);
+
+    bool isRasterized() const;
+    void setRasterized(bool rasterized);
+
+    int maxPagesInFlight() const;
+    void setMaxPagesInFlight(int count);
+
+    bool exportPdf(const QString &filename);
+    bool exportPdf(QIODevice *device);
+
+    static QPicture recordPage(PageViewItem *pageView, int index);
+    static QImage rasterizePage(const QPicture &picture, const QSizeF &pageSize, const QSize &imageSize);
+
+signals:
+    void pageExported(int index, int pageCount);
+
+private:
+    static void playPage(QPainter *painter, const QPicture &picture,
+                         const QSizeF &pageSize, const QSizeF &targetSize);
+    void writePages(QPdfWriter *writer, QPainter *painter);
+    PageViewItem *m_pageView;
+    QPageLayout m_pageLayout;
+    int m_resolution;
+    bool m_rasterized;
+    int m_maxPagesInFlight;
+};
+
+#endif // PAGEEXPORTER_H
@@ -20,11 +20,12 @@ PageItem::PageItem(QGraphicsItem *parent)
     : QGraphicsWidget(parent),
       SettingsObserver(Settings::Category::Layout),
       m_pageRect(QRectF()),
-      m_pageContentRect(QRectF())
+      m_pageContentRect(QRectF()),
+      m_decorationsVisible(true)
 {
     setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
 
-    LayoutSettings::registerObserver(this);
+    LayoutSettings::registerObserver(this, Settings::Id::PageLayout, LayoutSettings::NotifyCoalesced);
     LayoutSettings settings;
     setPageLayout(settings.pageLayout());
 
@@ -44,8 +45,16 @@ PageItem::PageItem(QGraphicsItem *parent)
     setGraphicsEffect(dropShadow);
 }
 
+PageItem::~PageItem()
+{
+    LayoutSettings::unregisterObserver(this);
+}
+
 void PageItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
 {
+    if (!m_decorationsVisible)
+        return;
+
     painter->setPen(QColor(0xD0, 0xD0, 0xD0));
     painter->drawRect(m_pageRect);
     painter->drawRect(m_pageContentRect);
@@ -68,6 +77,31 @@ void PageItem::setPageLayout(const QPageLayout &layout)
 
 }
 
+/*!
+ * \brief PageItem::pageRect Returns the rect of the whole page including the margins
+ *        in item coordinates.
+ */
+QRectF PageItem::pageRect() const
+{
+    return m_pageRect;
+}
+
+/*!
+ * \brief PageItem::setDecorationsVisible Shows or hides the drop shadow and the margin guides.
+ *        They are hidden while pages are exported, so the shadow doesn't turn the page
+ *        into a pixmap.
+ */
+void PageItem::setDecorationsVisible(bool visible)
+{
+    if (m_decorationsVisible == visible)
+        return;
+
+    m_decorationsVisible = visible;
+    if (graphicsEffect())
+        graphicsEffect()->setEnabled(visible);
+    update();
+}
+
 int PageItem::remainingVerticalSpace() const
 {
     if (!m_layout->count())
@@ -25,12 +25,15 @@ class PageItem : public QGraphicsWidget,
 
 public:
     explicit PageItem(QGraphicsItem *parent = 0);
+    ~PageItem();
 
     enum { Type = PageItemType };
     int type() const { return Type; }
 
     void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget);
 
+    QRectF pageRect() const;
+    void setDecorationsVisible(bool visible);
     int remainingVerticalSpace() const;
     int rowCount() const;
     int indexOfRow(QGraphicsWidget *row);
@@ -57,6 +60,7 @@ private:
     bool isValidRowIndex(int rowIndex);
     QRectF m_pageRect;
     QRectF m_pageContentRect;
+    bool m_decorationsVisible;
     QGraphicsLinearLayout *m_layout;
 };
 
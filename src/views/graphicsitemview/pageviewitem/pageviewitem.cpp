@@ -11,6 +11,7 @@
 #include <QGraphicsLinearLayout>
 
 #include <QDebug>
+#include <utilities/tracer.h>
 
 PageViewItem::PageViewItem(QGraphicsItem *parent)
     : QGraphicsWidget(parent)
@@ -31,6 +32,28 @@ int PageViewItem::pageCount() const
     return m_pageLayout->count();
 }
 
+/*!
+ * \brief PageViewItem::pageSceneRect Returns the rect of the page with the given index
+ *        in scene coordinates or an empty rect for an invalid index.
+ */
+QRectF PageViewItem::pageSceneRect(int index) const
+{
+    PageItem *page = pageAt(index);
+    if (!page)
+        return QRectF();
+
+    return page->mapRectToScene(page->pageRect());
+}
+
+void PageViewItem::setPageDecorationsVisible(bool visible)
+{
+    for (int i = 0; i < m_pageLayout->count(); i++) {
+        PageItem *page = pageAt(i);
+        if (page != 0)
+            page->setDecorationsVisible(visible);
+    }
+}
+
 int PageViewItem::rowCount() const
 {
     int rowCount = 0;
@@ -99,6 +122,7 @@ void PageViewItem::insertRow(int index, QGraphicsWidget *row)
 
 void PageViewItem::rowExceedsBoundsOfPage()
 {
+    LP_TRACE_SCOPE("PageViewItem::rowExceedsBoundsOfPage");
     PageItem *page = qobject_cast<PageItem*>(QObject::sender());
     Q_ASSERT(page);
     Q_ASSERT(page->remainingVerticalSpace() < 0);
@@ -120,6 +144,7 @@ void PageViewItem::rowExceedsBoundsOfPage()
 
 void PageViewItem::remainingVerticalSpaceHasChanged(int oldValue, int newValue)
 {
+    LP_TRACE_SCOPE("PageViewItem::remainingVerticalSpaceHasChanged");
     PageItem *page = qobject_cast<PageItem*>(QObject::sender());
     Q_ASSERT(page);
     int pageIndex = indexOfPage(page);
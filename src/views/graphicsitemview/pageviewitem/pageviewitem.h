@@ -30,6 +30,8 @@ public:
     QRectF boundingRect() const;
 
     int pageCount() const;
+    QRectF pageSceneRect(int index) const;
+    void setPageDecorationsVisible(bool visible);
     int rowCount() const;
     int rowCountOfPage(int index) const;
     int indexOfRow(QGraphicsWidget *row);
@@ -0,0 +1,418 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+/*!
+ * @class SvgPageExporter
+ * @brief Writes every page as SVG and as PNG thumbnail without a visible view.
+ *
+ * The glyphs of the music font are written once per page as symbol and are placed with
+ * use elements. Everything else on the page is written by QSvgGenerator.
+ *
+ * Pages are captured in the GUI thread. Writing the SVG and the thumbnail of a captured
+ * page runs on the thread pool, while the next page or document is laid out. At most
+ * maxPagesInFlight captured pages wait for being written.
+ *
+ * exportDirectory reads and parses up to maxPagesInFlight documents ahead on the thread pool.
+ * Only the layout of the read scores is left for the GUI thread.
+ */
+
+#include <QBuffer>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QGraphicsScene>
+#include <QPainter>
+#include <QSvgGenerator>
+#include <QThread>
+#include <QtConcurrent/QtConcurrentRun>
+#include <common/graphictypes/glyphitem.h>
+#include <common/layoutsettings.h>
+#include <utilities/error.h>
+#include <utilities/tracer.h>
+#include <musicmodel.h>
+#include "pageviewitem/pageviewitem.h"
+#include "offscreenpageview.h"
+#include "pageexporter.h"
+#include "svgpageexporter.h"
+
+SvgPageExporter::SvgPageExporter(QObject *parent)
+    : QObject(parent),
+      m_thumbnailWidth(256),
+      m_maxPagesInFlight(QThread::idealThreadCount()),
+      m_writtenPages(0),
+      m_failedCount(0)
+{
+}
+
+SvgPageExporter::~SvgPageExporter()
+{
+    waitForPagesInFlight(0);
+}
+
+int SvgPageExporter::thumbnailWidth() const
+{
+    return m_thumbnailWidth;
+}
+
+/*!
+ * \brief SvgPageExporter::setThumbnailWidth Sets the width of the PNG thumbnails in pixel.
+ *        A width of 0 disables the thumbnails.
+ */
+void SvgPageExporter::setThumbnailWidth(int width)
+{
+    m_thumbnailWidth = qMax(0, width);
+}
+
+int SvgPageExporter::maxPagesInFlight() const
+{
+    return m_maxPagesInFlight;
+}
+
+void SvgPageExporter::setMaxPagesInFlight(int count)
+{
+    m_maxPagesInFlight = qMax(1, count);
+}
+
+void SvgPageExporter::setPluginManager(PluginManager pluginManager)
+{
+    m_pluginManager = pluginManager;
+}
+
+/*!
+ * \brief SvgPageExporter::capturePage Records the page without glyphs and the positions of
+ *        the glyphs in page coordinates. Must be called from the GUI thread.
+ */
+SvgPageExporter::PageGraphics SvgPageExporter::capturePage(PageViewItem *pageView, int index)
+{
+    LP_TRACE_SCOPE("SvgPageExporter::capturePage");
+
+    PageGraphics page;
+    QRectF pageRect = pageView->pageSceneRect(index);
+    if (pageRect.isEmpty() || !pageView->scene())
+        return page;
+
+    page.size = pageRect.size();
+    QTransform sceneToPage = QTransform::fromTranslate(-pageRect.x(), -pageRect.y());
+    QColor glyphColor(Qt::black);
+    if (!LayoutSettings::musicFont().isNull())
+        glyphColor = LayoutSettings::musicFont()->fontColor(FontColor::Normal);
+
+    QList<GlyphItem*> glyphItems;
+    foreach (QGraphicsItem *item, pageView->scene()->items(pageRect)) {
+        GlyphItem *glyphItem = qobject_cast<GlyphItem*>(item->toGraphicsObject());
+        if (!glyphItem || glyphItem->glyphChar().isNull() || !glyphItem->isVisible())
+            continue;
+
+        GlyphPlacement placement;
+        placement.glyph = glyphItem->glyphChar();
+        placement.transform = glyphItem->sceneTransform() * sceneToPage;
+        placement.color = glyphColor;
+        page.glyphs << placement;
+
+        if (!page.glyphPaths.contains(placement.glyph))
+            page.glyphPaths.insert(placement.glyph, glyphPath(placement.glyph));
+
+        glyphItem->setGlyphPainted(false);
+        glyphItems << glyphItem;
+    }
+
+    pageView->setPageDecorationsVisible(false);
+    page.picture = PageExporter::recordPage(pageView, index);
+    pageView->setPageDecorationsVisible(true);
+
+    foreach (GlyphItem *glyphItem, glyphItems) {
+        glyphItem->setGlyphPainted(true);
+    }
+
+    return page;
+}
+
+/*!
+ * \brief SvgPageExporter::svgForPage Returns the SVG document of a captured page.
+ *        Can be called from any thread.
+ */
+QByteArray SvgPageExporter::svgForPage(const SvgPageExporter::PageGraphics &page)
+{
+    LP_TRACE_SCOPE("SvgPageExporter::svgForPage");
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+
+    QSvgGenerator generator;
+    generator.setOutputDevice(&buffer);
+    generator.setSize(page.size.toSize());
+    generator.setViewBox(QRectF(QPointF(), page.size));
+
+    QPainter painter(&generator);
+    painter.drawPicture(0, 0, page.picture);
+    painter.end();
+
+    QByteArray svg = buffer.data();
+    int svgEnd = svg.lastIndexOf("</svg>");
+    if (svgEnd == -1 || page.glyphs.isEmpty())
+        return svg;
+
+    QString glyphs("<defs>\n");
+    QHash<QChar, QPainterPath>::const_iterator it;
+    for (it = page.glyphPaths.constBegin(); it != page.glyphPaths.constEnd(); ++it) {
+        glyphs += QString(" <symbol id=\"%1\" overflow=\"visible\"><path d=\"%2\"/></symbol>\n")
+                .arg(glyphId(it.key()), svgPathData(it.value()));
+    }
+    glyphs += "</defs>\n<g stroke=\"none\">\n";
+
+    foreach (const GlyphPlacement &placement, page.glyphs) {
+        const QTransform &t = placement.transform;
+        glyphs += QString(" <use xlink:href=\"#%1\" fill=\"%2\" transform=\"matrix(%3 %4 %5 %6 %7 %8)\"/>\n")
+                .arg(glyphId(placement.glyph), placement.color.name())
+                .arg(t.m11()).arg(t.m12()).arg(t.m21()).arg(t.m22()).arg(t.dx()).arg(t.dy());
+    }
+    glyphs += "</g>\n";
+
+    svg.insert(svgEnd, glyphs.toUtf8());
+    return svg;
+}
+
+/*!
+ * \brief SvgPageExporter::thumbnailForPage Returns an image of the captured page with the
+ *        given width. Can be called from any thread.
+ */
+QImage SvgPageExporter::thumbnailForPage(const SvgPageExporter::PageGraphics &page, int width)
+{
+    LP_TRACE_SCOPE("SvgPageExporter::thumbnailForPage");
+
+    if (page.size.isEmpty() || width <= 0)
+        return QImage();
+
+    QSize imageSize(width, qMax(1, qRound(width * page.size.height() / page.size.width())));
+    QImage image = PageExporter::rasterizePage(page.picture, page.size, imageSize);
+
+    QTransform pageToImage = QTransform::fromScale(imageSize.width() / page.size.width(),
+                                                   imageSize.height() / page.size.height());
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+    foreach (const GlyphPlacement &placement, page.glyphs) {
+        painter.setTransform(placement.transform * pageToImage);
+        painter.fillPath(page.glyphPaths.value(placement.glyph), placement.color);
+    }
+    painter.end();
+
+    return image;
+}
+
+/*!
+ * \brief SvgPageExporter::exportPages Captures all pages and starts writing them as
+ *        baseName-<page>.svg and baseName-<page>.png into the output directory.
+ * \return The number of pages, that are written. Use waitForFinished to wait until
+ *         they are written.
+ */
+int SvgPageExporter::exportPages(PageViewItem *pageView, const QString &outputDir, const QString &baseName)
+{
+    LP_TRACE_SCOPE("SvgPageExporter::exportPages");
+
+    QDir dir(outputDir);
+    if (!dir.exists() && !dir.mkpath(".")) {
+        qWarning() << "SvgPageExporter: Can't create output directory " << outputDir;
+        return 0;
+    }
+
+    int pageCount = pageView->pageCount();
+    for (int i = 0; i < pageCount; ++i) {
+        waitForPagesInFlight(m_maxPagesInFlight - 1);
+
+        PageGraphics page = capturePage(pageView, i);
+        QString filePath = dir.filePath(QString("%1-%2").arg(baseName).arg(i + 1));
+        m_pendingPages << QtConcurrent::run(&SvgPageExporter::writePageFiles,
+                                            page, filePath, m_thumbnailWidth);
+    }
+
+    return pageCount;
+}
+
+/*!
+ * \brief SvgPageExporter::exportDirectory Exports the pages of all LimePipes documents in the
+ *        documents directory. While the pages of a document are written, the next documents
+ *        are read on the thread pool and the current one is laid out.
+ *        Documents, that can't be read, and pages, that can't be written, are counted
+ *        by failedCount.
+ * \return The number of written pages
+ */
+int SvgPageExporter::exportDirectory(const QString &documentsDir, const QString &outputDir)
+{
+    LP_TRACE_SCOPE("SvgPageExporter::exportDirectory");
+
+    QDir dir(documentsDir);
+    if (!dir.exists()) {
+        qWarning() << "SvgPageExporter: Documents directory doesn't exist " << documentsDir;
+        m_failedCount++;
+        return 0;
+    }
+
+    if (m_pluginManager.isNull()) {
+        qWarning() << "SvgPageExporter: No plugin manager set";
+        m_failedCount++;
+        return 0;
+    }
+
+    QStringList nameFilters(QStringLiteral("*.lime"));
+    QFileInfoList files(dir.entryInfoList(nameFilters, QDir::Files, QDir::Name));
+    QList<QFuture<Document> > pendingDocuments;
+    int nextFile = 0;
+    while (nextFile < files.count() || !pendingDocuments.isEmpty()) {
+        while (nextFile < files.count() && pendingDocuments.count() < m_maxPagesInFlight) {
+            pendingDocuments << QtConcurrent::run(&SvgPageExporter::readDocument, m_pluginManager,
+                                                  files.at(nextFile).absoluteFilePath());
+            nextFile++;
+        }
+
+        Document document = pendingDocuments.takeFirst().result();
+        if (!document.error.isEmpty()) {
+            qWarning() << "SvgPageExporter: Can't load " << document.filePath << document.error;
+            m_failedCount++;
+            continue;
+        }
+
+        MusicModel model;
+        model.setPluginManager(m_pluginManager);
+
+        OffscreenPageView offscreenView;
+        offscreenView.setPluginManager(m_pluginManager);
+        offscreenView.setModel(&model);
+
+        model.setScores(document.scores);
+        offscreenView.flushPendingLayout();
+        exportPages(offscreenView.pageView(), outputDir, QFileInfo(document.filePath).completeBaseName());
+    }
+
+    return waitForFinished();
+}
+
+/*!
+ * \brief SvgPageExporter::waitForFinished Waits until all pages are written.
+ * \return The number of pages written since the last call
+ */
+int SvgPageExporter::waitForFinished()
+{
+    waitForPagesInFlight(0);
+    int writtenPages = m_writtenPages;
+    m_writtenPages = 0;
+    return writtenPages;
+}
+
+/*!
+ * \brief SvgPageExporter::failedCount Returns the number of documents, that couldn't be read,
+ *        and of pages, that couldn't be written.
+ */
+int SvgPageExporter::failedCount() const
+{
+    return m_failedCount;
+}
+
+/*!
+ * \brief SvgPageExporter::readDocument Reads the scores of the document. Runs on the thread
+ *        pool, so the plugin manager must be usable from any thread.
+ */
+SvgPageExporter::Document SvgPageExporter::readDocument(PluginManager pluginManager, const QString &filePath)
+{
+    Document document;
+    document.filePath = filePath;
+
+    MusicModel model;
+    model.setPluginManager(pluginManager);
+    try {
+        document.scores = model.readScores(filePath);
+    } catch (LP::Error &error) {
+        document.error = QString::fromUtf8(error.what());
+    }
+
+    return document;
+}
+
+QString SvgPageExporter::glyphId(const QChar &glyph)
+{
+    return QString("glyph-%1").arg(glyph.unicode(), 4, 16, QChar('0'));
+}
+
+QString SvgPageExporter::svgPathData(const QPainterPath &path)
+{
+    QStringList commands;
+    for (int i = 0; i < path.elementCount(); ++i) {
+        const QPainterPath::Element &element = path.elementAt(i);
+        switch (element.type) {
+        case QPainterPath::MoveToElement:
+            if (i > 0)
+                commands << "Z";
+            commands << QString("M%1 %2").arg(element.x).arg(element.y);
+            break;
+        case QPainterPath::LineToElement:
+            commands << QString("L%1 %2").arg(element.x).arg(element.y);
+            break;
+        case QPainterPath::CurveToElement:
+            if (i + 2 < path.elementCount()) {
+                const QPainterPath::Element &control = path.elementAt(i + 1);
+                const QPainterPath::Element &end = path.elementAt(i + 2);
+                commands << QString("C%1 %2 %3 %4 %5 %6")
+                            .arg(element.x).arg(element.y)
+                            .arg(control.x).arg(control.y)
+                            .arg(end.x).arg(end.y);
+                i += 2;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    if (!commands.isEmpty())
+        commands << "Z";
+
+    return commands.join(' ');
+}
+
+bool SvgPageExporter::writePageFiles(const SvgPageExporter::PageGraphics &page, const QString &filePath,
+                                     int thumbnailWidth)
+{
+    QFile svgFile(filePath + ".svg");
+    if (!svgFile.open(QIODevice::WriteOnly) ||
+            svgFile.write(svgForPage(page)) == -1) {
+        qWarning() << "SvgPageExporter: Can't write " << svgFile.fileName();
+        return false;
+    }
+
+    if (thumbnailWidth > 0 &&
+            !thumbnailForPage(page, thumbnailWidth).save(filePath + ".png", "PNG")) {
+        qWarning() << "SvgPageExporter: Can't write " << filePath + ".png";
+        return false;
+    }
+
+    return true;
+}
+
+/*!
+ * \brief SvgPageExporter::glyphPath Returns the outline of the glyph at the origin, where
+ *        GlyphItem draws the glyph. Must be called from the GUI thread.
+ */
+QPainterPath SvgPageExporter::glyphPath(const QChar &glyph)
+{
+    if (!m_glyphPaths.contains(glyph)) {
+        QPainterPath path;
+        if (!LayoutSettings::musicFont().isNull())
+            path.addText(0, 0, LayoutSettings::musicFont()->font(), QString(glyph));
+        m_glyphPaths.insert(glyph, path);
+    }
+    return m_glyphPaths.value(glyph);
+}
+
+void SvgPageExporter::waitForPagesInFlight(int count)
+{
+    while (m_pendingPages.count() > count) {
+        QFuture<bool> page = m_pendingPages.takeFirst();
+        if (page.result())
+            m_writtenPages++;
+        else
+            m_failedCount++;
+    }
+}
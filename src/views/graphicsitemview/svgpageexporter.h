@@ -0,0 +1,85 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#ifndef SVGPAGEEXPORTER_H
+#define SVGPAGEEXPORTER_H
+
+#include <QObject>
+#include <QColor>
+#include <QFuture>
+#include <QHash>
+#include <QList>
+#include <QPainterPath>
+#include <QPicture>
+#include <QTransform>
+#include <QVector>
+#include <common/pluginmanagerinterface.h>
+
+class MusicItem;
+class PageViewItem;
+
+class SvgPageExporter : public QObject
+{
+    Q_OBJECT
+public:
+    struct GlyphPlacement {
+        QChar glyph;
+        QTransform transform;
+        QColor color;
+    };
+
+    struct PageGraphics {
+        QPicture picture;     // The page without glyphs
+        QSizeF size;
+        QVector<GlyphPlacement> glyphs;
+        QHash<QChar, QPainterPath> glyphPaths;
+    };
+
+    explicit SvgPageExporter(QObject *parent = 0);
+    ~SvgPageExporter();
+
+    int thumbnailWidth() const;
+    void setThumbnailWidth(int width);
+
+    int maxPagesInFlight() const;
+    void setMaxPagesInFlight(int count);
+
+    void setPluginManager(PluginManager pluginManager);
+
+    PageGraphics capturePage(PageViewItem *pageView, int index);
+    static QByteArray svgForPage(const PageGraphics &page);
+    static QImage thumbnailForPage(const PageGraphics &page, int width);
+
+    int exportPages(PageViewItem *pageView, const QString &outputDir, const QString &baseName);
+    int exportDirectory(const QString &documentsDir, const QString &outputDir);
+    int waitForFinished();
+    int failedCount() const;
+
+private:
+    struct Document {
+        QString filePath;
+        QList<MusicItem*> scores;
+        QString error;
+    };
+
+    static Document readDocument(PluginManager pluginManager, const QString &filePath);
+    static QString glyphId(const QChar &glyph);
+    static QString svgPathData(const QPainterPath &path);
+    static bool writePageFiles(const PageGraphics &page, const QString &filePath, int thumbnailWidth);
+    QPainterPath glyphPath(const QChar &glyph);
+    void waitForPagesInFlight(int count);
+    PluginManager m_pluginManager;
+    QHash<QChar, QPainterPath> m_glyphPaths;
+    QList<QFuture<bool> > m_pendingPages;
+    int m_thumbnailWidth;
+    int m_maxPagesInFlight;
+    int m_writtenPages;
+    int m_failedCount;
+};
+
+#endif // SVGPAGEEXPORTER_H
@@ -12,6 +12,7 @@
 
 #include <common/graphictypes/iteminteraction.h>
 #include <common/layoutsettings.h>
+#include <utilities/memoryaccounting.h>
 
 #include "interactinggraphicsitem.h"
 
@@ -23,6 +24,7 @@ InteractingGraphicsItem::InteractingGraphicsItem(QGraphicsItem *parent)
       m_itemInteraction(0),
       m_interactionMode(Direct)
 {
+    MemoryAccounting::addInstance(MemoryAccounting::GraphicsItems, sizeof(InteractingGraphicsItem));
     setMusicFont(LayoutSettings::musicFont());
     connect(LayoutSettings::musicFont().data(), &MusicFont::fontChanged,
             [this] {
@@ -30,6 +32,11 @@ InteractingGraphicsItem::InteractingGraphicsItem(QGraphicsItem *parent)
     });
 }
 
+InteractingGraphicsItem::~InteractingGraphicsItem()
+{
+    MemoryAccounting::removeInstance(MemoryAccounting::GraphicsItems, sizeof(InteractingGraphicsItem));
+}
+
 ItemInteraction *InteractingGraphicsItem::itemInteraction() const
 {
     return m_itemInteraction;
@@ -40,7 +40,7 @@ public:
     };
 
     explicit InteractingGraphicsItem(QGraphicsItem *parent = 0);
-    virtual ~InteractingGraphicsItem() {}
+    virtual ~InteractingGraphicsItem();
 
     enum { Type = InteractingGraphicsItemType };
     int type() const { return Type; }
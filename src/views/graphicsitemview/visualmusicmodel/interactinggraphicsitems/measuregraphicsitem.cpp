@@ -13,11 +13,16 @@
 #include <QGraphicsLinearLayout>
 
 #include <common/defines.h>
+#include <common/itemdataroles.h>
 #include <common/layoutsettings.h>
 #include <common/datatypes/timesignature.h>
 #include <common/graphictypes/stemengraver.h>
 #include <common/graphictypes/tieengraver.h>
+#include <common/graphictypes/beamengraver.h>
 #include <common/graphictypes/timesignatureglyphitem.h>
+#include <common/graphictypes/symbolgraphicbuilder.h>
+#include <common/engraving/engravingrules.h>
+#include <utilities/tracer.h>
 
 #include "symbolgraphicsitem.h"
 #include "measuregraphicsitem.h"
@@ -26,15 +31,18 @@ static const qreal TimeSigLeftMargin(0.8);
 
 MeasureGraphicsItem::MeasureGraphicsItem(QGraphicsItem *parent)
     : InteractingGraphicsItem(parent),
-      m_timeSignatureVisible(false)
+      m_timeSignatureVisible(false),
+      m_engravedByPipeline(false)
 {
     setAcceptHoverEvents(true);
     setAcceptDrops(true);
 
     StemEngraver *stemEngraver = new StemEngraver();
     appendEngraver(stemEngraver);
-    TieEngraver *tieEngraver = new TieEngraver();
-    appendEngraver(tieEngraver);
+    m_tieEngraver = new TieEngraver();
+    appendEngraver(m_tieEngraver);
+    m_beamEngraver = new BeamEngraver(stemEngraver);
+    appendEngraver(m_beamEngraver);
 
     m_layout = new QGraphicsLinearLayout(Qt::Horizontal, this);
     m_layout->setContentsMargins(0, 0, 0, 0);
@@ -51,6 +59,9 @@ MeasureGraphicsItem::MeasureGraphicsItem(QGraphicsItem *parent)
 
 MeasureGraphicsItem::~MeasureGraphicsItem()
 {
+    foreach (const QMetaObject::Connection &connection, m_spacingConnections) {
+        disconnect(connection);
+    }
     qDeleteAll(m_engravers);
 }
 
@@ -75,6 +86,7 @@ void MeasureGraphicsItem::setSymbolGeometry(SymbolGraphicsItem *symbolItem, cons
 void MeasureGraphicsItem::setTimeSignature(const TimeSignature &timeSig)
 {
     m_timeSigGlyph->setSignatureType(timeSig.type());
+    m_beamEngraver->setTimeSignature(timeSig);
     layoutTimeSig();
 }
 
@@ -103,6 +115,7 @@ void MeasureGraphicsItem::setMarginsForTimeSigGlyph(qreal width)
     }
 
     m_layout->setContentsMargins(margin, 0, 0, 0);
+    emit spacingChanged();
 }
 
 qreal MeasureGraphicsItem::timeSigLeftMargin() const
@@ -117,6 +130,200 @@ void MeasureGraphicsItem::appendEngraver(BaseEngraver *engraver)
     }
 }
 
+/*!
+ * \brief MeasureGraphicsItem::setPreviousMeasure Sets the measure before this measure.
+ *        Ties which aren't closed in the previous measure are continued in this measure.
+ */
+void MeasureGraphicsItem::setPreviousMeasure(MeasureGraphicsItem *measure)
+{
+    m_tieEngraver->setPreviousEngraver(measure ? measure->m_tieEngraver : 0);
+}
+
+bool MeasureGraphicsItem::isEngravedByPipeline() const
+{
+    return m_engravedByPipeline;
+}
+
+/*!
+ * \brief MeasureGraphicsItem::setEngravedByPipeline If set, the engravers and graphic builders of
+ *        the symbols don't compute the engraving themselves. The results of the EngravingPipeline
+ *        are applied with applyEngraving instead.
+ */
+void MeasureGraphicsItem::setEngravedByPipeline(bool engravedByPipeline)
+{
+    if (m_engravedByPipeline == engravedByPipeline)
+        return;
+
+    // Engravers switch their mode only without builders
+    for (int i = m_symbolItems.count() - 1; i >= 0; --i) {
+        SymbolGraphicBuilder *builder = m_symbolItems.at(i)->graphicBuilder();
+        if (!builder)
+            continue;
+        foreach (BaseEngraver *engraver, m_engravers) {
+            engraver->removeGraphicsBuilder(i, builder);
+        }
+    }
+
+    m_engravedByPipeline = engravedByPipeline;
+    m_engraving = MeasureEngraving();
+    foreach (BaseEngraver *engraver, m_engravers) {
+        engraver->setEngravedByPipeline(engravedByPipeline);
+    }
+
+    for (int i = 0; i < m_symbolItems.count(); ++i) {
+        SymbolGraphicBuilder *builder = m_symbolItems.at(i)->graphicBuilder();
+        if (!builder)
+            continue;
+        builder->setEngravedByPipeline(engravedByPipeline);
+        foreach (BaseEngraver *engraver, m_engravers) {
+            engraver->insertGraphicsBuilder(i, builder);
+        }
+    }
+}
+
+/*!
+ * \brief MeasureGraphicsItem::applyEngraving Applies the engraving computed by the EngravingPipeline
+ *        to the graphic builders and engravers of the symbols. The widths are used for the spacing
+ *        of the staff. The engraving is ignored, if it doesn't match the symbols of the measure.
+ * \return True, if the engraving has changed since the last call.
+ */
+bool MeasureGraphicsItem::applyEngraving(const MeasureEngraving &engraving)
+{
+    if (engraving.symbols.count() != m_symbolItems.count()) {
+        qWarning() << "MeasureGraphicsItem: Engraving doesn't match the symbols of the measure";
+        return false;
+    }
+
+    if (engraving == m_engraving)
+        return false;
+
+    LP_TRACE_SCOPE("MeasureGraphicsItem::applyEngraving");
+    m_engraving = engraving;
+    invalidateSymbolPositions();
+
+    QList<SymbolGraphicBuilder*> builders;
+    for (int i = 0; i < m_symbolItems.count(); ++i) {
+        SymbolGraphicBuilder *builder = m_symbolItems.at(i)->graphicBuilder();
+        if (builder && m_engravedByPipeline)
+            builder->applyEngraving(engraving.symbols.at(i));
+        builders << builder;
+    }
+
+    if (m_engravedByPipeline) {
+        foreach (BaseEngraver *engraver, m_engravers) {
+            engraver->applyEngraving(builders, engraving);
+        }
+    }
+
+    emit spacingChanged();
+    return true;
+}
+
+GlyphItem *MeasureGraphicsItem::glyphItemAt(int index) const
+{
+    if (index < 0 || index >= m_symbolItems.count())
+        return 0;
+
+    SymbolGraphicBuilder *builder = m_symbolItems.at(index)->graphicBuilder();
+    if (!builder)
+        return 0;
+
+    return builder->glyphItem();
+}
+
+bool MeasureGraphicsItem::hasCurrentEngraving() const
+{
+    return !m_symbolItems.isEmpty() &&
+            m_engraving.symbols.count() == m_symbolItems.count();
+}
+
+/*!
+ * \brief MeasureGraphicsItem::symbolWidth Returns the engraved width of the symbol. Until the
+ *        measure is engraved and for symbols without engraved width, the preferred width is used.
+ */
+qreal MeasureGraphicsItem::symbolWidth(int index) const
+{
+    if (hasCurrentEngraving() && m_engraving.symbols.at(index).width > 0)
+        return m_engraving.symbols.at(index).width;
+
+    return m_symbolItems.at(index)->preferredWidth();
+}
+
+/*!
+ * \brief MeasureGraphicsItem::spacingElements Returns the width and duration of every symbol
+ *        for the SpacingEngine.
+ */
+QVector<SpacingEngine::Element> MeasureGraphicsItem::spacingElements() const
+{
+    QVector<SpacingEngine::Element> elements;
+    elements.reserve(m_symbolItems.count());
+    for (int i = 0; i < m_symbolItems.count(); ++i) {
+        int ticks = 0;
+        SymbolGraphicBuilder *builder = m_symbolItems.at(i)->graphicBuilder();
+        if (builder) {
+            QVariant lengthData(builder->data(LP::SymbolLength));
+            if (lengthData.isValid()) {
+                int dots = builder->data(LP::MelodyNoteDots).toInt();
+                ticks = EngravingRules::ticksOfLength(lengthData.value<Length::Value>(), dots);
+            }
+        }
+        elements << SpacingEngine::Element(symbolWidth(i), ticks);
+    }
+    return elements;
+}
+
+qreal MeasureGraphicsItem::symbolsLeftMargin() const
+{
+    qreal left, top, right, bottom;
+    m_layout->getContentsMargins(&left, &top, &right, &bottom);
+    return left;
+}
+
+/*!
+ * \brief MeasureGraphicsItem::setSymbolPositions Places the symbols at the x positions computed
+ *        by the SpacingEngine. The space between the symbols is set as spacing of the layout.
+ *        The positions are valid until a symbol is inserted or removed or its width changes.
+ */
+void MeasureGraphicsItem::setSymbolPositions(const QVector<qreal> &positions)
+{
+    if (positions.count() != m_symbolItems.count()) {
+        qWarning() << "MeasureGraphicsItem: Symbol positions don't match the symbols of the measure";
+        return;
+    }
+
+    if (positions == m_symbolPositions)
+        return;
+
+    m_symbolPositions = positions;
+    for (int i = 0; i < positions.count() - 1; ++i) {
+        qreal symbolEnd = positions.at(i) + symbolWidth(i);
+        m_layout->setItemSpacing(i, qMax<qreal>(0, positions.at(i + 1) - symbolEnd));
+    }
+}
+
+/*!
+ * \brief MeasureGraphicsItem::invalidateSymbolPositions Drops the positions of the last spacing.
+ *        The symbols are placed at their unjustified positions until the staff is spaced again.
+ */
+void MeasureGraphicsItem::invalidateSymbolPositions()
+{
+    m_symbolPositions.clear();
+}
+
+void MeasureGraphicsItem::watchSpacingOfBuilder(SymbolGraphicBuilder *builder)
+{
+    if (m_spacingConnections.contains(builder))
+        return;
+
+    m_spacingConnections.insert(builder,
+                                connect(builder, &SymbolGraphicBuilder::dataChanged,
+                                        [this] (const QVariant &, int role) {
+        if (role == LP::SymbolLength || role == LP::MelodyNoteDots) {
+            invalidateSymbolPositions();
+            emit spacingChanged();
+        }
+    }));
+}
 
 void MeasureGraphicsItem::insertChildItem(int index, InteractingGraphicsItem *childItem)
 {
@@ -134,6 +341,8 @@ void MeasureGraphicsItem::insertChildItem(int index, InteractingGraphicsItem *ch
 
     m_layout->insertItem(index, childItem);
     m_symbolItems.insert(index, symbolItem);
+    m_engraving = MeasureEngraving();
+    invalidateSymbolPositions();
     SymbolGraphicBuilder *graphicBuilder = symbolItem->graphicBuilder();
     if(!graphicBuilder) {
         qDebug() << "MeasureGraphicsItem: No graphic builder returned from "
@@ -141,9 +350,13 @@ void MeasureGraphicsItem::insertChildItem(int index, InteractingGraphicsItem *ch
         return;
     }
 
+    graphicBuilder->setEngravedByPipeline(m_engravedByPipeline);
     foreach (BaseEngraver *engraver, m_engravers) {
         engraver->insertGraphicsBuilder(index, graphicBuilder);
     }
+
+    watchSpacingOfBuilder(graphicBuilder);
+    emit spacingChanged();
 }
 
 void MeasureGraphicsItem::removeChildItem(InteractingGraphicsItem *childItem)
@@ -154,7 +367,11 @@ void MeasureGraphicsItem::removeChildItem(InteractingGraphicsItem *childItem)
         InteractingGraphicsItem::removeChildItem(childItem);
         return;
     }
-    m_symbolItems.removeAll(symbolItem);
+    int index = m_symbolItems.indexOf(symbolItem);
+    if (index != -1)
+        m_symbolItems.removeAt(index);
+    m_engraving = MeasureEngraving();
+    invalidateSymbolPositions();
 
     SymbolGraphicBuilder *graphicBuilder = symbolItem->graphicBuilder();
     if (!graphicBuilder) {
@@ -165,10 +382,12 @@ void MeasureGraphicsItem::removeChildItem(InteractingGraphicsItem *childItem)
     }
 
     foreach (BaseEngraver *engraver, m_engravers) {
-        engraver->removeGraphicsBuilder(graphicBuilder);
+        engraver->removeGraphicsBuilder(index, graphicBuilder);
     }
 
+    disconnect(m_spacingConnections.take(graphicBuilder));
     InteractingGraphicsItem::removeChildItem(childItem);
+    emit spacingChanged();
 }
 
 void MeasureGraphicsItem::setData(const QVariant &value, int key)
@@ -189,6 +408,7 @@ void MeasureGraphicsItem::setGeometry(const QRectF &rect)
 
 void MeasureGraphicsItem::layoutSymbolItems()
 {
+    LP_TRACE_SCOPE("MeasureGraphicsItem::layoutSymbolItems");
     QList<QRectF> geometries(symbolGeometries());
     if (!geometries.count() == m_symbolItems.count())
         return;
@@ -206,16 +426,29 @@ void MeasureGraphicsItem::layoutSymbolItems()
 
 QList<QRectF> MeasureGraphicsItem::symbolGeometries() const
 {
-    QList<QRectF> geometries;
-    QRectF itemGeometry;
-    qreal currentWidth = 0;
+    QVector<qreal> widths;
+    widths.reserve(m_symbolItems.count());
     for (int i = 0; i < m_symbolItems.count(); ++i) {
-        SymbolGraphicsItem *currentItem = m_symbolItems.at(i);
-        qreal currentItemWidth = currentItem->preferredWidth();
-        itemGeometry = QRectF(currentWidth, 0, currentItemWidth,
-                              geometry().height());
-        geometries << itemGeometry;
-        currentWidth += currentItemWidth;
+        widths << symbolWidth(i);
+    }
+
+    // Use the positions of the last spacing, if they are still valid. Otherwise the
+    // unjustified positions of the engraving are used until the staff is spaced.
+    QList<qreal> positions;
+    if (m_symbolPositions.count() == m_symbolItems.count()) {
+        positions = m_symbolPositions.toList();
+    } else if (hasCurrentEngraving()) {
+        foreach (const SymbolEngraving &symbolEngraving, m_engraving.symbols) {
+            positions << symbolsLeftMargin() + symbolEngraving.x;
+        }
+    } else {
+        positions = EngravingRules::symbolPositions(widths, symbolsLeftMargin());
+    }
+
+    QList<QRectF> geometries;
+    for (int i = 0; i < positions.count(); ++i) {
+        geometries << QRectF(positions.at(i), 0, widths.at(i),
+                             geometry().height());
     }
     return geometries;
 }
@@ -10,15 +10,23 @@
 #define MEASUREGRAPHICSITEM_H
 
 #include <QList>
+#include <QHash>
+#include <QVector>
 #include <QPen>
 #include <common/defines.h>
+#include <common/engraving/spacingengine.h>
+#include <common/engraving/engravingtypes.h>
 #include "interactinggraphicsitem.h"
 
 class SymbolGraphicsItem;
 class QGraphicsLinearLayout;
 class BaseEngraver;
+class TieEngraver;
+class BeamEngraver;
+class SymbolGraphicBuilder;
 class TimeSignature;
 class TimeSignatureGlyphItem;
+class GlyphItem;
 
 class MeasureGraphicsItem : public InteractingGraphicsItem
 {
@@ -43,10 +51,23 @@ public:
     void setGeometry(const QRectF& rect);
 
     void appendEngraver(BaseEngraver *engraver);
+    void setPreviousMeasure(MeasureGraphicsItem *measure);
+
+    bool isEngravedByPipeline() const;
+    void setEngravedByPipeline(bool engravedByPipeline);
+    bool applyEngraving(const MeasureEngraving &engraving);
+    GlyphItem *glyphItemAt(int index) const;
+
+    QVector<SpacingEngine::Element> spacingElements() const;
+    qreal symbolsLeftMargin() const;
+    void setSymbolPositions(const QVector<qreal> &positions);
 
     bool timeSignatureVisible() const;
     void setTimeSignatureVisible(bool timeSignatureVisible);
 
+signals:
+    void spacingChanged();
+
 protected:
     void hoverEnterEvent(QGraphicsSceneHoverEvent *event);
     void hoverMoveEvent(QGraphicsSceneHoverEvent *event);
@@ -61,22 +82,32 @@ private:
     void layoutSymbolItems();
     void clearEndOfDrag();
     QList<QRectF> symbolGeometries() const;
+    void invalidateSymbolPositions();
     void setPenWidth(qreal width);
     qreal penWidth() const;
     void setSymbolGeometry(SymbolGraphicsItem *symbolItem, const QRectF& rect);
     void setSymbolGeometry(SymbolGraphicsItem *item, int i);
+    qreal symbolWidth(int index) const;
+    bool hasCurrentEngraving() const;
     void setTimeSignature(const TimeSignature &timeSig);
     void setMarginsForTimeSigGlyph(qreal width);
     qreal timeSigLeftMargin() const;
     void layoutTimeSig();
     void showGapAtScenePos(const QPointF &scenePos);
+    void watchSpacingOfBuilder(SymbolGraphicBuilder *builder);
     QList<SymbolGraphicsItem*> m_symbolItems;
     QPen m_linePen;
     QList<QRectF> m_dragMoveRects;
     QGraphicsLinearLayout *m_layout;
     QList<BaseEngraver*> m_engravers;
+    TieEngraver *m_tieEngraver;
+    BeamEngraver *m_beamEngraver;
     TimeSignatureGlyphItem *m_timeSigGlyph;
     bool m_timeSignatureVisible;
+    QVector<qreal> m_symbolPositions;
+    bool m_engravedByPipeline;
+    MeasureEngraving m_engraving;
+    QHash<SymbolGraphicBuilder*, QMetaObject::Connection> m_spacingConnections;
 };
 
 #endif // MEASUREGRAPHICSITEM_H
@@ -39,7 +39,7 @@ void ScoreGraphicsItem::initialize()
     m_rowLayout->setContentsMargins(0, 0, 0, 0);
 
     setSettingsCategory(Settings::Category::Score);
-    ScoreSettings::registerObserver(this);
+    ScoreSettings::registerObserver(this, Settings::Id::ScoreData);
 
     createConnections();
 }
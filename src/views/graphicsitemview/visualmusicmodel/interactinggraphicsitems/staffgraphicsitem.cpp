@@ -12,8 +12,10 @@
 #include <QGraphicsLinearLayout>
 #include <QGraphicsLayoutItem>
 #include <QGraphicsItem>
+#include <QTimer>
 
 #include <common/layoutsettings.h>
+#include "measuregraphicsitem.h"
 #include "staffgraphicsitem.h"
 #include <QDebug>
 
@@ -29,7 +31,8 @@ StaffGraphicsItem::StaffGraphicsItem(QGraphicsItem *parent)
       m_staffSpace(0),
       m_topMargin(0),
       m_measureLayout(0),
-      m_clefGlyph(0)
+      m_clefGlyph(0),
+      m_spacingTimer(0)
 {
     setSizePolicy(QSizePolicy(QSizePolicy::MinimumExpanding, QSizePolicy::Fixed));
 
@@ -37,6 +40,15 @@ StaffGraphicsItem::StaffGraphicsItem(QGraphicsItem *parent)
     m_measureLayout->setSpacing(0);
     m_measureLayout->setContentsMargins(0, 0, 0, 0);
 
+    // Changes of many measures are spaced at once, when the event loop is reached
+    m_spacingTimer = new QTimer(this);
+    m_spacingTimer->setSingleShot(true);
+    m_spacingTimer->setInterval(0);
+    connect(m_spacingTimer, &QTimer::timeout,
+            [this] {
+        updateSpacing();
+    });
+
     musicFontHasChanged(LayoutSettings::musicFont());
 
     updateTopMarginToMusicLayout();
@@ -174,6 +186,7 @@ qreal StaffGraphicsItem::clefLeftMargin()
 void StaffGraphicsItem::setMarginsForClefGlyph(qreal glyphWidth)
 {
     m_measureLayout->setContentsMargins(glyphWidth + clefLeftMargin(), 0, 0, 0);
+    scheduleSpacingUpdate();
 }
 
 ClefType StaffGraphicsItem::clefType() const
@@ -185,31 +198,102 @@ void StaffGraphicsItem::setClefType(const ClefType &clefType)
 {
     m_clefGlyph->setClef(clefType);
     layoutClef();
-    setFixedWidthsOnChildren();
+    scheduleSpacingUpdate();
 }
 
 void StaffGraphicsItem::insertChildItem(int index, InteractingGraphicsItem *childItem)
 {
+    if (index < 0 || index > m_measureItems.count())
+        index = m_measureItems.count();
+
     m_measureLayout->insertItem(index, childItem);
-    setFixedWidthsOnChildren();
+    m_measureItems.insert(index, childItem);
+    m_spacingEngine.insertMeasure(index);
+    connect(childItem, &QObject::destroyed, this,
+            [this, childItem] {
+        removeFromSpacing(childItem);
+    });
+
+    MeasureGraphicsItem *measureItem = qgraphicsitem_cast<MeasureGraphicsItem*>(childItem);
+    if (measureItem) {
+        connect(measureItem, &MeasureGraphicsItem::spacingChanged, this,
+                [this, measureItem] {
+            m_dirtyMeasures.insert(measureItem);
+            scheduleSpacingUpdate();
+        });
+        m_dirtyMeasures.insert(measureItem);
+    }
+
+    scheduleSpacingUpdate();
 }
 
-void StaffGraphicsItem::setFixedWidthsOnChildren()
+void StaffGraphicsItem::removeChildItem(InteractingGraphicsItem *childItem)
 {
-    int childCount = m_measureLayout->count();
-    qreal completeChildWidth = m_measureLayout->contentsRect().width();
-    qreal childWidth = completeChildWidth / childCount;
+    if (!m_measureItems.contains(childItem))
+        return;
 
-    for (int i = 0; i < childCount; ++i) {
-        QGraphicsLayoutItem *childItem = m_measureLayout->itemAt(i);
+    childItem->disconnect(this);
+    m_measureLayout->removeItem(childItem);
+    removeFromSpacing(childItem);
+}
 
-        if (childItem->minimumWidth() == childWidth &&
-                childItem->maximumWidth() == childWidth) {
+void StaffGraphicsItem::removeFromSpacing(InteractingGraphicsItem *childItem)
+{
+    int index = m_measureItems.indexOf(childItem);
+    if (index == -1)
+        return;
+
+    m_measureItems.removeAt(index);
+    m_dirtyMeasures.remove(childItem);
+    m_spacingEngine.removeMeasure(index);
+    scheduleSpacingUpdate();
+}
+
+void StaffGraphicsItem::setGeometry(const QRectF &rect)
+{
+    bool widthHasChanged = rect.width() != geometry().width();
+    InteractingGraphicsItem::setGeometry(rect);
+    if (widthHasChanged)
+        scheduleSpacingUpdate();
+}
+
+void StaffGraphicsItem::scheduleSpacingUpdate()
+{
+    if (m_spacingTimer && !m_spacingTimer->isActive())
+        m_spacingTimer->start();
+}
+
+/*!
+ * \brief StaffGraphicsItem::updateSpacing Justifies all measures of the staff with the SpacingEngine.
+ *        Only measures whose symbols have changed are passed to the engine again.
+ */
+void StaffGraphicsItem::updateSpacing()
+{
+    foreach (InteractingGraphicsItem *item, m_dirtyMeasures) {
+        int index = m_measureItems.indexOf(item);
+        MeasureGraphicsItem *measureItem = qgraphicsitem_cast<MeasureGraphicsItem*>(item);
+        if (index == -1 || !measureItem)
             continue;
+
+        m_spacingEngine.setMeasure(index, measureItem->spacingElements(),
+                                   measureItem->symbolsLeftMargin());
+    }
+    m_dirtyMeasures.clear();
+
+    m_spacingEngine.justify(m_measureLayout->contentsRect().width());
+
+    for (int i = 0; i < m_measureItems.count(); ++i) {
+        InteractingGraphicsItem *childItem = m_measureItems.at(i);
+        qreal childWidth = m_spacingEngine.measureWidth(i);
+        if (childItem->minimumWidth() != childWidth ||
+                childItem->maximumWidth() != childWidth) {
+            childItem->setMinimumWidth(childWidth);
+            childItem->setMaximumWidth(childWidth);
         }
 
-        childItem->setMinimumWidth(childWidth);
-        childItem->setMaximumWidth(childWidth);
+        MeasureGraphicsItem *measureItem = qgraphicsitem_cast<MeasureGraphicsItem*>(childItem);
+        if (measureItem)
+            measureItem->setSymbolPositions(m_spacingEngine.symbolPositions(i));
     }
 }
 
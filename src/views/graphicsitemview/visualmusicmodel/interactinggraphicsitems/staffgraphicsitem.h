@@ -10,11 +10,15 @@
 #define STAFFGRAPHICSITEM_H
 
 #include <QPen>
+#include <QList>
+#include <QSet>
 #include <common/defines.h>
 #include <common/graphictypes/clefglyphitem.h>
+#include <common/engraving/spacingengine.h>
 #include "interactinggraphicsitem.h"
 
 class QGraphicsLinearLayout;
+class QTimer;
 
 class StaffGraphicsItem : public InteractingGraphicsItem
 {
@@ -33,6 +37,8 @@ public:
 
     // InteractingGraphicsItem interface
     void insertChildItem(int index, InteractingGraphicsItem *childItem);
+    void removeChildItem(InteractingGraphicsItem *childItem);
+    void setGeometry(const QRectF &rect);
     int measureCount() const;
 
     ClefType clefType() const;
@@ -46,7 +52,9 @@ private:
     void setPenWidth(qreal width);
     void setSizeHintsForStaffType(StaffType type);
     void setWindowFrameRectForLineWidth(qreal width);
-    void setFixedWidthsOnChildren();
+    void removeFromSpacing(InteractingGraphicsItem *childItem);
+    void scheduleSpacingUpdate();
+    void updateSpacing();
     void updateTopMarginToMusicLayout();
     void layoutClef();
     void setMarginsForClefGlyph(qreal glyphWidth);
@@ -57,6 +65,10 @@ private:
     QPen m_pen;
     QGraphicsLinearLayout *m_measureLayout;
     ClefGlyphItem *m_clefGlyph;
+    SpacingEngine m_spacingEngine;
+    QList<InteractingGraphicsItem*> m_measureItems;     // Same order as in m_measureLayout
+    QSet<InteractingGraphicsItem*> m_dirtyMeasures;
+    QTimer *m_spacingTimer;
 };
 
 #endif // STAFFGRAPHICSITEM_H
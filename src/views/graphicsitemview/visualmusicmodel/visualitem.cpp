@@ -10,6 +10,7 @@
 #include <QGraphicsItem>
 #include "interactinggraphicsitems/interactinggraphicsitem.h"
 #include <common/graphictypes/iteminteraction.h>
+#include <utilities/memoryaccounting.h>
 #include "visualitem.h"
 
 VisualItem::VisualItem(QObject *parent)
@@ -17,6 +18,7 @@ VisualItem::VisualItem(QObject *parent)
       m_itemType(NoVisualItem),
       m_graphicalItemType(NoGraphicalType)
 {
+    MemoryAccounting::addInstance(MemoryAccounting::VisualItems, sizeof(VisualItem));
 }
 
 VisualItem::VisualItem(ItemType type, QObject *parent)
@@ -24,6 +26,7 @@ VisualItem::VisualItem(ItemType type, QObject *parent)
       m_itemType(type),
       m_graphicalItemType(NoGraphicalType)
 {
+    MemoryAccounting::addInstance(MemoryAccounting::VisualItems, sizeof(VisualItem));
 }
 
 VisualItem::VisualItem(VisualItem::ItemType type, VisualItem::GraphicalType graphicalType, QObject *parent)
@@ -31,10 +34,12 @@ VisualItem::VisualItem(VisualItem::ItemType type, VisualItem::GraphicalType grap
       m_itemType(type),
       m_graphicalItemType(graphicalType)
 {
+    MemoryAccounting::addInstance(MemoryAccounting::VisualItems, sizeof(VisualItem));
 }
 
 VisualItem::~VisualItem()
 {
+    MemoryAccounting::removeInstance(MemoryAccounting::VisualItems, sizeof(VisualItem));
 }
 
 void VisualItem::setInlineGraphic(InteractingGraphicsItem *inlineGraphic)
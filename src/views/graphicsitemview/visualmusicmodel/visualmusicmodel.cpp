@@ -7,13 +7,18 @@
  */
 
 #include <QAbstractItemModel>
+#include <QCoreApplication>
 #include <QGraphicsScene>
 #include <QGraphicsItem>
 #include <QGraphicsItemGroup>
+#include <QTimer>
 #include <common/datahandling/datakeys.h>
 #include <common/itemdataroles.h>
+#include <common/layoutsettings.h>
 #include <common/observablesettings.h>
+#include <utilities/tracer.h>
 #include "interactinggraphicsitems/interactinggraphicsitem.h"
+#include "visualpart.h"
 #include "visualmusicmodel.h"
 #include "sequentialtunesrowiterator.h"
 
@@ -22,8 +27,24 @@
 VisualMusicModel::VisualMusicModel(AbstractVisualItemFactory *itemFactory, QObject *parent)
     : QObject(parent),
       m_model(0),
-      m_itemFactory(itemFactory)
+      m_itemFactory(itemFactory),
+      m_engravingGeneration(0)
 {
+    m_engravingPipeline = new EngravingPipeline(this);
+    connect(m_engravingPipeline, &EngravingPipeline::engraved,
+            this, &VisualMusicModel::scoreEngraved);
+
+    // All changes of one event loop iteration are engraved together
+    m_engravingTimer = new QTimer(this);
+    m_engravingTimer->setSingleShot(true);
+    m_engravingTimer->setInterval(0);
+    connect(m_engravingTimer, &QTimer::timeout,
+            this, &VisualMusicModel::engraveNextScore);
+
+    if (!LayoutSettings::musicFont().isNull()) {
+        connect(LayoutSettings::musicFont().data(), &MusicFont::fontChanged,
+                this, &VisualMusicModel::musicFontChanged);
+    }
 }
 
 VisualMusicModel::~VisualMusicModel()
@@ -103,6 +124,12 @@ void VisualMusicModel::rowsInserted(const QModelIndex &parent, int start, int en
 {
     if (!parent.isValid()) {
         insertNewVisualItems(parent, start, end, VisualItem::VisualScoreItem);
+        for (int i = start; i <= end; ++i) {
+            scheduleEngraving(m_model->index(i, 0, parent));
+        }
+    } else {
+        m_measureSnapshots.remove(parent);
+        scheduleEngraving(parent);
     }
 
     LP::ItemType parentItemType = static_cast<LP::ItemType>(parent.data(LP::MusicItemType).toInt());
@@ -118,15 +145,30 @@ void VisualMusicModel::rowsInserted(const QModelIndex &parent, int start, int en
     if (parentItemType == LP::ItemType::MeasureType) {
         insertNewVisualItems(parent, start, end, VisualItem::VisualSymbolItem);
     }
+
+    // Rows can be inserted with their children, e.g. for loaded documents
+    for (int i = start; i <= end; ++i) {
+        QModelIndex itemIndex = m_model->index(i, 0, parent);
+        int childCount = m_model->rowCount(itemIndex);
+        if (childCount)
+            rowsInserted(itemIndex, 0, childCount - 1);
+    }
 }
 
 void VisualMusicModel::rowsAboutToBeRemoved(const QModelIndex &parent, int start, int end)
 {
+    if (parent.isValid()) {
+        m_measureSnapshots.remove(parent);
+        scheduleEngraving(parent);
+    }
+
     for (int i=start; i<=end; i++) {
         QModelIndex itemIndex = m_model->index(i, 0, parent);
         if (!itemIndex.isValid())
             continue;
 
+        removeMeasureSnapshots(itemIndex);
+
         VisualItem *item = m_visualItemIndexes.value(itemIndex);
         if (!item)
             continue;
@@ -158,12 +200,13 @@ void VisualMusicModel::rowsAboutToBeRemoved(const QModelIndex &parent, int start
 void VisualMusicModel::insertNewVisualItems(const QModelIndex &parentIndex, int start, int end,
                                             VisualItem::ItemType itemType)
 {
+    LP_TRACE_SCOPE("VisualMusicModel::insertNewVisualItems");
     if (!model())
         return;
 
     for (int i=start; i<=end; i++) {
         QPersistentModelIndex itemIndex(m_model->index(i, 0, parentIndex));
-        if (itemIndex.isValid()) {
+        if (itemIndex.isValid() && !m_visualItemIndexes.contains(itemIndex)) {
             VisualItem *visualItem = 0;
             if (itemType == VisualItem::VisualSymbolItem) {
                 QVariant data = m_model->data(itemIndex, LP::SymbolType);
@@ -291,19 +334,31 @@ QGraphicsItem *VisualMusicModel::itemForIndex(const QModelIndex &index) const
     return 0;
 }
 
+/*!
+ * \brief VisualMusicModel::setCurrent Focuses the inline graphic of the index. If the index is
+ *        invalid or has no inline graphic, the focus of the previous current item is cleared.
+ */
 void VisualMusicModel::setCurrent(const QModelIndex &current)
 {
+    InteractingGraphicsItem *interactingItem = 0;
     VisualItem *visualItem = m_visualItemIndexes.value(current);
-    if (!visualItem)
+    if (visualItem && visualItem->graphicalType() == VisualItem::GraphicalInlineType)
+        interactingItem = visualItem->inlineGraphic();
+
+    if (!interactingItem) {
+        VisualItem *previousItem = 0;
+        if (m_currentIndex.isValid())
+            previousItem = m_visualItemIndexes.value(m_currentIndex);
+        if (previousItem && previousItem->inlineGraphic() &&
+                previousItem->inlineGraphic()->hasFocus())
+            previousItem->inlineGraphic()->clearFocus();
+
+        m_currentIndex = QPersistentModelIndex();
         return;
-
-    if (visualItem->graphicalType() == VisualItem::GraphicalInlineType) {
-        InteractingGraphicsItem *interactingItem = visualItem->inlineGraphic();
-        if (!interactingItem)
-            return;
-
-        interactingItem->setFocus();
     }
+
+    m_currentIndex = current;
+    interactingItem->setFocus();
 }
 
 void VisualMusicModel::debugInsertion(const QModelIndex &parentIndex, int indexPos,
@@ -411,6 +466,190 @@ void VisualMusicModel::dataChanged(const QModelIndex &topLeft, const QModelIndex
             item->setData(m_model->data(topLeft, role), role);
         }
     }
+
+    // The index is either a measure or a symbol of a measure
+    for (int i = topLeft.row(); i <= bottomRight.row(); i++) {
+        QModelIndex index = topLeft.sibling(i, 0);
+        m_measureSnapshots.remove(index);
+        m_measureSnapshots.remove(index.parent());
+    }
+
+    scheduleEngraving(topLeft);
+}
+
+/*!
+ * \brief VisualMusicModel::scheduleEngraving Marks the score of the index to be engraved
+ *        on return to the event loop.
+ */
+void VisualMusicModel::scheduleEngraving(const QModelIndex &index)
+{
+    QModelIndex scoreIndex(index);
+    while (scoreIndex.parent().isValid()) {
+        scoreIndex = scoreIndex.parent();
+    }
+    if (!scoreIndex.isValid())
+        return;
+
+    m_scoresToEngrave.insert(QPersistentModelIndex(scoreIndex));
+    m_engravingTimer->start();
+}
+
+/*!
+ * \brief VisualMusicModel::removeMeasureSnapshots Removes the cached snapshots of all measures
+ *        of the index, before it is removed from the model.
+ */
+void VisualMusicModel::removeMeasureSnapshots(const QModelIndex &index)
+{
+    if (m_measureSnapshots.remove(index))
+        return;
+
+    for (int row = 0; row < m_model->rowCount(index); ++row) {
+        removeMeasureSnapshots(m_model->index(row, 0, index));
+    }
+}
+
+/*!
+ * \brief VisualMusicModel::musicFontChanged Measures the metrics of the changed music font
+ *        with the next engraving and engraves all scores again.
+ */
+void VisualMusicModel::musicFontChanged()
+{
+    m_metricsMusicFont.clear();
+    if (!m_model)
+        return;
+
+    for (int row = 0; row < m_model->rowCount(); ++row) {
+        scheduleEngraving(m_model->index(row, 0));
+    }
+}
+
+/*!
+ * \brief VisualMusicModel::engraveNextScore Starts the EngravingPipeline for one changed score.
+ *        The score which is engraved at the moment is restarted, if it changed again. Other
+ *        scores are engraved after the running engraving has finished.
+ */
+void VisualMusicModel::engraveNextScore()
+{
+    if (m_scoresToEngrave.isEmpty())
+        return;
+
+    QPersistentModelIndex scoreIndex(m_engravingScore);
+    if (!m_scoresToEngrave.contains(scoreIndex)) {
+        if (m_engravingPipeline->isRunning())
+            return;
+        scoreIndex = *m_scoresToEngrave.constBegin();
+    }
+    m_scoresToEngrave.remove(scoreIndex);
+
+    if (!scoreIndex.isValid()) {
+        m_engravingTimer->start();
+        return;
+    }
+
+    LP_TRACE_SCOPE("VisualMusicModel::engraveNextScore");
+    ScoreSnapshot snapshot(scoreSnapshot(scoreIndex));
+    m_engravingScore = scoreIndex;
+    m_engravingPartStaffCounts = snapshot.partStaffCounts;
+    m_engravingGeneration = m_engravingPipeline->engrave(snapshot, m_engravingMetrics);
+}
+
+/*!
+ * \brief VisualMusicModel::scoreSnapshot Reads the score for the engraving and updates the
+ *        metrics for the music font and the read symbol types.
+ */
+ScoreSnapshot VisualMusicModel::scoreSnapshot(const QModelIndex &scoreIndex)
+{
+    // The metrics are measured once per music font. The symbol widths are measured for the
+    // symbol types of the measures read from the model, so all measures are read again.
+    MusicFontPtr musicFont(LayoutSettings::musicFont());
+    if (musicFont != m_metricsMusicFont) {
+        m_measureSnapshots.clear();
+        m_metricsMusicFont = musicFont;
+        m_engravingMetrics = EngravingMetrics::fromMusicFont(musicFont);
+    }
+
+    // Only measures which have changed since the last snapshot are read from the model
+    QSet<int> readSymbolTypes;
+    ScoreSnapshot snapshot(EngravingPipeline::snapshotFromModel(m_model, scoreIndex,
+                                                                &m_measureSnapshots,
+                                                                &readSymbolTypes));
+    m_engravingMetrics.addSymbolWidths(musicFont, m_pluginManager, readSymbolTypes);
+    return snapshot;
+}
+
+/*!
+ * \brief VisualMusicModel::flushPendingLayout Engraves all changed scores synchronously and
+ *        runs the stem, spacing and layout updates, which are otherwise done on return to the
+ *        event loop. Must be called before the pages are captured without an event loop.
+ */
+void VisualMusicModel::flushPendingLayout()
+{
+    LP_TRACE_SCOPE("VisualMusicModel::flushPendingLayout");
+
+    // The running engraving is dropped and its score is engraved again
+    m_engravingTimer->stop();
+    m_engravingPipeline->cancel();
+    if (m_engravingScore.isValid())
+        m_scoresToEngrave.insert(m_engravingScore);
+    m_engravingScore = QPersistentModelIndex();
+
+    while (!m_scoresToEngrave.isEmpty()) {
+        QPersistentModelIndex scoreIndex(*m_scoresToEngrave.constBegin());
+        m_scoresToEngrave.remove(scoreIndex);
+        if (!scoreIndex.isValid())
+            continue;
+
+        ScoreSnapshot snapshot(scoreSnapshot(scoreIndex));
+        m_engravingPartStaffCounts = snapshot.partStaffCounts;
+        applyEngraving(scoreIndex, EngravingPipeline::engraveScore(snapshot, m_engravingMetrics));
+    }
+
+    // The engraving starts the spacing timers of the staves, the spacing posts layout
+    // requests and the layout can change the staff widths, which are spaced again.
+    const int LayoutPasses = 3;
+    for (int i = 0; i < LayoutPasses; ++i) {
+        QCoreApplication::sendPostedEvents();
+        QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+    }
+}
+
+void VisualMusicModel::scoreEngraved(int generation, const QVector<StaffEngraving> &staves)
+{
+    if (generation != m_engravingGeneration)
+        return;
+
+    // Results of a score which has changed in the meantime are outdated
+    if (m_engravingScore.isValid() && !m_scoresToEngrave.contains(m_engravingScore))
+        applyEngraving(m_engravingScore, staves);
+
+    m_engravingScore = QPersistentModelIndex();
+    if (!m_scoresToEngrave.isEmpty())
+        m_engravingTimer->start();
+}
+
+/*!
+ * \brief VisualMusicModel::applyEngraving Distributes the engraved staves to the parts of the
+ *        score in the order of the snapshot.
+ */
+void VisualMusicModel::applyEngraving(const QModelIndex &scoreIndex, const QVector<StaffEngraving> &staves)
+{
+    int partNumber = 0;
+    int firstStaff = 0;
+    for (int tuneRow = 0; tuneRow < m_model->rowCount(scoreIndex); ++tuneRow) {
+        QModelIndex tuneIndex = m_model->index(tuneRow, 0, scoreIndex);
+
+        for (int partRow = 0; partRow < m_model->rowCount(tuneIndex); ++partRow) {
+            if (partNumber >= m_engravingPartStaffCounts.count())
+                return;
+
+            int staffCount = m_engravingPartStaffCounts.at(partNumber++);
+            VisualPart *part = dynamic_cast<VisualPart*>(
+                        visualItemFromIndex(m_model->index(partRow, 0, tuneIndex)));
+            if (part)
+                part->applyEngraving(staves.mid(firstStaff, staffCount));
+            firstStaff += staffCount;
+        }
+    }
 }
 
 QAbstractItemModel *VisualMusicModel::model() const
@@ -442,6 +681,7 @@ RowIterator *VisualMusicModel::rowIteratorForScore(int index)
 void VisualMusicModel::setPluginManager(PluginManager pluginManager)
 {
     m_pluginManager = pluginManager;
+    m_metricsMusicFont.clear();
 }
 
 PluginManager VisualMusicModel::pluginManager() const
@@ -10,14 +10,19 @@
 
 #include <QObject>
 #include <QHash>
+#include <QSet>
+#include <QVector>
 #include <QPersistentModelIndex>
 
 #include <common/pluginmanagerinterface.h>
+#include <common/engraving/engravingtypes.h>
+#include <common/engraving/engravingpipeline.h>
 
 #include "rowiterator.h"
 #include "abstractvisualitemfactory.h"
 
 class QGraphicsItem;
+class QTimer;
 
 class VisualMusicModel : public QObject
 {
@@ -47,6 +52,8 @@ public:
     QGraphicsItem *itemForIndex(const QModelIndex &index) const;
     void setCurrent(const QModelIndex& current);
 
+    void flushPendingLayout();
+
 signals:
     void scoreRowSequenceChanged(int scoreIndex);
 
@@ -56,6 +63,9 @@ private slots:
     void dataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector<int>& dataRoles);
     void visualItemDataChanged(const QVariant& value, int dataRole);
     void itemRowSequenceChanged(VisualItem *visualItem);
+    void engraveNextScore();
+    void scoreEngraved(int generation, const QVector<StaffEngraving> &staves);
+    void musicFontChanged();
 
 private:
     VisualItem *visualItemFromIndex(const QModelIndex& itemIndex) const;
@@ -63,11 +73,25 @@ private:
     void insertVisualItem(QPersistentModelIndex itemIndex, VisualItem *item);
     void initVisualItemData(VisualItem *visualItem, const QPersistentModelIndex &itemIndex);
     void setVisualItemDataFromModel(VisualItem *visualItem, const QPersistentModelIndex &itemIndex, int role);
+    void scheduleEngraving(const QModelIndex &index);
+    void removeMeasureSnapshots(const QModelIndex &index);
+    ScoreSnapshot scoreSnapshot(const QModelIndex &scoreIndex);
+    void applyEngraving(const QModelIndex &scoreIndex, const QVector<StaffEngraving> &staves);
     void debugInsertion(const QModelIndex& parentIndex, int indexPos, const VisualItem *parentItem, const VisualItem *childItem);
     QAbstractItemModel *m_model;
     QHash<QPersistentModelIndex, VisualItem*> m_visualItemIndexes;
     AbstractVisualItemFactory *m_itemFactory;
     PluginManager m_pluginManager;
+    EngravingPipeline *m_engravingPipeline;
+    QTimer *m_engravingTimer;
+    QSet<QPersistentModelIndex> m_scoresToEngrave;
+    QPersistentModelIndex m_engravingScore;
+    QPersistentModelIndex m_currentIndex;
+    QVector<int> m_engravingPartStaffCounts;
+    int m_engravingGeneration;
+    MeasureSnapshotCache m_measureSnapshots;
+    MusicFontPtr m_metricsMusicFont;
+    EngravingMetrics m_engravingMetrics;
 };
 
 #endif // VISUALMUSICMODEL_H_7R3SY07L
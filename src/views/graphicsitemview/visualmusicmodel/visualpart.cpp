@@ -6,7 +6,12 @@
  *
  */
 
+#include <QHash>
 #include <common/itemdataroles.h>
+#include <common/layoutsettings.h>
+#include <common/graphictypes/tiegraphicsitem.h>
+#include <common/engraving/engravingrules.h>
+#include <common/engraving/engravingtypes.h>
 #include "interactinggraphicsitems/staffgraphicsitem.h"
 #include "interactinggraphicsitems/measuregraphicsitem.h"
 #include "visualpart.h"
@@ -21,6 +26,11 @@ VisualPart::VisualPart(QObject *parent)
     appendStaff();
 }
 
+VisualPart::~VisualPart()
+{
+    qDeleteAll(m_tieItems);
+}
+
 void VisualPart::setRepeat(bool repeat)
 {
     m_repeat = repeat;
@@ -119,6 +129,7 @@ void VisualPart::insertChildItem(int index, VisualItem *childItem)
     if (!measureItem) {
         qWarning() << "VisualPart: No measure item inserted";
     } else {
+        measureItem->setEngravedByPipeline(true);
         if (index == 0) {
             measureItem->setTimeSignatureVisible(true);
             if (m_measureItems.count()) {
@@ -127,12 +138,114 @@ void VisualPart::insertChildItem(int index, VisualItem *childItem)
         }
 
         m_measureItems.insert(index, measureItem);
+        if (index > 0)
+            measureItem->setPreviousMeasure(m_measureItems.at(index - 1));
+        if (index + 1 < m_measureItems.count())
+            m_measureItems.at(index + 1)->setPreviousMeasure(measureItem);
     }
     StaffGraphicsItem *lastStaffItem = m_staffItems.last();
-    if (lastStaffItem->measureCount() >= 4) {
+    if (lastStaffItem->measureCount() >= EngravingRules::MeasuresPerStaff) {
         appendStaff();
         lastStaffItem = m_staffItems.last();
     }
 
     lastStaffItem->insertChildItem(index, graphicsItem);
 }
+
+/*!
+ * \brief VisualPart::removeChildItem Removes the measure from its staff. The measures before
+ *        and after it are linked, so ties continue over the gap.
+ */
+void VisualPart::removeChildItem(VisualItem *childItem)
+{
+    InteractingGraphicsItem *graphicsItem = childItem->inlineGraphic();
+    if (!graphicsItem)
+        return;
+
+    MeasureGraphicsItem *measureItem = qgraphicsitem_cast<MeasureGraphicsItem*>(graphicsItem);
+    int index = m_measureItems.indexOf(measureItem);
+    if (index != -1) {
+        m_measureItems.removeAt(index);
+        measureItem->setPreviousMeasure(0);
+        if (index < m_measureItems.count()) {
+            m_measureItems.at(index)->setPreviousMeasure(index > 0 ? m_measureItems.at(index - 1) : 0);
+            if (index == 0)
+                m_measureItems.at(0)->setTimeSignatureVisible(true);
+        }
+    }
+
+    foreach (StaffGraphicsItem *staffItem, m_staffItems) {
+        staffItem->removeChildItem(graphicsItem);
+    }
+    graphicsItem->setVisible(false);
+    graphicsItem->deleteLater();
+}
+
+/*!
+ * \brief VisualPart::applyEngraving Applies the staves of this part engraved by the
+ *        EngravingPipeline to the measures in their order. Ties span measures, so their
+ *        items are recreated by the part, if the engraving of a measure has changed.
+ */
+void VisualPart::applyEngraving(const QVector<StaffEngraving> &staves)
+{
+    bool hasChanged = false;
+    int measureIndex = 0;
+    foreach (const StaffEngraving &staff, staves) {
+        foreach (const MeasureEngraving &measure, staff.measures) {
+            if (measureIndex >= m_measureItems.count())
+                break;
+            if (m_measureItems.at(measureIndex++)->applyEngraving(measure))
+                hasChanged = true;
+        }
+    }
+
+    if (hasChanged)
+        updateTieItems(staves);
+}
+
+/*!
+ * \brief VisualPart::updateTieItems Creates a TieGraphicsItem for every tie group of the staves.
+ *        A tie open at the end of a staff is continued by the first tie group of the next staff.
+ */
+void VisualPart::updateTieItems(const QVector<StaffEngraving> &staves)
+{
+    qDeleteAll(m_tieItems);
+    m_tieItems.clear();
+
+    TieGraphicsItem *openTieItem = 0;
+    int measureIndex = 0;
+    foreach (const StaffEngraving &staff, staves) {
+        QHash<int, TieGraphicsItem*> tieItems;
+        if (openTieItem)
+            tieItems.insert(0, openTieItem);
+
+        int lastTieGroup = -1;
+        foreach (const MeasureEngraving &measure, staff.measures) {
+            if (measureIndex >= m_measureItems.count())
+                return;
+
+            MeasureGraphicsItem *measureItem = m_measureItems.at(measureIndex++);
+            for (int i = 0; i < measure.symbols.count(); ++i) {
+                int tieGroup = measure.symbols.at(i).tieGroup;
+                if (tieGroup == -1)
+                    continue;
+
+                lastTieGroup = qMax(lastTieGroup, tieGroup);
+                GlyphItem *glyphItem = measureItem->glyphItemAt(i);
+                if (!glyphItem)
+                    continue;
+
+                TieGraphicsItem *tieItem = tieItems.value(tieGroup);
+                if (!tieItem) {
+                    tieItem = new TieGraphicsItem;
+                    tieItem->setMusicFont(LayoutSettings::musicFont());
+                    tieItems.insert(tieGroup, tieItem);
+                    m_tieItems.append(tieItem);
+                }
+                tieItem->addGlyph(glyphItem);
+            }
+        }
+
+        openTieItem = staff.tieOpenAtEnd ? tieItems.value(lastTieGroup) : 0;
+    }
+}
@@ -16,6 +16,8 @@
 
 class StaffGraphicsItem;
 class MeasureGraphicsItem;
+class TieGraphicsItem;
+struct StaffEngraving;
 
 class VisualPart : public VisualItem
 {
@@ -23,6 +25,7 @@ class VisualPart : public VisualItem
 
 public:
     explicit VisualPart(QObject *parent = 0);
+    ~VisualPart();
 
     void setRepeat(bool repeat);
     bool repeat() const;
@@ -37,14 +40,19 @@ public:
     // VisualItem interface
     void setData(const QVariant &value, int key);
     void insertChildItem(int index, VisualItem *childItem);
+    void removeChildItem(VisualItem *childItem);
+
+    void applyEngraving(const QVector<StaffEngraving> &staves);
 
     ClefType cleffType() const;
     void setCleffType(const ClefType &cleffType);
 
 private:
     StaffGraphicsItem *newStaffItem();
+    void updateTieItems(const QVector<StaffEngraving> &staves);
     QVector<StaffGraphicsItem*> m_staffItems;
     QList<MeasureGraphicsItem*> m_measureItems;
+    QList<TieGraphicsItem*> m_tieItems;
     bool m_repeat;
     StaffType m_staffType;
     ClefType m_cleffType;
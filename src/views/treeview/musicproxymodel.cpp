@@ -6,27 +6,47 @@
  *
  */
 
+/*!
+ * @class MusicProxyModel
+ * @brief Adds the pitch and length columns and the display texts of the music items to
+ *        the MusicModel for the TreeView.
+ *
+ * The proxy model neither sorts nor filters. It is an identity proxy, so the indexes are
+ * mapped without mapping tables and the column data is read directly from the music item.
+ */
+
 #include "musicproxymodel.h"
 #include <musicmodel.h>
 #include <common/itemdataroles.h>
 #include <common/datatypes/length.h>
 
 MusicProxyModel::MusicProxyModel(QObject *parent) :
-    QSortFilterProxyModel(parent)
+    QIdentityProxyModel(parent)
 {
 }
 
 QVariant MusicProxyModel::data(const QModelIndex &index, int role) const
 {
+    if (role != Qt::DisplayRole)
+        return QIdentityProxyModel::data(index, role);
+
+    MusicModel *model = musicModel();
+    if (!model || !index.isValid())
+        return QVariant();
+
+    const MusicItem *item = model->itemForIndex(mapToSource(index));
+    if (!item)
+        return QVariant();
+
     switch (index.column()) {
     case ItemColumn:
-        return itemColumnData(index, role);
+        return itemColumnData(item);
     case PitchColumn:
-        return pitchColumnData(index, role);
+        return pitchColumnData(item);
     case LengthColumn:
-        return lengthColumnData(index, role);
+        return lengthColumnData(item);
     }
-    return QSortFilterProxyModel::data(index, role);
+    return QIdentityProxyModel::data(index, role);
 }
 
 bool MusicProxyModel::setData(const QModelIndex &index, const QVariant &value, int role)
@@ -38,77 +58,54 @@ bool MusicProxyModel::setData(const QModelIndex &index, const QVariant &value, i
         }
         return model->setData(srcIndex, value, role);
     }
-    return QSortFilterProxyModel::setData(index, value, role);
+    return QIdentityProxyModel::setData(index, value, role);
 }
 
-QVariant MusicProxyModel::itemColumnData(const QModelIndex &index, int role) const
+QVariant MusicProxyModel::itemColumnData(const MusicItem *item) const
 {
-    MusicModel *model = musicModel();
-    if (!model)
-        return QVariant();
-    QModelIndex srcIndex = mapToSource(index);
-
-    if (role == Qt::DisplayRole) {
-
-        if (model->isIndexScore(srcIndex))
-            return index.data(LP::ScoreTitle);
-
-        if (model->isIndexTune(srcIndex)) {
-            int instrumentType = srcIndex.data(LP::TuneInstrument).toInt();
-            InstrumentMetaData instrument = m_pluginManager->instrumentMetaData(instrumentType);
-                return instrument.name() + " tune";
-        }
-
-        if (model->isIndexSymbol(srcIndex))
-            return index.data(LP::SymbolName);
-        if (model->isIndexPart(srcIndex))
-            return QString("Part");
-        if (model->isIndexMeasure(srcIndex))
-            return QString("Measure");
+    switch (item->type()) {
+    case LP::ItemType::ScoreType:
+        return item->data(LP::ScoreTitle);
+    case LP::ItemType::TuneType: {
+        int instrumentType = item->data(LP::TuneInstrument).toInt();
+        InstrumentMetaData instrument = m_pluginManager->instrumentMetaData(instrumentType);
+        return instrument.name() + " tune";
+    }
+    case LP::ItemType::PartType:
+        return QString("Part");
+    case LP::ItemType::MeasureType:
+        return QString("Measure");
+    case LP::ItemType::SymbolType:
+        return item->data(LP::SymbolName);
+    default:
+        return item->data(Qt::DisplayRole);
     }
-
-    return QSortFilterProxyModel::data(index, role);
 }
 
-QVariant MusicProxyModel::pitchColumnData(const QModelIndex &index, int role) const
+QVariant MusicProxyModel::pitchColumnData(const MusicItem *item) const
 {
-    MusicModel *model = musicModel();
-    if (!model)
-        return QVariant();
-
-    QModelIndex srcIndex = mapToSource(index);
-
-    if (role == Qt::DisplayRole) {
-        if (model->isIndexSymbol(srcIndex)) {
-            QVariant pitchVar = srcIndex.data(LP::SymbolPitch);
-            if (pitchVar.canConvert<Pitch>()) {
-                Pitch pitch = pitchVar.value<Pitch>();
-                return pitch.name();
-            }
+    if (item->type() == LP::ItemType::SymbolType) {
+        QVariant pitchVar = item->data(LP::SymbolPitch);
+        if (pitchVar.canConvert<Pitch>()) {
+            Pitch pitch = pitchVar.value<Pitch>();
+            return pitch.name();
         }
     }
-    return QSortFilterProxyModel::data(index, role);
+    return item->data(Qt::DisplayRole);
 }
 
-QVariant MusicProxyModel::lengthColumnData(const QModelIndex &index, int role) const
+QVariant MusicProxyModel::lengthColumnData(const MusicItem *item) const
 {
-    MusicModel *model = musicModel();
-    if (!model)
-        return QVariant();
-
-    QModelIndex srcIndex = mapToSource(index);
-
-    if (role == Qt::DisplayRole) {
-        if (model->isIndexSymbol(srcIndex)) {
-            QVariant lengthVar = srcIndex.data(LP::SymbolLength);
-            if (lengthVar.canConvert<Length::Value>()) {
-                Length::Value length = lengthVar.value<Length::Value>();
-                return length;
-            }
+    if (item->type() == LP::ItemType::SymbolType) {
+        QVariant lengthVar = item->data(LP::SymbolLength);
+        if (lengthVar.canConvert<Length::Value>()) {
+            Length::Value length = lengthVar.value<Length::Value>();
+            return length;
         }
     }
-    return QSortFilterProxyModel::data(index, role);
+    return item->data(Qt::DisplayRole);
 }
+
 PluginManager MusicProxyModel::pluginManager() const
 {
     return m_pluginManager;
@@ -136,7 +133,7 @@ QVariant MusicProxyModel::headerData(int section, Qt::Orientation orientation, i
 
 void MusicProxyModel::setSourceModel(QAbstractItemModel *sourceModel)
 {
-    QSortFilterProxyModel::setSourceModel(sourceModel);
+    QIdentityProxyModel::setSourceModel(sourceModel);
 
     MusicModel *model = musicModel();
     if (model)
@@ -192,6 +189,33 @@ QModelIndex MusicProxyModel::appendTuneToScore(const QModelIndex &score, const Q
     return QModelIndex();
 }
 
+QModelIndex MusicProxyModel::insertTuneIntoScore(int row, const QModelIndex &score, int instrumentType)
+{
+    if (MusicModel *model = musicModel()) {
+        QModelIndex srcIndex = mapToSource(score);
+        return mapFromSource(model->insertTuneIntoScore(row, srcIndex, instrumentType));
+    }
+    return QModelIndex();
+}
+
+QModelIndex MusicProxyModel::insertTuneWithScore(int rowOfScore, const QString &scoreTitle, int instrumentType)
+{
+    if (MusicModel *model = musicModel()) {
+        return mapFromSource(model->insertTuneWithScore(rowOfScore, scoreTitle, instrumentType));
+    }
+    return QModelIndex();
+}
+
+QModelIndex MusicProxyModel::appendTuneToScore(const QModelIndex &score, int instrumentType)
+{
+    if (MusicModel *model = musicModel()) {
+        QModelIndex srcScoreIndex = mapToSource(score);
+        QModelIndex srcIndex = model->appendTuneToScore(srcScoreIndex, instrumentType);
+        return mapFromSource(srcIndex);
+    }
+    return QModelIndex();
+}
+
 QModelIndex MusicProxyModel::insertPartIntoTune(int row, const QModelIndex &tune, int measures, bool withRepeat)
 {
     if (MusicModel *model = musicModel()) {
@@ -9,13 +9,13 @@
 #ifndef MUSICPROXYMODEL_H
 #define MUSICPROXYMODEL_H
 
-#include <QSortFilterProxyModel>
+#include <QIdentityProxyModel>
 #include <common/pluginmanagerinterface.h>
 #include <musicmodelinterface.h>
 
 class MusicModel;
 
-class MusicProxyModel : public QSortFilterProxyModel,
+class MusicProxyModel : public QIdentityProxyModel,
         public MusicModelInterface
 {
     Q_OBJECT
@@ -38,6 +38,9 @@ public:
     QModelIndex insertTuneIntoScore(int row, const QModelIndex &score, const QString &instrumentName);
     QModelIndex insertTuneWithScore(int rowOfScore, const QString &scoreTitle, const QString &instrumentName);
     QModelIndex appendTuneToScore(const QModelIndex &score, const QString &instrumentName);
+    QModelIndex insertTuneIntoScore(int row, const QModelIndex &score, int instrumentType);
+    QModelIndex insertTuneWithScore(int rowOfScore, const QString &scoreTitle, int instrumentType);
+    QModelIndex appendTuneToScore(const QModelIndex &score, int instrumentType);
     QModelIndex insertPartIntoTune(int row, const QModelIndex &tune, int measures, bool withRepeat=false);
     QModelIndex appendPartToTune(const QModelIndex &tune, int measures, bool withRepeat=false);
     QModelIndex insertMeasureIntoPart(int row, const QModelIndex &part);
@@ -66,9 +69,9 @@ public:
 
 private:
     MusicModel *musicModel() const;
-    QVariant itemColumnData(const QModelIndex &index, int role) const;
-    QVariant pitchColumnData(const QModelIndex &index, int role) const;
-    QVariant lengthColumnData(const QModelIndex &index, int role) const;
+    QVariant itemColumnData(const MusicItem *item) const;
+    QVariant pitchColumnData(const MusicItem *item) const;
+    QVariant lengthColumnData(const MusicItem *item) const;
     PluginManager m_pluginManager;
 };
 
@@ -10,16 +10,31 @@
 #include <QtTest>
 #include <QDebug>
 #include <QHash>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QtConcurrent/QtConcurrentRun>
 #include <app/commonpluginmanager.h>
+#include <common/defines.h>
 #include <common/datatypes/instrument.h>
 #include <common/pluginmanagerinterface.h>
 #include <common/interfaces/instrumentinterface.h>
 #include <common/interfaces/symbolinterface.h>
 #include <common/graphictypes/symbolgraphicbuilder.h>
+#include <common/itemdataroles.h>
+#include <common/datahandling/symbolbehavior.h>
 
 Q_IMPORT_PLUGIN(GreatHighlandBagpipe)
 Q_IMPORT_PLUGIN(IntegratedSymbols)
 
+namespace {
+const QString MetaDataCacheSettingsKey("PluginMetaDataCache");
+const QString RemovedPluginFile("removedplugin.so");
+}
+
 class CommonPluginManagerTest : public QObject
 {
     Q_OBJECT
@@ -37,9 +52,14 @@ private Q_SLOTS:
     void testLoadedDynamicPlugins();
     void testInstrumentForName();
     void testInstrumentNames();
+    void testInstrumentTypeForName();
     void testSymbolNamesForInstrument();
     void testGetSymbolByName();
     void testSymbolGraphicBuilderforType();
+    void testSymbolBehaviorIsClonedFromPrototype();
+    void testPluginMetaDataIsCached();
+    void testCacheOfRemovedPluginIsPruned();
+    void testConcurrentLookups();
 
 private:
     void loadStaticPlugins();
@@ -69,9 +89,19 @@ CommonPluginManagerTest::CommonPluginManagerTest()
 
 void CommonPluginManagerTest::initTestCase()
 {
+    // The meta data cache isn't shared with the application or other tests
+    QStandardPaths::setTestModeEnabled(true);
+    QCoreApplication::setOrganizationName("LimePipesTest");
+    QCoreApplication::setApplicationName("CommonPluginManagerTest");
+
     loadStaticPlugins();
     loadDynamicPlugins();
 
+    QJsonObject cache;
+    cache.insert(m_pluginsPath.absoluteFilePath(RemovedPluginFile), QJsonObject());
+    QSettings settings;
+    settings.setValue(MetaDataCacheSettingsKey, QJsonDocument(cache).toJson(QJsonDocument::Compact));
+
     m_commonPluginManager = new CommonPluginManager(m_pluginsPath, this);
     m_managerInstrumentNames = m_commonPluginManager->instrumentNames();
 }
@@ -79,6 +109,9 @@ void CommonPluginManagerTest::initTestCase()
 void CommonPluginManagerTest::cleanupTestCase()
 {
     qDeleteAll(m_symbolGraphicBuilder.values());
+
+    QSettings settings;
+    settings.remove(MetaDataCacheSettingsKey);
 }
 
 void CommonPluginManagerTest::testPreconditions()
@@ -130,6 +163,19 @@ void CommonPluginManagerTest::testInstrumentNames()
     }
 }
 
+void CommonPluginManagerTest::testInstrumentTypeForName()
+{
+    foreach (QString instrumentName, m_managerInstrumentNames) {
+        int instrumentType = m_commonPluginManager->instrumentTypeForName(instrumentName);
+        QVERIFY2(instrumentType != LP::NoInstrument, "No instrument type for instrument name");
+        QVERIFY2(m_commonPluginManager->instrumentMetaData(instrumentType).name() == instrumentName,
+                 "Instrument type has not the name it was looked up with");
+    }
+
+    QVERIFY2(m_commonPluginManager->instrumentTypeForName("No such instrument") == LP::NoInstrument,
+             "Unknown instrument name returned an instrument type");
+}
+
 void CommonPluginManagerTest::testSymbolNamesForInstrument()
 {
     QString instrumentName = "Great Highland Bagpipe";
@@ -152,6 +198,71 @@ void CommonPluginManagerTest::testGetSymbolByName()
     }
 }
 
+void CommonPluginManagerTest::testSymbolBehaviorIsClonedFromPrototype()
+{
+    SymbolBehavior *behavior = m_commonPluginManager->symbolBehaviorForType(LP::MelodyNote);
+    SymbolBehavior *otherBehavior = m_commonPluginManager->symbolBehaviorForType(LP::MelodyNote);
+    QVERIFY2(behavior != 0, "No behavior returned for melody note");
+    QVERIFY2(behavior != otherBehavior, "Same behavior returned twice");
+    QVERIFY2(behavior->symbolType() == LP::MelodyNote, "Clone has wrong symbol type");
+    QVERIFY2(behavior->supportsData(LP::MelodyNoteDots), "Clone lost supported data");
+
+    behavior->setData(2, LP::MelodyNoteDots);
+    QVERIFY2(behavior->toJson() != otherBehavior->toJson(), "Clone has no own data");
+    QVERIFY2(!otherBehavior->data(LP::MelodyNoteDots).isValid(), "Data of clones is shared");
+
+    delete behavior;
+    delete otherBehavior;
+}
+
+void CommonPluginManagerTest::testPluginMetaDataIsCached()
+{
+    QSettings settings;
+    QByteArray cachedJson(settings.value(MetaDataCacheSettingsKey).toByteArray());
+    QJsonObject cache(QJsonDocument::fromJson(cachedJson).object());
+
+    foreach (const QFileInfo &pluginFile, m_pluginsPath.entryInfoList(QDir::Files)) {
+        QJsonObject cacheEntry(cache.value(pluginFile.absoluteFilePath()).toObject());
+        QVERIFY2(!cacheEntry.isEmpty(), "Plugin meta data wasn't cached");
+        QVERIFY2(cacheEntry.value("lastModified").toDouble() ==
+                 static_cast<double>(pluginFile.lastModified().toMSecsSinceEpoch()),
+                 "Wrong modification time in cache");
+    }
+}
+
+void CommonPluginManagerTest::testCacheOfRemovedPluginIsPruned()
+{
+    QSettings settings;
+    QByteArray cachedJson(settings.value(MetaDataCacheSettingsKey).toByteArray());
+    QJsonObject cache(QJsonDocument::fromJson(cachedJson).object());
+
+    QVERIFY2(!cache.isEmpty(), "No plugin meta data cached");
+    QVERIFY2(!cache.contains(m_pluginsPath.absoluteFilePath(RemovedPluginFile)),
+             "Cache entry of removed plugin file wasn't pruned");
+}
+
+void CommonPluginManagerTest::testConcurrentLookups()
+{
+    // The static plugins are pending, so the first lookups load them concurrently
+    CommonPluginManager pluginManager;
+    QString expectedNames(m_commonPluginManager->symbolMetaData(LP::MelodyNote).name() +
+                          m_commonPluginManager->instrumentMetaData(LP::GreatHighlandBagpipe).name());
+
+    QList<QFuture<QString> > lookups;
+    for (int i = 0; i < 8; ++i) {
+        lookups << QtConcurrent::run([&pluginManager] () {
+            return pluginManager.symbolMetaData(LP::MelodyNote).name() +
+                    pluginManager.instrumentMetaData(LP::GreatHighlandBagpipe).name();
+        });
+    }
+
+    foreach (QFuture<QString> lookup, lookups) {
+        QVERIFY2(lookup.result() == expectedNames, "Concurrent lookup returned wrong meta data");
+    }
+    QVERIFY2(pluginManager.staticPluginsCount() == m_staticInstrumentPlugins,
+             "Static plugins were counted more than once");
+}
+
 void CommonPluginManagerTest::testSymbolGraphicBuilderforType()
 {
     foreach (int type, m_symbolGraphicBuilder.keys()) {
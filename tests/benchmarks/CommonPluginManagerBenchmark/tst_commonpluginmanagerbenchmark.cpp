@@ -0,0 +1,99 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#include <QString>
+#include <QtTest>
+#include <QMimeData>
+#include <app/commonpluginmanager.h>
+#include <common/defines.h>
+#include <common/itemdataroles.h>
+#include <musicmodel.h>
+
+Q_IMPORT_PLUGIN(GreatHighlandBagpipe)
+Q_IMPORT_PLUGIN(IntegratedSymbols)
+
+namespace {
+const int NoteCount = 10000;
+const int NotesPerMeasure = 8;
+const QString InstrumentName("Great Highland Bagpipe");
+}
+
+class CommonPluginManagerBenchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    CommonPluginManagerBenchmark();
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void benchmarkSymbolTypeLookup();
+    void benchmarkLoadDocument();
+
+private:
+    PluginManager m_pluginManager;
+    QMimeData *m_partMimeData;
+};
+
+CommonPluginManagerBenchmark::CommonPluginManagerBenchmark()
+    : m_partMimeData(0)
+{
+}
+
+void CommonPluginManagerBenchmark::initTestCase()
+{
+    CommonPluginManager *pluginManager = new CommonPluginManager;
+    m_pluginManager = PluginManager(pluginManager);
+    pluginManager->setSharedPluginManager(m_pluginManager);
+    QVERIFY2(m_pluginManager->instrumentNames().contains(InstrumentName),
+             "Bagpipe plugin wasn't loaded");
+
+    MusicModel model;
+    model.setPluginManager(m_pluginManager);
+    QModelIndex tune = model.insertTuneWithScore(0, "Benchmark", InstrumentName);
+    QModelIndex part = model.insertPartIntoTune(0, tune, NoteCount / NotesPerMeasure);
+    for (int i = 0; i < model.rowCount(part); ++i) {
+        QModelIndex measure = model.index(i, 0, part);
+        for (int j = 0; j < NotesPerMeasure; ++j) {
+            model.appendSymbolToMeasure(measure, LP::MelodyNote);
+        }
+    }
+
+    m_partMimeData = model.mimeData(QModelIndexList() << part);
+    QVERIFY2(m_partMimeData, "No mime data for part");
+}
+
+void CommonPluginManagerBenchmark::cleanupTestCase()
+{
+    delete m_partMimeData;
+}
+
+void CommonPluginManagerBenchmark::benchmarkSymbolTypeLookup()
+{
+    QBENCHMARK {
+        for (int i = 0; i < NoteCount; ++i) {
+            delete m_pluginManager->symbolBehaviorForType(LP::MelodyNote);
+            m_pluginManager->additionalDataForSymbolType(LP::MelodyNote);
+        }
+    }
+}
+
+void CommonPluginManagerBenchmark::benchmarkLoadDocument()
+{
+    QBENCHMARK {
+        MusicModel model;
+        model.setPluginManager(m_pluginManager);
+        QModelIndex tune = model.insertTuneWithScore(0, "Benchmark", InstrumentName);
+        QVERIFY(model.dropMimeData(m_partMimeData, Qt::CopyAction, -1, 0, tune));
+    }
+}
+
+QTEST_MAIN(CommonPluginManagerBenchmark)
+
+#include "tst_commonpluginmanagerbenchmark.moc"
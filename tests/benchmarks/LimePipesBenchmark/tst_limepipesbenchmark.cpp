@@ -0,0 +1,220 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#include <QString>
+#include <QtTest>
+#include <QMimeData>
+#include <QUndoStack>
+#include <QGraphicsWidget>
+#include <app/commonpluginmanager.h>
+#include <app/SMuFL/smuflloader.h>
+#include <common/defines.h>
+#include <common/itemdataroles.h>
+#include <common/layoutsettings.h>
+#include <common/datahandling/mimedata.h>
+#include <musicmodel.h>
+#include <scoregenerator.h>
+#include <plugins/GreatHighlandBagpipe/ghb_symboltypes.h>
+#include <graphicsitemview/pageviewitem/pageviewitem.h>
+#include <graphicsitemview/visualmusicmodel/visualmusicmodel.h>
+#include <graphicsitemview/visualmusicmodel/visualitemfactory.h>
+
+Q_IMPORT_PLUGIN(GreatHighlandBagpipe)
+Q_IMPORT_PLUGIN(IntegratedSymbols)
+
+namespace {
+const int SymbolCount = 10000;
+const int SymbolsPerMeasure = 8;
+const int PageCount = 100;
+const int RowHeight = 80;
+const int MaximumRowCount = 100000;
+const QString InstrumentName("Great Highland Bagpipe");
+const QStringList GlyphNames = QStringList() << "noteheadBlack" << "noteheadHalf"
+                                             << "noteheadWhole" << "flag8thUp"
+                                             << "flag16thUp" << "augmentationDot"
+                                             << "gClef" << "timeSig4";
+}
+
+class LimePipesBenchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    LimePipesBenchmark();
+
+private Q_SLOTS:
+    void initTestCase();
+    void benchmarkBuildTune();
+    void benchmarkGenerateBook();
+    void benchmarkVisualMusicModelPopulation();
+    void benchmarkPagination();
+    void benchmarkGlyphLookup();
+    void benchmarkMimeDataRoundTrip();
+    void benchmarkUndoRedoMacro();
+
+private:
+    QModelIndex fillModelWithTune(MusicModel *model);
+    PluginManager m_pluginManager;
+    MusicFontPtr m_musicFont;
+    SMuFLLoader *m_smuflLoader;
+};
+
+LimePipesBenchmark::LimePipesBenchmark()
+    : m_smuflLoader(0)
+{
+}
+
+void LimePipesBenchmark::initTestCase()
+{
+    m_smuflLoader = new SMuFLLoader();
+    m_smuflLoader->setFontFromPath(QStringLiteral(":/SMuFL/fonts/Bravura/Bravura.otf"));
+    m_smuflLoader->loadGlyphnamesFromFile(QStringLiteral(":/SMuFL/glyphnames.json"));
+    m_smuflLoader->loadFontMetadataFromFile(QStringLiteral(":/SMuFL/fonts/Bravura/metadata.json"));
+    m_musicFont = MusicFontPtr(m_smuflLoader);
+    LayoutSettings::setMusicFont(m_musicFont);
+
+    CommonPluginManager *pluginManager = new CommonPluginManager;
+    pluginManager->setMusicFont(m_musicFont);
+    m_pluginManager = PluginManager(pluginManager);
+    pluginManager->setSharedPluginManager(m_pluginManager);
+    QVERIFY2(m_pluginManager->instrumentNames().contains(InstrumentName),
+             "Bagpipe plugin wasn't loaded");
+}
+
+void LimePipesBenchmark::benchmarkBuildTune()
+{
+    QBENCHMARK {
+        MusicModel model;
+        model.setPluginManager(m_pluginManager);
+        fillModelWithTune(&model);
+    }
+}
+
+void LimePipesBenchmark::benchmarkGenerateBook()
+{
+    ScoreGenerator generator(m_pluginManager);
+    generator.setScoreCount(20);
+    generator.setTunesPerScore(2);
+    generator.setPartsPerTune(4);
+    generator.setMeasuresPerPart(16);
+    generator.setSymbolWeight(LP::Tie, 1);
+    generator.setSymbolWeight(GHB::Doubling, 2);
+
+    QBENCHMARK {
+        MusicModel model;
+        model.setPluginManager(m_pluginManager);
+        generator.insertScores(&model, 0);
+    }
+}
+
+void LimePipesBenchmark::benchmarkVisualMusicModelPopulation()
+{
+    QBENCHMARK {
+        VisualItemFactory itemFactory;
+        itemFactory.setPluginManager(m_pluginManager);
+        MusicModel model;
+        model.setPluginManager(m_pluginManager);
+        VisualMusicModel visualMusicModel(&itemFactory);
+        visualMusicModel.setPluginManager(m_pluginManager);
+        visualMusicModel.setModel(&model);
+
+        fillModelWithTune(&model);
+    }
+}
+
+void LimePipesBenchmark::benchmarkPagination()
+{
+    QBENCHMARK {
+        PageViewItem pageView;
+        for (int i = 0; pageView.pageCount() < PageCount && i < MaximumRowCount; ++i) {
+            QGraphicsWidget *row = new QGraphicsWidget();
+            row->setMinimumHeight(RowHeight);
+            row->setPreferredHeight(RowHeight);
+            pageView.appendRow(row);
+        }
+        QVERIFY2(pageView.pageCount() == PageCount, "Wrong page count");
+    }
+}
+
+void LimePipesBenchmark::benchmarkGlyphLookup()
+{
+    QVERIFY2(m_smuflLoader->codepointForGlyph(GlyphNames.first()),
+             "Glyph names weren't loaded");
+
+    quint32 codepointSum = 0;
+    QBENCHMARK {
+        for (int i = 0; i < SymbolCount; ++i) {
+            const QString &glyphName = GlyphNames.at(i % GlyphNames.count());
+            codepointSum += m_smuflLoader->codepointForGlyph(glyphName);
+            m_smuflLoader->glyphData(glyphName);
+        }
+    }
+    QVERIFY(codepointSum);
+}
+
+void LimePipesBenchmark::benchmarkMimeDataRoundTrip()
+{
+    MusicModel model;
+    model.setPluginManager(m_pluginManager);
+    QModelIndex tune = fillModelWithTune(&model);
+    QJsonArray tunes;
+    tunes.append(model.itemForIndex(tune)->toJson());
+    QString mimeType = MimeData::mimeTypeForItemType(LP::ItemType::TuneType);
+
+    QJsonArray decodedTunes;
+    QBENCHMARK {
+        QScopedPointer<QMimeData> mimeData(MimeData::fromJsonArray(tunes));
+
+        // Data from another application has to be decoded
+        QMimeData externalMimeData;
+        externalMimeData.setData(mimeType, mimeData->data(mimeType));
+        decodedTunes = MimeData::toJsonArray(&externalMimeData);
+    }
+    QVERIFY2(decodedTunes == tunes, "Tune changed after round trip");
+}
+
+void LimePipesBenchmark::benchmarkUndoRedoMacro()
+{
+    MusicModel model;
+    model.setPluginManager(m_pluginManager);
+    QModelIndex tune = model.insertTuneWithScore(0, "Benchmark", InstrumentName);
+    QUndoStack *undoStack = model.undoStack();
+
+    undoStack->beginMacro("Add part with symbols");
+    QModelIndex part = model.insertPartIntoTune(0, tune, SymbolCount / SymbolsPerMeasure);
+    for (int i = 0; i < model.rowCount(part); ++i) {
+        QModelIndex measure = model.index(i, 0, part);
+        for (int j = 0; j < SymbolsPerMeasure; ++j) {
+            model.appendSymbolToMeasure(measure, LP::MelodyNote);
+        }
+    }
+    undoStack->endMacro();
+
+    QBENCHMARK {
+        undoStack->undo();
+        undoStack->redo();
+    }
+    QVERIFY2(model.rowCount(tune) == 1, "Part wasn't restored");
+}
+
+QModelIndex LimePipesBenchmark::fillModelWithTune(MusicModel *model)
+{
+    QModelIndex tune = model->insertTuneWithScore(0, "Benchmark", InstrumentName);
+    QModelIndex part = model->insertPartIntoTune(0, tune, SymbolCount / SymbolsPerMeasure);
+    for (int i = 0; i < model->rowCount(part); ++i) {
+        QModelIndex measure = model->index(i, 0, part);
+        for (int j = 0; j < SymbolsPerMeasure; ++j) {
+            model->appendSymbolToMeasure(measure, LP::MelodyNote);
+        }
+    }
+    return tune;
+}
+
+QTEST_MAIN(LimePipesBenchmark)
+
+#include "tst_limepipesbenchmark.moc"
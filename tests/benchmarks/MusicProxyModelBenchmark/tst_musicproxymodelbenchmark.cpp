@@ -0,0 +1,124 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#include <QString>
+#include <QtTest>
+#include <QTreeView>
+#include <app/commonpluginmanager.h>
+#include <common/defines.h>
+#include <common/itemdataroles.h>
+#include <musicmodel.h>
+#include <views/treeview/musicproxymodel.h>
+
+Q_IMPORT_PLUGIN(GreatHighlandBagpipe)
+Q_IMPORT_PLUGIN(IntegratedSymbols)
+
+namespace {
+const int TuneCount = 50;
+const int PartsPerTune = 2;
+const int MeasuresPerPart = 16;
+const int NotesPerMeasure = 8;
+const QString InstrumentName("Great Highland Bagpipe");
+}
+
+class MusicProxyModelBenchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    MusicProxyModelBenchmark();
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void benchmarkExpandAll();
+    void benchmarkDisplayData();
+
+private:
+    int displayDataOfChildren(const QModelIndex &parent);
+    PluginManager m_pluginManager;
+    MusicModel *m_model;
+    MusicProxyModel *m_proxyModel;
+};
+
+MusicProxyModelBenchmark::MusicProxyModelBenchmark()
+    : m_model(0),
+      m_proxyModel(0)
+{
+}
+
+void MusicProxyModelBenchmark::initTestCase()
+{
+    CommonPluginManager *pluginManager = new CommonPluginManager;
+    m_pluginManager = PluginManager(pluginManager);
+    pluginManager->setSharedPluginManager(m_pluginManager);
+
+    m_model = new MusicModel(this);
+    m_model->setPluginManager(m_pluginManager);
+    for (int i = 0; i < TuneCount; ++i) {
+        QModelIndex tune = m_model->insertTuneWithScore(i, QString("Tune %1").arg(i), InstrumentName);
+        for (int j = 0; j < PartsPerTune; ++j) {
+            QModelIndex part = m_model->appendPartToTune(tune, MeasuresPerPart);
+            for (int k = 0; k < m_model->rowCount(part); ++k) {
+                QModelIndex measure = m_model->index(k, 0, part);
+                for (int l = 0; l < NotesPerMeasure; ++l) {
+                    m_model->appendSymbolToMeasure(measure, LP::MelodyNote);
+                }
+            }
+        }
+    }
+    QVERIFY2(m_model->rowCount(QModelIndex()) == TuneCount, "Book wasn't created");
+
+    m_proxyModel = new MusicProxyModel(this);
+    m_proxyModel->setPluginManager(m_pluginManager);
+    m_proxyModel->setSourceModel(m_model);
+}
+
+void MusicProxyModelBenchmark::cleanupTestCase()
+{
+    delete m_proxyModel;
+    delete m_model;
+}
+
+void MusicProxyModelBenchmark::benchmarkExpandAll()
+{
+    QTreeView treeView;
+    treeView.setModel(m_proxyModel);
+
+    QBENCHMARK {
+        treeView.expandAll();
+        treeView.collapseAll();
+    }
+}
+
+void MusicProxyModelBenchmark::benchmarkDisplayData()
+{
+    int itemCount = 0;
+    QBENCHMARK {
+        itemCount = displayDataOfChildren(QModelIndex());
+    }
+
+    int expectedCount = TuneCount * (2 + PartsPerTune * (1 + MeasuresPerPart * (1 + NotesPerMeasure)));
+    QVERIFY2(itemCount == expectedCount, "Not all items were visited");
+}
+
+int MusicProxyModelBenchmark::displayDataOfChildren(const QModelIndex &parent)
+{
+    int count = 0;
+    for (int row = 0; row < m_proxyModel->rowCount(parent); ++row) {
+        for (int column = 0; column < m_proxyModel->columnCount(parent); ++column) {
+            m_proxyModel->index(row, column, parent).data(Qt::DisplayRole);
+        }
+        count += 1 + displayDataOfChildren(m_proxyModel->index(row, 0, parent));
+    }
+    return count;
+}
+
+QTEST_MAIN(MusicProxyModelBenchmark)
+
+#include "tst_musicproxymodelbenchmark.moc"
@@ -30,6 +30,8 @@ private Q_SLOTS:
     void testUnregisterObserver();
     void testNotifyCategory();
     void testIsObserverRegistered();
+    void testNotifyId();
+    void testCoalescedNotifications();
 };
 
 ObservableSettingsTest::ObservableSettingsTest()
@@ -38,7 +40,7 @@ ObservableSettingsTest::ObservableSettingsTest()
 
 void ObservableSettingsTest::init()
 {
-    ObservableSettings::m_settingsObserver.clear();
+    ObservableSettings::removeAllObservers();
 }
 
 void ObservableSettingsTest::cleanup()
@@ -47,34 +49,34 @@ void ObservableSettingsTest::cleanup()
 
 void ObservableSettingsTest::testRegisterObserver()
 {
-    Q_ASSERT(ObservableSettings::m_settingsObserver.count() == 0);
+    Q_ASSERT(ObservableSettings::m_subscriptions.count() == 0);
 
     TestSettingsObserver *testObserver = new TestSettingsObserver(this);
     testObserver->setSettingsCategory(Category::NoCategory);
     ObservableSettings::registerObserver(testObserver);
-    QVERIFY2(ObservableSettings::m_settingsObserver.count() == 0,
+    QVERIFY2(ObservableSettings::m_subscriptions.count() == 0,
              "Observer was registered despite no settings category");
 
     testObserver->setSettingsCategory(Category::Score);
     ObservableSettings::registerObserver(testObserver);
-    QVERIFY2(ObservableSettings::m_settingsObserver.count() == 1,
+    QVERIFY2(ObservableSettings::m_subscriptions.count() == 1,
              "Observer wasn't registered.");
 }
 
 void ObservableSettingsTest::testUnregisterObserver()
 {
-    Q_ASSERT(ObservableSettings::m_settingsObserver.count() == 0);
+    Q_ASSERT(ObservableSettings::m_subscriptions.count() == 0);
 
-    ObservableSettings::m_settingsObserver.clear();
-    Q_ASSERT(ObservableSettings::m_settingsObserver.count() == 0);
+    ObservableSettings::removeAllObservers();
+    Q_ASSERT(ObservableSettings::m_subscriptions.count() == 0);
 
     TestSettingsObserver *testObserver = new TestSettingsObserver(this);
     testObserver->setSettingsCategory(Category::Score);
     ObservableSettings::registerObserver(testObserver);
-    Q_ASSERT(ObservableSettings::m_settingsObserver.count());
+    Q_ASSERT(ObservableSettings::m_subscriptions.count());
 
     ObservableSettings::unregisterObserver(testObserver);
-    QVERIFY2(ObservableSettings::m_settingsObserver.count() == 0,
+    QVERIFY2(ObservableSettings::m_subscriptions.count() == 0,
              "Observer wasn't unregistered");
 
     delete testObserver;
@@ -82,7 +84,7 @@ void ObservableSettingsTest::testUnregisterObserver()
 
 void ObservableSettingsTest::testNotifyCategory()
 {
-    Q_ASSERT(ObservableSettings::m_settingsObserver.count() == 0);
+    Q_ASSERT(ObservableSettings::m_subscriptions.count() == 0);
 
     TestSettingsObserver *testObserverScoreSettings = new TestSettingsObserver();
     testObserverScoreSettings->setSettingsCategory(Category::Score);
@@ -95,9 +97,9 @@ void ObservableSettingsTest::testNotifyCategory()
     ObservableSettings::registerObserver(testObserverScoreSettings);
     ObservableSettings::registerObserver(testObserverTuneSettings);
 
-    Q_ASSERT(ObservableSettings::m_settingsObserver.count() == 2);
+    Q_ASSERT(ObservableSettings::m_subscriptions.count() == 2);
 
-    ObservableSettings::notify(Category::Score);
+    ObservableSettings::notify(Category::Score, Id::ScoreData);
 
     QVERIFY2(scoreSpy.count() == 1,
              "Notify wasn't called on settings observer");
@@ -118,6 +120,59 @@ void ObservableSettingsTest::testIsObserverRegistered()
              "Observer wasn't registered");
 }
 
-QTEST_APPLESS_MAIN(ObservableSettingsTest)
+void ObservableSettingsTest::testNotifyId()
+{
+    TestSettingsObserver *pageLayoutObserver = new TestSettingsObserver();
+    pageLayoutObserver->setSettingsCategory(Category::Layout);
+    TestSettingsObserver *layoutObserver = new TestSettingsObserver();
+    layoutObserver->setSettingsCategory(Category::Layout);
+
+    QSignalSpy pageLayoutSpy(pageLayoutObserver, SIGNAL(notifyCalled()));
+    QSignalSpy layoutSpy(layoutObserver, SIGNAL(notifyCalled()));
+
+    ObservableSettings::registerObserver(pageLayoutObserver, Id::PageLayout);
+    ObservableSettings::registerObserver(layoutObserver);
+
+    ObservableSettings::notify(Category::Layout, Id::StaffSpace);
+    QVERIFY2(pageLayoutSpy.count() == 0, "Observer was notified for an id it isn't registered for");
+    QVERIFY2(layoutSpy.count() == 1, "Observer of the category wasn't notified");
+
+    ObservableSettings::notify(Category::Layout, Id::PageLayout);
+    QVERIFY2(pageLayoutSpy.count() == 1, "Observer wasn't notified for its id");
+    QVERIFY2(layoutSpy.count() == 2, "Observer of the category wasn't notified");
+
+    ObservableSettings::unregisterObserver(pageLayoutObserver);
+    ObservableSettings::notify(Category::Layout, Id::PageLayout);
+    QVERIFY2(pageLayoutSpy.count() == 1, "Unregistered observer was notified");
+
+    delete pageLayoutObserver;
+    delete layoutObserver;
+}
+
+void ObservableSettingsTest::testCoalescedNotifications()
+{
+    TestSettingsObserver *testObserver = new TestSettingsObserver();
+    testObserver->setSettingsCategory(Category::Layout);
+    QSignalSpy notifySpy(testObserver, SIGNAL(notifyCalled()));
+
+    ObservableSettings::registerObserver(testObserver, ObservableSettings::NotifyCoalesced);
+
+    ObservableSettings::notify(Category::Layout, Id::PageLayout);
+    ObservableSettings::notify(Category::Layout, Id::PageLayout);
+    ObservableSettings::notify(Category::Layout, Id::StaffSpace);
+    QVERIFY2(notifySpy.count() == 0, "Coalesced observer was notified immediately");
+
+    QCoreApplication::processEvents();
+    QVERIFY2(notifySpy.count() == 2, "Coalesced observer wasn't notified once per id");
+
+    ObservableSettings::notify(Category::Layout, Id::PageLayout);
+    ObservableSettings::unregisterObserver(testObserver);
+    QCoreApplication::processEvents();
+    QVERIFY2(notifySpy.count() == 2, "Unregistered observer got a pending notification");
+
+    delete testObserver;
+}
+
+QTEST_GUILESS_MAIN(ObservableSettingsTest)
 
 #include "tst_observablesettingstest.moc"
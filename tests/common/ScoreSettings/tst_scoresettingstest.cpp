@@ -36,6 +36,7 @@ private Q_SLOTS:
     void testSetRow();
     void testSetAlignment();
     void testNotifyObservers();
+    void testValuesAreCached();
 
 private:
     void clearSettings();
@@ -232,10 +233,34 @@ void ScoreSettingsTest::testNotifyObservers()
     delete testObserver;
 }
 
+void ScoreSettingsTest::testValuesAreCached()
+{
+    clearSettings();
+
+    m_scoreSettings->setScoreArea(Header);
+    m_scoreSettings->setDataRole(LP::ScoreTitle);
+    int defaultRow = m_scoreSettings->value(Row).toInt();
+
+    // Write around the cache
+    m_scoreSettings->m_settings->setValue(ScoreSettings::getKey(Header, LP::ScoreTitle, Row), defaultRow + 1);
+    QVERIFY2(m_scoreSettings->value(Row).toInt() == defaultRow,
+             "Value wasn't read from cache");
+
+    ScoreSettings otherSettings(Header, LP::ScoreTitle);
+    otherSettings.setValue(Row, defaultRow + 2);
+    QVERIFY2(m_scoreSettings->value(Row).toInt() == defaultRow + 2,
+             "Cache wasn't invalidated by setting a value");
+
+    m_scoreSettings->m_settings->setValue(ScoreSettings::getKey(Header, LP::ScoreTitle, Row), defaultRow + 3);
+    ScoreSettings::notify(Category::Score, Id::ScoreData);
+    QVERIFY2(m_scoreSettings->value(Row).toInt() == defaultRow + 3,
+             "Cache wasn't invalidated by notify");
+}
+
 void ScoreSettingsTest::clearSettings()
 {
-    m_scoreSettings->m_settings->clear();
-    m_scoreSettings->m_settings->sync();
+    m_scoreSettings->clear();
+    m_scoreSettings->sync();
 }
 
 QTEST_APPLESS_MAIN(ScoreSettingsTest)
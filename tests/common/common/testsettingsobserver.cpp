@@ -9,11 +9,12 @@
 #include "testsettingsobserver.h"
 
 TestSettingsObserver::TestSettingsObserver(QObject *parent)
-    : SettingsObserver(parent)
+    : QObject(parent)
 {
 }
 
-void TestSettingsObserver::notify()
+void TestSettingsObserver::notify(Settings::Id id)
 {
+    Q_UNUSED(id);
     emit notifyCalled();
 }
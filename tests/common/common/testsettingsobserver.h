@@ -20,7 +20,7 @@ class TestSettingsObserver : public QObject,
 public:
     explicit TestSettingsObserver(QObject *parent = 0);
 
-    void notify();
+    void notify(Settings::Id id);
 
 signals:
     void notifyCalled();
@@ -0,0 +1,262 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#include <QString>
+#include <QtTest>
+#include <QSignalSpy>
+#include <QStandardItemModel>
+#include <common/defines.h>
+#include <common/itemdataroles.h>
+#include <common/engraving/engravingrules.h>
+#include <src/common/engraving/engravingpipeline.h>
+
+class EngravingPipelineTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    EngravingPipelineTest() {}
+
+private Q_SLOTS:
+    void init();
+    void testSymbolPositions();
+    void testLedgerLines();
+    void testBeamGroups();
+    void testTieOverMeasures();
+    void testTieOverStaves();
+    void testEqualEngravingOfUnchangedMeasure();
+    void testAsynchronousEngraving();
+    void testSnapshotFromModel();
+    void testSnapshotFromModelWithCache();
+
+private:
+    SymbolSnapshot note(Length::Value length, int staffPos = 4) const;
+    SymbolSnapshot tie(SpanType spanType) const;
+    EngravingMetrics m_metrics;
+};
+
+void EngravingPipelineTest::init()
+{
+    m_metrics = EngravingMetrics();
+    m_metrics.staffSpace = 10;
+    m_metrics.glyphWidths.insert(QStringLiteral("noteheadBlack"), 12);
+    m_metrics.symbolWidths.insert(LP::Tie, 0);
+}
+
+SymbolSnapshot EngravingPipelineTest::note(Length::Value length, int staffPos) const
+{
+    SymbolSnapshot symbol;
+    symbol.symbolType = LP::MelodyNote;
+    symbol.length = length;
+    symbol.hasLength = true;
+    symbol.staffPos = staffPos;
+    symbol.hasPitch = true;
+    return symbol;
+}
+
+SymbolSnapshot EngravingPipelineTest::tie(SpanType spanType) const
+{
+    SymbolSnapshot symbol;
+    symbol.symbolType = LP::Tie;
+    symbol.spanType = spanType;
+    return symbol;
+}
+
+void EngravingPipelineTest::testSymbolPositions()
+{
+    MeasureSnapshot measure;
+    measure.symbols << note(Length::_4) << note(Length::_4) << note(Length::_4);
+    StaffSnapshot staff;
+    staff.measures << measure;
+
+    StaffEngraving engraving = EngravingPipeline::engraveStaff(staff, m_metrics);
+    QVERIFY2(engraving.measures.count() == 1, "Wrong measure count");
+    const MeasureEngraving &measureEngraving = engraving.measures.at(0);
+    QVERIFY2(measureEngraving.symbols.at(0).x == 0, "Wrong position of first symbol");
+    QVERIFY2(measureEngraving.symbols.at(2).x == 24, "Wrong position of last symbol");
+    QVERIFY2(measureEngraving.width == 36, "Wrong measure width");
+}
+
+void EngravingPipelineTest::testLedgerLines()
+{
+    MeasureSnapshot measure;
+    measure.symbols << note(Length::_4, -4) << note(Length::_4, 4);
+    StaffSnapshot staff;
+    staff.measures << measure;
+
+    StaffEngraving engraving = EngravingPipeline::engraveStaff(staff, m_metrics);
+    const SymbolEngraving &highNote = engraving.measures.at(0).symbols.at(0);
+    QVERIFY2(highNote.ledgerLines == 2, "Wrong ledger line count");
+    QVERIFY2(highNote.ledgerLinesAbove, "Ledger lines aren't above");
+    QVERIFY2(engraving.measures.at(0).symbols.at(1).ledgerLines == 0, "Note in staff has ledger lines");
+}
+
+void EngravingPipelineTest::testBeamGroups()
+{
+    MeasureSnapshot measure;
+    measure.timeSignature = TimeSignature::_2_4;
+    measure.symbols << note(Length::_8, 2) << note(Length::_8, 6)
+                    << note(Length::_4);
+    StaffSnapshot staff;
+    staff.measures << measure;
+
+    StaffEngraving engraving = EngravingPipeline::engraveStaff(staff, m_metrics);
+    const MeasureEngraving &measureEngraving = engraving.measures.at(0);
+    QVERIFY2(measureEngraving.symbols.at(0).beamGroup == 0, "First eighth isn't beamed");
+    QVERIFY2(measureEngraving.symbols.at(1).beamGroup == 0, "Second eighth isn't beamed");
+    QVERIFY2(measureEngraving.symbols.at(2).beamGroup == -1, "Quarter is beamed");
+    QVERIFY2(measureEngraving.symbols.at(0).beamCount == 1, "Wrong beam count");
+    QVERIFY2(measureEngraving.symbols.at(0).flagGlyph.isEmpty(), "Beamed note has a flag");
+    QVERIFY2(measureEngraving.symbols.at(0).stemLength > measureEngraving.symbols.at(1).stemLength,
+             "Stem of higher note isn't extended to the beam");
+}
+
+void EngravingPipelineTest::testTieOverMeasures()
+{
+    MeasureSnapshot firstMeasure;
+    firstMeasure.symbols << tie(SpanType::Start) << note(Length::_4);
+    MeasureSnapshot secondMeasure;
+    secondMeasure.symbols << note(Length::_4) << tie(SpanType::End) << note(Length::_4);
+    StaffSnapshot staff;
+    staff.measures << firstMeasure << secondMeasure;
+
+    StaffEngraving engraving = EngravingPipeline::engraveStaff(staff, m_metrics);
+    QVERIFY2(engraving.measures.at(0).symbols.at(1).tieGroup == 0, "Note isn't tied");
+    QVERIFY2(engraving.measures.at(1).symbols.at(0).tieGroup == 0, "Note in next measure isn't tied");
+    QVERIFY2(engraving.measures.at(1).symbols.at(2).tieGroup == -1, "Note after tie end is tied");
+    QVERIFY2(!engraving.tieOpenAtEnd, "Closed tie is open at end of staff");
+}
+
+void EngravingPipelineTest::testTieOverStaves()
+{
+    MeasureSnapshot measure;
+    measure.symbols << note(Length::_4) << tie(SpanType::End) << note(Length::_4);
+    StaffSnapshot staff;
+    staff.tieOpenAtStart = true;
+    staff.measures << measure;
+
+    StaffEngraving engraving = EngravingPipeline::engraveStaff(staff, m_metrics);
+    QVERIFY2(engraving.measures.at(0).symbols.at(0).tieGroup == 0,
+             "Note at start of staff doesn't continue the tie");
+    QVERIFY2(engraving.measures.at(0).symbols.at(2).tieGroup == -1, "Note after tie end is tied");
+}
+
+void EngravingPipelineTest::testEqualEngravingOfUnchangedMeasure()
+{
+    MeasureSnapshot beamedMeasure;
+    beamedMeasure.timeSignature = TimeSignature::_2_4;
+    beamedMeasure.symbols << note(Length::_8) << note(Length::_8);
+    StaffSnapshot staff;
+    staff.measures << beamedMeasure << beamedMeasure;
+
+    StaffEngraving engraving = EngravingPipeline::engraveStaff(staff, m_metrics);
+    QVERIFY2(engraving.measures.at(0) == engraving.measures.at(1),
+             "Beam groups aren't numbered per measure");
+
+    staff.measures[0].symbols << note(Length::_8);
+    StaffEngraving changedEngraving = EngravingPipeline::engraveStaff(staff, m_metrics);
+    QVERIFY2(changedEngraving.measures.at(0) != engraving.measures.at(0), "Changed measure is equal");
+    QVERIFY2(changedEngraving.measures.at(1) == engraving.measures.at(1), "Unchanged measure differs");
+}
+
+void EngravingPipelineTest::testAsynchronousEngraving()
+{
+    ScoreSnapshot score;
+    for (int i = 0; i < 8; ++i) {
+        MeasureSnapshot measure;
+        measure.symbols << note(Length::_4) << note(Length::_8);
+        StaffSnapshot staff;
+        staff.measures << measure;
+        score.staves << staff;
+    }
+
+    EngravingPipeline pipeline;
+    QSignalSpy spy(&pipeline, SIGNAL(engraved(int,QVector<StaffEngraving>)));
+    int generation = pipeline.engrave(score, m_metrics);
+    QVERIFY2(spy.wait(5000), "Pipeline didn't finish");
+
+    QList<QVariant> arguments = spy.takeFirst();
+    QVERIFY2(arguments.at(0).toInt() == generation, "Wrong generation");
+    QVector<StaffEngraving> staves = arguments.at(1).value<QVector<StaffEngraving> >();
+    QVERIFY2(staves.count() == score.staves.count(), "Not all staves were engraved");
+    QVERIFY2(staves.last().measures.at(0).symbols.at(1).x == 12, "Wrong position in engraved staff");
+}
+
+void EngravingPipelineTest::testSnapshotFromModel()
+{
+    QStandardItemModel model;
+    QStandardItem *score = new QStandardItem;
+    QStandardItem *tune = new QStandardItem;
+    QStandardItem *firstPart = new QStandardItem;
+    QStandardItem *emptyPart = new QStandardItem;
+    model.appendRow(score);
+    score->appendRow(tune);
+    tune->appendRow(firstPart);
+    tune->appendRow(emptyPart);
+
+    for (int i = 0; i < EngravingRules::MeasuresPerStaff + 1; ++i) {
+        QStandardItem *measure = new QStandardItem;
+        QStandardItem *symbol = new QStandardItem;
+        symbol->setData(i ? LP::MelodyNote : LP::Tie, LP::SymbolType);
+        measure->appendRow(symbol);
+        firstPart->appendRow(measure);
+    }
+
+    ScoreSnapshot snapshot = EngravingPipeline::snapshotFromModel(&model, score->index());
+    QVERIFY2(snapshot.staves.count() == 3, "Wrong staff count");
+    QVERIFY2(snapshot.staves.at(0).measures.count() == EngravingRules::MeasuresPerStaff,
+             "First staff isn't full");
+    QVERIFY2(snapshot.partStaffCounts == QVector<int>() << 2 << 1, "Wrong staff counts of the parts");
+    QVERIFY2(snapshot.symbolTypes() == QSet<int>() << LP::MelodyNote << LP::Tie,
+             "Wrong symbol types");
+}
+
+void EngravingPipelineTest::testSnapshotFromModelWithCache()
+{
+    QStandardItemModel model;
+    QStandardItem *score = new QStandardItem;
+    QStandardItem *tune = new QStandardItem;
+    QStandardItem *part = new QStandardItem;
+    model.appendRow(score);
+    score->appendRow(tune);
+    tune->appendRow(part);
+
+    QList<QStandardItem*> symbols;
+    for (int i = 0; i < 2; ++i) {
+        QStandardItem *measure = new QStandardItem;
+        QStandardItem *symbol = new QStandardItem;
+        symbol->setData(LP::MelodyNote, LP::SymbolType);
+        measure->appendRow(symbol);
+        part->appendRow(measure);
+        symbols << symbol;
+    }
+
+    MeasureSnapshotCache cache;
+    QSet<int> readSymbolTypes;
+    EngravingPipeline::snapshotFromModel(&model, score->index(), &cache, &readSymbolTypes);
+    QVERIFY2(cache.count() == 2, "Measures weren't cached");
+    QVERIFY2(readSymbolTypes == QSet<int>() << LP::MelodyNote, "Wrong read symbol types");
+
+    // Only the measure removed from the cache is read again
+    symbols.at(0)->setData(LP::Tie, LP::SymbolType);
+    symbols.at(1)->setData(LP::Tie, LP::SymbolType);
+    cache.remove(symbols.at(1)->parent()->index());
+    readSymbolTypes.clear();
+    ScoreSnapshot snapshot = EngravingPipeline::snapshotFromModel(&model, score->index(), &cache,
+                                                                  &readSymbolTypes);
+    const StaffSnapshot &staff = snapshot.staves.at(0);
+    QVERIFY2(staff.measures.at(0).symbols.at(0).symbolType == LP::MelodyNote,
+             "Cached measure was read again");
+    QVERIFY2(staff.measures.at(1).symbols.at(0).symbolType == LP::Tie,
+             "Changed measure wasn't read again");
+    QVERIFY2(readSymbolTypes == QSet<int>() << LP::Tie, "Wrong read symbol types");
+}
+
+QTEST_MAIN(EngravingPipelineTest)
+
+#include "tst_engravingpipelinetest.moc"
@@ -0,0 +1,59 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#include <QString>
+#include <QtTest>
+#include <common/datatypes/length.h>
+#include <common/datatypes/timesignature.h>
+#include <src/common/engraving/engravingrules.h>
+
+class EngravingRulesTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    EngravingRulesTest() {}
+
+private Q_SLOTS:
+    void testTicksOfLength();
+    void testBeamCountOfLength();
+    void testBeatTicks();
+};
+
+void EngravingRulesTest::testTicksOfLength()
+{
+    int quarter = EngravingRules::WholeNoteTicks / 4;
+    QVERIFY2(EngravingRules::ticksOfLength(Length::_4) == quarter, "Wrong ticks for quarter");
+    QVERIFY2(EngravingRules::ticksOfLength(Length::_8) == quarter / 2, "Wrong ticks for eighth");
+    QVERIFY2(EngravingRules::ticksOfLength(Length::_4, 1) == quarter + quarter / 2,
+             "Wrong ticks for dotted quarter");
+    QVERIFY2(EngravingRules::ticksOfLength(Length::_4, 2) == quarter + quarter / 2 + quarter / 4,
+             "Wrong ticks for double dotted quarter");
+}
+
+void EngravingRulesTest::testBeamCountOfLength()
+{
+    QVERIFY2(EngravingRules::beamCountOfLength(Length::_4) == 0, "Quarter has a beam");
+    QVERIFY2(EngravingRules::beamCountOfLength(Length::_8) == 1, "Wrong beam count for eighth");
+    QVERIFY2(EngravingRules::beamCountOfLength(Length::_32) == 3, "Wrong beam count for 32nd");
+}
+
+void EngravingRulesTest::testBeatTicks()
+{
+    int quarter = EngravingRules::WholeNoteTicks / 4;
+    QVERIFY2(EngravingRules::beatTicks(TimeSignature::_2_4) == quarter, "Wrong beat for 2/4");
+    QVERIFY2(EngravingRules::beatTicks(TimeSignature::_6_8) == quarter + quarter / 2,
+             "6/8 isn't beamed in dotted quarters");
+    QVERIFY2(EngravingRules::beatTicks(TimeSignature::_2_2) == 2 * quarter, "Wrong beat for 2/2");
+    QVERIFY2(EngravingRules::beatTicks(TimeSignature::None) == quarter,
+             "Measures without time signature aren't beamed in quarters");
+}
+
+QTEST_MAIN(EngravingRulesTest)
+
+#include "tst_engravingrulestest.moc"
@@ -0,0 +1,129 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#include <QString>
+#include <QtTest>
+#include <common/engraving/engravingrules.h>
+#include <src/common/engraving/spacingengine.h>
+
+class SpacingEngineTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    SpacingEngineTest() {}
+
+private Q_SLOTS:
+    void testDurationWeight();
+    void testMinimumWidth();
+    void testJustify();
+    void testJustifyTooShortLine();
+    void testJustifyWithoutDurations();
+    void testOnlyChangedMeasuresAreUpdated();
+
+private:
+    int ticks(Length::Value length) const { return EngravingRules::ticksOfLength(length); }
+};
+
+void SpacingEngineTest::testDurationWeight()
+{
+    QVERIFY2(SpacingEngine::durationWeight(0) == 0, "Symbol without duration has weight");
+    qreal quarterWeight = SpacingEngine::durationWeight(ticks(Length::_4));
+    qreal eighthWeight = SpacingEngine::durationWeight(ticks(Length::_8));
+    QVERIFY2(qFuzzyCompare(quarterWeight, eighthWeight + 1), "Double duration doesn't add one unit");
+}
+
+void SpacingEngineTest::testMinimumWidth()
+{
+    SpacingEngine engine;
+    engine.insertMeasure(0);
+    engine.insertMeasure(1);
+    engine.setMeasure(0, QVector<SpacingEngine::Element>()
+                      << SpacingEngine::Element(10, ticks(Length::_4))
+                      << SpacingEngine::Element(5, 0), 3);
+    engine.setMeasure(1, QVector<SpacingEngine::Element>()
+                      << SpacingEngine::Element(10, ticks(Length::_4)));
+    engine.setMinimumDistance(1);
+
+    QVERIFY2(engine.minimumWidth(0) == 20, "Wrong minimum width of measure");
+    QVERIFY2(engine.minimumWidth() == 31, "Wrong minimum width of line");
+}
+
+void SpacingEngineTest::testJustify()
+{
+    SpacingEngine engine;
+    engine.insertMeasure(0);
+    engine.insertMeasure(1);
+    engine.setMeasure(0, QVector<SpacingEngine::Element>()
+                      << SpacingEngine::Element(10, ticks(Length::_4))
+                      << SpacingEngine::Element(10, ticks(Length::_8)));
+    engine.setMeasure(1, QVector<SpacingEngine::Element>()
+                      << SpacingEngine::Element(10, ticks(Length::_2)));
+
+    engine.justify(200);
+    qreal lineWidth = engine.measureWidth(0) + engine.measureWidth(1);
+    QVERIFY2(qFuzzyCompare(lineWidth, 200), "Measures don't fill the line");
+
+    QVector<qreal> positions(engine.symbolPositions(0));
+    QVERIFY2(positions.count() == 2, "Wrong position count");
+    QVERIFY2(positions.at(0) == 0, "Wrong position of first symbol");
+    qreal quarterSpace = positions.at(1) - positions.at(0);
+    qreal eighthSpace = engine.measureWidth(0) - positions.at(1);
+    QVERIFY2(quarterSpace > eighthSpace, "Quarter note doesn't get more space than eighth");
+}
+
+void SpacingEngineTest::testJustifyTooShortLine()
+{
+    SpacingEngine engine;
+    engine.insertMeasure(0);
+    engine.setMeasure(0, QVector<SpacingEngine::Element>()
+                      << SpacingEngine::Element(10, ticks(Length::_4))
+                      << SpacingEngine::Element(10, ticks(Length::_4)));
+
+    engine.justify(5);
+    QVERIFY2(engine.measureWidth(0) == 20, "Measure is smaller than its minimum width");
+    QVERIFY2(engine.symbolPositions(0).at(1) == 10, "Symbols overlap");
+}
+
+void SpacingEngineTest::testJustifyWithoutDurations()
+{
+    SpacingEngine engine;
+    engine.insertMeasure(0);
+    engine.insertMeasure(1);
+
+    engine.justify(100);
+    QVERIFY2(engine.measureWidth(0) == 50, "Empty measures don't share the line");
+    QVERIFY2(engine.measureWidth(1) == 50, "Empty measures don't share the line");
+}
+
+void SpacingEngineTest::testOnlyChangedMeasuresAreUpdated()
+{
+    SpacingEngine engine;
+    engine.insertMeasure(0);
+    engine.insertMeasure(1);
+    engine.setMeasure(0, QVector<SpacingEngine::Element>()
+                      << SpacingEngine::Element(10, ticks(Length::_4)));
+    engine.setMeasure(1, QVector<SpacingEngine::Element>()
+                      << SpacingEngine::Element(10, ticks(Length::_4)));
+    engine.justify(100);
+    QVERIFY2(!engine.isMeasureChanged(0), "Measure wasn't updated");
+
+    engine.symbolPositions(0);
+    engine.setMeasure(1, QVector<SpacingEngine::Element>()
+                      << SpacingEngine::Element(20, ticks(Length::_4)));
+    QVERIFY2(engine.isMeasureChanged(1), "Changed measure isn't dirty");
+    QVERIFY2(!engine.isMeasureChanged(0), "Unchanged measure is dirty");
+
+    engine.justify(100);
+    QVERIFY2(!engine.isMeasureChanged(1), "Changed measure wasn't updated");
+    QVERIFY2(engine.measureWidth(1) > engine.measureWidth(0), "Wider measure didn't get more space");
+}
+
+QTEST_MAIN(SpacingEngineTest)
+
+#include "tst_spacingenginetest.moc"
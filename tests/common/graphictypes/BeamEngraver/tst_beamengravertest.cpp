@@ -0,0 +1,140 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#include <algorithm>
+#include <QString>
+#include <QtTest>
+#include <common/defines.h>
+#include <common/itemdataroles.h>
+#include <common/datatypes/length.h>
+#include <common/datatypes/timesignature.h>
+#include <common/engraving/engravingrules.h>
+#include <src/common/graphictypes/symbolgraphicbuilder.h>
+#include <src/common/graphictypes/beamengraver.h>
+
+class NoteBuilder : public SymbolGraphicBuilder
+{
+public:
+    explicit NoteBuilder(Length::Value length)
+    {
+        setSymbolType(LP::MelodyNote);
+        setData(QVariant::fromValue<Length::Value>(length), LP::SymbolLength);
+    }
+
+    QVector<int> graphicDataRoles() const
+    {
+        return QVector<int>() << LP::SymbolLength << LP::MelodyNoteDots;
+    }
+};
+
+class BeamEngraverTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    BeamEngraverTest() {}
+
+private Q_SLOTS:
+    void cleanup();
+    void testBeatTicks();
+    void testOnsetsAfterInsert();
+    void testOnsetsAfterRemove();
+    void testOnsetsAfterLengthChange();
+
+private:
+    NoteBuilder *newNote(Length::Value length);
+    QList<int> onsets(const BeamEngraver &engraver) const;
+    QList<SymbolGraphicBuilder*> m_builders;
+};
+
+void BeamEngraverTest::cleanup()
+{
+    qDeleteAll(m_builders);
+    m_builders.clear();
+}
+
+NoteBuilder *BeamEngraverTest::newNote(Length::Value length)
+{
+    NoteBuilder *builder = new NoteBuilder(length);
+    m_builders << builder;
+    return builder;
+}
+
+QList<int> BeamEngraverTest::onsets(const BeamEngraver &engraver) const
+{
+    QList<int> onsets;
+    foreach (SymbolGraphicBuilder *builder, m_builders) {
+        int onset = engraver.onsetOfBuilder(builder);
+        if (onset != -1)
+            onsets << onset;
+    }
+    std::sort(onsets.begin(), onsets.end());
+    return onsets;
+}
+
+void BeamEngraverTest::testBeatTicks()
+{
+    BeamEngraver engraver;
+    int quarter = EngravingRules::WholeNoteTicks / 4;
+
+    engraver.setTimeSignature(TimeSignature(TimeSignature::_2_4));
+    QVERIFY2(engraver.beatTicks() == quarter, "Wrong beat for 2/4");
+
+    engraver.setTimeSignature(TimeSignature(TimeSignature::_6_8));
+    QVERIFY2(engraver.beatTicks() == quarter + quarter / 2, "6/8 isn't beamed in dotted quarters");
+
+    engraver.setTimeSignature(TimeSignature(TimeSignature::_2_2));
+    QVERIFY2(engraver.beatTicks() == 2 * quarter, "Wrong beat for 2/2");
+}
+
+void BeamEngraverTest::testOnsetsAfterInsert()
+{
+    BeamEngraver engraver;
+    int eighth = EngravingRules::ticksOfLength(Length::_8);
+
+    engraver.insertGraphicsBuilder(0, newNote(Length::_8));
+    engraver.insertGraphicsBuilder(1, newNote(Length::_8));
+    engraver.insertGraphicsBuilder(0, newNote(Length::_4));
+
+    QList<int> expected({0, 2 * eighth, 3 * eighth});
+    QVERIFY2(onsets(engraver) == expected, "Wrong onsets after inserting notes");
+}
+
+void BeamEngraverTest::testOnsetsAfterRemove()
+{
+    BeamEngraver engraver;
+    int eighth = EngravingRules::ticksOfLength(Length::_8);
+    NoteBuilder *quarter = newNote(Length::_4);
+
+    engraver.insertGraphicsBuilder(0, newNote(Length::_8));
+    engraver.insertGraphicsBuilder(1, quarter);
+    engraver.insertGraphicsBuilder(2, newNote(Length::_8));
+    engraver.removeGraphicsBuilder(1, quarter);
+
+    QList<int> expected({0, eighth});
+    QVERIFY2(onsets(engraver) == expected, "Wrong onsets after removing a note");
+}
+
+void BeamEngraverTest::testOnsetsAfterLengthChange()
+{
+    BeamEngraver engraver;
+    int sixteenth = EngravingRules::ticksOfLength(Length::_16);
+    NoteBuilder *note = newNote(Length::_8);
+
+    engraver.insertGraphicsBuilder(0, note);
+    engraver.insertGraphicsBuilder(1, newNote(Length::_8));
+    note->setData(QVariant::fromValue<Length::Value>(Length::_16), LP::SymbolLength);
+
+    QList<int> expected({0, sixteenth});
+    QVERIFY2(onsets(engraver) == expected, "Onsets weren't updated after length change");
+    QVERIFY2(engraver.beamCountOfBuilder(note) == 2, "Beam count wasn't updated after length change");
+}
+
+QTEST_MAIN(BeamEngraverTest)
+
+#include "tst_beamengravertest.moc"
@@ -0,0 +1,244 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#include <QString>
+#include <QtTest>
+#include <QGraphicsLineItem>
+#include <app/SMuFL/smuflloader.h>
+#include <common/defines.h>
+#include <common/itemdataroles.h>
+#include <common/layoutsettings.h>
+#include <common/datatypes/length.h>
+#include <common/datatypes/pitch.h>
+#include <common/graphictypes/glyphitem.h>
+#include <common/graphictypes/stemglyphitem.h>
+#include <common/engraving/engravingrules.h>
+#include <common/engraving/engravingtypes.h>
+#include <src/common/graphictypes/symbolgraphicbuilder.h>
+#include <src/common/graphictypes/stemengraver.h>
+
+class NoteBuilder : public SymbolGraphicBuilder
+{
+public:
+    explicit NoteBuilder(Length::Value length, int staffPos)
+        : m_glyphItem(new GlyphItem(QStringLiteral("noteheadBlack")))
+    {
+        setSymbolType(LP::MelodyNote);
+        setData(QVariant::fromValue<Length::Value>(length), LP::SymbolLength);
+        setData(QVariant::fromValue<Pitch>(Pitch(staffPos, QString())), LP::SymbolPitch);
+    }
+
+    ~NoteBuilder()
+    {
+        delete m_glyphItem;
+    }
+
+    GlyphItem *glyphItem() const
+    {
+        return m_glyphItem;
+    }
+
+    QVector<int> graphicDataRoles() const
+    {
+        return QVector<int>() << LP::SymbolLength << LP::SymbolPitch;
+    }
+
+private:
+    GlyphItem *m_glyphItem;
+};
+
+class StemEngraverTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    StemEngraverTest() {}
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanup();
+    void testStemsOfBatch();
+    void testBatchedUpdate();
+    void testUpdateAfterPitchChange();
+    void testRemoveGraphicsBuilder();
+    void testApplyEngraving();
+
+private:
+    NoteBuilder *newNote(Length::Value length, int staffPos = 0);
+    StemGlyphItem *stemOf(SymbolGraphicBuilder *builder) const;
+    qreal stemLength(SymbolGraphicBuilder *builder) const;
+    QList<SymbolGraphicBuilder*> m_builders;
+    MusicFontPtr m_musicFont;
+};
+
+void StemEngraverTest::initTestCase()
+{
+    SMuFLLoader *smuflLoader = new SMuFLLoader();
+    smuflLoader->setFontFromPath(QStringLiteral(":/SMuFL/fonts/Bravura/Bravura.otf"));
+    smuflLoader->setFontPixelSize(40);
+    smuflLoader->loadGlyphnamesFromFile(QStringLiteral(":/SMuFL/glyphnames.json"));
+    smuflLoader->loadFontMetadataFromFile(QStringLiteral(":/SMuFL/fonts/Bravura/metadata.json"));
+    smuflLoader->setFontColor(FontColor::Normal, Qt::black);
+    m_musicFont = MusicFontPtr(smuflLoader);
+    LayoutSettings::setMusicFont(m_musicFont);
+}
+
+void StemEngraverTest::cleanup()
+{
+    qDeleteAll(m_builders);
+    m_builders.clear();
+}
+
+NoteBuilder *StemEngraverTest::newNote(Length::Value length, int staffPos)
+{
+    NoteBuilder *builder = new NoteBuilder(length, staffPos);
+    m_builders << builder;
+    return builder;
+}
+
+StemGlyphItem *StemEngraverTest::stemOf(SymbolGraphicBuilder *builder) const
+{
+    StemGlyphItem *stem = 0;
+    foreach (QGraphicsItem *child, builder->glyphItem()->childItems()) {
+        StemGlyphItem *childStem = dynamic_cast<StemGlyphItem*>(child);
+        if (!childStem)
+            continue;
+        if (stem)
+            return 0;  // More than one stem
+        stem = childStem;
+    }
+    return stem;
+}
+
+qreal StemEngraverTest::stemLength(SymbolGraphicBuilder *builder) const
+{
+    StemGlyphItem *stem = stemOf(builder);
+    if (!stem)
+        return 0;
+
+    foreach (QGraphicsItem *child, stem->childItems()) {
+        QGraphicsLineItem *line = dynamic_cast<QGraphicsLineItem*>(child);
+        if (line && line->isVisible())
+            return line->line().length();
+    }
+    return 0;
+}
+
+void StemEngraverTest::testStemsOfBatch()
+{
+    StemEngraver engraver;
+    engraver.insertGraphicsBuilder(0, newNote(Length::_8, 1));
+    engraver.insertGraphicsBuilder(1, newNote(Length::_16, 3));
+    engraver.insertGraphicsBuilder(2, newNote(Length::_8, 5));
+    engraver.insertGraphicsBuilder(3, newNote(Length::_4, 2));
+    engraver.updateStems();
+
+    qreal defaultStemLength = 3.5 * m_musicFont->staffSpace();
+    for (int i = 0; i < 3; ++i) {
+        StemGlyphItem *stem = stemOf(m_builders.at(i));
+        QVERIFY2(stem, "Note has not exactly one stem");
+        QVERIFY2(stem->stemDirection() == StemGlyphItem::Downwards, "Wrong stem direction");
+        QVERIFY2(qFuzzyCompare(stemLength(m_builders.at(i)), defaultStemLength),
+                 "Wrong stem length");
+    }
+
+    QVERIFY2(stemOf(m_builders.at(3)), "Quarter note has no stem item");
+    QVERIFY2(stemLength(m_builders.at(3)) == 0, "Stem of quarter note without flag is visible");
+}
+
+void StemEngraverTest::testBatchedUpdate()
+{
+    StemEngraver engraver;
+    NoteBuilder *note = newNote(Length::_4);
+    engraver.insertGraphicsBuilder(0, note);
+    QVERIFY2(stemLength(note) == 0, "Stem was laid out before the update");
+
+    // Both changes are applied with one update
+    note->setData(QVariant::fromValue<Length::Value>(Length::_16), LP::SymbolLength);
+    note->setData(QVariant::fromValue<Pitch>(Pitch(4, QString())), LP::SymbolPitch);
+    QVERIFY2(stemLength(note) == 0, "Stem was laid out before the update");
+
+    QTRY_VERIFY2(stemLength(note) > 0, "Stem wasn't laid out on return to the event loop");
+}
+
+void StemEngraverTest::testUpdateAfterPitchChange()
+{
+    StemEngraver engraver;
+    NoteBuilder *changedNote = newNote(Length::_8, 1);
+    NoteBuilder *unchangedNote = newNote(Length::_8, 1);
+    engraver.insertGraphicsBuilder(0, changedNote);
+    engraver.insertGraphicsBuilder(1, unchangedNote);
+    engraver.updateStems();
+
+    qreal defaultStemLength = stemLength(changedNote);
+    QVERIFY2(defaultStemLength > 0, "Stem wasn't laid out");
+
+    // A new length factor only shows up, when the stem is laid out again
+    stemOf(changedNote)->setStemLengthFactor(5);
+    stemOf(unchangedNote)->setStemLengthFactor(5);
+
+    changedNote->setData(QVariant::fromValue<Pitch>(Pitch(6, QString())), LP::SymbolPitch);
+    engraver.updateStems();
+
+    QVERIFY2(qFuzzyCompare(stemLength(changedNote), 5 * m_musicFont->staffSpace()),
+             "Stem wasn't updated after pitch change");
+    QVERIFY2(qFuzzyCompare(stemLength(unchangedNote), defaultStemLength),
+             "Stem of unchanged note was updated");
+    QVERIFY2(stemOf(changedNote)->stemDirection() == StemGlyphItem::Downwards,
+             "Stem direction changed with pitch");
+}
+
+void StemEngraverTest::testRemoveGraphicsBuilder()
+{
+    StemEngraver engraver;
+    NoteBuilder *note = newNote(Length::_8);
+    engraver.insertGraphicsBuilder(0, note);
+    QVERIFY2(stemOf(note), "No stem created");
+
+    engraver.removeGraphicsBuilder(0, note);
+    QVERIFY2(!stemOf(note), "Stem wasn't removed");
+
+    // Changes of removed notes are ignored
+    note->setData(QVariant::fromValue<Pitch>(Pitch(2, QString())), LP::SymbolPitch);
+    engraver.updateStems();
+    QVERIFY2(!stemOf(note), "Stem recreated after remove");
+}
+
+void StemEngraverTest::testApplyEngraving()
+{
+    StemEngraver engraver;
+    engraver.setEngravedByPipeline(true);
+    NoteBuilder *note = newNote(Length::_4);
+    NoteBuilder *beamedNote = newNote(Length::_8);
+    engraver.insertGraphicsBuilder(0, note);
+    engraver.insertGraphicsBuilder(1, beamedNote);
+    QVERIFY2(!stemOf(note)->isVisible(), "Stem is visible before the engraving is applied");
+
+    // Data changes are engraved by the pipeline
+    note->setData(QVariant::fromValue<Length::Value>(Length::_16), LP::SymbolLength);
+    QTest::qWait(0);
+    QVERIFY2(stemLength(note) == 0, "Stem was laid out from the data");
+
+    MeasureEngraving engraving;
+    SymbolEngraving noteEngraving;
+    noteEngraving.stemLength = 50;
+    noteEngraving.flagGlyph = EngravingRules::flagGlyphForLength(Length::_16,
+                                                                 EngravingRules::StemDirection::Downwards);
+    SymbolEngraving beamedEngraving;
+    beamedEngraving.beamGroup = 0;
+    engraving.symbols << noteEngraving << beamedEngraving;
+    engraver.applyEngraving(QList<SymbolGraphicBuilder*>() << note << beamedNote, engraving);
+
+    QVERIFY2(stemOf(note)->isVisible(), "Stem isn't visible after the engraving was applied");
+    QVERIFY2(qFuzzyCompare(stemLength(note), 50), "Engraved stem length wasn't applied");
+    QVERIFY2(!stemOf(beamedNote)->isVisible(), "Stem of beamed note is visible");
+}
+
+QTEST_MAIN(StemEngraverTest)
+
+#include "tst_stemengravertest.moc"
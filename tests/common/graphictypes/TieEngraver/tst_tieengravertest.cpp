@@ -0,0 +1,261 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#include <QString>
+#include <QtTest>
+#include <common/defines.h>
+#include <common/itemdataroles.h>
+#include <src/common/graphictypes/symbolgraphicbuilder.h>
+#include <src/common/graphictypes/tieengraver.h>
+
+class TieBuilder : public SymbolGraphicBuilder
+{
+public:
+    explicit TieBuilder(SpanType spanType)
+    {
+        setSymbolType(LP::Tie);
+        setData(QVariant::fromValue<SpanType>(spanType), LP::SymbolSpanType);
+    }
+
+    QVector<int> graphicDataRoles() const
+    {
+        return QVector<int>() << LP::SymbolSpanType;
+    }
+};
+
+class TieEngraverTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    TieEngraverTest() {}
+
+private Q_SLOTS:
+    void cleanup();
+    void testPairStartAndEnd();
+    void testPairEndInsertedBeforeStart();
+    void testSpanPositionsAfterInsertAndRemove();
+    void testRemoveStartUnpairsEnd();
+    void testSeveralTies();
+    void testTieSpanningMeasures();
+    void testTieSpanningSeveralMeasures();
+
+private:
+    SymbolGraphicBuilder *newNote();
+    QList<SymbolGraphicBuilder*> m_builders;
+};
+
+void TieEngraverTest::cleanup()
+{
+    qDeleteAll(m_builders);
+    m_builders.clear();
+}
+
+SymbolGraphicBuilder *TieEngraverTest::newNote()
+{
+    SymbolGraphicBuilder *builder = new SymbolGraphicBuilder();
+    builder->setSymbolType(LP::MelodyNote);
+    m_builders << builder;
+    return builder;
+}
+
+void TieEngraverTest::testPairStartAndEnd()
+{
+    TieEngraver engraver;
+    TieBuilder *start = new TieBuilder(SpanType::Start);
+    TieBuilder *end = new TieBuilder(SpanType::End);
+    m_builders << start << end;
+
+    engraver.insertGraphicsBuilder(0, newNote());
+    engraver.insertGraphicsBuilder(1, start);
+    engraver.insertGraphicsBuilder(2, newNote());
+    engraver.insertGraphicsBuilder(3, end);
+
+    QVERIFY2(engraver.tieItemOfBuilder(start), "No tie item created for tie start");
+    QVERIFY2(engraver.tieItemOfBuilder(start) == engraver.tieItemOfBuilder(end),
+             "Tie end wasn't paired with tie start");
+    QVERIFY2(!engraver.openTieItem(), "Closed tie is returned as open tie");
+}
+
+void TieEngraverTest::testPairEndInsertedBeforeStart()
+{
+    TieEngraver engraver;
+    TieBuilder *start = new TieBuilder(SpanType::Start);
+    TieBuilder *end = new TieBuilder(SpanType::End);
+    m_builders << start << end;
+
+    engraver.insertGraphicsBuilder(0, newNote());
+    engraver.insertGraphicsBuilder(0, newNote());
+    engraver.insertGraphicsBuilder(1, end);
+    engraver.insertGraphicsBuilder(1, start);
+
+    QVERIFY2(engraver.tieItemOfBuilder(end), "Tie end wasn't paired with tie start inserted before");
+    QVERIFY2(engraver.tieItemOfBuilder(start) == engraver.tieItemOfBuilder(end),
+             "Tie end was paired with wrong tie item");
+}
+
+void TieEngraverTest::testSpanPositionsAfterInsertAndRemove()
+{
+    TieEngraver engraver;
+    TieBuilder *start = new TieBuilder(SpanType::Start);
+    TieBuilder *end = new TieBuilder(SpanType::End);
+    m_builders << start << end;
+
+    SymbolGraphicBuilder *firstNote = newNote();
+    engraver.insertGraphicsBuilder(0, start);
+    engraver.insertGraphicsBuilder(1, end);
+    engraver.insertGraphicsBuilder(0, firstNote);
+    engraver.insertGraphicsBuilder(2, newNote());
+
+    // note, start, note, end
+    TieGraphicsItem *tieItem = engraver.tieItemOfBuilder(start);
+    QVERIFY2(!engraver.tieItemAt(1), "Tie start has wrong position");
+    QVERIFY2(engraver.tieItemAt(2) == tieItem, "Tied note has wrong tie item");
+    QVERIFY2(!engraver.tieItemAt(4), "Tie end has wrong position");
+
+    engraver.removeGraphicsBuilder(0, firstNote);
+
+    // start, note, end
+    QVERIFY2(!engraver.tieItemAt(0), "Tie start wasn't shifted after removal");
+    QVERIFY2(engraver.tieItemAt(1) == tieItem, "Tied note has wrong tie item after removal");
+    QVERIFY2(!engraver.tieItemAt(3), "Tie end wasn't shifted after removal");
+    QVERIFY2(engraver.tieItemOfBuilder(end) == tieItem, "Tie end was unpaired by removal");
+}
+
+void TieEngraverTest::testRemoveStartUnpairsEnd()
+{
+    TieEngraver engraver;
+    TieBuilder *start = new TieBuilder(SpanType::Start);
+    TieBuilder *end = new TieBuilder(SpanType::End);
+    m_builders << start << end;
+
+    engraver.insertGraphicsBuilder(0, start);
+    engraver.insertGraphicsBuilder(1, newNote());
+    engraver.insertGraphicsBuilder(2, end);
+    engraver.removeGraphicsBuilder(0, start);
+
+    QVERIFY2(!engraver.tieItemOfBuilder(start), "Removed tie start still has a tie item");
+    QVERIFY2(!engraver.tieItemOfBuilder(end), "Tie end is still paired with removed tie start");
+}
+
+void TieEngraverTest::testSeveralTies()
+{
+    TieEngraver engraver;
+    TieBuilder *firstStart = new TieBuilder(SpanType::Start);
+    TieBuilder *firstEnd = new TieBuilder(SpanType::End);
+    TieBuilder *secondStart = new TieBuilder(SpanType::Start);
+    TieBuilder *secondEnd = new TieBuilder(SpanType::End);
+    m_builders << firstStart << firstEnd << secondStart << secondEnd;
+
+    SymbolGraphicBuilder *untiedNote = newNote();
+    engraver.insertGraphicsBuilder(0, firstStart);
+    engraver.insertGraphicsBuilder(1, firstEnd);
+    engraver.insertGraphicsBuilder(2, secondStart);
+    engraver.insertGraphicsBuilder(3, secondEnd);
+    engraver.insertGraphicsBuilder(1, newNote());
+    engraver.insertGraphicsBuilder(3, untiedNote);
+    engraver.insertGraphicsBuilder(5, newNote());
+    engraver.insertGraphicsBuilder(5, newNote());
+
+    // start, note, end, untied note, start, note, note, end
+    TieGraphicsItem *firstTie = engraver.tieItemOfBuilder(firstStart);
+    TieGraphicsItem *secondTie = engraver.tieItemOfBuilder(secondStart);
+    QVERIFY2(firstTie && secondTie && firstTie != secondTie, "Tie starts share a tie item");
+    QVERIFY2(engraver.tieItemAt(1) == firstTie, "Note of first tie has wrong tie item");
+    QVERIFY2(!engraver.tieItemAt(3), "Note between ties is tied");
+    QVERIFY2(engraver.tieItemAt(5) == secondTie, "Note of second tie has wrong tie item");
+    QVERIFY2(engraver.tieItemAt(6) == secondTie, "Note of second tie has wrong tie item");
+    QVERIFY2(engraver.tieItemOfBuilder(secondEnd) == secondTie, "Second tie end has wrong tie item");
+
+    // A builder isn't removed at an index it isn't at
+    engraver.removeGraphicsBuilder(0, untiedNote);
+    QVERIFY2(engraver.tieItemOfBuilder(firstStart) == firstTie, "Wrong builder was removed");
+
+    engraver.removeGraphicsBuilder(3, untiedNote);
+    engraver.removeGraphicsBuilder(2, firstEnd);
+
+    // start, note, start, note, note, end
+    QVERIFY2(engraver.tieItemAt(1) == firstTie, "Note of first tie has wrong tie item after removal");
+    QVERIFY2(engraver.tieItemAt(4) == secondTie, "Note of second tie has wrong tie item after removal");
+    QVERIFY2(engraver.tieItemOfBuilder(secondEnd) == secondTie,
+             "Second tie end has wrong tie item after removal");
+    QVERIFY2(!engraver.openTieItem(), "Closed tie is returned as open tie");
+
+    engraver.removeGraphicsBuilder(2, secondStart);
+
+    // start, note, note, note, end
+    QVERIFY2(engraver.tieItemAt(3) == firstTie, "Notes weren't added to the first tie");
+    QVERIFY2(engraver.tieItemOfBuilder(secondEnd) == firstTie,
+             "Second tie end wasn't paired with the first tie start");
+}
+
+void TieEngraverTest::testTieSpanningMeasures()
+{
+    TieEngraver firstMeasure;
+    TieEngraver secondMeasure;
+    secondMeasure.setPreviousEngraver(&firstMeasure);
+    QVERIFY2(firstMeasure.nextEngraver() == &secondMeasure, "Engravers weren't linked");
+
+    TieBuilder *start = new TieBuilder(SpanType::Start);
+    TieBuilder *end = new TieBuilder(SpanType::End);
+    m_builders << start << end;
+
+    firstMeasure.insertGraphicsBuilder(0, newNote());
+    firstMeasure.insertGraphicsBuilder(1, start);
+    firstMeasure.insertGraphicsBuilder(2, newNote());
+    QVERIFY2(firstMeasure.openTieItem() == firstMeasure.tieItemOfBuilder(start),
+             "Tie without end isn't open at the end of the measure");
+
+    secondMeasure.insertGraphicsBuilder(0, newNote());
+    secondMeasure.insertGraphicsBuilder(1, end);
+    QVERIFY2(secondMeasure.tieItemOfBuilder(end) == firstMeasure.tieItemOfBuilder(start),
+             "Tie end wasn't paired with tie start of previous measure");
+    QVERIFY2(!secondMeasure.openTieItem(), "Closed tie is returned as open tie");
+
+    secondMeasure.setPreviousEngraver(0);
+    QVERIFY2(!firstMeasure.nextEngraver(), "Engravers weren't unlinked");
+    QVERIFY2(!secondMeasure.tieItemOfBuilder(end),
+             "Tie end is still paired after unlinking measures");
+}
+
+void TieEngraverTest::testTieSpanningSeveralMeasures()
+{
+    TieEngraver firstMeasure;
+    TieEngraver secondMeasure;
+    TieEngraver thirdMeasure;
+    secondMeasure.setPreviousEngraver(&firstMeasure);
+    thirdMeasure.setPreviousEngraver(&secondMeasure);
+
+    TieBuilder *start = new TieBuilder(SpanType::Start);
+    TieBuilder *end = new TieBuilder(SpanType::End);
+    m_builders << start << end;
+
+    firstMeasure.insertGraphicsBuilder(0, start);
+    secondMeasure.insertGraphicsBuilder(0, newNote());
+    thirdMeasure.insertGraphicsBuilder(0, newNote());
+    thirdMeasure.insertGraphicsBuilder(1, end);
+
+    TieGraphicsItem *tieItem = firstMeasure.tieItemOfBuilder(start);
+    QVERIFY2(secondMeasure.openTieItem() == tieItem, "Tie isn't continued in measure without ties");
+    QVERIFY2(thirdMeasure.tieItemOfBuilder(end) == tieItem,
+             "Tie end wasn't paired with tie start two measures before");
+
+    // Inserting into the tied measure doesn't change the tie
+    secondMeasure.insertGraphicsBuilder(1, newNote());
+    QVERIFY2(secondMeasure.tieItemAt(1) == tieItem, "Inserted note isn't tied");
+    QVERIFY2(thirdMeasure.tieItemOfBuilder(end) == tieItem, "Tie end was unpaired by insert");
+
+    firstMeasure.removeGraphicsBuilder(0, start);
+    QVERIFY2(!secondMeasure.openTieItem(), "Tie is still continued after removing its start");
+    QVERIFY2(!thirdMeasure.tieItemOfBuilder(end),
+             "Tie end is still paired after removing the tie start");
+}
+
+QTEST_MAIN(TieEngraverTest)
+
+#include "tst_tieengravertest.moc"
@@ -0,0 +1,128 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#include <QString>
+#include <QtTest>
+#include <QBuffer>
+#include <common/playback/offlinerenderer.h>
+#include <common/playback/wavfilewriter.h>
+
+namespace {
+const int SampleRate = 8000;
+const int Tempo = 60;       // One quarter note per second
+const int ReleaseFrames = SampleRate / 50;
+}
+
+class OfflineRendererTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    OfflineRendererTest() {}
+
+private Q_SLOTS:
+    void init();
+    void testChunksDontChangeSamples();
+    void testLengthIncludesRelease();
+    void testDronesSoundInSpans();
+    void testConvertSamples();
+    void testWriteWavFile();
+
+private:
+    Timeline m_timeline;
+    OfflineRenderer m_renderer;
+};
+
+void OfflineRendererTest::init()
+{
+    m_timeline = Timeline();
+    quint8 notes[] = { 69, 74, 76 };
+    for (int i = 0; i < 3; ++i) {
+        NoteEvent event;
+        event.start = i * Playback::TicksPerQuarter;
+        event.duration = Playback::TicksPerQuarter;
+        event.note = notes[i];
+        event.velocity = 100;
+        m_timeline.events << event;
+    }
+    m_timeline.length = 4 * Playback::TicksPerQuarter;
+
+    m_renderer = OfflineRenderer();
+    m_renderer.setSampleRate(SampleRate);
+    m_renderer.setTempo(Tempo);
+}
+
+void OfflineRendererTest::testChunksDontChangeSamples()
+{
+    m_renderer.setChunkFrames(4 * SampleRate);
+    QVector<qint16> samples = m_renderer.render(m_timeline);
+
+    m_renderer.setChunkFrames(300);
+    QVector<qint16> chunkedSamples = m_renderer.render(m_timeline);
+
+    QVERIFY2(!samples.isEmpty(), "No samples rendered");
+    QVERIFY2(samples == chunkedSamples, "Samples depend on the chunk size");
+}
+
+void OfflineRendererTest::testLengthIncludesRelease()
+{
+    m_renderer.setDronesEnabled(false);
+    m_timeline.length = 3 * Playback::TicksPerQuarter;
+    QVector<qint16> samples = m_renderer.render(m_timeline);
+    QVERIFY2(samples.count() == 3 * SampleRate + ReleaseFrames, "Wrong number of samples");
+
+    QVector<qint16> firstNote = samples.mid(0, SampleRate);
+    QVERIFY2(firstNote.count(0) < SampleRate / 2, "First note isn't rendered");
+}
+
+void OfflineRendererTest::testDronesSoundInSpans()
+{
+    Timeline timeline;
+    timeline.length = 4 * Playback::TicksPerQuarter;
+    OfflineRenderer::DroneSpan span;
+    span.start = Playback::TicksPerQuarter;
+    span.end = 2 * Playback::TicksPerQuarter;
+
+    QVector<qint16> samples = m_renderer.render(timeline, QVector<OfflineRenderer::DroneSpan>() << span);
+    QVERIFY2(samples.count() == 4 * SampleRate, "Wrong number of samples");
+    QVERIFY2(samples.mid(0, SampleRate).count(0) == SampleRate, "Drones sound before the span");
+    QVERIFY2(samples.mid(SampleRate, SampleRate).count(0) < SampleRate / 2, "Drones don't sound in the span");
+    QVERIFY2(samples.mid(3 * SampleRate).count(0) == SampleRate, "Drones sound after the release");
+}
+
+void OfflineRendererTest::testConvertSamples()
+{
+    const float source[] = { -2.0f, -1.0f, -0.5f, 0.0f, 0.5f, 1.0f, 2.0f, 0.25f, 0.1f };
+    const qint16 expected[] = { -32767, -32767, -16384, 0, 16384, 32767, 32767, 8192, 3277 };
+    qint16 target[9];
+
+    OfflineRenderer::convertSamples(source, target, 9);
+    for (int i = 0; i < 9; ++i) {
+        QVERIFY2(target[i] == expected[i], "Sample wasn't converted");
+    }
+}
+
+void OfflineRendererTest::testWriteWavFile()
+{
+    QVector<qint16> samples(100, 1);
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    WavFileWriter writer;
+    writer.setSampleRate(SampleRate);
+    QVERIFY2(writer.write(samples, &buffer), "WAV file wasn't written");
+
+    QByteArray data = buffer.data();
+    QVERIFY2(data.size() == 44 + 2 * samples.count(), "Wrong file size");
+    QVERIFY2(data.startsWith("RIFF"), "No RIFF header");
+    QVERIFY2(data.mid(8, 4) == "WAVE", "No WAVE format");
+    QVERIFY2(data.mid(36, 4) == "data", "No data chunk");
+}
+
+QTEST_APPLESS_MAIN(OfflineRendererTest)
+
+#include "tst_offlinerenderertest.moc"
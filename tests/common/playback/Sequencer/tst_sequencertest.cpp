@@ -0,0 +1,151 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#include <QString>
+#include <QtTest>
+#include <common/playback/eventqueue.h>
+#include <common/playback/sequencer.h>
+
+namespace {
+const int SampleRate = 8000;
+const int Tempo = 60;   // One quarter note per second
+}
+
+class SequencerTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    SequencerTest() {}
+
+private Q_SLOTS:
+    void testEventQueue();
+    void testPlaysNotesInOrder();
+    void testRestartStopsPlaying();
+    void testWaitsForEvents();
+
+private:
+    SequencerEvent event(SequencerEvent::Type type, int generation, quint32 start,
+                         quint32 duration = 0, int index = -1);
+    bool isSilent(Sequencer *sequencer, int frameCount);
+    void render(Sequencer *sequencer, int frameCount);
+};
+
+void SequencerTest::testEventQueue()
+{
+    EventQueue<int> queue(3);
+    QVERIFY2(queue.capacity() == 4, "Capacity isn't a power of two");
+
+    for (int i = 0; i < 4; ++i) {
+        QVERIFY2(queue.tryPush(i), "Item wasn't pushed");
+    }
+    QVERIFY2(!queue.tryPush(4), "Item was pushed into full queue");
+
+    int item = -1;
+    for (int i = 0; i < 4; ++i) {
+        QVERIFY2(queue.tryPop(&item), "No item popped");
+        QVERIFY2(item == i, "Items aren't popped in order");
+    }
+    QVERIFY2(!queue.tryPop(&item), "Item popped from empty queue");
+    QVERIFY2(queue.tryPush(5), "Item wasn't pushed after wrap around");
+}
+
+void SequencerTest::testPlaysNotesInOrder()
+{
+    Sequencer sequencer(SampleRate);
+    sequencer.setTempo(Tempo);
+    int generation = sequencer.restart();
+    sequencer.enqueue(event(SequencerEvent::Start, generation, 0));
+    sequencer.enqueue(event(SequencerEvent::Note, generation, 0, 480, 0));
+    sequencer.enqueue(event(SequencerEvent::Note, generation, 480, 480, 1));
+    sequencer.enqueue(event(SequencerEvent::End, generation, 960));
+
+    QVERIFY2(!isSilent(&sequencer, SampleRate / 2), "First note isn't played");
+    QVERIFY2(sequencer.currentEvent() == 0, "Wrong current event");
+
+    render(&sequencer, SampleRate);
+    QVERIFY2(sequencer.currentEvent() == 1, "Second note isn't played after the first");
+    QVERIFY2(!sequencer.isFinished(generation), "Finished too early");
+
+    render(&sequencer, SampleRate);
+    QVERIFY2(sequencer.isFinished(generation), "Not finished after the end");
+    QVERIFY2(sequencer.currentEvent() == -1, "Current event after the end");
+    QVERIFY2(isSilent(&sequencer, SampleRate / 10), "Sound after the end");
+}
+
+void SequencerTest::testRestartStopsPlaying()
+{
+    Sequencer sequencer(SampleRate);
+    sequencer.setTempo(Tempo);
+    int generation = sequencer.restart();
+    sequencer.enqueue(event(SequencerEvent::Start, generation, 0));
+    sequencer.enqueue(event(SequencerEvent::Note, generation, 0, 4 * 480, 0));
+    sequencer.enqueue(event(SequencerEvent::End, generation, 4 * 480));
+    render(&sequencer, SampleRate / 2);
+
+    int nextGeneration = sequencer.restart();
+    render(&sequencer, SampleRate / 2);
+    QVERIFY2(sequencer.currentEvent() == -1, "Still playing after restart");
+    QVERIFY2(isSilent(&sequencer, SampleRate / 10), "Note isn't stopped after restart");
+    QVERIFY2(!sequencer.isFinished(generation), "Stopped playback reported as finished");
+
+    sequencer.enqueue(event(SequencerEvent::Start, nextGeneration, 480));
+    sequencer.enqueue(event(SequencerEvent::Note, nextGeneration, 480, 480, 7));
+    render(&sequencer, SampleRate / 10);
+    QVERIFY2(sequencer.currentEvent() == 7, "Playback doesn't start at the start tick");
+}
+
+void SequencerTest::testWaitsForEvents()
+{
+    Sequencer sequencer(SampleRate);
+    sequencer.setTempo(Tempo);
+    int generation = sequencer.restart();
+    sequencer.enqueue(event(SequencerEvent::Start, generation, 0));
+    render(&sequencer, SampleRate);
+    QVERIFY2(!sequencer.isFinished(generation), "Finished without end event");
+
+    sequencer.enqueue(event(SequencerEvent::Note, generation, 0, 480, 0));
+    sequencer.enqueue(event(SequencerEvent::End, generation, 480));
+    render(&sequencer, SampleRate / 10);
+    QVERIFY2(sequencer.currentEvent() == 0, "Position wasn't held for late events");
+}
+
+SequencerEvent SequencerTest::event(SequencerEvent::Type type, int generation, quint32 start,
+                                    quint32 duration, int index)
+{
+    SequencerEvent event;
+    event.type = type;
+    event.generation = generation;
+    event.note.start = start;
+    event.note.duration = duration;
+    event.note.note = 69;
+    event.note.velocity = 100;
+    event.index = index;
+    return event;
+}
+
+bool SequencerTest::isSilent(Sequencer *sequencer, int frameCount)
+{
+    QVector<qint16> samples(frameCount);
+    sequencer->render(samples.data(), frameCount);
+    foreach (qint16 sample, samples) {
+        if (sample != 0)
+            return false;
+    }
+    return true;
+}
+
+void SequencerTest::render(Sequencer *sequencer, int frameCount)
+{
+    QVector<qint16> samples(frameCount);
+    sequencer->render(samples.data(), frameCount);
+}
+
+QTEST_APPLESS_MAIN(SequencerTest)
+
+#include "tst_sequencertest.moc"
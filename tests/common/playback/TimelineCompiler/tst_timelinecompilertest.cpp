@@ -0,0 +1,217 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#include <QString>
+#include <QtTest>
+#include <QBuffer>
+#include <app/commonpluginmanager.h>
+#include <common/defines.h>
+#include <common/itemdataroles.h>
+#include <common/datatypes/length.h>
+#include <common/datatypes/pitch.h>
+#include <common/playback/timelinecompiler.h>
+#include <common/playback/midifilewriter.h>
+#include <plugins/GreatHighlandBagpipe/ghb_symboltypes.h>
+#include <musicmodel.h>
+
+Q_IMPORT_PLUGIN(GreatHighlandBagpipe)
+Q_IMPORT_PLUGIN(IntegratedSymbols)
+
+namespace {
+const int LowA = 5;
+const int D = 2;
+const quint32 MeasureTicks = 4 * Playback::TicksPerQuarter;
+}
+
+class TimelineCompilerTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    TimelineCompilerTest();
+
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+    void testMidiNote();
+    void testRepeatedPart();
+    void testDoublingExpandsToGraceNotes();
+    void testTiedNotesAreMerged();
+    void testTieEndsAtBarLine();
+    void testOnlyChangedMeasureIsCompiled();
+    void testWriteMidiFile();
+
+private:
+    QModelIndex insertNote(int row, const QModelIndex &measure, int staffPos, Length::Value length);
+    PluginManager m_pluginManager;
+    MusicModel *m_model;
+    TimelineCompiler *m_compiler;
+    QModelIndex m_tune;
+    QModelIndex m_part;
+};
+
+TimelineCompilerTest::TimelineCompilerTest()
+    : m_model(0),
+      m_compiler(0)
+{
+}
+
+void TimelineCompilerTest::initTestCase()
+{
+    CommonPluginManager *pluginManager = new CommonPluginManager;
+    m_pluginManager = PluginManager(pluginManager);
+    pluginManager->setSharedPluginManager(m_pluginManager);
+}
+
+void TimelineCompilerTest::init()
+{
+    m_model = new MusicModel();
+    m_model->setPluginManager(m_pluginManager);
+    QModelIndex score = m_model->appendScore("Score");
+    m_tune = m_model->appendTuneToScore(score, LP::GreatHighlandBagpipe);
+    m_part = m_model->insertPartIntoTune(0, m_tune, 2);
+
+    m_compiler = new TimelineCompiler();
+    m_compiler->setModel(m_model);
+    m_compiler->setPluginManager(m_pluginManager);
+}
+
+void TimelineCompilerTest::cleanup()
+{
+    delete m_compiler;
+    delete m_model;
+}
+
+void TimelineCompilerTest::testMidiNote()
+{
+    QVERIFY2(TimelineCompiler::midiNote(LowA, ClefType::Treble, LP::GreatHighlandBagpipe) == 69,
+             "Wrong note for Low A");
+    QVERIFY2(TimelineCompiler::midiNote(3, ClefType::Treble, LP::GreatHighlandBagpipe) == 73,
+             "C isn't played sharp");
+    QVERIFY2(TimelineCompiler::midiNote(0, ClefType::Treble, LP::GreatHighlandBagpipe) == 78,
+             "F isn't played sharp");
+    QVERIFY2(TimelineCompiler::midiNote(-2, ClefType::Treble, LP::GreatHighlandBagpipe) == 81,
+             "Wrong note for High A");
+    QVERIFY2(TimelineCompiler::midiNote(0, ClefType::Treble, LP::TinWhistle) == 77,
+             "Key of the bagpipe used for other instruments");
+}
+
+void TimelineCompilerTest::testRepeatedPart()
+{
+    m_model->setData(m_part, QVariant::fromValue<bool>(true), LP::PartRepeat);
+    insertNote(0, m_model->index(0, 0, m_part), LowA, Length::_4);
+
+    Timeline timeline = m_compiler->timeline(m_tune);
+    QVERIFY2(timeline.events.count() == 2, "Repeated part wasn't played twice");
+    QVERIFY2(timeline.events.at(1).start == 2 * MeasureTicks, "Repeat doesn't start after the part");
+    QVERIFY2(timeline.length == 4 * MeasureTicks, "Rests of the measures aren't played");
+}
+
+void TimelineCompilerTest::testDoublingExpandsToGraceNotes()
+{
+    QModelIndex measure = m_model->index(0, 0, m_part);
+    QModelIndex doubling = m_model->insertSymbolIntoMeasure(0, measure, GHB::Doubling);
+    QModelIndex melodyNote = insertNote(1, measure, D, Length::_4);
+
+    Timeline timeline = m_compiler->timeline(m_tune);
+    QVERIFY2(timeline.events.count() == 4, "Doubling wasn't expanded into grace notes");
+    for (int i = 0; i < 3; ++i) {
+        QVERIFY2(timeline.events.at(i).flags & Playback::GraceNote, "No grace note");
+        QVERIFY2(timeline.events.at(i).start == quint32(i * Playback::GraceNoteTicks),
+                 "Grace notes aren't played after another");
+        QVERIFY2(timeline.symbols.at(i) == doubling, "Grace note doesn't belong to the doubling");
+    }
+    QVERIFY2(timeline.symbols.at(3) == melodyNote, "Wrong symbol of the melody note");
+
+    NoteEvent note = timeline.events.at(3);
+    QVERIFY2(note.note == TimelineCompiler::midiNote(D, ClefType::Treble, LP::GreatHighlandBagpipe),
+             "Wrong melody note");
+    QVERIFY2(note.start + note.duration == quint32(Playback::TicksPerQuarter),
+             "Grace notes don't take their time from the melody note");
+}
+
+void TimelineCompilerTest::testTiedNotesAreMerged()
+{
+    QModelIndex measure = m_model->index(0, 0, m_part);
+    m_model->insertSymbolIntoMeasure(0, measure, LP::Tie);
+    insertNote(1, measure, LowA, Length::_4);
+    insertNote(2, measure, LowA, Length::_4);
+    insertNote(4, measure, LowA, Length::_4);
+
+    Timeline timeline = m_compiler->timeline(m_tune);
+    QVERIFY2(timeline.events.count() == 2, "Tied notes weren't merged");
+    QVERIFY2(timeline.events.at(0).duration == 2 * quint32(Playback::TicksPerQuarter),
+             "Tied note has wrong duration");
+    QVERIFY2(timeline.events.at(1).start == 2 * quint32(Playback::TicksPerQuarter),
+             "Note after the tie has wrong start");
+}
+
+void TimelineCompilerTest::testTieEndsAtBarLine()
+{
+    QModelIndex firstMeasure = m_model->index(0, 0, m_part);
+    QModelIndex secondMeasure = m_model->index(1, 0, m_part);
+
+    // Tie start in the first measure, tie end before the first note of the second
+    m_model->insertSymbolIntoMeasure(0, firstMeasure, LP::Tie);
+    m_model->removeRows(1, 1, firstMeasure);
+    insertNote(1, firstMeasure, LowA, Length::_2);
+    insertNote(2, firstMeasure, LowA, Length::_2);
+    m_model->insertSymbolIntoMeasure(0, secondMeasure, LP::Tie);
+    m_model->removeRows(0, 1, secondMeasure);
+    insertNote(1, secondMeasure, LowA, Length::_4);
+
+    Timeline timeline = m_compiler->timeline(m_tune);
+    QVERIFY2(timeline.events.count() == 2, "Tie doesn't end at the bar line");
+    QVERIFY2(timeline.events.at(0).duration == MeasureTicks, "Tied note has wrong duration");
+    QVERIFY2(timeline.events.at(1).start == MeasureTicks, "Note after the tie has wrong start");
+}
+
+void TimelineCompilerTest::testOnlyChangedMeasureIsCompiled()
+{
+    QModelIndex note = insertNote(0, m_model->index(1, 0, m_part), LowA, Length::_4);
+    m_compiler->timeline(m_tune);
+    int compiledMeasures = m_compiler->compiledMeasureCount();
+
+    m_model->setData(note, QVariant::fromValue<Length::Value>(Length::_2), LP::SymbolLength);
+    QVERIFY2(m_compiler->compiledMeasureCount() == compiledMeasures + 1,
+             "Not only the changed measure was compiled");
+
+    Timeline timeline = m_compiler->timeline(m_tune);
+    QVERIFY2(timeline.events.count() == 1, "Wrong event count");
+    QVERIFY2(timeline.events.at(0).start == MeasureTicks, "Note isn't in the second measure");
+    QVERIFY2(timeline.events.at(0).duration == 2 * quint32(Playback::TicksPerQuarter),
+             "Changed length wasn't compiled");
+}
+
+void TimelineCompilerTest::testWriteMidiFile()
+{
+    insertNote(0, m_model->index(0, 0, m_part), LowA, Length::_4);
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    MidiFileWriter writer;
+    QVERIFY2(writer.write(m_compiler->timeline(m_tune), &buffer), "MIDI file wasn't written");
+
+    QByteArray data = buffer.data();
+    QVERIFY2(data.startsWith("MThd"), "No MIDI header");
+    QVERIFY2(data.indexOf("MTrk") == 14, "No track after the header");
+    QVERIFY2(data.endsWith(QByteArray("\xFF\x2F\x00", 3)), "Track isn't ended");
+}
+
+QModelIndex TimelineCompilerTest::insertNote(int row, const QModelIndex &measure, int staffPos, Length::Value length)
+{
+    QModelIndex note = m_model->insertSymbolIntoMeasure(row, measure, LP::MelodyNote);
+    m_model->setData(note, QVariant::fromValue<Length::Value>(length), LP::SymbolLength);
+    m_model->setData(note, QVariant::fromValue<Pitch>(Pitch(staffPos, QString())), LP::SymbolPitch);
+    return note;
+}
+
+QTEST_MAIN(TimelineCompilerTest)
+
+#include "tst_timelinecompilertest.moc"
@@ -0,0 +1,171 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#include <QString>
+#include <QtTest>
+#include <QBuffer>
+#include <QTemporaryFile>
+#include <QUndoStack>
+#include <app/commonpluginmanager.h>
+#include <common/defines.h>
+#include <common/itemdataroles.h>
+#include <common/datatypes/length.h>
+#include <common/datatypes/pitch.h>
+#include <common/datatypes/timesignature.h>
+#include <plugins/GreatHighlandBagpipe/ghb_symboltypes.h>
+#include <musicmodel.h>
+#include <musicitem.h>
+#include <bwwimporter.h>
+
+Q_IMPORT_PLUGIN(GreatHighlandBagpipe)
+Q_IMPORT_PLUGIN(IntegratedSymbols)
+
+namespace {
+const char *TestTune =
+        "Bagpipe Reader:1.0\n"
+        "MIDINoteMappings,(54,56,58,59,61,63,64,66,68,56,58,60,61,63,65,66,68,70)\n"
+        "\n"
+        "\"Test Tune\",(T,L,0,0,Times New Roman,16,700,0,0,18,0,0,0)\n"
+        "\"Trad.\",(M,R,0,0,Times New Roman,14,400,0,0,18,0,0,0)\n"
+        "\n"
+        "&\tsharpf sharpc 2_4 I!''\tLA_4 'la dbb Br_8 Cl_8 ! gg LA_4 ^tla LA_4 !t\n"
+        "&\tE_8 ^ts E_8 E_8 ^te F_8 ''!I\n"
+        "&\tHA_2 !I\n";
+}
+
+class BwwImporterTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    BwwImporterTest();
+
+private Q_SLOTS:
+    void initTestCase();
+    void testReadScores();
+    void testTitleStartsNewScore();
+    void testImportFile();
+
+private:
+    QList<MusicItem*> readScores(BwwImporter *importer, const QByteArray &data);
+    PluginManager m_pluginManager;
+};
+
+BwwImporterTest::BwwImporterTest()
+{
+}
+
+void BwwImporterTest::initTestCase()
+{
+    CommonPluginManager *pluginManager = new CommonPluginManager;
+    m_pluginManager = PluginManager(pluginManager);
+    pluginManager->setSharedPluginManager(m_pluginManager);
+}
+
+void BwwImporterTest::testReadScores()
+{
+    BwwImporter importer(m_pluginManager);
+    QList<MusicItem*> scores = readScores(&importer, TestTune);
+    QVERIFY2(scores.count() == 1, "Wrong score count");
+    QVERIFY2(importer.noteCount() == 10, "Wrong note count");
+    QVERIFY2(importer.skippedTokenCount() == 3, "Wrong skipped token count");
+
+    MusicItem *score = scores.first();
+    QVERIFY2(score->data(LP::ScoreTitle).toString() == "Test Tune", "Title wasn't read");
+    QVERIFY2(score->data(LP::ScoreComposer).toString() == "Trad.", "Composer wasn't read");
+
+    MusicItem *tune = score->childAt(0);
+    QVERIFY2(tune && tune->childCount() == 2, "Wrong part count");
+    TimeSignature timeSignature = tune->data(LP::TuneTimeSignature).value<TimeSignature>();
+    QVERIFY2(timeSignature.type() == TimeSignature::_2_4, "Time signature wasn't read");
+
+    MusicItem *firstPart = tune->childAt(0);
+    QVERIFY2(firstPart->data(LP::PartRepeat).toBool(), "First part isn't repeated");
+    QVERIFY2(!tune->childAt(1)->data(LP::PartRepeat).toBool(), "Second part is repeated");
+    QVERIFY2(firstPart->childCount() == 3, "Wrong measure count");
+
+    MusicItem *measure = firstPart->childAt(0);
+    QVERIFY2(measure->childCount() == 4, "Wrong symbol count");
+    QVERIFY2(measure->childAt(0)->data(LP::MelodyNoteDots).toInt() == 1, "Dot wasn't read");
+    QVERIFY2(measure->childAt(1)->data(LP::SymbolType).toInt() == GHB::Doubling,
+             "Doubling wasn't read");
+    QVERIFY2(measure->childAt(2)->data(LP::SymbolPitch).value<Pitch>().name() == "B",
+             "Wrong pitch");
+    QVERIFY2(measure->childAt(2)->data(LP::SymbolLength).value<Length::Value>() == Length::_8,
+             "Wrong length");
+
+    // ^tla after the first note
+    measure = firstPart->childAt(1);
+    QVERIFY2(measure->childCount() == 4, "Wrong symbol count with tie");
+    QVERIFY2(measure->childAt(0)->data(LP::SymbolSpanType).value<SpanType>() == SpanType::Start,
+             "Tie doesn't start before the first note");
+    QVERIFY2(measure->childAt(3)->data(LP::SymbolSpanType).value<SpanType>() == SpanType::End,
+             "Tie doesn't end after the second note");
+
+    // ^ts ... ^te around the notes
+    measure = firstPart->childAt(2);
+    QVERIFY2(measure->childCount() == 6, "Wrong symbol count with old tie");
+    QVERIFY2(measure->childAt(1)->data(LP::SymbolSpanType).value<SpanType>() == SpanType::Start,
+             "Old tie doesn't start");
+    QVERIFY2(measure->childAt(4)->data(LP::SymbolSpanType).value<SpanType>() == SpanType::End,
+             "Old tie doesn't end");
+
+    qDeleteAll(scores);
+}
+
+void BwwImporterTest::testTitleStartsNewScore()
+{
+    QByteArray data(TestTune);
+    data.append("\"Second Tune\",(T,L,0,0,Times New Roman,16,700,0,0,18,0,0,0)\n"
+                "&\t6_8 LA_4 'la !I\n");
+
+    BwwImporter importer(m_pluginManager);
+    QList<MusicItem*> scores = readScores(&importer, data);
+    QVERIFY2(scores.count() == 2, "Second title didn't start a new score");
+
+    MusicItem *tune = scores.at(1)->childAt(0);
+    QVERIFY2(tune->childCount() == 1, "Parts of the first score in the second");
+    TimeSignature timeSignature = tune->data(LP::TuneTimeSignature).value<TimeSignature>();
+    QVERIFY2(timeSignature.type() == TimeSignature::_6_8, "Time signature of the second tune");
+
+    qDeleteAll(scores);
+}
+
+void BwwImporterTest::testImportFile()
+{
+    QTemporaryFile file;
+    QVERIFY2(file.open(), "Temporary file wasn't opened");
+    file.write("&\tC LA_4 B_4 C_4 D_4 !I\n");
+    file.close();
+
+    MusicModel model;
+    model.setPluginManager(m_pluginManager);
+    model.appendScore("First score");
+
+    BwwImporter importer(m_pluginManager);
+    QModelIndex firstScore = importer.importFile(&model, file.fileName(), 1);
+    QVERIFY2(firstScore.isValid(), "No valid index returned");
+    QVERIFY2(firstScore.row() == 1, "Score inserted into wrong row");
+    QVERIFY2(!firstScore.data(LP::ScoreTitle).toString().isEmpty(), "Score has no title");
+    QVERIFY2(model.rowCount(firstScore) == 1, "Score has no tune");
+
+    model.undoStack()->undo();
+    QVERIFY2(model.rowCount(QModelIndex()) == 1, "Score wasn't inserted with one command");
+}
+
+QList<MusicItem *> BwwImporterTest::readScores(BwwImporter *importer, const QByteArray &data)
+{
+    QBuffer buffer;
+    buffer.setData(data);
+    buffer.open(QIODevice::ReadOnly | QIODevice::Text);
+    return importer->readScores(&buffer);
+}
+
+QTEST_MAIN(BwwImporterTest)
+
+#include "tst_bwwimportertest.moc"
@@ -18,6 +18,7 @@
 #include <QXmlSchemaValidator>
 #include <QXmlStreamReader>
 #include <utilities/error.h>
+#include <utilities/memoryaccounting.h>
 #include "qt_modeltest/modeltest.h"
 #include <utilities/error.h>
 #include <common/itemdataroles.h>
@@ -545,17 +546,12 @@ void MusicModelTest::testRemoveRows()
 
 void MusicModelTest::testSave()
 {
-#ifdef Q_OS_MAC
-    QSKIP("Test hangs up on QXmlSchema::load() und OS X");
-#endif
     QTemporaryFile tempFile;
     tempFile.open();
-    QStack<QStringRef> musicItemTagStack;
-
     Q_ASSERT(!tempFile.fileName().isEmpty());
 
     QModelIndex tune = m_model->insertTuneWithScore(0, "First Score", m_instrumentNames.at(0));
-    QModelIndex part = m_model->insertPartIntoTune(0, tune, 10);
+    QModelIndex part = m_model->insertPartIntoTune(0, tune, 10, true);
     QModelIndex measure = m_model->index(3, 0, part);
 
     m_model->insertSymbolIntoMeasure(0, measure, m_symbolTypes.at(0));
@@ -565,59 +561,43 @@ void MusicModelTest::testSave()
     part = m_model->insertPartIntoTune(0, tune, 10);
     measure = m_model->index(3, 0, part);
     m_model->insertSymbolIntoMeasure(0, measure, m_symbolTypes.at(0));
-    m_model->insertSymbolIntoMeasure(0, measure, m_symbolTypes.at(0));
-
 
     try {
-        Q_ASSERT(tempFile.isOpen());
         m_model->save(tempFile.fileName());
     }
     catch (LP::Error &error){
-        qWarning() << "Failed saving: " << error.what();
+        QFAIL(error.what());
     }
+    QVERIFY2(tempFile.size() > 0, "Nothing was saved");
 
-    QXmlStreamReader reader(&tempFile);
-
-    // Check nesting of items
-    while (!reader.atEnd()) {
-        reader.readNext();
-        if (reader.isStartElement()) {
-            if (isMusicItemTag(reader.name())) {
-                if (musicItemTagStack.count())
-                    checkTagHierarchy(musicItemTagStack.top(), reader.name());
-                musicItemTagStack.push(reader.name());
-            }
-        }
-        if (reader.isEndElement()) {
-            if (isMusicItemTag(reader.name())) {
-                QVERIFY2(musicItemTagStack.pop() == reader.name(), "Music items are not correctly nested");
-            }
-        }
+    MusicModel loadedModel;
+    loadedModel.setPluginManager(m_pluginManager);
+    QSignalSpy rowsInsertedSpy(&loadedModel, SIGNAL(rowsInserted(const QModelIndex, int, int)));
+    try {
+        loadedModel.load(tempFile.fileName());
     }
-    QString errorMessage = QString("Error occured while reading saved xml file: ") + reader.errorString();
-    QVERIFY2(!reader.hasError(), errorMessage.toUtf8());
-
-    // Check for instrument and symbol name attribute
-    tempFile.reset();
-    reader.setDevice(&tempFile);
-    while (!reader.atEnd()) {
-        reader.readNext();
-        if (reader.isStartElement()) {
-            if (reader.name() == "TUNE") {
-                QVERIFY2(reader.attributes().hasAttribute("INSTRUMENT"), "Tune has no instrument attribute");
-                QVERIFY2(reader.attributes().value("INSTRUMENT") == m_instrumentNames.at(0), "Tune returned wrong instrument name");
-            }
-            if (reader.name() == "SYMBOL") {
-                QVERIFY2(reader.attributes().hasAttribute("NAME"), "Symbol has no name attribute");
-                QVERIFY2(!reader.attributes().value("NAME").isEmpty(), "Symbol name was empty");
-            }
-        }
-        if (reader.isEndElement()) {
-
-        }
+    catch (LP::Error &error){
+        QFAIL(error.what());
     }
-    errorMessage = QString("Error occured while reading saved xml file for attribute check: ") + reader.errorString();
-    QVERIFY2(!reader.hasError(), errorMessage.toUtf8());
+
+    QVERIFY2(rowsInsertedSpy.count() == 1, "Loaded scores weren't inserted at once");
+    QVERIFY2(rowsInsertedSpy.at(0).at(2).toInt() == 1, "Not all loaded scores were inserted");
+    QVERIFY2(loadedModel.rowCount(QModelIndex()) == 2, "Wrong score count loaded");
+    QModelIndex score = loadedModel.index(1, 0, QModelIndex());
+    QVERIFY2(score.data(LP::ScoreTitle).toString() == "First Score", "Score title wasn't loaded");
+
+    QModelIndex loadedTune = loadedModel.index(0, 0, score);
+    QVERIFY2(loadedTune.data(LP::TuneInstrument).toInt() == m_model->index(0, 0, m_model->index(1, 0)).data(LP::TuneInstrument).toInt(),
+             "Tune instrument wasn't loaded");
+
+    QModelIndex loadedPart = loadedModel.index(0, 0, loadedTune);
+    QVERIFY2(loadedPart.data(LP::PartRepeat).toBool(), "Part repeat wasn't loaded");
+    QVERIFY2(loadedModel.rowCount(loadedPart) == 10, "Wrong measure count loaded");
+
+    QModelIndex loadedMeasure = loadedModel.index(3, 0, loadedPart);
+    QVERIFY2(loadedModel.rowCount(loadedMeasure) == 2, "Wrong symbol count loaded");
+    QVERIFY2(loadedModel.index(0, 0, loadedMeasure).data(LP::SymbolType).toInt() == m_symbolTypes.at(0),
+             "Symbol type wasn't loaded");
 }
 
 bool MusicModelTest::isMusicItemTag(const QStringRef &tagName)
@@ -1005,6 +985,56 @@ void MusicModelTest::testDropMimeDataScores()
     QVERIFY2(model2.rowCount(QModelIndex()) == 2, "Failed dropping scores at end");
 }
 
+void MusicModelTest::testDropEncodedMimeData()
+{
+    populateModelWithTestdata();
+    QModelIndex scoreIndex = m_model->index(0, 0, QModelIndex());
+    QModelIndex scoreIndex2 = m_model->index(1, 0, QModelIndex());
+    QMimeData *data = m_model->mimeData(QModelIndexList() << scoreIndex << scoreIndex2);
+    Q_ASSERT(data->formats().count() == 1);
+
+    // Mime data from another application contains only the encoded data
+    QMimeData encodedData;
+    encodedData.setData(data->formats().at(0), data->data(data->formats().at(0)));
+    delete data;
+
+    MusicModel model2;
+    model2.setPluginManager(m_pluginManager);
+    model2.dropMimeData(&encodedData, Qt::CopyAction, 0, 0, QModelIndex());
+    QVERIFY2(model2.rowCount(QModelIndex()) == 2, "Failed dropping encoded scores into model");
+
+    QString scoreTitle = m_model->data(scoreIndex, LP::ScoreTitle).toString();
+    QString droppedScoreTitle = model2.data(model2.index(0, 0, QModelIndex()), LP::ScoreTitle).toString();
+    QVERIFY2(scoreTitle == droppedScoreTitle, "Dropped score has wrong title");
+}
+
+void MusicModelTest::testDropEncodedMimeDataKeepsChildren()
+{
+    populateModelWithTestdata();
+    QModelIndex scoreIndex = m_model->index(0, 0, QModelIndex());
+    QMimeData *data = m_model->mimeData(QModelIndexList() << scoreIndex);
+    Q_ASSERT(data->formats().count() == 1);
+
+    QMimeData encodedData;
+    encodedData.setData(data->formats().at(0), data->data(data->formats().at(0)));
+    delete data;
+
+    MusicModel model2;
+    model2.setPluginManager(m_pluginManager);
+    model2.dropMimeData(&encodedData, Qt::CopyAction, 0, 0, QModelIndex());
+
+    QModelIndex tune = m_model->index(0, 0, scoreIndex);
+    QModelIndex part = m_model->index(0, 0, tune);
+    QModelIndex measure = m_model->index(0, 0, part);
+
+    QModelIndex droppedTune = model2.index(0, 0, model2.index(0, 0, QModelIndex()));
+    QModelIndex droppedPart = model2.index(0, 0, droppedTune);
+    QModelIndex droppedMeasure = model2.index(0, 0, droppedPart);
+    QVERIFY2(droppedTune.isValid(), "Dropped score has no tune");
+    QVERIFY2(model2.rowCount(droppedPart) == m_model->rowCount(part), "Dropped part has wrong measure count");
+    QVERIFY2(model2.rowCount(droppedMeasure) == m_model->rowCount(measure), "Dropped measure has wrong symbol count");
+}
+
 void MusicModelTest::testDropMimeDataTunes()
 {
     populateModelWithTestdata();
@@ -1280,6 +1310,44 @@ void MusicModelTest::testUndoStackDropMimeData()
     QVERIFY2(model2.undoStack()->count() == 1, "No command/too many commands pushed on undo stack while appending");
 }
 
+void MusicModelTest::testUndoMemoryLimit()
+{
+    populateModelWithTestdata();
+    QModelIndex scoreIndex = m_model->index(0, 0, QModelIndex());
+    QString scoreTitle = m_model->data(scoreIndex, LP::ScoreTitle).toString();
+    QModelIndex tuneIndex = m_model->index(0, 0, scoreIndex);
+    int partCount = m_model->rowCount(tuneIndex);
+    Q_ASSERT(partCount);
+
+    m_model->setUndoMemoryLimit(0);
+    qint64 usageBeforeRemove = m_model->undoMemoryUsage();
+    qint64 accountedBeforeRemove = MemoryAccounting::bytes(MemoryAccounting::UndoStack);
+    m_model->removeRows(0, 1, QModelIndex());
+    qint64 usageAfterRemove = m_model->undoMemoryUsage();
+    QVERIFY2(usageAfterRemove > usageBeforeRemove, "Removed items don't count as undo memory");
+    QVERIFY2(MemoryAccounting::bytes(MemoryAccounting::UndoStack) - accountedBeforeRemove <
+             usageAfterRemove - usageBeforeRemove,
+             "Removed items are counted twice in the memory accounting");
+
+    m_model->setUndoMemoryLimit(1);
+    QVERIFY2(m_model->undoMemoryUsage() < usageAfterRemove, "Undo memory wasn't reduced");
+
+    m_model->undoStack()->undo();
+    scoreIndex = m_model->index(0, 0, QModelIndex());
+    QVERIFY2(m_model->data(scoreIndex, LP::ScoreTitle).toString() == scoreTitle,
+             "Removed score wasn't restored");
+    tuneIndex = m_model->index(0, 0, scoreIndex);
+    QVERIFY2(m_model->rowCount(tuneIndex) == partCount, "Children of removed score weren't restored");
+
+    m_model->undoStack()->redo();
+    m_model->undoStack()->undo();
+    QVERIFY2(m_model->data(m_model->index(0, 0, QModelIndex()), LP::ScoreTitle).toString() == scoreTitle,
+             "Score wasn't restored after redo");
+
+    m_model->undoStack()->clear();
+    QVERIFY2(m_model->undoMemoryUsage() == 0, "Deleted commands still count as undo memory");
+}
+
 void MusicModelTest::populateModelWithTestdata()
 {
     QModelIndex tune = m_model->insertTuneWithScore(0, "First Score", m_instrumentNames.at(0));
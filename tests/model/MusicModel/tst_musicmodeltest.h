@@ -71,6 +71,8 @@ private Q_SLOTS:
     void testMimeTypes();
     void testMimeData();
     void testDropMimeDataScores();
+    void testDropEncodedMimeData();
+    void testDropEncodedMimeDataKeepsChildren();
     void testDropMimeDataTunes();
     void testDropMimeDataParts();
     void testDropMimeDataMeasures();
@@ -84,6 +86,7 @@ private Q_SLOTS:
     void testUndoStackInsertSymbol();
     void testUndoStackRemoveRows();
     void testUndoStackDropMimeData();
+    void testUndoMemoryLimit();
 
 private:
     void checkForTuneCount(const QString &filename, int count);
@@ -10,6 +10,7 @@
 #include <QtTest/QtTest>
 #include <common/datatypes/timesignature.h>
 #include <common/itemdataroles.h>
+#include <tune.h>
 #include "tst_scoretest.h"
 
 void ScoreTest::init()
@@ -62,6 +63,27 @@ void ScoreTest::testConstructor()
     QVERIFY2(m_score->childType() == MusicItem::TuneType, "The child itemtype of score is not TuneType");
 }
 
+void ScoreTest::testClone()
+{
+    m_score->setData("Original title", LP::ScoreTitle);
+    Tune *tune = new Tune(LP::GreatHighlandBagpipe);
+    m_score->addChild(tune);
+
+    Score *scoreClone = m_score->clone();
+    QVERIFY2(scoreClone->parent() == 0, "Clone has a parent");
+    QVERIFY2(scoreClone->data(LP::ScoreTitle) == "Original title", "Data wasn't cloned");
+    QVERIFY2(scoreClone->childCount() == 1, "Children weren't cloned");
+    QVERIFY2(scoreClone->childAt(0) != tune, "Child of clone is the original child");
+    QVERIFY2(scoreClone->childAt(0)->parent() == scoreClone, "Child of clone has wrong parent");
+    QVERIFY2(scoreClone->childAt(0)->data(LP::TuneInstrument).toInt() == LP::GreatHighlandBagpipe,
+             "Child data wasn't cloned");
+
+    scoreClone->setData("Changed title", LP::ScoreTitle);
+    QVERIFY2(m_score->data(LP::ScoreTitle) == "Original title", "Changing clone changed original");
+
+    delete scoreClone;
+}
+
 void ScoreTest::testSetGetTitle()
 {
     m_score->setTitle(QString("New Title"));
@@ -26,6 +26,7 @@ private Q_SLOTS:
     void testChildType();
     void testSetData();
     void testConstructor();
+    void testClone();
     void testSetGetTitle();
     void testWriteToXmlStream();
     void testReadFromXmlStream();
@@ -0,0 +1,175 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#include <QString>
+#include <QtTest>
+#include <QJsonArray>
+#include <QUndoStack>
+#include <app/commonpluginmanager.h>
+#include <common/defines.h>
+#include <common/itemdataroles.h>
+#include <musicmodel.h>
+#include <musicitem.h>
+#include <scoregenerator.h>
+
+Q_IMPORT_PLUGIN(GreatHighlandBagpipe)
+Q_IMPORT_PLUGIN(IntegratedSymbols)
+
+class ScoreGeneratorTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    ScoreGeneratorTest();
+
+private Q_SLOTS:
+    void initTestCase();
+    void testCreateScores();
+    void testSameSeedCreatesSameScores();
+    void testSpansAreClosed();
+    void testInstrumentSymbolWeights();
+    void testInsertScores();
+
+private:
+    QJsonArray jsonOfScores(const QList<MusicItem*> &scores);
+    PluginManager m_pluginManager;
+};
+
+ScoreGeneratorTest::ScoreGeneratorTest()
+{
+}
+
+void ScoreGeneratorTest::initTestCase()
+{
+    CommonPluginManager *pluginManager = new CommonPluginManager;
+    m_pluginManager = PluginManager(pluginManager);
+    pluginManager->setSharedPluginManager(m_pluginManager);
+}
+
+void ScoreGeneratorTest::testCreateScores()
+{
+    ScoreGenerator generator(m_pluginManager);
+    generator.setScoreCount(2);
+    generator.setTunesPerScore(3);
+    generator.setPartsPerTune(2);
+    generator.setMeasuresPerPart(5);
+    generator.setSymbolsPerMeasure(4);
+
+    QList<MusicItem*> scores = generator.createScores();
+    QVERIFY2(scores.count() == 2, "Wrong score count");
+
+    MusicItem *tune = scores.first()->childAt(2);
+    QVERIFY2(tune && tune->type() == LP::ItemType::TuneType, "No tune created");
+    MusicItem *part = tune->childAt(1);
+    QVERIFY2(part && part->childCount() == 5, "Wrong measure count");
+    QVERIFY2(part->childAt(4)->childCount() == 4, "Wrong symbol count");
+
+    MusicItem *symbol = part->childAt(0)->childAt(0);
+    QVERIFY2(symbol->data(LP::SymbolPitch).isValid(), "Melody note has no pitch");
+
+    qDeleteAll(scores);
+}
+
+void ScoreGeneratorTest::testSameSeedCreatesSameScores()
+{
+    ScoreGenerator generator(m_pluginManager);
+    generator.setSeed(42);
+    generator.setSymbolWeight(LP::Tie, 1);
+
+    QList<MusicItem*> firstScores = generator.createScores();
+    QList<MusicItem*> secondScores = generator.createScores();
+    QVERIFY2(jsonOfScores(firstScores) == jsonOfScores(secondScores),
+             "Same seed created different scores");
+
+    generator.setSeed(43);
+    QList<MusicItem*> otherScores = generator.createScores();
+    QVERIFY2(jsonOfScores(firstScores) != jsonOfScores(otherScores),
+             "Different seeds created the same scores");
+
+    qDeleteAll(firstScores);
+    qDeleteAll(secondScores);
+    qDeleteAll(otherScores);
+}
+
+void ScoreGeneratorTest::testSpansAreClosed()
+{
+    ScoreGenerator generator(m_pluginManager);
+    generator.setSymbolWeight(LP::MelodyNote, 1);
+    generator.setSymbolWeight(LP::Tie, 1);
+
+    QList<MusicItem*> scores = generator.createScores();
+    MusicItem *part = scores.first()->childAt(0)->childAt(0);
+
+    int openSpans = 0;
+    int spanCount = 0;
+    foreach (MusicItem *measure, part->children()) {
+        foreach (MusicItem *symbol, measure->children()) {
+            SpanType spanType = symbol->data(LP::SymbolSpanType).value<SpanType>();
+            if (spanType == SpanType::Start) {
+                QVERIFY2(openSpans == 0, "Span started inside of another span");
+                openSpans++;
+                spanCount++;
+            } else if (spanType == SpanType::End) {
+                openSpans--;
+            }
+        }
+    }
+    QVERIFY2(spanCount > 0, "No ties were created");
+    QVERIFY2(openSpans == 0, "Not all ties were closed");
+
+    qDeleteAll(scores);
+}
+
+void ScoreGeneratorTest::testInstrumentSymbolWeights()
+{
+    ScoreGenerator generator(m_pluginManager);
+    generator.setSymbolWeight(LP::NoSymbolType, 5);
+    generator.setInstrumentSymbolWeights();
+
+    int instrumentType = m_pluginManager->instrumentTypeForName(generator.instrumentName());
+    QList<int> symbolTypes = m_pluginManager->instrumentMetaData(instrumentType).supportedSymbols();
+    QVERIFY2(symbolTypes.count() > 2, "Instrument has not enough symbols");
+    foreach (int symbolType, symbolTypes) {
+        QVERIFY2(generator.symbolWeight(symbolType) > 0, "Symbol of instrument isn't used");
+    }
+    QVERIFY2(generator.symbolWeight(LP::NoSymbolType) == 0, "Previous symbol mix wasn't replaced");
+    QVERIFY2(generator.symbolWeight(LP::MelodyNote) > generator.symbolWeight(LP::Tie),
+             "Spanning symbols are chosen as often as melody notes");
+}
+
+void ScoreGeneratorTest::testInsertScores()
+{
+    MusicModel model;
+    model.setPluginManager(m_pluginManager);
+    model.appendScore("First score");
+
+    ScoreGenerator generator(m_pluginManager);
+    generator.setScoreCount(3);
+    QModelIndex firstScore = generator.insertScores(&model, 1);
+
+    QVERIFY2(firstScore.isValid(), "No valid index returned");
+    QVERIFY2(firstScore.row() == 1, "Scores inserted into wrong row");
+    QVERIFY2(model.rowCount(QModelIndex()) == 4, "Wrong score count in model");
+    QVERIFY2(model.rowCount(firstScore) == generator.tunesPerScore(), "Score has no tunes");
+
+    model.undoStack()->undo();
+    QVERIFY2(model.rowCount(QModelIndex()) == 1, "Scores weren't inserted with one command");
+}
+
+QJsonArray ScoreGeneratorTest::jsonOfScores(const QList<MusicItem *> &scores)
+{
+    QJsonArray array;
+    foreach (const MusicItem *score, scores) {
+        array.append(score->toJson());
+    }
+    return array;
+}
+
+QTEST_MAIN(ScoreGeneratorTest)
+
+#include "tst_scoregeneratortest.moc"
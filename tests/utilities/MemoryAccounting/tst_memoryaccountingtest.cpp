@@ -0,0 +1,136 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#include <QString>
+#include <QtTest>
+#include <common/itemdataroles.h>
+#include <common/datahandling/itembehavior.h>
+#include <utilities/memoryaccounting.h>
+#include <score.h>
+
+class MemoryAccountingTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    MemoryAccountingTest();
+
+private Q_SLOTS:
+    void testInstances();
+    void testAddBytes();
+    void testMusicItemsAreCounted();
+    void testBehaviorDataIsCounted();
+    void testAssignedBehaviorIsCounted();
+    void testReport();
+};
+
+MemoryAccountingTest::MemoryAccountingTest()
+{
+}
+
+void MemoryAccountingTest::testInstances()
+{
+    qint64 bytesBefore = MemoryAccounting::bytes(MemoryAccounting::VisualItems);
+    qint64 instancesBefore = MemoryAccounting::instanceCount(MemoryAccounting::VisualItems);
+
+    MemoryAccounting::addInstance(MemoryAccounting::VisualItems, 100);
+    MemoryAccounting::addInstance(MemoryAccounting::VisualItems, 100);
+    QVERIFY2(MemoryAccounting::bytes(MemoryAccounting::VisualItems) == bytesBefore + 200,
+             "Bytes weren't added");
+    QVERIFY2(MemoryAccounting::instanceCount(MemoryAccounting::VisualItems) == instancesBefore + 2,
+             "Instances weren't counted");
+
+    MemoryAccounting::removeInstance(MemoryAccounting::VisualItems, 100);
+    MemoryAccounting::removeInstance(MemoryAccounting::VisualItems, 100);
+    QVERIFY2(MemoryAccounting::bytes(MemoryAccounting::VisualItems) == bytesBefore,
+             "Bytes weren't removed");
+    QVERIFY2(MemoryAccounting::instanceCount(MemoryAccounting::VisualItems) == instancesBefore,
+             "Instances weren't removed");
+}
+
+void MemoryAccountingTest::testAddBytes()
+{
+    qint64 totalBefore = MemoryAccounting::totalBytes();
+    MemoryAccounting::addBytes(MemoryAccounting::UndoStack, 1000);
+    QVERIFY2(MemoryAccounting::totalBytes() == totalBefore + 1000, "Total bytes are wrong");
+    QVERIFY2(MemoryAccounting::instanceCount(MemoryAccounting::UndoStack) == 0,
+             "Adding bytes changed the instance count");
+
+    MemoryAccounting::addBytes(MemoryAccounting::UndoStack, -1000);
+    QVERIFY2(MemoryAccounting::totalBytes() == totalBefore, "Bytes weren't removed");
+}
+
+void MemoryAccountingTest::testMusicItemsAreCounted()
+{
+    qint64 itemsBefore = MemoryAccounting::instanceCount(MemoryAccounting::MusicItems);
+    qint64 behaviorsBefore = MemoryAccounting::instanceCount(MemoryAccounting::ItemBehaviors);
+
+    Score *score = new Score("Title");
+    Score *clone = score->clone();
+    QVERIFY2(MemoryAccounting::instanceCount(MemoryAccounting::MusicItems) == itemsBefore + 2,
+             "Music items weren't counted");
+    QVERIFY2(MemoryAccounting::instanceCount(MemoryAccounting::ItemBehaviors) == behaviorsBefore + 2,
+             "Item behaviors weren't counted");
+
+    delete score;
+    delete clone;
+    QVERIFY2(MemoryAccounting::instanceCount(MemoryAccounting::MusicItems) == itemsBefore,
+             "Music items weren't removed");
+    QVERIFY2(MemoryAccounting::instanceCount(MemoryAccounting::ItemBehaviors) == behaviorsBefore,
+             "Item behaviors weren't removed");
+}
+
+void MemoryAccountingTest::testBehaviorDataIsCounted()
+{
+    Score score("Title");
+    qint64 usageBefore = score.itemBehavior()->memoryUsage();
+    qint64 bytesBefore = MemoryAccounting::bytes(MemoryAccounting::ItemBehaviors);
+
+    score.setData("Composer", LP::ScoreComposer);
+    qint64 addedBytes = score.itemBehavior()->memoryUsage() - usageBefore;
+    QVERIFY2(addedBytes > 0, "Data wasn't counted");
+    QVERIFY2(MemoryAccounting::bytes(MemoryAccounting::ItemBehaviors) == bytesBefore + addedBytes,
+             "Layer bytes weren't updated");
+}
+
+void MemoryAccountingTest::testAssignedBehaviorIsCounted()
+{
+    qint64 bytesBefore = MemoryAccounting::bytes(MemoryAccounting::ItemBehaviors);
+    qint64 behaviorsBefore = MemoryAccounting::instanceCount(MemoryAccounting::ItemBehaviors);
+    {
+        Score score("Title");
+        score.setData("Composer", LP::ScoreComposer);
+
+        ItemBehavior behavior(LP::ItemType::ScoreType);
+        behavior = *score.itemBehavior();
+        QVERIFY2(behavior.memoryUsage() == score.itemBehavior()->memoryUsage(),
+                 "Memory usage wasn't assigned");
+    }
+    QVERIFY2(MemoryAccounting::bytes(MemoryAccounting::ItemBehaviors) == bytesBefore,
+             "Assigned behavior left bytes in the layer");
+    QVERIFY2(MemoryAccounting::instanceCount(MemoryAccounting::ItemBehaviors) == behaviorsBefore,
+             "Assigned behavior left an instance in the layer");
+}
+
+void MemoryAccountingTest::testReport()
+{
+    MemoryAccounting::NamedSizes scoreSizes;
+    scoreSizes << qMakePair(QString("Test Score"), qint64(2048));
+
+    QString report = MemoryAccounting::report(scoreSizes);
+    for (int i = 0; i < MemoryAccounting::LayerCount; ++i) {
+        QString layerName = MemoryAccounting::layerName(static_cast<MemoryAccounting::Layer>(i));
+        QVERIFY2(report.contains(layerName), "Layer is missing in report");
+    }
+    QVERIFY2(report.contains("Test Score"), "Score is missing in report");
+    QVERIFY2(report.contains("2.0 KiB"), "Score size is missing in report");
+}
+
+QTEST_GUILESS_MAIN(MemoryAccountingTest)
+
+#include "tst_memoryaccountingtest.moc"
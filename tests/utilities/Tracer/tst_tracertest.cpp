@@ -0,0 +1,124 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#include <QString>
+#include <QtTest>
+#include <QBuffer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <utilities/tracer.h>
+
+class TracerTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    TracerTest();
+
+private Q_SLOTS:
+    void init();
+    void cleanup();
+    void testDisabledTracerRecordsNothing();
+    void testTraceScope();
+    void testWriteChromeTrace();
+    void testOldestEventsAreDropped();
+
+private:
+    void tracedFunction();
+};
+
+TracerTest::TracerTest()
+{
+}
+
+void TracerTest::init()
+{
+    Tracer::clear();
+}
+
+void TracerTest::cleanup()
+{
+    Tracer::setEnabled(false);
+}
+
+void TracerTest::testDisabledTracerRecordsNothing()
+{
+    Tracer::setEnabled(false);
+    tracedFunction();
+
+    QVERIFY2(Tracer::eventCount() == 0, "Event recorded while tracer is disabled");
+}
+
+void TracerTest::testTraceScope()
+{
+    Tracer::setEnabled(true);
+    tracedFunction();
+    tracedFunction();
+
+    QVERIFY2(Tracer::eventCount() == 2, "Wrong event count");
+
+    Tracer::clear();
+    QVERIFY2(Tracer::eventCount() == 0, "Events weren't cleared");
+}
+
+void TracerTest::testWriteChromeTrace()
+{
+    Tracer::setEnabled(true);
+    tracedFunction();
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    QVERIFY2(Tracer::writeChromeTrace(&buffer), "Trace wasn't written");
+
+    QJsonDocument document = QJsonDocument::fromJson(buffer.data());
+    QJsonArray events = document.object().value("traceEvents").toArray();
+    QVERIFY2(events.count() == 1, "Wrong event count in trace");
+
+    QJsonObject event = events.at(0).toObject();
+    QVERIFY2(event.value("name").toString() == "TracerTest::tracedFunction", "Wrong event name");
+    QVERIFY2(event.value("ph").toString() == "X", "Event isn't a complete event");
+    QVERIFY2(event.value("dur").toDouble() >= 1000, "Wrong duration");
+}
+
+void TracerTest::testOldestEventsAreDropped()
+{
+    int maxEvents = Tracer::maxEventsPerThread();
+    Tracer::setMaxEventsPerThread(3);
+    for (int i = 0; i < 5; ++i) {
+        Tracer::addEvent("TracerTest::event", i, 1);
+    }
+
+    QVERIFY2(Tracer::eventCount() == 3, "Wrong event count in full buffer");
+    QVERIFY2(Tracer::droppedEventCount() == 2, "Wrong dropped event count");
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    QVERIFY2(Tracer::writeChromeTrace(&buffer), "Trace wasn't written");
+
+    QJsonArray events = QJsonDocument::fromJson(buffer.data()).object().value("traceEvents").toArray();
+    QVERIFY2(events.count() == 3, "Wrong event count in trace");
+    for (int i = 0; i < events.count(); ++i) {
+        QVERIFY2(events.at(i).toObject().value("ts").toDouble() == i + 2,
+                 "Oldest events weren't dropped");
+    }
+
+    Tracer::setMaxEventsPerThread(maxEvents);
+    QVERIFY2(Tracer::eventCount() == 0, "Events weren't cleared with new buffer size");
+    QVERIFY2(Tracer::droppedEventCount() == 0, "Dropped events weren't cleared");
+}
+
+void TracerTest::tracedFunction()
+{
+    LP_TRACE_SCOPE("TracerTest::tracedFunction");
+    QTest::qSleep(1);
+}
+
+QTEST_GUILESS_MAIN(TracerTest)
+
+#include "tst_tracertest.moc"
@@ -0,0 +1,119 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#include <QString>
+#include <QtTest>
+#include <QBuffer>
+#include <QGraphicsScene>
+#include <QGraphicsWidget>
+#include <graphicsitemview/pageexporter.h>
+#include <graphicsitemview/pageviewitem/pageviewitem.h>
+
+class PageExporterTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    PageExporterTest();
+
+private Q_SLOTS:
+    void init();
+    void cleanup();
+    void testRasterizePage();
+    void testExportPdf();
+    void testExportRasterizedPdf();
+
+private:
+    QGraphicsWidget *createRow();
+    QGraphicsScene *m_scene;
+    PageViewItem *m_pageView;
+};
+
+PageExporterTest::PageExporterTest()
+    : m_scene(0),
+      m_pageView(0)
+{
+}
+
+void PageExporterTest::init()
+{
+    m_scene = new QGraphicsScene();
+    m_pageView = new PageViewItem();
+    m_scene->addItem(m_pageView);
+
+    while (m_pageView->pageCount() < 3) {
+        m_pageView->appendRow(createRow());
+    }
+}
+
+void PageExporterTest::cleanup()
+{
+    delete m_scene;
+}
+
+void PageExporterTest::testRasterizePage()
+{
+    QRectF pageRect = m_pageView->pageSceneRect(0);
+    QVERIFY2(!pageRect.isEmpty(), "Page has no rect");
+
+    QPicture picture = PageExporter::recordPage(m_pageView, 0);
+    QImage image = PageExporter::rasterizePage(picture, pageRect.size(), pageRect.size().toSize());
+    QVERIFY2(image.size() == pageRect.size().toSize(), "Wrong image size");
+
+    QRectF rowRect = m_pageView->rowAt(0)->sceneBoundingRect().translated(-pageRect.topLeft());
+    QVERIFY2(image.pixel(rowRect.center().toPoint()) == qRgb(255, 0, 0), "Row wasn't rendered");
+    QVERIFY2(image.pixel(1, 1) == qRgb(255, 255, 255), "Page margin isn't white");
+}
+
+void PageExporterTest::testExportPdf()
+{
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+
+    PageExporter exporter(m_pageView);
+    QVERIFY2(!exporter.isRasterized(), "Pages are rasterized by default");
+    QSignalSpy spy(&exporter, SIGNAL(pageExported(int,int)));
+
+    QVERIFY2(exporter.exportPdf(&buffer), "Export failed");
+    QVERIFY2(buffer.data().startsWith("%PDF"), "No PDF written");
+    QVERIFY2(spy.count() == m_pageView->pageCount(), "Not all pages exported");
+}
+
+void PageExporterTest::testExportRasterizedPdf()
+{
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+
+    PageExporter exporter(m_pageView);
+    exporter.setRasterized(true);
+    exporter.setResolution(72);
+    exporter.setMaxPagesInFlight(2);
+    QSignalSpy spy(&exporter, SIGNAL(pageExported(int,int)));
+
+    QVERIFY2(exporter.exportPdf(&buffer), "Export failed");
+    QVERIFY2(buffer.data().startsWith("%PDF"), "No PDF written");
+    QVERIFY2(spy.count() == m_pageView->pageCount(), "Not all pages exported");
+    QVERIFY2(spy.last().at(0).toInt() == m_pageView->pageCount() - 1, "Pages written out of order");
+}
+
+QGraphicsWidget *PageExporterTest::createRow()
+{
+    QGraphicsWidget *row = new QGraphicsWidget();
+    row->setPreferredHeight(200);
+    row->setMinimumHeight(200);
+
+    QPalette rowPalette = row->palette();
+    rowPalette.setColor(QPalette::Window, Qt::red);
+    row->setPalette(rowPalette);
+    row->setAutoFillBackground(true);
+    return row;
+}
+
+QTEST_MAIN(PageExporterTest)
+
+#include "tst_pageexportertest.moc"
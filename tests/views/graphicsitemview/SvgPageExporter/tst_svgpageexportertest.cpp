@@ -0,0 +1,179 @@
+/**
+ * @author  Thomas Baumann <teebaum@ymail.com>
+ *
+ * @section LICENSE
+ * Licensed under the GNU GENERAL PUBLIC LICENSE. See LICENSE for details.
+ *
+ */
+
+#include <QString>
+#include <QtTest>
+#include <QGraphicsScene>
+#include <QGraphicsWidget>
+#include <QTemporaryDir>
+#include <app/commonpluginmanager.h>
+#include <app/SMuFL/smuflloader.h>
+#include <common/defines.h>
+#include <common/itemdataroles.h>
+#include <common/layoutsettings.h>
+#include <common/datatypes/length.h>
+#include <common/graphictypes/glyphitem.h>
+#include <musicmodel.h>
+#include <graphicsitemview/svgpageexporter.h>
+#include <graphicsitemview/pageviewitem/pageviewitem.h>
+
+Q_IMPORT_PLUGIN(GreatHighlandBagpipe)
+Q_IMPORT_PLUGIN(IntegratedSymbols)
+
+class SvgPageExporterTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    SvgPageExporterTest();
+
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+    void testGlyphsAreSharedSymbols();
+    void testThumbnailForPage();
+    void testExportPages();
+    void testExportDirectoryEngravesStems();
+
+private:
+    QGraphicsScene *m_scene;
+    PageViewItem *m_pageView;
+    QList<GlyphItem*> m_glyphs;
+    MusicFontPtr m_musicFont;
+    PluginManager m_pluginManager;
+};
+
+SvgPageExporterTest::SvgPageExporterTest()
+    : m_scene(0),
+      m_pageView(0)
+{
+}
+
+void SvgPageExporterTest::initTestCase()
+{
+    SMuFLLoader *smuflLoader = new SMuFLLoader();
+    smuflLoader->setFontFromPath(QStringLiteral(":/SMuFL/fonts/Bravura/Bravura.otf"));
+    smuflLoader->setFontPixelSize(40);
+    smuflLoader->loadGlyphnamesFromFile(QStringLiteral(":/SMuFL/glyphnames.json"));
+    smuflLoader->loadFontMetadataFromFile(QStringLiteral(":/SMuFL/fonts/Bravura/metadata.json"));
+    smuflLoader->setFontColor(FontColor::Normal, Qt::black);
+    m_musicFont = MusicFontPtr(smuflLoader);
+    LayoutSettings::setMusicFont(m_musicFont);
+
+    CommonPluginManager *pluginManager = new CommonPluginManager;
+    pluginManager->setMusicFont(m_musicFont);
+    m_pluginManager = PluginManager(pluginManager);
+    pluginManager->setSharedPluginManager(m_pluginManager);
+}
+
+void SvgPageExporterTest::init()
+{
+    m_scene = new QGraphicsScene();
+    m_pageView = new PageViewItem();
+    m_scene->addItem(m_pageView);
+
+    QGraphicsWidget *row = new QGraphicsWidget();
+    row->setPreferredHeight(100);
+    m_glyphs.clear();
+    for (int i = 0; i < 3; ++i) {
+        GlyphItem *glyph = new GlyphItem("noteheadBlack", row);
+        glyph->setPos(20 + i * 30, 50);
+        m_glyphs << glyph;
+    }
+    m_pageView->appendRow(row);
+}
+
+void SvgPageExporterTest::cleanup()
+{
+    delete m_scene;
+}
+
+void SvgPageExporterTest::testGlyphsAreSharedSymbols()
+{
+    SvgPageExporter exporter;
+    SvgPageExporter::PageGraphics page = exporter.capturePage(m_pageView, 0);
+    QVERIFY2(page.glyphs.count() == 3, "Not all glyphs captured");
+    QVERIFY2(page.glyphPaths.count() == 1, "Same glyph captured more than once");
+
+    foreach (GlyphItem *glyph, m_glyphs) {
+        QVERIFY2(glyph->isGlyphPainted(), "Glyph isn't painted again after capturing");
+    }
+
+    QByteArray svg = SvgPageExporter::svgForPage(page);
+    QVERIFY2(svg.count("<symbol ") == 1, "Glyph isn't defined once");
+    QVERIFY2(svg.count("<use ") == 3, "Glyphs aren't placed with use");
+    QVERIFY2(!svg.contains("<text"), "Glyph was written as text");
+    QVERIFY2(svg.trimmed().endsWith("</svg>"), "SVG isn't closed");
+}
+
+void SvgPageExporterTest::testThumbnailForPage()
+{
+    SvgPageExporter exporter;
+    SvgPageExporter::PageGraphics page = exporter.capturePage(m_pageView, 0);
+
+    QImage thumbnail = SvgPageExporter::thumbnailForPage(page, 100);
+    QVERIFY2(thumbnail.width() == 100, "Wrong thumbnail width");
+    QVERIFY2(qAbs(thumbnail.height() - 100 * page.size.height() / page.size.width()) < 1,
+             "Thumbnail doesn't keep the aspect ratio");
+}
+
+void SvgPageExporterTest::testExportPages()
+{
+    QTemporaryDir outputDir;
+    QVERIFY2(outputDir.isValid(), "No temporary directory");
+
+    SvgPageExporter exporter;
+    exporter.setMaxPagesInFlight(1);
+    int pageCount = exporter.exportPages(m_pageView, outputDir.path(), "tune");
+    QVERIFY2(pageCount == m_pageView->pageCount(), "Not all pages exported");
+    QVERIFY2(exporter.waitForFinished() == pageCount, "Not all pages written");
+
+    QDir dir(outputDir.path());
+    QVERIFY2(dir.exists("tune-1.svg"), "SVG wasn't written");
+    QVERIFY2(dir.exists("tune-1.png"), "Thumbnail wasn't written");
+}
+
+void SvgPageExporterTest::testExportDirectoryEngravesStems()
+{
+    QTemporaryDir documentsDir;
+    QTemporaryDir outputDir;
+    QVERIFY2(documentsDir.isValid() && outputDir.isValid(), "No temporary directory");
+
+    // A single eighth note isn't beamed, so its stem has a flag
+    MusicModel model;
+    model.setPluginManager(m_pluginManager);
+    QModelIndex tune = model.insertTuneWithScore(0, "Stems", "Great Highland Bagpipe");
+    QModelIndex part = model.insertPartIntoTune(0, tune, 1);
+    QModelIndex measure = model.index(0, 0, part);
+    QModelIndex eighth = model.appendSymbolToMeasure(measure, LP::MelodyNote);
+    model.setData(eighth, QVariant::fromValue<Length::Value>(Length::_8), LP::SymbolLength);
+    QModelIndex quarter = model.appendSymbolToMeasure(measure, LP::MelodyNote);
+    model.setData(quarter, QVariant::fromValue<Length::Value>(Length::_4), LP::SymbolLength);
+    model.save(QDir(documentsDir.path()).filePath("stems.lime"));
+
+    SvgPageExporter exporter;
+    exporter.setPluginManager(m_pluginManager);
+    exporter.setThumbnailWidth(0);
+    QVERIFY2(exporter.exportDirectory(documentsDir.path(), outputDir.path()) == 1,
+             "Page of the document wasn't written");
+    QVERIFY2(exporter.failedCount() == 0, "Export failed");
+
+    QFile svgFile(QDir(outputDir.path()).filePath("stems-1.svg"));
+    QVERIFY2(svgFile.open(QIODevice::ReadOnly), "SVG wasn't written");
+    QByteArray svg = svgFile.readAll();
+
+    QChar flagGlyph(m_musicFont->codepointForGlyph("flag8thDown"));
+    QString flagId = QString("glyph-%1").arg(flagGlyph.unicode(), 4, 16, QChar('0'));
+    QVERIFY2(svg.contains(QString("href=\"#%1\"").arg(flagId).toUtf8()),
+             "Stem of the eighth note wasn't engraved before the page was captured");
+}
+
+QTEST_MAIN(SvgPageExporterTest)
+
+#include "tst_svgpageexportertest.moc"
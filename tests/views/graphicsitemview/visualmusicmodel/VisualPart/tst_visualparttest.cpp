@@ -10,9 +10,12 @@
 #include <QtTest>
 #include <QCoreApplication>
 #include <QSignalSpy>
+#include <app/SMuFL/smuflloader.h>
 #include <common/itemdataroles.h>
+#include <common/layoutsettings.h>
 #include <views/graphicsitemview/visualmusicmodel/visualpart.h>
 #include <views/graphicsitemview/visualmusicmodel/interactinggraphicsitems/staffgraphicsitem.h>
+#include <views/graphicsitemview/visualmusicmodel/interactinggraphicsitems/measuregraphicsitem.h>
 
 class VisualPartTest : public QObject
 {
@@ -22,6 +25,7 @@ public:
     VisualPartTest();
 
 private Q_SLOTS:
+    void initTestCase();
     void init();
     void cleanup();
     void testConstructor();
@@ -34,8 +38,10 @@ private Q_SLOTS:
     void testRemoveLastStaffItem();
     void testSetStaffTypeOnStaffItem();
     void testInsertChildItemImplementation();
+    void testRemoveChildItem();
 
 private:
+    VisualItem *newVisualMeasure() const;
     VisualPart *m_visualPart;
 };
 
@@ -43,6 +49,17 @@ VisualPartTest::VisualPartTest()
 {
 }
 
+void VisualPartTest::initTestCase()
+{
+    SMuFLLoader *smuflLoader = new SMuFLLoader();
+    smuflLoader->setFontFromPath(QStringLiteral(":/SMuFL/fonts/Bravura/Bravura.otf"));
+    smuflLoader->setFontPixelSize(40);
+    smuflLoader->loadGlyphnamesFromFile(QStringLiteral(":/SMuFL/glyphnames.json"));
+    smuflLoader->loadFontMetadataFromFile(QStringLiteral(":/SMuFL/fonts/Bravura/metadata.json"));
+    smuflLoader->setFontColor(FontColor::Normal, Qt::black);
+    LayoutSettings::setMusicFont(MusicFontPtr(smuflLoader));
+}
+
 void VisualPartTest::init()
 {
     m_visualPart = new VisualPart;
@@ -151,6 +168,37 @@ void VisualPartTest::testInsertChildItemImplementation()
              "Measure wasn't inserted");
 }
 
+VisualItem *VisualPartTest::newVisualMeasure() const
+{
+    VisualItem *visualMeasure = new VisualItem(VisualItem::VisualMeasureItem,
+                                               VisualItem::GraphicalInlineType,
+                                               m_visualPart);
+    visualMeasure->setInlineGraphic(new MeasureGraphicsItem);
+    return visualMeasure;
+}
+
+void VisualPartTest::testRemoveChildItem()
+{
+    VisualItem *firstMeasure = newVisualMeasure();
+    VisualItem *secondMeasure = newVisualMeasure();
+    VisualItem *thirdMeasure = newVisualMeasure();
+    m_visualPart->insertChildItem(0, firstMeasure);
+    m_visualPart->insertChildItem(1, secondMeasure);
+    m_visualPart->insertChildItem(2, thirdMeasure);
+
+    m_visualPart->removeChildItem(secondMeasure);
+    QVERIFY2(m_visualPart->m_measureItems.count() == 2, "Measure wasn't removed from part");
+    QVERIFY2(m_visualPart->m_staffItems.at(0)->measureCount() == 2, "Measure wasn't removed from staff");
+    QVERIFY2(!m_visualPart->m_measureItems.contains(
+                 qgraphicsitem_cast<MeasureGraphicsItem*>(secondMeasure->inlineGraphic())),
+             "Removed measure is still in the part");
+
+    m_visualPart->removeChildItem(firstMeasure);
+    MeasureGraphicsItem *newFirstMeasure = m_visualPart->m_measureItems.at(0);
+    QVERIFY2(newFirstMeasure == thirdMeasure->inlineGraphic(), "Wrong measure left");
+    QVERIFY2(newFirstMeasure->timeSignatureVisible(), "Time signature of new first measure isn't visible");
+}
+
 QTEST_MAIN(VisualPartTest)
 
 #include "tst_visualparttest.moc"
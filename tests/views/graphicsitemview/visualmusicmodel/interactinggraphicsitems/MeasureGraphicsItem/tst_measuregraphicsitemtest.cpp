@@ -12,6 +12,7 @@
 #include <QCoreApplication>
 #include <QGraphicsLinearLayout>
 #include <src/views/graphicsitemview/visualmusicmodel/interactinggraphicsitems/measuregraphicsitem.h>
+#include <src/views/graphicsitemview/visualmusicmodel/interactinggraphicsitems/symbolgraphicsitem.h>
 
 class MeasureGraphicsItemTest : public QObject
 {
@@ -27,6 +28,7 @@ private Q_SLOTS:
     void testSymbolLayout();
     void testInsertChildItemImplementation();
     void testSetGetPenWidth();
+    void testSymbolPositionsAreDroppedOnInsertAndRemove();
 //    void testSetLineSide();
     void testBoundingRect();
 //    void testBoundingRectLineSide();
@@ -108,6 +110,36 @@ void MeasureGraphicsItemTest::testSetGetPenWidth()
              "Can't set line width");
 }
 
+void MeasureGraphicsItemTest::testSymbolPositionsAreDroppedOnInsertAndRemove()
+{
+    SymbolGraphicsItem *firstSymbol = new SymbolGraphicsItem;
+    SymbolGraphicsItem *secondSymbol = new SymbolGraphicsItem;
+    SymbolGraphicsItem *insertedSymbol = new SymbolGraphicsItem;
+    firstSymbol->setPreferredWidth(10);
+    secondSymbol->setPreferredWidth(20);
+    insertedSymbol->setPreferredWidth(5);
+    m_measureGraphicsItem->insertChildItem(0, firstSymbol);
+    m_measureGraphicsItem->insertChildItem(1, secondSymbol);
+
+    m_measureGraphicsItem->setSymbolPositions(QVector<qreal>() << 0 << 30);
+    QList<QRectF> geometries(m_measureGraphicsItem->symbolGeometries());
+    QVERIFY2(geometries.at(1).left() == 30, "Positions of the spacing aren't used");
+    QVERIFY2(geometries.at(0).width() == m_measureGraphicsItem->symbolWidth(0) &&
+             geometries.at(1).width() == m_measureGraphicsItem->symbolWidth(1),
+             "Geometries don't use the symbol widths of the spacing");
+
+    m_measureGraphicsItem->insertChildItem(1, insertedSymbol);
+    QVERIFY2(m_measureGraphicsItem->m_symbolPositions.isEmpty(),
+             "Positions of the last spacing are used after insert");
+
+    m_measureGraphicsItem->setSymbolPositions(QVector<qreal>() << 0 << 15 << 30);
+    m_measureGraphicsItem->removeChildItem(insertedSymbol);
+    QVERIFY2(m_measureGraphicsItem->m_symbolPositions.isEmpty(),
+             "Positions of the last spacing are used after remove");
+
+    delete insertedSymbol;
+}
+
 void MeasureGraphicsItemTest::testBoundingRect()
 {
     int testItemWidth = 200;